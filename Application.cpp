@@ -43,6 +43,11 @@ Application::Application()
 
 	//Timer
 	time_manager = new TimeManager();
+
+	//Worker threads
+	jobs = new JobSystem();
+	loader = new AsyncLoader(jobs);
+	scheduler = new FrameScheduler(jobs);
 }
 
 Application::~Application()
@@ -63,6 +68,15 @@ Application::~Application()
 
 	delete time_manager;
 	time_manager = nullptr;
+
+	delete scheduler;
+	scheduler = nullptr;
+
+	delete loader;
+	loader = nullptr;
+
+	delete jobs;
+	jobs = nullptr;
 }
 
 bool Application::Init()
@@ -116,6 +130,9 @@ void Application::PrepareUpdate()
 	ms_timer.Start();
 
 	time_manager->Update();
+
+	//Resources the workers loaded since last frame get their GL objects
+	loader->Update(LOAD_FINISH_BUDGET_MS);
 }
 
 // ---------------------------------------------
@@ -142,47 +159,94 @@ void Application::FinishUpdate()
 	window->SetTitle(t);
 }
 
-// Call PreUpdate, Update and PostUpdate on all modules
+// Call PreUpdate, Update and PostUpdate on all modules, the scheduler runs
+// at the same time the ones that don't touch the same things
 update_status Application::Update()
 {
 	update_status ret = UPDATE_CONTINUE;
 	PrepareUpdate();
-	
-	list<Module*>::iterator it = list_modules.begin();
-	
-	while(it != list_modules.end() && ret == UPDATE_CONTINUE)
+
+	ret = scheduler->RunPhase(FRAME_PRE_UPDATE, list_modules, dt);
+
+	if (ret == UPDATE_CONTINUE)
 	{
-		if((*it)->IsEnabled())
-			ret = (*it)->PreUpdate(dt);
-		++it;
+		ret = scheduler->RunPhase(FRAME_UPDATE, list_modules, dt);
 	}
 
-	it = list_modules.begin();
-
-	while(it != list_modules.end() && ret == UPDATE_CONTINUE)
+	//The next frame simulates while this one renders
+	if (ret == UPDATE_CONTINUE)
 	{
-		if((*it)->IsEnabled())
-  			ret = (*it)->Update(dt);
-		++it;
+		scheduler->StartSimulation(list_modules, dt);
+		ret = scheduler->RunPhase(FRAME_POST_UPDATE, list_modules, dt);
 	}
 
-	it = list_modules.begin();
+	FinishUpdate();
+	return ret;
+}
 
-	while(it != list_modules.end() && ret == UPDATE_CONTINUE)
+// Frames per second with 1, 2, 4 and 8 cores on whatever is loaded, no frame cap
+update_status Application::Benchmark()
+{
+	update_status ret = UPDATE_CONTINUE;
+	int previous_cap = capped_ms;
+	capped_ms = -1;
+
+	uint cores[] = { 1, 2, 4, 8 };
+	for (uint i = 0; i < 4 && ret == UPDATE_CONTINUE; i++)
 	{
-		if((*it)->IsEnabled())
-			ret = (*it)->PostUpdate(dt);
-		++it;
+		SetNumCores(cores[i]);
+
+		for (uint frame = 0; frame < BENCHMARK_WARMUP_FRAMES && ret == UPDATE_CONTINUE; frame++)
+		{
+			ret = Update();
+		}
+
+		Timer timer;
+		renderer3D->ResetSubmitStats();
+		for (uint frame = 0; frame < BENCHMARK_FRAMES && ret == UPDATE_CONTINUE; frame++)
+		{
+			ret = Update();
+		}
+		uint ms = timer.Read();
+
+		//To stdout as well, there's no window to read the console from
+		char result[192];
+		sprintf_s(result, "Benchmark %d cores (%d workers): %d frames in %d ms, %.1f fps, submission %.3f ms/frame (%s)\n", cores[i], jobs->GetNumWorkers(), BENCHMARK_FRAMES, ms,
+			(ms > 0) ? BENCHMARK_FRAMES * 1000.0f / ms : 0.0f, renderer3D->GetAverageSubmitMs(),
+			renderer3D->IsIndirect() ? "core, indirect" : (renderer3D->IsCorePath() ? "core" : "fixed"));
+		printf("%s", result);
+		Log(result);
 	}
 
-	FinishUpdate();
+	SetNumCores(0);
+	capped_ms = previous_cap;
 	return ret;
 }
 
+// 0 goes back to one worker per core
+void Application::SetNumCores(uint cores)
+{
+	//Nothing of the old pool can be in flight
+	scheduler->WaitSimulation();
+	loader->Flush();
+
+	delete scheduler;
+	delete loader;
+	delete jobs;
+
+	jobs = new JobSystem((cores > 0) ? (int)cores - 1 : JOB_WORKERS_AUTO);
+	loader = new AsyncLoader(jobs);
+	scheduler = new FrameScheduler(jobs);
+}
+
 bool Application::CleanUp()
 {
 	bool ret = true;
 
+	//Nothing can be loading or simulating while the modules go
+	scheduler->WaitSimulation();
+	loader->Flush();
+
 	list<Module*>::reverse_iterator it = list_modules.rbegin();
 
 	while(it != list_modules.rend() && ret == true)
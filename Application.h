@@ -17,8 +17,14 @@
 #include "ModuleTextures.h"
 #include "ModuleGOManager.h"
 #include "TimeManager.h"
+#include "JobSystem.h"
+#include "AsyncLoader.h"
+#include "FrameScheduler.h"
 #include "MathGeoLib\include\MathGeoLib.h"
 
+#define BENCHMARK_WARMUP_FRAMES 60
+#define BENCHMARK_FRAMES 600
+
 enum STATES
 {
 	PLAY,
@@ -44,6 +50,9 @@ public:
 	ModuleGOManager* go_manager;
 
 	TimeManager* time_manager;
+	JobSystem* jobs;
+	AsyncLoader* loader;
+	FrameScheduler* scheduler;
 
 private:
 
@@ -69,6 +78,8 @@ public:
 
 	bool Init();
 	update_status Update();
+	update_status Benchmark();
+	void SetNumCores(uint cores);
 	bool CleanUp();
 	void SetMaxFPS(int max_fps);
 	int GetLastFPS();
@@ -77,6 +88,8 @@ public:
 
 
 	bool console_on;
+	bool headless = false;		// Hidden window and no vsync, for the benchmark
+	bool fixed_pipeline = false;		// Skip the core profile path
 	LCG* random_id = nullptr;
 
 private:
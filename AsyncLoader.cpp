@@ -0,0 +1,160 @@
+#include "AsyncLoader.h"
+#include <chrono>
+#include <float.h>
+
+// LoadRequest ----------------------------------------------
+
+LoadRequest::State LoadRequest::GetState() const
+{
+	return state;
+}
+
+bool LoadRequest::IsDone() const
+{
+	return state != LOADING;
+}
+
+uint LoadRequest::GetResult() const
+{
+	return (state == READY) ? result : 0;
+}
+
+void LoadRequest::Cancel()
+{
+	if (state == LOADING)
+	{
+		cancelled = true;
+	}
+	else if (state == READY)
+	{
+		state = CANCELLED;
+		if (discard)
+		{
+			discard(result);
+		}
+		result = 0;
+	}
+}
+
+// AsyncLoader ----------------------------------------------
+
+AsyncLoader::AsyncLoader(JobSystem* jobs) : jobs(jobs)
+{}
+
+AsyncLoader::~AsyncLoader()
+{
+	//Workers can't be left with requests pointing here, whatever they load is dropped
+	jobs->Wait(counter, true);
+}
+
+LoadHandle AsyncLoader::Request(const LoadRequest::WorkFunction& work, const LoadRequest::FinishFunction& finish, const LoadRequest::DiscardFunction& discard)
+{
+	LoadHandle request = std::make_shared<LoadRequest>();
+	request->work = work;
+	request->finish = finish;
+	request->discard = discard;
+	in_flight++;
+
+	jobs->ScheduleBackground([this, request]()
+	{
+		//Cancelled before a worker got to it, nothing to read
+		if (request->cancelled == false)
+		{
+			request->loaded = request->work();
+		}
+
+		std::lock_guard<std::mutex> lock(loaded_mutex);
+		loaded.push_back(request);
+	}, &counter);
+
+	return request;
+}
+
+uint AsyncLoader::Update(float budget_ms)
+{
+	//Without workers the loads run here, one per frame
+	if (jobs->GetNumWorkers() == 0)
+	{
+		jobs->RunPendingJob(true);
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	float elapsed_ms = 0.0f;
+	uint finished = 0;
+
+	while (finished == 0 || elapsed_ms < budget_ms)
+	{
+		LoadHandle request;
+		{
+			std::lock_guard<std::mutex> lock(loaded_mutex);
+			if (loaded.empty())
+			{
+				break;
+			}
+			request = loaded.front();
+			loaded.pop_front();
+		}
+
+		Finish(request);
+		finished++;
+		elapsed_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	last_update_ms = elapsed_ms;
+	return finished;
+}
+
+void AsyncLoader::Flush()
+{
+	//Finish steps may ask for more loads, until nothing is left
+	while (in_flight > 0)
+	{
+		jobs->Wait(counter, true);
+		Update(FLT_MAX);
+	}
+}
+
+uint AsyncLoader::GetNumInFlight() const
+{
+	return in_flight;
+}
+
+uint AsyncLoader::GetNumWaiting()
+{
+	std::lock_guard<std::mutex> lock(loaded_mutex);
+	return loaded.size();
+}
+
+uint AsyncLoader::GetNumFinished() const
+{
+	return num_finished;
+}
+
+float AsyncLoader::GetLastUpdateMs() const
+{
+	return last_update_ms;
+}
+
+void AsyncLoader::Finish(LoadHandle& request)
+{
+	in_flight--;
+	num_finished++;
+
+	if (request->cancelled)
+	{
+		request->state = LoadRequest::CANCELLED;
+		if (request->discard)
+		{
+			request->discard(0);
+		}
+	}
+	else
+	{
+		request->result = request->finish(request->loaded);
+		request->state = (request->result != 0) ? LoadRequest::READY : LoadRequest::FAILED;
+	}
+
+	//Whatever the work left in the captures goes now, discard is kept for a later Cancel
+	request->work = nullptr;
+	request->finish = nullptr;
+}
@@ -0,0 +1,89 @@
+#ifndef __ASYNCLOADER_H__
+#define __ASYNCLOADER_H__
+
+#include "Globals.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#define LOAD_FINISH_BUDGET_MS 2.0f		// Main thread time per frame for the finish steps, at least one goes
+
+// One asynchronous load, shared by whoever asked for it and the loader
+class LoadRequest
+{
+public:
+	enum State
+	{
+		LOADING,
+		READY,
+		FAILED,
+		CANCELLED
+	};
+
+	typedef std::function<bool()> WorkFunction;		// Worker thread: read, parse, decode. No GL
+	typedef std::function<uint(bool loaded)> FinishFunction;		// Main thread: GL objects, returns the result, 0 failed
+	typedef std::function<void(uint result)> DiscardFunction;		// Main thread: frees what a cancelled request left
+
+	State GetState() const;
+	bool IsDone() const;
+	uint GetResult() const;		// 0 until READY
+
+	// Nobody wants it anymore. A finished result is discarded now, a pending
+	// one when it arrives, and work that didn't start is skipped
+	void Cancel();
+
+private:
+	friend class AsyncLoader;
+
+	State state = LOADING;
+	std::atomic<bool> cancelled = { false };
+	bool loaded = false;		// Written by the worker before the request is queued back
+	uint result = 0;
+
+	WorkFunction work;
+	FinishFunction finish;
+	DiscardFunction discard;
+};
+
+typedef std::shared_ptr<LoadRequest> LoadHandle;
+
+// Loads split in two: the slow part (file reads, parsing, decoding) runs on the
+// job system workers as background jobs, the finish step that creates GL objects
+// is queued back and run on the main thread in Update, a few each frame within a
+// time budget
+class AsyncLoader
+{
+public:
+	AsyncLoader(JobSystem* jobs);
+	~AsyncLoader();
+
+	LoadHandle Request(const LoadRequest::WorkFunction& work, const LoadRequest::FinishFunction& finish, const LoadRequest::DiscardFunction& discard = nullptr);
+
+	// Main thread only
+	uint Update(float budget_ms);		// Finish steps run, at least one if any is waiting
+	void Flush();		// Waits for every request in flight and finishes them all
+
+	uint GetNumInFlight() const;
+	uint GetNumWaiting();		// Loaded by a worker, waiting for their finish step
+	uint GetNumFinished() const;
+	float GetLastUpdateMs() const;
+
+private:
+	void Finish(LoadHandle& request);
+
+private:
+	JobSystem* jobs = nullptr;
+	JobCounter counter;
+
+	std::mutex loaded_mutex;
+	std::deque<LoadHandle> loaded;
+
+	uint in_flight = 0;
+	uint num_finished = 0;
+	float last_update_ms = 0.0f;
+};
+
+#endif // !__ASYNCLOADER_H__
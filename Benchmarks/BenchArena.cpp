@@ -0,0 +1,122 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include <vector>
+
+#define ARENA_OBJECTS 100000
+#define ARENA_CHILDS 8
+
+// Scene before the arena: every GameObject and Component with its own new, and
+// every GameObject deleting its childs
+static void DeleteWithChilds(GameObject* go)
+{
+	for (uint i = 0; i < go->childs.size(); i++)
+	{
+		DeleteWithChilds(go->childs[i]);
+	}
+	delete go;
+}
+
+// Objects level by level, ARENA_CHILDS under each
+static void BuildScene(std::vector<GameObject*>& objects)
+{
+	objects.clear();
+	objects.push_back(App->go_manager->CreateGameObject(nullptr, "Object"));
+	objects.back()->AddComponent(Component::TRANSFORM);
+	for (uint i = 1; i < ARENA_OBJECTS; i++)
+	{
+		objects.push_back(App->go_manager->CreateGameObject(objects[(i - 1) / ARENA_CHILDS], "Object"));
+		objects.back()->AddComponent(Component::TRANSFORM);
+	}
+}
+
+BENCHMARK(ArenaSceneTeardown)
+{
+	ModuleGOManager* manager = App->go_manager;
+
+	//Only the GameObjects, the allocators alone
+	std::vector<GameObject*> objects;
+	BenchmarkTimer timer;
+	objects.push_back(new GameObject(nullptr, "Object"));
+	for (uint i = 1; i < ARENA_OBJECTS; i++)
+	{
+		GameObject* parent = objects[(i - 1) / ARENA_CHILDS];
+		objects.push_back(new GameObject(parent, "Object"));
+		parent->childs.push_back(objects.back());
+	}
+	double new_ms = timer.ReadMs();
+
+	timer.Start();
+	DeleteWithChilds(objects[0]);
+	double delete_ms = timer.ReadMs();
+
+	SceneArena<GameObject> arena;
+	objects.clear();
+	timer.Start();
+	objects.push_back(arena.New(nullptr, "Object"));
+	for (uint i = 1; i < ARENA_OBJECTS; i++)
+	{
+		GameObject* parent = objects[(i - 1) / ARENA_CHILDS];
+		objects.push_back(arena.New(parent, "Object"));
+		parent->childs.push_back(objects.back());
+	}
+	double arena_ms = timer.ReadMs();
+
+	timer.Start();
+	arena.Reset();
+	double arena_reset_ms = timer.ReadMs();
+	printf("  GameObjects only: new %.1f ms, delete %.1f ms, arena %.1f ms, arena reset %.1f ms\n", new_ms, delete_ms, arena_ms, arena_reset_ms);
+
+	//Scene with a transform each, with new and delete
+	std::vector<ComponentTransform*> transforms;
+	objects.clear();
+	timer.Start();
+	objects.push_back(new GameObject(nullptr, "Object"));
+	transforms.push_back(new ComponentTransform(Component::TRANSFORM));
+	for (uint i = 1; i < ARENA_OBJECTS; i++)
+	{
+		GameObject* parent = objects[(i - 1) / ARENA_CHILDS];
+		objects.push_back(new GameObject(parent, "Object"));
+		parent->childs.push_back(objects.back());
+		transforms.push_back(new ComponentTransform(Component::TRANSFORM));
+	}
+	new_ms = timer.ReadMs();
+
+	timer.Start();
+	DeleteWithChilds(objects[0]);
+	for (uint i = 0; i < transforms.size(); i++)
+	{
+		delete transforms[i];
+	}
+	delete_ms = timer.ReadMs();
+	manager->transforms.Update(manager->GetRoot());
+	printf("  Scene, new/delete: build %.1f ms, teardown %.1f ms, %d news\n", new_ms, delete_ms, ARENA_OBJECTS * 2);
+
+	//Arena and pools through the manager, deleting one by one like the editor does
+	timer.Start();
+	BuildScene(objects);
+	double build_ms = timer.ReadMs();
+	uint allocations = manager->scene_objects.GetNumAllocations();
+	uint blocks = manager->scene_objects.GetNumBlocks();
+	float arena_mb = manager->scene_objects.GetMemoryUsage() / (1024.0f * 1024.0f);
+
+	timer.Start();
+	manager->DeleteGameObject(objects[0]);
+	manager->PreUpdate(0.0f);
+	double one_by_one_ms = timer.ReadMs();
+	manager->transforms.Update(manager->GetRoot());
+
+	//Arena and pools, the whole scene at once like loading another one
+	BuildScene(objects);
+	timer.Start();
+	manager->DeleteScene();
+	double reset_ms = timer.ReadMs();
+
+	printf("  Scene, arena and pools: build %.1f ms, %d objects in %d blocks of %d, %.1f MB\n", build_ms, allocations, blocks, SCENE_ARENA_BLOCK, arena_mb);
+	printf("  Scene, arena and pools: teardown one by one %.1f ms, whole scene %.1f ms\n", one_by_one_ms, reset_ms);
+
+	//The next benchmarks need a root again
+	Json config;
+	manager->Init(config);
+}
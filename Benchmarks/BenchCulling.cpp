@@ -0,0 +1,88 @@
+#include "Benchmarks.h"
+#include "Octree.h"
+#include "ComponentCamera.h"
+#include <vector>
+
+#define CULLING_FRAMES 100
+
+// Game camera above the level turning a little every frame, like the scene one
+static void PointCamera(ComponentCamera& camera, uint frame)
+{
+	camera.frustum.pos = float3(0.0f, 10.0f, 0.0f);
+	camera.frustum.front = float3(sin(frame * 0.01f), 0.0f, cos(frame * 0.01f));
+	camera.frustum.up = float3::unitY;
+}
+
+// Visible objects as flags per box, the order of the lists doesn't matter
+static uint CountDifferences(const std::vector<GameObject*>& visible, const std::vector<bool>& expected)
+{
+	std::vector<bool> flags(expected.size(), false);
+	for (uint i = 0; i < visible.size(); i++)
+	{
+		flags[GetBenchmarkIndex(visible[i])] = true;
+	}
+
+	uint differences = 0;
+	for (uint i = 0; i < expected.size(); i++)
+	{
+		differences += (flags[i] != expected[i]) ? 1 : 0;
+	}
+	return differences;
+}
+
+BENCHMARK(CullingHierarchical)
+{
+	ComponentCamera camera(Component::CAMERA);
+	camera.SetFarDistance(500.0f);
+
+	uint sizes[] = { 10000, 100000, 1000000 };
+	for (uint s = 0; s < 3; s++)
+	{
+		LCG rng(1);
+		std::vector<AABB> boxes;
+		MakeRandomBoxes(rng, sizes[s], boxes);
+
+		Octree octree;
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			octree.Insert(GetBenchmarkObject(i), boxes[i]);
+		}
+
+		double hierarchical_ms = 0.0;
+		double batched_ms = 0.0;
+		double every_box_ms = 0.0;
+		uint differences = 0;
+		uint num_visible = 0;
+		std::vector<GameObject*> visible;
+		std::vector<bool> contained(boxes.size());
+		for (uint frame = 0; frame < CULLING_FRAMES; frame++)
+		{
+			PointCamera(camera, frame);
+
+			//What every mesh did before, its own box against the camera
+			BenchmarkTimer timer;
+			for (uint i = 0; i < boxes.size(); i++)
+			{
+				contained[i] = camera.ContainsAABB(boxes[i]);
+			}
+			every_box_ms += timer.ReadMs();
+
+			visible.clear();
+			timer.Start();
+			octree.FrustumCulling(&camera, visible);
+			hierarchical_ms += timer.ReadMs();
+			differences += CountDifferences(visible, contained);
+			num_visible += visible.size();
+
+			//Same batched test on every node, without skipping the ones outside
+			visible.clear();
+			timer.Start();
+			octree.FrustumCullingBruteForce(&camera, visible);
+			batched_ms += timer.ReadMs();
+			differences += CountDifferences(visible, contained);
+		}
+
+		printf("  %7d boxes, %d visible: hierarchical %.3f ms per frame, every node batched %.3f ms, every box %.3f ms, %d differences\n", sizes[s],
+			num_visible / CULLING_FRAMES, hierarchical_ms / CULLING_FRAMES, batched_ms / CULLING_FRAMES, every_box_ms / CULLING_FRAMES, differences);
+	}
+}
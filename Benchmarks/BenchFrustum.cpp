@@ -0,0 +1,114 @@
+#include "Benchmarks.h"
+#include "FrustumCulling.h"
+#include "ComponentCamera.h"
+#include <vector>
+
+#define FRUSTUM_BOXES 1000000
+#define FRUSTUM_FRAMES 20
+
+// ContainsAABB before the kernel: planes taken from the frustum on every call and
+// the 8 corners of the box tested against each of them
+static bool ContainsAABBCorners(const Frustum& frustum, const AABB& box)
+{
+	float3 corners[8];
+	box.GetCornerPoints(corners);
+
+	Plane planes[6];
+	frustum.GetPlanes(planes);
+
+	for (int p = 0; p < 6; ++p)
+	{
+		int in_count = 8;
+		for (int i = 0; i < 8; ++i)
+		{
+			if (planes[p].IsOnPositiveSide(corners[i]))
+			{
+				--in_count;
+			}
+		}
+
+		if (in_count == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+BENCHMARK(CullAABBsAgainstContainsAABB)
+{
+#ifdef __AVX__
+	printf("  CullAABBs with AVX, 8 boxes at a time\n");
+#else
+	printf("  CullAABBs with SSE, 4 boxes at a time\n");
+#endif
+
+	ComponentCamera camera(Component::CAMERA);
+	camera.SetFarDistance(500.0f);
+	camera.frustum.pos = float3(0.0f, 10.0f, 0.0f);
+
+	LCG rng(1);
+	std::vector<AABB> boxes;
+	MakeRandomBoxes(rng, FRUSTUM_BOXES, boxes);
+
+	AABBArray array;
+	for (uint i = 0; i < boxes.size(); i++)
+	{
+		array.Push(boxes[i]);
+	}
+
+	double corners_ms = 0.0;
+	double contains_ms = 0.0;
+	double batched_ms = 0.0;
+	uint num_visible = 0;
+	uint corner_differences = 0;
+	uint differences = 0;
+	std::vector<bool> contained(boxes.size());
+	std::vector<uint> visible(boxes.size());
+	for (uint frame = 0; frame < FRUSTUM_FRAMES; frame++)
+	{
+		camera.frustum.front = float3(sin(frame * 0.3f), 0.0f, cos(frame * 0.3f));
+
+		BenchmarkTimer timer;
+		uint count = 0;
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			count += ContainsAABBCorners(camera.frustum, boxes[i]) ? 1 : 0;
+		}
+		corners_ms += timer.ReadMs();
+
+		timer.Start();
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			contained[i] = camera.ContainsAABB(boxes[i]);
+		}
+		contains_ms += timer.ReadMs();
+
+		//The planes are extracted once per frame, like the octree does
+		timer.Start();
+		FrustumPlanes planes;
+		planes.Set(camera.frustum);
+		uint num_batched = CullAABBs(planes, FRUSTUM_ALL_PLANES, array, visible.data());
+		batched_ms += timer.ReadMs();
+
+		//Same boxes, not only the same count
+		uint num_contained = 0;
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			num_contained += contained[i] ? 1 : 0;
+		}
+		differences += (num_batched > num_contained) ? num_batched - num_contained : num_contained - num_batched;
+		for (uint i = 0; i < num_batched; i++)
+		{
+			differences += contained[visible[i]] ? 0 : 1;
+		}
+		corner_differences += (count > num_contained) ? count - num_contained : num_contained - count;
+		num_visible += num_batched;
+	}
+
+	printf("  %d boxes, %d visible: corners %.2f ms per frame, ContainsAABB %.2f ms, CullAABBs %.2f ms\n", FRUSTUM_BOXES, num_visible / FRUSTUM_FRAMES,
+		corners_ms / FRUSTUM_FRAMES, contains_ms / FRUSTUM_FRAMES, batched_ms / FRUSTUM_FRAMES);
+	printf("  %.1f ns per box batched against %.1f ns with ContainsAABB, %d differences, %d in the count of the corners test\n",
+		batched_ms * 1000000.0 / ((double)FRUSTUM_BOXES * FRUSTUM_FRAMES), contains_ms * 1000000.0 / ((double)FRUSTUM_BOXES * FRUSTUM_FRAMES),
+		differences, corner_differences);
+}
@@ -0,0 +1,196 @@
+#include "Benchmarks.h"
+#include "IndirectBuilder.h"
+#include "RenderQueue.h"
+#include "ModuleMesh.h"
+#include "JobSystem.h"
+#include <vector>
+
+#define INDIRECT_MESHES 256
+#define INDIRECT_FRAMES 50
+
+// Meshes with three levels each, placed one after the other in the arena. Every
+// outside-th one is left out of it, 0 keeps them all in
+static void MakeMeshes(LCG& rng, uint outside, Mesh* meshes)
+{
+	for (uint i = 0; i < INDIRECT_MESHES; i++)
+	{
+		Mesh& mesh = meshes[i];
+		mesh.id_vertices = i + 1;
+		mesh.num_lods = 3;
+		for (uint l = 0; l < mesh.num_lods; l++)
+		{
+			mesh.lods[l].first_index = l * 3000;
+			mesh.lods[l].num_indices = 3000 >> l;
+		}
+		mesh.arena_vertex = (outside != 0 && i % outside == 0) ? -1 : (int)(i * 1000);
+		mesh.arena_index = i * 6000;
+		mesh.arena_center = float3(rng.Float(-5.0f, 5.0f), rng.Float(-5.0f, 5.0f), rng.Float(-5.0f, 5.0f));
+		mesh.arena_scale = float3(rng.Float(0.5f, 5.0f), rng.Float(0.5f, 5.0f), rng.Float(0.5f, 5.0f));
+	}
+}
+
+// A frame of what culling left visible, sorted like the renderer does before drawing indirect
+static void SubmitFrame(LCG& rng, uint num_packets, const Mesh* meshes, RenderQueue& queue)
+{
+	queue.Clear();
+	for (uint i = 0; i < num_packets; i++)
+	{
+		DrawPacket packet;
+		packet.pass = (rng.Int(0, 7) == 0) ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE;
+		packet.shader = rng.Int(0, 1);
+		packet.texture = rng.Int(0, 31);
+		packet.mesh = &meshes[rng.Int(0, INDIRECT_MESHES - 1)];
+		packet.lod = rng.Int(0, 2);
+		packet.depth = rng.Float();
+		packet.transform = float4x4::FromTRS(float3(rng.Float(-1000.0f, 1000.0f), 0.0f, rng.Float(-1000.0f, 1000.0f)),
+			Quat::RotateY(rng.Float(0.0f, 6.28f)), float3::one).Transposed();
+		queue.Submit(packet);
+	}
+	queue.Sort();
+}
+
+// Batches, command and transform of every packet with plain floats, one packet at a time
+static void WriteScalar(const RenderQueue& queue, std::vector<IndirectBatch>& batches, std::vector<uint>& missing, DrawElementsIndirectCommand* commands,
+	float4x4* transforms)
+{
+	batches.clear();
+	missing.clear();
+	uint pass = 0;
+	for (uint i = 0; i < queue.GetNumPackets(); i++)
+	{
+		const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(i));
+		if (batches.empty() || packet.pass != pass || packet.shader != batches.back().shader || packet.texture != batches.back().texture)
+		{
+			IndirectBatch batch;
+			batch.shader = packet.shader;
+			batch.texture = packet.texture;
+			batch.first_command = i;
+			batches.push_back(batch);
+			pass = packet.pass;
+		}
+		batches.back().num_commands++;
+
+		const Mesh& m = *packet.mesh;
+		bool resident = (m.arena_vertex >= 0);
+		if (resident == false)
+		{
+			missing.push_back(i);
+		}
+
+		commands[i].count = resident ? m.lods[packet.lod].num_indices : 0;
+		commands[i].instance_count = resident ? 1 : 0;
+		commands[i].first_index = m.arena_index + m.lods[packet.lod].first_index;
+		commands[i].base_vertex = m.arena_vertex;
+		commands[i].base_instance = i;
+
+		const float* in = packet.transform.v[0];
+		float* out = transforms[i].v[0];
+		for (uint c = 0; c < 4; c++)
+		{
+			out[c] = in[c] * m.arena_scale.x;
+			out[4 + c] = in[4 + c] * m.arena_scale.y;
+			out[8 + c] = in[8 + c] * m.arena_scale.z;
+			out[12 + c] = in[12 + c] + in[c] * m.arena_center.x + in[4 + c] * m.arena_center.y + in[8 + c] * m.arena_center.z;
+		}
+	}
+}
+
+// Each write checked on its own, not on what the one before left
+static void ClearOutput(std::vector<DrawElementsIndirectCommand>& commands, std::vector<float4x4>& transforms)
+{
+	memset(commands.data(), 0, commands.size() * sizeof(DrawElementsIndirectCommand));
+	memset(transforms.data(), 0, transforms.size() * sizeof(float4x4));
+}
+
+// Commands, transforms, batches and missing that don't match the scalar loop
+static uint CountDifferences(const IndirectBuilder& builder, const std::vector<IndirectBatch>& batches, const std::vector<uint>& missing,
+	const std::vector<DrawElementsIndirectCommand>& commands, const std::vector<float4x4>& transforms, const std::vector<DrawElementsIndirectCommand>& expected_commands,
+	const std::vector<float4x4>& expected_transforms)
+{
+	uint differences = (builder.GetBatches().size() == batches.size()) ? 0 : 1;
+	differences += (builder.GetMissing() == missing) ? 0 : 1;
+	for (uint i = 0; i < batches.size() && i < builder.GetBatches().size(); i++)
+	{
+		differences += (memcmp(&builder.GetBatches()[i], &batches[i], sizeof(IndirectBatch)) == 0) ? 0 : 1;
+	}
+	for (uint i = 0; i < builder.GetNumCommands(); i++)
+	{
+		differences += (memcmp(&commands[i], &expected_commands[i], sizeof(DrawElementsIndirectCommand)) == 0) ? 0 : 1;
+		differences += transforms[i].Equals(expected_transforms[i], 1e-3f) ? 0 : 1;
+	}
+	return differences;
+}
+
+BENCHMARK(IndirectBuilderAgainstScalar)
+{
+	JobSystem one_worker(1);
+	JobSystem all_workers(JOB_WORKERS_AUTO);
+
+	uint sizes[] = { 10000, 100000 };
+	uint outside[] = { 0, 4 };
+	const char* outside_names[] = { "every mesh in the arena", "one mesh in 4 outside" };
+	for (uint o = 0; o < 2; o++)
+	{
+		for (uint s = 0; s < 2; s++)
+		{
+			LCG rng(1);
+			Mesh* meshes = new Mesh[INDIRECT_MESHES];
+			MakeMeshes(rng, outside[o], meshes);
+
+			RenderQueue queue;
+			IndirectBuilder builder;
+			std::vector<DrawElementsIndirectCommand> commands(sizes[s]);
+			std::vector<float4x4> transforms(sizes[s]);
+			std::vector<DrawElementsIndirectCommand> expected_commands(sizes[s]);
+			std::vector<float4x4> expected_transforms(sizes[s]);
+			std::vector<IndirectBatch> batches;
+			std::vector<uint> missing;
+
+			double scalar_ms = 0.0;
+			double prepare_ms = 0.0;
+			double calling_ms = 0.0;
+			double one_ms = 0.0;
+			double all_ms = 0.0;
+			uint differences = 0;
+			for (uint frame = 0; frame < INDIRECT_FRAMES; frame++)
+			{
+				SubmitFrame(rng, sizes[s], meshes, queue);
+
+				BenchmarkTimer timer;
+				WriteScalar(queue, batches, missing, expected_commands.data(), expected_transforms.data());
+				scalar_ms += timer.ReadMs();
+
+				timer.Start();
+				builder.Prepare(queue);
+				prepare_ms += timer.ReadMs();
+
+				//Same commands on the calling thread, one worker and all of them
+				ClearOutput(commands, transforms);
+				timer.Start();
+				builder.Write(queue, commands.data(), transforms.data(), 0, nullptr);
+				calling_ms += timer.ReadMs();
+				differences += CountDifferences(builder, batches, missing, commands, transforms, expected_commands, expected_transforms);
+
+				ClearOutput(commands, transforms);
+				timer.Start();
+				builder.Write(queue, commands.data(), transforms.data(), 0, &one_worker);
+				one_ms += timer.ReadMs();
+				differences += CountDifferences(builder, batches, missing, commands, transforms, expected_commands, expected_transforms);
+
+				ClearOutput(commands, transforms);
+				timer.Start();
+				builder.Write(queue, commands.data(), transforms.data(), 0, &all_workers);
+				all_ms += timer.ReadMs();
+				differences += CountDifferences(builder, batches, missing, commands, transforms, expected_commands, expected_transforms);
+			}
+
+			printf("  %6d packets, %s, %d batches, %d missing: scalar loop %.3f ms per frame\n", sizes[s], outside_names[o], (uint)batches.size(),
+				(uint)missing.size(), scalar_ms / INDIRECT_FRAMES);
+			printf("         prepare %.3f ms, write on the calling thread %.3f ms, 1 worker %.3f ms, all %d workers %.3f ms, %d differences\n",
+				prepare_ms / INDIRECT_FRAMES, calling_ms / INDIRECT_FRAMES, one_ms / INDIRECT_FRAMES, all_workers.GetNumWorkers(), all_ms / INDIRECT_FRAMES,
+				differences);
+
+			delete[] meshes;
+		}
+	}
+}
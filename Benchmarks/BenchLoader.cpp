@@ -0,0 +1,186 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include "ModuleMesh.h"
+#include <string>
+#include <vector>
+
+#define LOADER_MESHES 32
+#define LOADER_GRID 255		// Quads per side, 65536 vertices with 32 bit indices
+
+// Grid of LOADER_GRID x LOADER_GRID quads with normals and UVs, bent so it isn't flat
+static aiMesh* CreateGridMesh(const char* name)
+{
+	uint side = LOADER_GRID + 1;
+	aiMesh* mesh = new aiMesh();
+	mesh->mName = aiString(std::string(name));
+	mesh->mNumVertices = side * side;
+	mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+	mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+	mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+	mesh->mNumUVComponents[0] = 2;
+
+	for (uint z = 0; z < side; z++)
+	{
+		for (uint x = 0; x < side; x++)
+		{
+			uint i = z * side + x;
+			float u = (float)x / LOADER_GRID;
+			float v = (float)z / LOADER_GRID;
+			mesh->mVertices[i] = aiVector3D(u * 10.0f, sin(u * 6.0f) * cos(v * 6.0f), v * 10.0f);
+			mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+			mesh->mTextureCoords[0][i] = aiVector3D(u, v, 0.0f);
+		}
+	}
+
+	mesh->mNumFaces = LOADER_GRID * LOADER_GRID * 2;
+	mesh->mFaces = new aiFace[mesh->mNumFaces];
+	for (uint z = 0; z < LOADER_GRID; z++)
+	{
+		for (uint x = 0; x < LOADER_GRID; x++)
+		{
+			uint corner = z * side + x;
+			uint quad[6] = { corner, corner + side, corner + 1, corner + 1, corner + side, corner + side + 1 };
+			for (uint t = 0; t < 2; t++)
+			{
+				aiFace& face = mesh->mFaces[(z * LOADER_GRID + x) * 2 + t];
+				face.mNumIndices = 3;
+				face.mIndices = new unsigned int[3];
+				memcpy(face.mIndices, &quad[t * 3], sizeof(uint) * 3);
+			}
+		}
+	}
+	return mesh;
+}
+
+// What the upload reads, so both ways touch every byte of the meshes
+static uint Checksum(const void* data, uint bytes)
+{
+	uint sum = 0;
+	const uint* words = (const uint*)data;
+	for (uint i = 0; i < bytes / sizeof(uint); i++)
+	{
+		sum += words[i];
+	}
+	return sum;
+}
+
+// The loader before the files were mapped: the whole file to a buffer, then
+// every block copied to its own array
+struct CopiedMesh
+{
+	char* vertices = nullptr;
+	char* indices = nullptr;
+};
+
+static uint LoadWithCopies(const char* path, CopiedMesh& mesh, uint& checksum)
+{
+	char* buffer = nullptr;
+	uint size = App->fs->Load(path, &buffer);
+	if (size < sizeof(ShlHeader))
+	{
+		delete[] buffer;
+		return 0;
+	}
+
+	ShlHeader header;
+	memcpy(&header, buffer, sizeof(ShlHeader));
+	uint vertex_bytes = header.num_vertices * sizeof(PackedVertex);
+	uint index_bytes = header.num_indices * header.index_size;
+
+	mesh.vertices = new char[vertex_bytes];
+	memcpy(mesh.vertices, buffer + header.vertices_offset, vertex_bytes);
+	mesh.indices = new char[index_bytes];
+	memcpy(mesh.indices, buffer + header.indices_offset, index_bytes);
+	delete[] buffer;
+
+	checksum += Checksum(mesh.vertices, vertex_bytes) + Checksum(mesh.indices, index_bytes);
+	return size;
+}
+
+static uint LoadMapped(const char* path, Mesh*& mesh, uint& checksum)
+{
+	uint size = 0;
+	mesh = new Mesh();
+	if (App->meshes->ReadMeshFile(mesh, path, size) == false)
+	{
+		return 0;
+	}
+
+	checksum += Checksum(mesh->vertices, mesh->num_vertices * sizeof(PackedVertex)) + Checksum(mesh->indices, mesh->GetTotalIndices() * mesh->index_size);
+	return size;
+}
+
+static void Report(const char* name, uint bytes, double ms, float working_set, float private_mb)
+{
+	float mb = bytes / (1024.0f * 1024.0f);
+	printf("  %-8s %.1f MB in %.1f ms, %.0f MB/s, working set +%.1f MB, private +%.1f MB\n", name, mb, ms, mb / (ms / 1000.0), working_set, private_mb);
+}
+
+BENCHMARK(LoaderMappedMeshes)
+{
+	//Written by the importer, without the optimizer and the LODs they are only quicker to make
+	bool optimize = App->meshes->optimize_meshes;
+	bool lods = App->meshes->generate_lods;
+	App->meshes->optimize_meshes = false;
+	App->meshes->generate_lods = false;
+	App->fs->MakeDirectory(BENCHMARK_FOLDER MESH_FOLDER);
+
+	std::vector<std::string> files(LOADER_MESHES);
+	for (uint i = 0; i < LOADER_MESHES; i++)
+	{
+		char name[32];
+		sprintf_s(name, "Grid_%d", i);
+		aiMesh* mesh = CreateGridMesh(name);
+		App->meshes->ImportMesh(mesh, files[i], BENCHMARK_FOLDER);
+		delete mesh;
+	}
+	App->meshes->optimize_meshes = optimize;
+	App->meshes->generate_lods = lods;
+
+	//Once each first, the files come from the OS cache in both
+	for (uint pass = 0; pass < 2; pass++)
+	{
+		uint checksum_copies = 0;
+		uint checksum_mapped = 0;
+
+		float working_set = GetWorkingSetMB();
+		float private_mb = GetPrivateMB();
+		std::vector<CopiedMesh> copies(LOADER_MESHES);
+		uint bytes = 0;
+		BenchmarkTimer timer;
+		for (uint i = 0; i < LOADER_MESHES; i++)
+		{
+			bytes += LoadWithCopies(files[i].data(), copies[i], checksum_copies);
+		}
+		double ms = timer.ReadMs();
+		if (pass == 1)
+		{
+			Report("Copies", bytes, ms, GetWorkingSetMB() - working_set, GetPrivateMB() - private_mb);
+		}
+		for (uint i = 0; i < LOADER_MESHES; i++)
+		{
+			delete[] copies[i].vertices;
+			delete[] copies[i].indices;
+		}
+
+		working_set = GetWorkingSetMB();
+		private_mb = GetPrivateMB();
+		std::vector<Mesh*> meshes(LOADER_MESHES, nullptr);
+		bytes = 0;
+		timer.Start();
+		for (uint i = 0; i < LOADER_MESHES; i++)
+		{
+			bytes += LoadMapped(files[i].data(), meshes[i], checksum_mapped);
+		}
+		ms = timer.ReadMs();
+		if (pass == 1)
+		{
+			Report("Mapped", bytes, ms, GetWorkingSetMB() - working_set, GetPrivateMB() - private_mb);
+			printf("  Same data: %s, peak working set %.1f MB\n", (checksum_copies == checksum_mapped) ? "yes" : "NO", GetPeakWorkingSetMB());
+		}
+		for (uint i = 0; i < LOADER_MESHES; i++)
+		{
+			delete meshes[i];
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include "Benchmarks.h"
+#include "Octree.h"
+#include <vector>
+
+#define OCTREE_QUERIES 1000
+#define OCTREE_BRUTE_QUERIES 100		// Every box for each, enough to compare
+#define OCTREE_QUERY_SIZE 50.0f
+
+BENCHMARK(OctreeBuildAndQuery)
+{
+	uint sizes[] = { 10000, 100000, 1000000 };
+	for (uint s = 0; s < 3; s++)
+	{
+		LCG rng(1);
+		std::vector<AABB> boxes;
+		MakeRandomBoxes(rng, sizes[s], boxes);
+
+		Octree octree;
+		BenchmarkTimer timer;
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			octree.Insert(GetBenchmarkObject(i), boxes[i]);
+		}
+		double build_ms = timer.ReadMs();
+
+		std::vector<AABB> queries(OCTREE_QUERIES);
+		for (uint q = 0; q < OCTREE_QUERIES; q++)
+		{
+			float3 center(rng.Float(-1000.0f, 1000.0f), 0.0f, rng.Float(-1000.0f, 1000.0f));
+			queries[q] = AABB(center - float3(OCTREE_QUERY_SIZE), center + float3(OCTREE_QUERY_SIZE));
+		}
+
+		std::vector<GameObject*> found;
+		std::vector<uint> num_found(OCTREE_QUERIES);
+		timer.Start();
+		for (uint q = 0; q < OCTREE_QUERIES; q++)
+		{
+			found.clear();
+			octree.CollectIntersections(found, queries[q]);
+			num_found[q] = found.size();
+		}
+		double query_ms = timer.ReadMs();
+
+		//Every box against the same queries, the counts have to match
+		uint mismatches = 0;
+		timer.Start();
+		for (uint q = 0; q < OCTREE_BRUTE_QUERIES; q++)
+		{
+			uint count = 0;
+			for (uint i = 0; i < boxes.size(); i++)
+			{
+				count += queries[q].Intersects(boxes[i]) ? 1 : 0;
+			}
+			mismatches += (count != num_found[q]) ? 1 : 0;
+		}
+		double brute_ms = timer.ReadMs();
+
+		//Every object moves a little, most stay in their node
+		timer.Start();
+		for (uint i = 0; i < boxes.size(); i++)
+		{
+			boxes[i].Translate(float3(1.0f, 0.0f, 0.0f));
+			octree.Update(GetBenchmarkObject(i), boxes[i]);
+		}
+		double update_ms = timer.ReadMs();
+
+		printf("  %7d boxes: build %.1f ms, update all %.1f ms, %d nodes, %.0f bytes per object\n", sizes[s], build_ms, update_ms,
+			octree.GetNumNodes(), (float)octree.GetMemoryUsage() / sizes[s]);
+		printf("           %d queries %.1f ms (%.3f ms each) against %.3f ms each testing every box, %d mismatches\n", OCTREE_QUERIES, query_ms,
+			query_ms / OCTREE_QUERIES, brute_ms / OCTREE_BRUTE_QUERIES, mismatches);
+	}
+}
@@ -0,0 +1,175 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include "SceneFormat.h"
+#include <vector>
+
+#define FORMAT_OBJECTS 10000
+#define FORMAT_CHILDS 8
+#define FORMAT_JSON_PATH BENCHMARK_FOLDER "/Format.json"
+#define FORMAT_BINARY_PATH BENCHMARK_FOLDER "/Format." SCENE_EXTENSION
+
+// Every object with a transform and one of three with a camera too. Materials
+// are left out, loading them requests their textures
+static void BuildScene()
+{
+	std::vector<GameObject*> objects;
+	for (uint i = 0; i < FORMAT_OBJECTS; i++)
+	{
+		GameObject* parent = (i == 0) ? nullptr : objects[(i - 1) / FORMAT_CHILDS];
+		objects.push_back(App->go_manager->CreateGameObject(parent, "Object"));
+
+		ComponentTransform* transform = (ComponentTransform*)objects.back()->AddComponent(Component::TRANSFORM);
+		transform->SetTranslation(float3((float)(i % 10), 0.5f, (float)(i % 7)));
+		transform->SetRotation(float3(0.0f, (float)(i % 360), 0.0f));
+		transform->SetScale(float3::one);
+
+		if (i % 3 == 2)
+		{
+			objects.back()->AddComponent(Component::CAMERA);
+		}
+	}
+}
+
+static uint SaveJson(char** buffer)
+{
+	Json data;
+	data.AddArray("Game Objects");
+	App->go_manager->GetRoot()->Save(data);
+	return data.Save(buffer);
+}
+
+static uint SaveBinary(char** buffer)
+{
+	SceneWriter writer;
+	App->go_manager->GetRoot()->Save(writer);
+	return writer.Save(buffer);
+}
+
+static double LoadScene(const char* path)
+{
+	//The old scene goes before the timer, only the load is measured
+	App->go_manager->DeleteScene();
+	Json config;
+	App->go_manager->Init(config);
+
+	BenchmarkTimer timer;
+	App->go_manager->LoadScene(path);
+	return timer.ReadMs();
+}
+
+// Cameras follow their transform when it's updated and change its scale, the
+// second update is the one that leaves the scene still
+static void UpdateTransforms()
+{
+	App->go_manager->transforms.Update(App->go_manager->GetRoot());
+	App->go_manager->transforms.Update(App->go_manager->GetRoot());
+}
+
+static bool SameComponent(const SceneComponentRecord& a, const SceneComponentRecord& b)
+{
+	bool same = a.type == b.type && a.id == b.id && a.enabled == b.enabled && a.flags == b.flags;
+	for (uint i = 0; i < sizeof(a.camera) / sizeof(float); i++)
+	{
+		same = same && Abs(a.transform.local[i] - b.transform.local[i]) < 1e-4f;
+	}
+	return same;
+}
+
+// Records of two scene files that don't match. JSON numbers are written with 6
+// decimals, so the floats are compared with that precision. A camera keeps its
+// fov in the scale of its transform with a 0 on x, the rotation read back from
+// that matrix can come out flipped, so those transforms are not compared
+static uint CountDifferentRecords(const char* a_data, uint a_size, const char* b_data, uint b_size)
+{
+	SceneReader a;
+	SceneReader b;
+	if (a.Open(a_data, a_size) == false || b.Open(b_data, b_size) == false || a.GetNumObjects() != b.GetNumObjects() ||
+		a.GetNumComponents() != b.GetNumComponents())
+	{
+		return a.GetNumObjects() + a.GetNumComponents();
+	}
+
+	uint different = 0;
+	SceneObjectRecord a_object;
+	SceneObjectRecord b_object;
+	SceneComponentRecord a_component;
+	SceneComponentRecord b_component;
+	for (uint i = 0; i < a.GetNumObjects(); i++)
+	{
+		a.GetObjectRecord(i, a_object);
+		b.GetObjectRecord(i, b_object);
+		if (memcmp(&a_object, &b_object, sizeof(SceneObjectRecord)) != 0)
+		{
+			different++;
+			continue;
+		}
+
+		bool camera = false;
+		for (uint c = 0; c < a_object.num_components; c++)
+		{
+			a.GetComponentRecord(a_object.first_component + c, a_component);
+			camera = camera || (a_component.type == Component::CAMERA);
+		}
+
+		for (uint c = 0; c < a_object.num_components; c++)
+		{
+			a.GetComponentRecord(a_object.first_component + c, a_component);
+			b.GetComponentRecord(b_object.first_component + c, b_component);
+			if (camera && a_component.type == Component::TRANSFORM && b_component.type == Component::TRANSFORM)
+			{
+				continue;
+			}
+			different += SameComponent(a_component, b_component) ? 0 : 1;
+		}
+	}
+	return different;
+}
+
+BENCHMARK(SceneJsonAgainstBinary)
+{
+	BuildScene();
+	UpdateTransforms();
+
+	char* json = nullptr;
+	BenchmarkTimer timer;
+	uint json_size = SaveJson(&json);
+	double json_save_ms = timer.ReadMs();
+
+	char* binary = nullptr;
+	timer.Start();
+	uint binary_size = SaveBinary(&binary);
+	double binary_save_ms = timer.ReadMs();
+
+	App->fs->Save(FORMAT_JSON_PATH, json, json_size);
+	App->fs->Save(FORMAT_BINARY_PATH, binary, binary_size);
+	delete[] json;
+
+	delete[] binary;
+
+	//Both files have to give the same scene, saved again after a frame
+	double json_load_ms = LoadScene(FORMAT_JSON_PATH);
+	UpdateTransforms();
+	char* from_json = nullptr;
+	uint from_json_size = SaveBinary(&from_json);
+
+	double binary_load_ms = LoadScene(FORMAT_BINARY_PATH);
+	UpdateTransforms();
+	char* from_binary = nullptr;
+	uint from_binary_size = SaveBinary(&from_binary);
+
+	uint different = CountDifferentRecords(from_json, from_json_size, from_binary, from_binary_size);
+	delete[] from_json;
+	delete[] from_binary;
+
+	printf("  %d objects, %d components\n", FORMAT_OBJECTS, App->go_manager->transform_pool.Size() + App->go_manager->material_pool.Size() +
+		App->go_manager->camera_pool.Size());
+	printf("  Json:   %.1f KB, save %.1f ms, load %.1f ms\n", json_size / 1024.0f, json_save_ms, json_load_ms);
+	printf("  Binary: %.1f KB, save %.1f ms, load %.1f ms\n", binary_size / 1024.0f, binary_save_ms, binary_load_ms);
+	printf("  Records that differ between both: %d\n", different);
+
+	App->go_manager->DeleteScene();
+	Json config;
+	App->go_manager->Init(config);
+}
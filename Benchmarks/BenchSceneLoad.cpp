@@ -0,0 +1,134 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "SceneFormat.h"
+#include <random>
+#include <string>
+#include <vector>
+
+#define LOAD_CHILDS 8
+#define LOAD_MAX_JSON 100000		// The parson document of a bigger scene takes GBs
+#define LOAD_SEARCHES 1000		// Parents searched the old way, the total is estimated from them
+
+// Scene of num_objects with a transform each, LOAD_CHILDS under every object
+// level by level. The ids are random 64 bit like the ones the engine gives
+static uint MakeScene(uint num_objects, std::vector<UID>& ids, char** buffer)
+{
+	std::mt19937_64 generator(num_objects);
+	ids.resize(num_objects);
+
+	SceneWriter writer;
+	SceneComponentRecord transform;
+	transform.type = Component::TRANSFORM;
+	for (uint i = 0; i < num_objects; i++)
+	{
+		ids[i] = generator();
+		writer.AddObject(ids[i], (i == 0) ? 0 : ids[(i - 1) / LOAD_CHILDS], (i == 0) ? "root" : "Object", true);
+
+		float4x4 local = float4x4::FromTRS(float3((float)(i % 10), 0.0f, (float)(i % 7)), Quat::identity, float3::one);
+		memcpy(transform.transform.local, local.ptr(), sizeof(transform.transform.local));
+		transform.id = i;
+		writer.AddComponent(transform);
+	}
+	return writer.Save(buffer);
+}
+
+// What LoadGameObjectsOnScene did for every parent before the id registry
+static GameObject* SearchGameObjectsByID(GameObject* go, UID id)
+{
+	if (go->GetID() == id)
+	{
+		return go;
+	}
+
+	for (uint i = 0; i < go->childs.size(); i++)
+	{
+		GameObject* found = SearchGameObjectsByID(go->childs[i], id);
+		if (found != nullptr)
+		{
+			return found;
+		}
+	}
+	return nullptr;
+}
+
+// Every object there once, under the parent it was saved with
+static uint CountWrongObjects(const std::vector<UID>& ids)
+{
+	uint wrong = (App->go_manager->scene_objects.GetNumObjects() == ids.size()) ? 0 : 1;
+	for (uint i = 0; i < ids.size(); i++)
+	{
+		GameObject* go = App->go_manager->FindGameObject(ids[i]);
+		UID parent_id = (go != nullptr && go->GetParent() != nullptr) ? go->GetParent()->GetID() : 0;
+		if (go == nullptr || parent_id != ((i == 0) ? 0 : ids[(i - 1) / LOAD_CHILDS]))
+		{
+			wrong++;
+		}
+	}
+	return wrong;
+}
+
+static double LoadScene(const char* path, const std::vector<UID>& ids, uint& wrong)
+{
+	BenchmarkTimer timer;
+	App->go_manager->LoadScene(path);
+	double ms = timer.ReadMs();
+	wrong += CountWrongObjects(ids);
+	return ms;
+}
+
+BENCHMARK(SceneLoadLinear)
+{
+	uint sizes[] = { 10000, 100000, 1000000 };
+	for (uint s = 0; s < 3; s++)
+	{
+		std::vector<UID> ids;
+		char* buffer = nullptr;
+		uint size = MakeScene(sizes[s], ids, &buffer);
+
+		char path[64];
+		sprintf_s(path, BENCHMARK_FOLDER "/Load_%d." SCENE_EXTENSION, sizes[s]);
+		App->fs->Save(path, buffer, size);
+
+		std::string json_path(path, strlen(path) - strlen(SCENE_EXTENSION));
+		json_path.append("json");
+		if (sizes[s] <= LOAD_MAX_JSON)
+		{
+			char* json = nullptr;
+			uint json_size = SceneBinaryToJson(buffer, size, &json);
+			App->fs->Save(json_path.data(), json, json_size);
+			delete[] json;
+		}
+		delete[] buffer;
+
+		uint wrong = 0;
+		double binary_ms = LoadScene(path, ids, wrong);
+
+		//The old search walks the tree from the root until it finds the parent
+		GameObject* root = App->go_manager->GetRoot();
+		uint step = sizes[s] / LOAD_SEARCHES;
+		BenchmarkTimer timer;
+		for (uint i = 1; i < sizes[s]; i += step)
+		{
+			wrong += (SearchGameObjectsByID(root, ids[(i - 1) / LOAD_CHILDS]) != nullptr) ? 0 : 1;
+		}
+		double search_ms = timer.ReadMs() * sizes[s] / LOAD_SEARCHES;
+
+		if (sizes[s] <= LOAD_MAX_JSON)
+		{
+			double json_ms = LoadScene(json_path.data(), ids, wrong);
+			printf("  %7d objects: binary %.1f ms (%.2f us per object), json %.1f ms (%.2f us per object)\n", sizes[s], binary_ms,
+				binary_ms * 1000.0 / sizes[s], json_ms, json_ms * 1000.0 / sizes[s]);
+		}
+		else
+		{
+			printf("  %7d objects: binary %.1f ms (%.2f us per object)\n", sizes[s], binary_ms, binary_ms * 1000.0 / sizes[s]);
+		}
+		printf("           searching every parent from the root would add %.1f s, %d objects wrong\n", search_ms / 1000.0, wrong);
+	}
+
+	//The next benchmarks start from an empty scene
+	App->go_manager->DeleteScene();
+	Json config;
+	App->go_manager->Init(config);
+}
@@ -0,0 +1,163 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "ComponentTransform.h"
+#include <vector>
+
+#define TRANSFORM_FRAMES 100
+#define TRANSFORM_OLD_FRAMES 3		// The old update is slow on the deep chain
+
+// Objects of a generated hierarchy in creation order, parents before childs
+struct Hierarchy
+{
+	std::vector<GameObject*> objects;
+	std::vector<ComponentTransform*> transforms;
+	std::vector<int> parents;
+	std::vector<std::vector<uint>> childs;
+	std::vector<float3> translations;
+	std::vector<float4x4> local;
+	std::vector<float4x4> world;
+};
+
+static void AddObject(Hierarchy& hierarchy, int parent)
+{
+	uint index = hierarchy.objects.size();
+	GameObject* go = App->go_manager->CreateGameObject((parent < 0) ? nullptr : hierarchy.objects[parent], "Transform");
+	ComponentTransform* transform = (ComponentTransform*)go->AddComponent(Component::TRANSFORM);
+
+	float3 translation((float)(index % 7), 1.0f, 0.0f);
+	transform->SetTranslation(translation);
+	transform->SetRotation(Quat::RotateY(0.01f));
+	transform->SetScale(float3::one);
+
+	hierarchy.objects.push_back(go);
+	hierarchy.transforms.push_back(transform);
+	hierarchy.parents.push_back(parent);
+	hierarchy.childs.push_back(std::vector<uint>());
+	hierarchy.translations.push_back(translation);
+	if (parent >= 0)
+	{
+		hierarchy.childs[parent].push_back(index);
+	}
+}
+
+static void SetTranslation(Hierarchy& hierarchy, uint index, const float3& translation)
+{
+	hierarchy.translations[index] = translation;
+	hierarchy.transforms[index]->SetTranslation(translation);
+}
+
+// What ComponentTransform::WorldTransformation did: the object and everything below it
+static void OldWorldTransformation(Hierarchy& hierarchy, uint index)
+{
+	int parent = hierarchy.parents[index];
+	hierarchy.world[index] = (parent < 0) ? hierarchy.local[index] : hierarchy.world[parent] * hierarchy.local[index];
+	for (uint i = 0; i < hierarchy.childs[index].size(); i++)
+	{
+		OldWorldTransformation(hierarchy, hierarchy.childs[index][i]);
+	}
+	hierarchy.objects[index]->UpdateGameObjectTransform();
+}
+
+// Every ComponentTransform::Update of a frame before the TransformSystem, in scene order
+static double OldFrame(Hierarchy& hierarchy)
+{
+	hierarchy.local.resize(hierarchy.objects.size());
+	hierarchy.world.resize(hierarchy.objects.size());
+
+	BenchmarkTimer timer;
+	for (uint i = 0; i < hierarchy.objects.size(); i++)
+	{
+		hierarchy.local[i] = float4x4::FromTRS(hierarchy.translations[i], Quat::RotateY(0.01f), float3::one);
+		OldWorldTransformation(hierarchy, i);
+	}
+	return timer.ReadMs();
+}
+
+static uint CountWrongWorlds(const Hierarchy& hierarchy)
+{
+	uint wrong = 0;
+	for (uint i = 0; i < hierarchy.objects.size(); i++)
+	{
+		wrong += hierarchy.transforms[i]->GetWorldTransformationMatrix().Equals(hierarchy.world[i], 1e-3f) ? 0 : 1;
+	}
+	return wrong;
+}
+
+static double UpdateTransforms()
+{
+	BenchmarkTimer timer;
+	App->go_manager->transforms.Update(App->go_manager->GetRoot());
+	return timer.ReadMs();
+}
+
+static void RunHierarchy(const char* name, Hierarchy& hierarchy, const std::vector<uint>& tops, uint one)
+{
+	//The first update puts the new objects in order
+	double rebuild_ms = UpdateTransforms();
+	double idle_ms = 0.0;
+	double one_ms = 0.0;
+	double all_ms = 0.0;
+	uint one_updated = 0;
+	uint all_updated = 0;
+
+	for (uint frame = 0; frame < TRANSFORM_FRAMES; frame++)
+	{
+		idle_ms += UpdateTransforms();
+
+		SetTranslation(hierarchy, one, float3((float)frame, 1.0f, 0.0f));
+		one_ms += UpdateTransforms();
+		one_updated = App->go_manager->transforms.GetNumUpdated();
+
+		for (uint i = 0; i < tops.size(); i++)
+		{
+			SetTranslation(hierarchy, tops[i], float3((float)frame, 1.0f, (float)i));
+		}
+		all_ms += UpdateTransforms();
+		all_updated = App->go_manager->transforms.GetNumUpdated();
+	}
+
+	double old_ms = 0.0;
+	for (uint frame = 0; frame < TRANSFORM_OLD_FRAMES; frame++)
+	{
+		old_ms += OldFrame(hierarchy);
+	}
+
+	printf("  %s, %d objects: rebuild %.2f ms, idle %.3f ms, one moved %.3f ms (%d updated), all moved %.2f ms (%d updated)\n", name,
+		(uint)hierarchy.objects.size(), rebuild_ms, idle_ms / TRANSFORM_FRAMES, one_ms / TRANSFORM_FRAMES, one_updated, all_ms / TRANSFORM_FRAMES, all_updated);
+	printf("  %s, every transform updating its subtree each frame: %.2f ms, %d world matrices differ\n", name, old_ms / TRANSFORM_OLD_FRAMES,
+		CountWrongWorlds(hierarchy));
+
+	for (uint i = 0; i < tops.size(); i++)
+	{
+		App->go_manager->DeleteGameObject(hierarchy.objects[tops[i]]);
+	}
+	App->go_manager->PreUpdate(0.0f);
+}
+
+BENCHMARK(TransformsDeepAndWide)
+{
+	//One chain, every object moves what's below it
+	Hierarchy deep;
+	for (uint i = 0; i < 5000; i++)
+	{
+		AddObject(deep, (int)i - 1);
+	}
+	std::vector<uint> deep_tops(1, 0);
+	RunHierarchy("Deep 5000", deep, deep_tops, 4999);
+
+	//Few levels and many siblings, like most scenes
+	Hierarchy wide;
+	std::vector<uint> wide_tops;
+	for (uint p = 0; p < 100; p++)
+	{
+		wide_tops.push_back(wide.objects.size());
+		int parent = wide.objects.size();
+		AddObject(wide, -1);
+		for (uint c = 0; c < 1000; c++)
+		{
+			AddObject(wide, parent);
+		}
+	}
+	RunHierarchy("Wide 100 x 1000", wide, wide_tops, wide.objects.size() - 1);
+}
@@ -0,0 +1,139 @@
+#include "Benchmarks.h"
+#include "Application.h"
+#include <psapi.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma comment (lib, "psapi.lib")
+#pragma comment (lib, "SDL/libx86/SDL2.lib")
+#pragma comment (lib, "SDL/libx86/SDL2main.lib")		// Application.h brings SDL.h, main is SDL_main like in the engine
+
+Application* App = nullptr;
+
+static BenchmarkCase* first_benchmark = nullptr;
+static BenchmarkCase* last_benchmark = nullptr;
+
+BenchmarkRegistrar::BenchmarkRegistrar(BenchmarkCase& benchmark, const char* name, BenchmarkFunction function)
+{
+	//Kept in the order of their files
+	benchmark.name = name;
+	benchmark.function = function;
+	if (last_benchmark != nullptr)
+	{
+		last_benchmark->next = &benchmark;
+	}
+	else
+	{
+		first_benchmark = &benchmark;
+	}
+	last_benchmark = &benchmark;
+}
+
+BenchmarkTimer::BenchmarkTimer()
+{
+	Start();
+}
+
+void BenchmarkTimer::Start()
+{
+	started_at = std::chrono::high_resolution_clock::now();
+}
+
+double BenchmarkTimer::ReadMs() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - started_at).count();
+}
+
+float GetWorkingSetMB()
+{
+	PROCESS_MEMORY_COUNTERS memory;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		return memory.WorkingSetSize / (1024.0f * 1024.0f);
+	}
+	return 0.0f;
+}
+
+float GetPeakWorkingSetMB()
+{
+	PROCESS_MEMORY_COUNTERS memory;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		return memory.PeakWorkingSetSize / (1024.0f * 1024.0f);
+	}
+	return 0.0f;
+}
+
+float GetPrivateMB()
+{
+	PROCESS_MEMORY_COUNTERS memory;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		return memory.PagefileUsage / (1024.0f * 1024.0f);
+	}
+	return 0.0f;
+}
+
+void MakeRandomBoxes(LCG& rng, uint num_boxes, std::vector<AABB>& boxes)
+{
+	boxes.resize(num_boxes);
+	for (uint i = 0; i < num_boxes; i++)
+	{
+		float3 center(rng.Float(-1000.0f, 1000.0f), rng.Float(-100.0f, 100.0f), rng.Float(-1000.0f, 1000.0f));
+		float3 half_size(rng.Float(0.5f, 5.0f), rng.Float(0.5f, 5.0f), rng.Float(0.5f, 5.0f));
+		boxes[i] = AABB(center - half_size, center + half_size);
+	}
+}
+
+GameObject* GetBenchmarkObject(uint index)
+{
+	return (GameObject*)(uintptr_t)(index + 1);
+}
+
+uint GetBenchmarkIndex(const GameObject* object)
+{
+	return (uint)(uintptr_t)object - 1;
+}
+
+//The engine logs to the console window, here it goes to stdout
+void log(const char file[], int line, const char* format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	vprintf(format, ap);
+	va_end(ap);
+	printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+	setvbuf(stdout, nullptr, _IONBF, 0);
+
+	//No window nor GL, only the file system and the scene are initialized
+	App = new Application();
+	Json config;
+	App->fs->Init(config);
+	App->fs->MakeDirectory(BENCHMARK_FOLDER);
+	App->go_manager->Init(config);
+
+	const char* filter = (argc > 1) ? argv[1] : nullptr;
+	for (BenchmarkCase* benchmark = first_benchmark; benchmark != nullptr; benchmark = benchmark->next)
+	{
+		if (filter != nullptr && strstr(benchmark->name, filter) == nullptr)
+		{
+			continue;
+		}
+
+		printf("%s\n", benchmark->name);
+		BenchmarkTimer timer;
+		benchmark->function();
+		printf("  (%.0f ms)\n", timer.ReadMs());
+	}
+
+	App->go_manager->CleanUp();
+	delete App;
+	App = nullptr;
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef __BENCHMARKS_H__
+#define __BENCHMARKS_H__
+
+#include "Globals.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "MathGeoLib\include\Algorithm\Random\LCG.h"
+#include <chrono>
+#include <vector>
+
+class GameObject;
+
+// Timings of the engine parts that were reworked for speed, each one against
+// what it replaced or against its brute force reference. The Application is
+// created without a window, the modules that need one are never started.
+// Benchmarks.exe runs them all or the ones with the name given in the command line
+typedef void(*BenchmarkFunction)();
+
+struct BenchmarkCase
+{
+	const char* name = nullptr;
+	BenchmarkFunction function = nullptr;
+	BenchmarkCase* next = nullptr;
+};
+
+class BenchmarkRegistrar
+{
+public:
+	BenchmarkRegistrar(BenchmarkCase& benchmark, const char* name, BenchmarkFunction function);
+};
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static BenchmarkCase name##_case; \
+	static BenchmarkRegistrar name##_registrar(name##_case, #name, name); \
+	static void name()
+
+// Milliseconds with the resolution of the high resolution clock, Timer only has SDL ticks
+class BenchmarkTimer
+{
+public:
+	BenchmarkTimer();
+
+	void Start();
+	double ReadMs() const;
+
+private:
+	std::chrono::high_resolution_clock::time_point started_at;
+};
+
+// Memory of the process in MB. Private is what it committed for itself, mapped
+// files are in the working set but not there
+float GetWorkingSetMB();
+float GetPeakWorkingSetMB();
+float GetPrivateMB();
+
+// Boxes of 1 to 10 units spread over 2000 x 200 x 2000, like a big flat level
+void MakeRandomBoxes(LCG& rng, uint num_boxes, std::vector<AABB>& boxes);
+
+// The octree never looks into the objects, the index of their box is enough
+GameObject* GetBenchmarkObject(uint index);
+uint GetBenchmarkIndex(const GameObject* object);
+
+#define BENCHMARK_FOLDER "Library/Benchmark"		// Files the benchmarks write, overwritten every run
+
+#endif // !__BENCHMARKS_H__
@@ -48,4 +48,7 @@ uint Component::GetID() const
 	return id;
 }
 
-
+ComponentHandle Component::GetHandle() const
+{
+	return handle;
+}
@@ -4,6 +4,17 @@
 
 class GameObject;
 class Json;
+class SceneWriter;
+class SceneReader;
+struct SceneComponentRecord;
+
+// Refers to a slot of a ComponentPool, stays valid while the component lives
+// and stops resolving once it's destroyed, even if the slot is reused
+struct ComponentHandle
+{
+	uint index = 0;
+	uint generation = 0;		// Odd while alive, 0 is never valid
+};
 
 class Component
 {
@@ -28,12 +39,16 @@ public:
 	virtual void UpdateTransform() {}; 
 	virtual void ToSave(Json& file_data) const {};
 	virtual void ToLoad(Json& file_data) {};
+	virtual void ToSave(SceneComponentRecord& record, SceneWriter& writer) const {};		// Binary scenes, one flat record per component
+	virtual void ToLoad(const SceneComponentRecord& record, const SceneReader& reader) {};
+	virtual void Restore(const SceneComponentRecord& record, const SceneReader& reader) { ToLoad(record, reader); }		// From a snapshot, loaded resources are reused
 
 	bool isEnabled();
 	Types GetType() const;
 	const char* GetTypeStr() const;
 	GameObject* GetGameObject() const;
 	uint GetID() const;
+	ComponentHandle GetHandle() const;
 
 public: 
 	GameObject* go = nullptr;
@@ -42,6 +57,10 @@ public:
 protected:
 	uint id = NULL;
 	Types type = NONE;
+
+private:
+	template<typename T> friend class ComponentPool;
+	ComponentHandle handle;
 };
 
 
@@ -4,6 +4,7 @@
 #include "ComponentTransform.h"
 #include "ComponentMesh.h"
 #include "Imgui\imgui.h"
+#include "SceneFormat.h"
 
 ComponentCamera::ComponentCamera(Component::Types type) : Component(type)
 {
@@ -24,6 +25,10 @@ ComponentCamera::ComponentCamera(Component::Types type) : Component(type)
 
 ComponentCamera::~ComponentCamera()
 {
+	if (App->go_manager->culling_camera == this)
+	{
+		App->go_manager->culling_camera = nullptr;
+	}
 
 }
 
@@ -64,6 +69,7 @@ void ComponentCamera::ShowOnEditor()
 		bool is_enabled = debug_frustum;
 		if (ImGui::Checkbox("Debug", &is_enabled))
 		{
+			App->go_manager->NotifyChanged(go);
 			if (is_enabled)
 			{
 				debug_frustum = true;
@@ -78,6 +84,7 @@ void ComponentCamera::ShowOnEditor()
 		bool culling_enabled = culling;
 		if (ImGui::Checkbox("Culling",&culling_enabled))
 		{
+			App->go_manager->NotifyChanged(go);
 			if (culling_enabled)
 			{
 				culling = true;
@@ -90,23 +97,26 @@ void ComponentCamera::ShowOnEditor()
 
 			ImGui::Text("Near plane");
 			float new_near = frustum.nearPlaneDistance;
-			if (ImGui::SliderFloat("##near", &new_near,1.0f,4999.0f));
+			if (ImGui::SliderFloat("##near", &new_near,1.0f,4999.0f))
 			{
 				SetNearDistance(new_near);
+				App->go_manager->NotifyChanged(go);
 			}
 
 			ImGui::Text("Far plane");
 			float new_far = frustum.farPlaneDistance;
-			if (ImGui::SliderFloat("##far", &new_far, 1.0f, 5000.0f));
+			if (ImGui::SliderFloat("##far", &new_far, 1.0f, 5000.0f))
 			{
 				SetFarDistance(new_far);
+				App->go_manager->NotifyChanged(go);
 			}
 
 			ImGui::Text("FOV");
 			float fov = field_of_view;
-			if (ImGui::SliderFloat("##fov", &fov, 1.0f, 150.0f));
+			if (ImGui::SliderFloat("##fov", &fov, 1.0f, 150.0f))
 			{
 				SetFieldOfView(fov);
+				App->go_manager->NotifyChanged(go);
 			}
 	}
 }
@@ -146,7 +156,43 @@ void ComponentCamera::ToLoad(Json & file_data)
 	frustum.nearPlaneDistance = file_data.GetFloat("Near plane");
 	frustum.farPlaneDistance = file_data.GetFloat("Far plane");
 	field_of_view = file_data.GetFloat("FOV");
-	aspect_ratio = file_data.GetFloat("Aspect Ratio");
+	aspect_ratio = file_data.GetFloat("Aspect ratio");
+
+	UpdateTransform();
+}
+
+void ComponentCamera::ToSave(SceneComponentRecord & record, SceneWriter & writer) const
+{
+	record.type = type;
+	record.id = id;
+	record.enabled = enabled ? 1 : 0;
+
+	record.flags |= culling ? SCENE_CULLING : 0;
+	record.flags |= debug_frustum ? SCENE_DEBUG_FRUSTUM : 0;
+	memcpy(record.camera.pos, frustum.pos.ptr(), sizeof(record.camera.pos));
+	memcpy(record.camera.front, frustum.front.ptr(), sizeof(record.camera.front));
+	memcpy(record.camera.up, frustum.up.ptr(), sizeof(record.camera.up));
+	record.camera.near_plane = frustum.nearPlaneDistance;
+	record.camera.far_plane = frustum.farPlaneDistance;
+	record.camera.fov = field_of_view;
+	record.camera.aspect_ratio = aspect_ratio;
+}
+
+void ComponentCamera::ToLoad(const SceneComponentRecord & record, const SceneReader & reader)
+{
+	id = record.id;
+	enabled = record.enabled != 0;
+
+	culling = (record.flags & SCENE_CULLING) != 0;
+
+	debug_frustum = (record.flags & SCENE_DEBUG_FRUSTUM) != 0;
+	frustum.pos = float3(record.camera.pos);
+	frustum.front = float3(record.camera.front);
+	frustum.up = float3(record.camera.up);
+	frustum.nearPlaneDistance = record.camera.near_plane;
+	frustum.farPlaneDistance = record.camera.far_plane;
+	field_of_view = record.camera.fov;
+	aspect_ratio = record.camera.aspect_ratio;
 
 	UpdateTransform();
 }
@@ -248,29 +294,35 @@ void ComponentCamera::LookAt(const float3 & position)
 
 bool ComponentCamera::ContainsAABB(const AABB & ref_box) const
 {
-	float3 corners[8];
-	ref_box.GetCornerPoints(corners);
+	uint mask = FRUSTUM_ALL_PLANES;
+	uint last_plane = 0;
 
-	Plane planes[6];
-	frustum.GetPlanes(planes);
+	return CullAABB(GetFrustumPlanes(), ref_box.CenterPoint(), ref_box.HalfSize(), mask, last_plane) != CULL_OUTSIDE;
+}
 
-	for (int n_planes = 0; n_planes < 6; ++n_planes)
+const FrustumPlanes& ComponentCamera::GetFrustumPlanes() const
+{
+	//The frustum is public and edited from outside, compare it with the one the planes came from
+	if (planes_valid == false || memcmp(&planes_frustum, &frustum, sizeof(Frustum)) != 0)
 	{
-		int in_count = 8;
+		memcpy(&planes_frustum, &frustum, sizeof(Frustum));
+		planes.Set(frustum);
+		planes_valid = true;
+	}
 
-		for (int i = 0; i < 8; ++i)
-		{
-			if (planes[n_planes].IsOnPositiveSide(corners[i]))
-			{
-				--in_count;
-			}
-		}
+	return planes;
+}
 
-		if (in_count == 0)
-		{
-			return false;
-			break;
-		}
+float ComponentCamera::GetProjectedSize(const AABB& box) const
+{
+	//Bounding sphere against the vertical field of view, 1 fills the viewport height
+	Sphere sphere = box.MinimalEnclosingSphere();
+	float distance = frustum.pos.Distance(sphere.pos);
+
+	if (distance <= sphere.r)
+	{
+		return FLOAT_INF;
 	}
-	return true;
+
+	return sphere.r / (distance * tan(frustum.verticalFov * 0.5f));
 }
@@ -2,6 +2,7 @@
 #define __COMPONENTCAMERA_H__
 #include "Component.h"
 #include "MathGeoLib\include\MathGeoLib.h"
+#include "FrustumCulling.h"
 
 class ComponentTransform;
 class GameObject;
@@ -17,6 +18,8 @@ public:
 	void ShowOnEditor();
 	void ToSave(Json& file_data) const;
 	void ToLoad(Json& file_data);
+	void ToSave(SceneComponentRecord& record, SceneWriter& writer) const;
+	void ToLoad(const SceneComponentRecord& record, const SceneReader& reader);
 
 	Frustum GetFrustum() const;
 	float GetNearDistance() const;
@@ -32,6 +35,8 @@ public:
 	void LookAt(const float3& position);
 
 	bool ContainsAABB(const AABB& ref_box) const;
+	const FrustumPlanes& GetFrustumPlanes() const;
+	float GetProjectedSize(const AABB& box) const;
 
 	float* GetViewMatrix();
 	float* GetProjectionMatrix();
@@ -48,6 +53,11 @@ private:
 	float aspect_ratio = 1.75f;
 	bool debug_frustum = false;
 
+	//Planes are extracted again only when the frustum changes
+	mutable FrustumPlanes planes;
+	mutable Frustum planes_frustum;
+	mutable bool planes_valid = false;
+
 
 };
 
@@ -3,6 +3,7 @@
 #include "ModuleMesh.h"
 #include "GameObject.h"
 #include "Imgui\imgui.h"
+#include "SceneFormat.h"
 
 ComponentMaterial::ComponentMaterial(Component::Types _type) : Component(_type)
 {
@@ -11,7 +12,20 @@ ComponentMaterial::ComponentMaterial(Component::Types _type) : Component(_type)
 
 ComponentMaterial::~ComponentMaterial()
 {
+	if (texture_request != nullptr)
+	{
+		texture_request->Cancel();
+	}
+	App->tex->ReleaseTexture(texture_id);
+}
 
+void ComponentMaterial::Update(float dt)
+{
+	if (texture_request != nullptr && texture_request->IsDone())
+	{
+		SetTexture(texture_request->GetResult());
+		texture_request = nullptr;
+	}
 }
 
 void ComponentMaterial::ShowOnEditor()
@@ -45,6 +59,48 @@ void ComponentMaterial::ToLoad(Json & file_data)
 {
 	id = file_data.GetInt("ID Component");
 	directory = file_data.GetString("Directory");
-	texture_id = App->tex->LoadTexture(directory.data());
+	RequestTexture(directory.data());
 	enabled = file_data.GetBool("enabled");
 }
+
+void ComponentMaterial::ToSave(SceneComponentRecord & record, SceneWriter & writer) const
+{
+	record.type = type;
+	record.id = id;
+	record.enabled = enabled ? 1 : 0;
+	record.material.texture_id = texture_id;
+	record.material.directory = writer.AddString(directory.data());
+}
+
+void ComponentMaterial::ToLoad(const SceneComponentRecord & record, const SceneReader & reader)
+{
+	id = record.id;
+	const char* path = reader.GetString(record.material.directory);
+	directory = (path != nullptr) ? path : "";
+	RequestTexture(directory.data());
+	enabled = record.enabled != 0;
+}
+
+void ComponentMaterial::SetTexture(uint texture)
+{
+	//The new one is loaded before the old is released, the same texture isn't freed in between
+	App->tex->ReleaseTexture(texture_id);
+	texture_id = texture;
+
+	//The static batch is grouped by texture
+	ComponentMesh* mesh = (go != nullptr) ? (ComponentMesh*)go->GetComponent(Component::MESH) : nullptr;
+	if (mesh != nullptr && mesh->is_static)
+	{
+		App->go_manager->InvalidateStaticBatch();
+	}
+}
+
+void ComponentMaterial::RequestTexture(const char* path)
+{
+	//Only the last request counts
+	if (texture_request != nullptr)
+	{
+		texture_request->Cancel();
+	}
+	texture_request = App->tex->RequestTexture(path);
+}
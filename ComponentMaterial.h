@@ -3,6 +3,7 @@
 
 #include "Globals.h"
 #include "Component.h"
+#include "AsyncLoader.h"
 #include <string>
 
 struct Mesh;
@@ -14,14 +15,22 @@ public:
 	ComponentMaterial(Component::Types type);
 	~ComponentMaterial();
 
+	void Update(float dt);
 	void ShowOnEditor();
 	void ToSave(Json& file_data) const;
 	void ToLoad(Json& file_data);
+	void ToSave(SceneComponentRecord& record, SceneWriter& writer) const;
+	void ToLoad(const SceneComponentRecord& record, const SceneReader& reader);
+	void SetTexture(uint texture);		// Takes a reference from LoadTexture, releases the previous one
+	void RequestTexture(const char* path);		// Streamed, the current texture stays until the new one is ready
 
 public:
 	uint texture_id = 0;
 	ComponentMaterial* material;
 	std::string directory;
 
+private:
+	LoadHandle texture_request;
+
 };
 #endif // !__COMPONENT_MATERIAL_H__
\ No newline at end of file
@@ -2,9 +2,11 @@
 #include "ComponentMesh.h"
 #include "ComponentTransform.h"
 #include "ComponentMaterial.h"
+#include "ComponentCamera.h"
 #include "GameObject.h"
 #include "ModuleMesh.h"
 #include"Imgui\imgui.h"
+#include "SceneFormat.h"
 
 ComponentMesh::ComponentMesh(Types _type) : Component(_type)
 {
@@ -15,65 +17,108 @@ ComponentMesh::ComponentMesh(Types _type) : Component(_type)
 
 ComponentMesh::~ComponentMesh()
 {
-	delete mesh;
+	App->go_manager->octree.Remove(go);
+	if (is_static)
+	{
+		App->go_manager->InvalidateStaticBatch();
+	}
+
+	//While playing the snapshot keeps the reference, Stop gives it back
+	if (App->go_manager->snapshot.IsActive())
+	{
+		App->go_manager->snapshot.KeepMesh(mesh);
+	}
+	else
+	{
+		App->meshes->ReleaseMesh(mesh);
+	}
 }
 
 void ComponentMesh::Update(float dt)
 {
-	if (isEnabled())
+	//Streamed meshes show up the frame their load is done
+	if (placed == false && mesh != nullptr && mesh->IsReady())
 	{
-		
-		if (render == true)
-		{
-				transformation = (ComponentTransform*)go->GetComponent(Component::TRANSFORM);
-
-				ComponentMaterial* material = (ComponentMaterial*)go->GetComponent(Component::MATERIAL);
-
-				uint tex_id = 0;
-				if (material)
-				{
-					tex_id = material->texture_id;
-				}
+		SetMesh(mesh);
+		UpdateTransform();
+	}
+}
 
-				//If geometry is enabled, Render it
+void ComponentMesh::Draw()
+{
+	if (isEnabled() == false || placed == false)
+	{
+		return;
+	}
 
-				if (App->renderer3D->wireframe)
-				{
-					App->renderer3D->Render(*mesh, transformation->GetTransformationMatrix(), tex_id, true);
-				}
-				else
-				{
-					App->renderer3D->Render(*mesh, transformation->GetTransformationMatrix(), tex_id);
-				}
+	transformation = (ComponentTransform*)go->GetComponent(Component::TRANSFORM);
 
-				if (bbox_enabled)
-				{
-					App->renderer3D->RenderBoundingBox(world_bb, Red);
-				}
+	ComponentMaterial* material = (ComponentMaterial*)go->GetComponent(Component::MATERIAL);
 
-		}//if render is false means that we are doing frustum culling 
-		else
-		{
-			return;
-		}
+	uint tex_id = 0;
+	if (material)
+	{
+		tex_id = material->texture_id;
+	}
 
+	//Static meshes only say they're visible, the batch has their geometry
+	if (static_range >= 0)
+	{
+		App->renderer3D->SubmitStatic(static_range);
 	}
 	else
 	{
-		return;
+		SubmitPacket(tex_id);
+	}
+
+	if (bbox_enabled)
+	{
+		App->renderer3D->RenderBoundingBox(world_bb, Red);
 	}
 }
 
+void ComponentMesh::SubmitPacket(uint tex_id)
+{
+	//Pick the level of detail from the size of the box on screen
+	ComponentCamera* camera = App->editor->main_camera_component;
+	float pixel_size = camera->GetProjectedSize(world_bb) * App->renderer3D->viewport_height;
+	lod = mesh->SelectLod(pixel_size);
+
+	//Queued, the renderer sorts the frame and draws it at once
+	DrawPacket packet;
+	packet.shader = (App->renderer3D->wireframe) ? RENDER_SHADER_WIREFRAME : RENDER_SHADER_SOLID;
+	packet.texture = tex_id;
+	packet.mesh = mesh;
+	packet.lod = lod;
+	packet.depth = camera->frustum.pos.Distance(world_bb.CenterPoint()) / camera->frustum.farPlaneDistance;
+	packet.transform = transformation->GetTransformationMatrix();
+	App->renderer3D->Submit(packet);
+}
+
 void ComponentMesh::UpdateTransform()
 {
 	CalculateFinalBB();
+
+	//Moved objects update their place in the octree
+	App->go_manager->octree.Update(go);
+
+	//A static object that moves anyway has to be merged again
+	if (is_static)
+	{
+		App->go_manager->InvalidateStaticBatch();
+	}
 }
 
 void ComponentMesh::ShowOnEditor()
 {
 	if (ImGui::CollapsingHeader("Mesh"))
 	{
-		if (mesh)
+		if (mesh != nullptr && placed == false)
+		{
+			bool failed = mesh->request != nullptr && mesh->request->GetState() == LoadRequest::FAILED;
+			ImGui::TextColored(IMGUI_YELLOW, failed ? "Can't load %s" : "Loading %s", mesh->directory.data());
+		}
+		else if (mesh)
 		{
 			ImGui::TextColored(IMGUI_YELLOW, "N. vertices: ");
 			ImGui::SameLine();
@@ -87,10 +132,14 @@ void ComponentMesh::ShowOnEditor()
 			ImGui::TextColored(IMGUI_YELLOW, "N. Normal:   ");
 			ImGui::SameLine();
 			ImGui::Text("%d", mesh->num_normal);
+			ImGui::TextColored(IMGUI_YELLOW, "LOD:         ");
+			ImGui::SameLine();
+			ImGui::Text("%d of %d (%d triangles)", lod, mesh->num_lods, mesh->lods[lod].num_indices / 3);
 
 			bool is_enabled = bbox_enabled;
 			if (ImGui::Checkbox("Bounding box", &is_enabled))
 			{
+				App->go_manager->NotifyChanged(go);
 				if (is_enabled)
 				{
 					bbox_enabled = true;
@@ -100,6 +149,14 @@ void ComponentMesh::ShowOnEditor()
 					bbox_enabled = false;
 				}
 			}
+
+			bool is_static_enabled = is_static;
+			if (ImGui::Checkbox("Static", &is_static_enabled))
+			{
+				App->go_manager->NotifyChanged(go);
+				is_static = is_static_enabled;
+				App->go_manager->InvalidateStaticBatch();
+			}
 		}
 	}
 }
@@ -111,9 +168,25 @@ bool ComponentMesh::SetMesh(Mesh* _mesh)
 	if (_mesh)
 	{
 		mesh = _mesh;
-		local_bb.Enclose((float3*)_mesh->vertices, _mesh->num_vertices);
-		CalculateFinalBB();
+		if (is_static)
+		{
+			App->go_manager->InvalidateStaticBatch();
+		}
+		placed = _mesh->IsReady();
 		ret = true;
+
+		if (placed == false)
+		{
+			//Not drawn until Update finds it ready
+			App->go_manager->octree.Remove(go);
+			return ret;
+		}
+
+		local_bb = _mesh->bounds;
+		CalculateFinalBB();
+
+		//Every mesh is in the octree, the culling only draws what it returns
+		App->go_manager->octree.Insert(go);
 	}
 
 	return ret;
@@ -121,7 +194,7 @@ bool ComponentMesh::SetMesh(Mesh* _mesh)
 
 Mesh * ComponentMesh::GetMesh() const
 {	
-	return mesh;
+	return placed ? mesh : nullptr;
 }
 
 void ComponentMesh::CalculateFinalBB()
@@ -141,6 +214,7 @@ void ComponentMesh::ToSave(Json & file_data) const
 	data.AddInt("ID Component", id);
 	data.AddBool("enabled", enabled);
 	data.AddBool("Bounding box", bbox_enabled);
+	data.AddBool("Static", is_static);
 	data.AddString("Directory", mesh->directory.data());
 
 	file_data.AddArrayData(data);
@@ -150,11 +224,68 @@ void ComponentMesh::ToLoad(Json & file_data)
 {
 	id = file_data.GetInt("ID Component");
 	enabled = file_data.GetBool("enabled");
+	is_static = file_data.GetBool("Static", false);
 	const char* directory = file_data.GetString("Directory");
-	Mesh* m = App->meshes->LoadMesh(directory);
-	m->directory = directory;
+	Mesh* m = App->meshes->AcquireMesh(directory);
+	if (m != nullptr)
+	{
+		SetMesh(m);
+		UpdateTransform();
+	}
+}
+
+void ComponentMesh::ToSave(SceneComponentRecord & record, SceneWriter & writer) const
+{
+	record.type = type;
+	record.id = id;
+	record.enabled = enabled ? 1 : 0;
+	record.flags |= bbox_enabled ? SCENE_BOUNDING_BOX : 0;
+	record.flags |= is_static ? SCENE_STATIC : 0;
+	record.mesh.directory = writer.AddString(mesh->directory.data());
+}
+
+void ComponentMesh::ToLoad(const SceneComponentRecord & record, const SceneReader & reader)
+{
+	id = record.id;
+	enabled = record.enabled != 0;
+	is_static = (record.flags & SCENE_STATIC) != 0;
+	const char* directory = reader.GetString(record.mesh.directory);
+	Mesh* m = App->meshes->AcquireMesh(directory);
+	if (m != nullptr)
+	{
+		SetMesh(m);
+		UpdateTransform();
+	}
+}
+
+void ComponentMesh::Restore(const SceneComponentRecord & record, const SceneReader & reader)
+{
+	id = record.id;
+	enabled = record.enabled != 0;
+	bbox_enabled = (record.flags & SCENE_BOUNDING_BOX) != 0;
+	if (is_static != ((record.flags & SCENE_STATIC) != 0))
+	{
+		is_static = (record.flags & SCENE_STATIC) != 0;
+		App->go_manager->InvalidateStaticBatch();
+	}
+
+	//The snapshot gives back the reference it kept, or the cache shares the mesh
+	const char* directory = reader.GetString(record.mesh.directory);
+	if (directory != nullptr && (mesh == nullptr || mesh->directory != directory))
+	{
+		Mesh* m = App->go_manager->snapshot.TakeMesh(directory);
+		if (m == nullptr)
+		{
+			m = App->meshes->AcquireMesh(directory);
+		}
+
+		if (m != nullptr)
+		{
+			App->go_manager->snapshot.KeepMesh(mesh);
+			SetMesh(m);
+		}
+	}
 
-	SetMesh(m);
 	UpdateTransform();
 }
 
@@ -13,13 +13,18 @@ public:
 	~ComponentMesh();
 
 	void Update(float dt);
+	void Draw();
+	void SubmitPacket(uint tex_id);
 	void UpdateTransform();
 	void ShowOnEditor();
-	bool SetMesh(Mesh* _mesh);
-	Mesh* GetMesh()const;
+	bool SetMesh(Mesh* _mesh);		// A mesh still streaming is placed once it's ready
+	Mesh* GetMesh()const;		// nullptr until the mesh is ready
 	void CalculateFinalBB();
 	void ToSave(Json& file_data) const;
 	void ToLoad(Json& file_data);
+	void ToSave(SceneComponentRecord& record, SceneWriter& writer) const;
+	void ToLoad(const SceneComponentRecord& record, const SceneReader& reader);
+	void Restore(const SceneComponentRecord& record, const SceneReader& reader);
 
 public:
 	AABB local_bb;
@@ -27,7 +32,10 @@ public:
 	Mesh* mesh = nullptr;
 	ComponentTransform* transformation;
 	bool bbox_enabled = false;
-	bool render = true;
+	uint lod = 0;
+	bool placed = false;		// Bounds and octree set from a ready mesh
+	bool is_static = false;		// Never moves, drawn from the static batch
+	int static_range = -1;		// In the static batch, -1 while it's drawn on its own
 };
 
 #endif // !__COMPONENTMESH_H__
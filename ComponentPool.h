@@ -0,0 +1,150 @@
+#ifndef __COMPONENTPOOL_H__
+#define __COMPONENTPOOL_H__
+
+#include "Globals.h"
+#include "Component.h"
+#include <vector>
+#include <new>
+
+#define COMPONENT_POOL_CHUNK 64		// Components per block, blocks never move
+
+// Components of one type stored together in fixed blocks. A component never
+// moves once created, so the raw pointers the engine keeps stay valid, and
+// free slots are reused before a new block is added
+template<typename T>
+class ComponentPool
+{
+public:
+	ComponentPool() {}
+	~ComponentPool() { Clear(); }
+
+	T* Create(Component::Types type);
+	void Destroy(Component* component);
+	void Clear();
+
+	T* Get(const ComponentHandle& handle) const;
+	uint Size() const { return count; }
+	uint GetMemoryUsage() const { return sizeof(*this) + chunks.size() * sizeof(Chunk) + free_slots.capacity() * sizeof(uint); }
+
+	// Calls function on every live component, in memory order
+	template<typename F>
+	void ForEach(F function);
+
+private:
+	struct Chunk
+	{
+		alignas(T) unsigned char data[sizeof(T) * COMPONENT_POOL_CHUNK];
+		uint generations[COMPONENT_POOL_CHUNK];		// Odd while the slot is alive
+	};
+
+	T* Slot(uint index) const { return (T*)(chunks[index / COMPONENT_POOL_CHUNK]->data) + index % COMPONENT_POOL_CHUNK; }
+	uint& Generation(uint index) const { return chunks[index / COMPONENT_POOL_CHUNK]->generations[index % COMPONENT_POOL_CHUNK]; }
+
+private:
+	std::vector<Chunk*> chunks;
+	std::vector<uint> free_slots;
+	uint count = 0;
+
+	//Pools are owned by the GameObject manager, never copied
+	ComponentPool(const ComponentPool&);
+	ComponentPool& operator=(const ComponentPool&);
+};
+
+template<typename T>
+T* ComponentPool<T>::Create(Component::Types type)
+{
+	if (free_slots.empty())
+	{
+		Chunk* chunk = new Chunk();
+		uint first = chunks.size() * COMPONENT_POOL_CHUNK;
+		chunks.push_back(chunk);
+
+		//Lower slots on top so they are used first
+		for (uint i = COMPONENT_POOL_CHUNK; i > 0; i--)
+		{
+			chunk->generations[i - 1] = 0;
+			free_slots.push_back(first + i - 1);
+		}
+	}
+
+	uint index = free_slots.back();
+	free_slots.pop_back();
+
+	T* component = new (Slot(index)) T(type);
+	Generation(index)++;
+	component->handle.index = index;
+	component->handle.generation = Generation(index);
+	count++;
+
+	return component;
+}
+
+template<typename T>
+void ComponentPool<T>::Destroy(Component* component)
+{
+	if (component == nullptr)
+	{
+		return;
+	}
+
+	uint index = component->GetHandle().index;
+	if (index >= chunks.size() * COMPONENT_POOL_CHUNK || Slot(index) != component || (Generation(index) & 1) == 0)
+	{
+		return;
+	}
+
+	((T*)component)->~T();
+	Generation(index)++;
+	free_slots.push_back(index);
+	count--;
+}
+
+template<typename T>
+void ComponentPool<T>::Clear()
+{
+	for (uint i = 0; i < chunks.size() * COMPONENT_POOL_CHUNK; i++)
+	{
+		if (Generation(i) & 1)
+		{
+			Slot(i)->~T();
+		}
+	}
+
+	for (uint i = 0; i < chunks.size(); i++)
+	{
+		delete chunks[i];
+	}
+
+	chunks.clear();
+	free_slots.clear();
+	count = 0;
+}
+
+template<typename T>
+T* ComponentPool<T>::Get(const ComponentHandle& handle) const
+{
+	if (handle.index < chunks.size() * COMPONENT_POOL_CHUNK && Generation(handle.index) == handle.generation && (handle.generation & 1))
+	{
+		return Slot(handle.index);
+	}
+	return nullptr;
+}
+
+template<typename T>
+template<typename F>
+void ComponentPool<T>::ForEach(F function)
+{
+	for (uint c = 0; c < chunks.size(); c++)
+	{
+		Chunk* chunk = chunks[c];
+		for (uint i = 0; i < COMPONENT_POOL_CHUNK; i++)
+		{
+			if (chunk->generations[i] & 1)
+			{
+				function((T*)(chunk->data) + i);
+			}
+		}
+	}
+}
+
+#endif // !__COMPONENTPOOL_H__
@@ -1,24 +1,25 @@
+#include "Application.h"
 #include "ComponentTransform.h"
 #include "GameObject.h"
 #include "JSON.h"
 #include "Imgui\imgui.h"
+#include "SceneFormat.h"
 
 ComponentTransform::ComponentTransform(Types _type) : Component(_type)
 {
 	_type = TRANSFORM;
+	slot = App->go_manager->transforms.Add(this);
 	SetTransformation();
-	WorldTransformation();
 }
 
 ComponentTransform::~ComponentTransform()
 {
-
+	App->go_manager->transforms.Remove(slot);
 }
 
 void ComponentTransform::Update(float dt)
 {
-	SetTransformation();
-	WorldTransformation();
+	//World matrices are updated by the TransformSystem, only for what moved
 }
 
 void ComponentTransform::ShowOnEditor()
@@ -47,7 +48,7 @@ void ComponentTransform::ShowOnEditor()
 		ImGui::SameLine();
 
 		float3 rot = rotation_deg;	
-		if (ImGui::DragFloat3("##R", rot.ptr(), 0.2f, -360.0f, 360.0f));
+		if (ImGui::DragFloat3("##R", rot.ptr(), 0.2f, -360.0f, 360.0f))
 		{
 			SetRotation(rot);
 		}
@@ -74,7 +75,7 @@ void ComponentTransform::ToSave(Json & file_data) const
 	data.AddFloatArray("Translation", translation.ptr());
 	data.AddFloatArray("Rotation", rotation_deg.ptr());
 	data.AddFloatArray("Scale", scale.ptr());
-	data.AddMatrix("transf_matrix", transformation);
+	data.AddMatrix("transf_matrix", App->go_manager->transforms.GetLocal(slot));
 
 
 	file_data.AddArrayData(data);
@@ -86,15 +87,39 @@ void ComponentTransform::ToLoad(Json & file_data)
 {
 	id = file_data.GetInt("ID Component");
 	enabled = file_data.GetBool("enabled");
-	transformation = file_data.GetMatrix("transf_matrix");
+	float4x4 transformation = file_data.GetMatrix("transf_matrix");
+	App->go_manager->transforms.SetLocal(slot, transformation);
 
 	translation = transformation.TranslatePart();
 	rotation_deg = transformation.ToEulerXYZ();
 	rotation = Quat::FromEulerXYZ(rotation_deg.x, rotation_deg.y, rotation_deg.z);
 	rotation_deg = RadToDeg(rotation_deg);
 	scale = transformation.GetScale();
+}
+
+void ComponentTransform::ToSave(SceneComponentRecord & record, SceneWriter & writer) const
+{
+	record.type = type;
+	record.id = id;
+	record.enabled = enabled ? 1 : 0;
+
+	const float4x4& local = App->go_manager->transforms.GetLocal(slot);
+	memcpy(record.transform.local, local.ptr(), sizeof(record.transform.local));
+}
+
+void ComponentTransform::ToLoad(const SceneComponentRecord & record, const SceneReader & reader)
+{
+	id = record.id;
+	enabled = record.enabled != 0;
+	float4x4 transformation = float4x4::identity;
+	memcpy(transformation.ptr(), record.transform.local, sizeof(record.transform.local));
+	App->go_manager->transforms.SetLocal(slot, transformation);
 
-	transform_updated = true;
+	translation = transformation.TranslatePart();
+	rotation_deg = transformation.ToEulerXYZ();
+	rotation = Quat::FromEulerXYZ(rotation_deg.x, rotation_deg.y, rotation_deg.z);
+	rotation_deg = RadToDeg(rotation_deg);
+	scale = transformation.GetScale();
 }
 
 void ComponentTransform::SetTranslation(float3 pos)
@@ -111,7 +136,7 @@ float3 ComponentTransform::GetTranslation() const
 
 float3 ComponentTransform::GetWorldTranslation() const
 {
-	return final_transformation.TranslatePart();
+	return App->go_manager->transforms.GetWorld(slot).TranslatePart();
 }
 
 void ComponentTransform::SetScale(float3 _scale)
@@ -166,48 +191,18 @@ float3 ComponentTransform::GetRotation() const
 
 float4x4 ComponentTransform::GetTransformationMatrix() const
 {
-	return final_transformation.Transposed();
+	return App->go_manager->transforms.GetWorld(slot).Transposed();
 }
 
 float4x4 ComponentTransform::GetWorldTransformationMatrix() const
 {
-	return final_transformation;
-}
-
-void ComponentTransform::WorldTransformation()
-{
-	if (go != nullptr)
-	{
-		if (go->GetParent() != nullptr)
-		{
-			//get parent transformation
-			ComponentTransform* parent_transformation = (ComponentTransform*)go->GetParent()->GetComponent(Component::TRANSFORM);
-			final_transformation = parent_transformation->final_transformation * transformation;
-
-			std::vector<GameObject*>::iterator it = go->childs.begin();
-			while (it != go->childs.end())
-			{
-				//Apply transform to the childs
-				ComponentTransform* child_transformation = (ComponentTransform*)(*it)->GetComponent(Component::TRANSFORM);
-				if (child_transformation != nullptr)
-				{	
-					child_transformation->WorldTransformation();
-				}
-				++it;
-			}
-		}
-		else
-		{
-			final_transformation = transformation;
-		}
-
-	   go->UpdateGameObjectTransform();
-	}
+	return App->go_manager->transforms.GetWorld(slot);
 }
 
 void ComponentTransform::SetTransformation()
 {
-	transformation = transformation.FromTRS(translation, rotation, scale);
+	App->go_manager->transforms.SetLocal(slot, float4x4::FromTRS(translation, rotation, scale));
+	App->go_manager->NotifyChanged(go);
 }
 
 
@@ -4,8 +4,11 @@
 #include "MathGeoLib\include\MathGeoLib.h"
 #include "Component.h"
 
+// Matrices live in the TransformSystem of the GameObject manager, the
+// component keeps the editable values and its slot there
 class ComponentTransform : public Component
 {
+	friend class TransformSystem;
 public:
 	ComponentTransform(Types _type);
 	~ComponentTransform();
@@ -14,6 +17,8 @@ public:
 	void ShowOnEditor();
 	void ToSave(Json& file_data) const;
 	void ToLoad(Json& file_data);
+	void ToSave(SceneComponentRecord& record, SceneWriter& writer) const;
+	void ToLoad(const SceneComponentRecord& record, const SceneReader& reader);
 
 	void SetTranslation(float3 pos);
 	float3 GetTranslation() const;
@@ -31,7 +36,6 @@ public:
 	float4x4 GetWorldTransformationMatrix() const;
 
 private:
-	void WorldTransformation();
 	void SetTransformation();
 
 private:
@@ -40,10 +44,7 @@ private:
 	Quat rotation = Quat::identity;
 	float3 rotation_deg = float3::zero;
 
-	float4x4 transformation = float4x4::identity;
-
-	bool transform_updated = false;
-	float4x4 final_transformation = float4x4::identity;
+	uint slot = 0;		// Index in the TransformSystem arrays, changes when the hierarchy does
 
 public:
 
@@ -0,0 +1,600 @@
+#include "CoreRenderer.h"
+#include "ModuleMesh.h"
+#include "Light.h"
+#include "Glew\include\glew.h"
+#include <stddef.h>
+
+//Attribute locations shared by the shaders and the VAOs, the transform takes four
+#define ATTRIBUTE_POSITION 0
+#define ATTRIBUTE_NORMAL 1
+#define ATTRIBUTE_UV 2
+#define ATTRIBUTE_TRANSFORM 3
+#define ATTRIBUTE_COLOR 1
+
+#define FRAME_BLOCK_BINDING 0
+
+static const char* frame_block =
+	"layout(std140) uniform Frame\n"
+	"{\n"
+	"	mat4 view;\n"
+	"	mat4 projection;\n"
+	"	vec4 light_position;\n"
+	"	vec4 light_ambient;\n"
+	"	vec4 light_diffuse;\n"
+	"};\n";
+
+//Light 0, white material and modulated texture, as the fixed pipeline draws
+static const char* mesh_vertex_shader =
+	"layout(location = 0) in vec3 position;\n"
+	"layout(location = 1) in vec3 normal;\n"
+	"layout(location = 2) in vec2 uv;\n"
+	"layout(location = 3) in mat4 transform;\n"
+	"uniform vec3 dequantize_center;\n"
+	"uniform vec3 dequantize_scale;\n"
+	"out vec2 frag_uv;\n"
+	"out vec3 frag_light;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 view_position = view * (transform * vec4(dequantize_center + position * dequantize_scale, 1.0));\n"
+	"	gl_Position = projection * view_position;\n"
+	"	vec3 view_normal = normalize(mat3(view) * (mat3(transform) * normal));\n"
+	"	float diffuse = max(dot(view_normal, normalize(light_position.xyz - view_position.xyz)), 0.0);\n"
+	"	frag_light = light_ambient.rgb + light_diffuse.rgb * diffuse;\n"
+	"	frag_uv = uv;\n"
+	"}\n";
+
+static const char* mesh_fragment_shader =
+	"uniform sampler2D diffuse_map;\n"
+	"uniform bool use_texture;\n"
+	"in vec2 frag_uv;\n"
+	"in vec3 frag_light;\n"
+	"out vec4 frag_color;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 color = (use_texture) ? texture(diffuse_map, frag_uv) : vec4(1.0);\n"
+	"	frag_color = vec4(color.rgb * frag_light, color.a);\n"
+	"}\n";
+
+static const char* line_vertex_shader =
+	"layout(location = 0) in vec3 position;\n"
+	"layout(location = 1) in vec3 color;\n"
+	"out vec3 frag_line_color;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = projection * (view * vec4(position, 1.0));\n"
+	"	frag_line_color = color;\n"
+	"}\n";
+
+static const char* line_fragment_shader =
+	"in vec3 frag_line_color;\n"
+	"out vec4 frag_color;\n"
+	"void main()\n"
+	"{\n"
+	"	frag_color = vec4(frag_line_color, 1.0);\n"
+	"}\n";
+
+//Corners of a box as AABB::GetCornerPoints gives them, two per edge
+static const uint box_edges[24] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 2, 1, 3, 4, 6, 5, 7, 0, 4, 1, 5, 2, 6, 3, 7 };
+
+bool CoreRenderer::IsSupported()
+{
+	return GLEW_VERSION_4_4 || (GLEW_VERSION_3_3 && GLEW_ARB_buffer_storage && GLEW_ARB_base_instance);
+}
+
+bool CoreRenderer::IsIndirectSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+}
+
+bool CoreRenderer::Init(bool use_indirect)
+{
+	if (IsSupported() == false)
+	{
+		LOG("The core path needs GL 4.4 or buffer storage and base instance");
+		return false;
+	}
+
+	mesh_program = CreateProgram(mesh_vertex_shader, mesh_fragment_shader);
+	line_program = CreateProgram(line_vertex_shader, line_fragment_shader);
+	if (mesh_program == 0 || line_program == 0 || ring.Create(CORE_RING_REGION_SIZE) == false)
+	{
+		CleanUp();
+		return false;
+	}
+
+	dequantize_center_location = glGetUniformLocation(mesh_program, "dequantize_center");
+	dequantize_scale_location = glGetUniformLocation(mesh_program, "dequantize_scale");
+	use_texture_location = glGetUniformLocation(mesh_program, "use_texture");
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+
+	glGenVertexArrays(1, &mesh_vao);
+	glGenVertexArrays(1, &line_vao);
+
+	//The meshes are put in the arena as they're loaded, it has to be there first
+	if (use_indirect)
+	{
+		indirect = IsIndirectSupported() && arena.Create(MESH_ARENA_VERTICES, MESH_ARENA_INDICES);
+		if (indirect == false)
+		{
+			LOG("No multi draw indirect, the render queue is drawn command by command");
+		}
+	}
+
+	return true;
+}
+
+void CoreRenderer::CleanUp()
+{
+	ring.Destroy();
+	arena.Destroy();
+	indirect = false;
+
+	if (mesh_vao != 0)
+	{
+		glDeleteVertexArrays(1, &mesh_vao);
+		glDeleteVertexArrays(1, &line_vao);
+		mesh_vao = 0;
+		line_vao = 0;
+	}
+
+	glDeleteProgram(mesh_program);
+	glDeleteProgram(line_program);
+	mesh_program = 0;
+	line_program = 0;
+}
+
+void CoreRenderer::SetFrame(const float* view, const float* projection, const Light& light)
+{
+	memcpy(frame.view, view, sizeof(frame.view));
+	memcpy(frame.projection, projection, sizeof(frame.projection));
+
+	//The fixed pipeline keeps light positions in view space too
+	float position[4] = { light.position.x, light.position.y, light.position.z, 1.0f };
+	for (uint row = 0; row < 4; row++)
+	{
+		frame.light_position[row] = 0.0f;
+		for (uint column = 0; column < 4; column++)
+		{
+			frame.light_position[row] += view[column * 4 + row] * position[column];
+		}
+	}
+
+	Color ambient = light.on ? light.ambient : Color(0.0f, 0.0f, 0.0f, 1.0f);
+	Color diffuse = light.on ? light.diffuse : Color(0.0f, 0.0f, 0.0f, 1.0f);
+	memcpy(frame.light_ambient, &ambient, sizeof(frame.light_ambient));
+	memcpy(frame.light_diffuse, &diffuse, sizeof(frame.light_diffuse));
+}
+
+void CoreRenderer::AddBox(const float3* corners, const Color& color)
+{
+	for (uint i = 0; i < 24; i++)
+	{
+		DebugVertex vertex;
+		const float3& corner = corners[box_edges[i]];
+		vertex.position[0] = corner.x;
+		vertex.position[1] = corner.y;
+		vertex.position[2] = corner.z;
+		vertex.color[0] = color.r;
+		vertex.color[1] = color.g;
+		vertex.color[2] = color.b;
+		lines.push_back(vertex);
+	}
+}
+
+void CoreRenderer::AddLine(const float3& from, const float3& to, const Color& color)
+{
+	DebugVertex vertex;
+	vertex.color[0] = color.r;
+	vertex.color[1] = color.g;
+	vertex.color[2] = color.b;
+
+	vertex.position[0] = from.x;
+	vertex.position[1] = from.y;
+	vertex.position[2] = from.z;
+	lines.push_back(vertex);
+
+	vertex.position[0] = to.x;
+	vertex.position[1] = to.y;
+	vertex.position[2] = to.z;
+	lines.push_back(vertex);
+}
+
+void CoreRenderer::Render(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, bool wireframe, JobSystem* jobs)
+{
+	num_draw_calls = 0;
+	num_indirect_commands = (indirect) ? indirect_builder.Prepare(queue) + static_draws.size() : 0;
+	ring.BeginFrame();
+
+	//Frame block, one transform per packet plus the identity of the static batch, the indirect commands and the lines
+	uint num_transforms = queue.GetNumPackets() + 1;
+	uint needed = sizeof(CoreFrameData) + num_transforms * sizeof(float4x4) + num_indirect_commands * sizeof(DrawElementsIndirectCommand) +
+		lines.size() * sizeof(DebugVertex) + 4 * uniform_alignment;
+	if (needed > ring.GetRegionSize())
+	{
+		ring.Grow(needed * 2);
+	}
+
+	uint frame_offset = 0;
+	char* frame_data = ring.Allocate(sizeof(CoreFrameData), uniform_alignment, frame_offset);
+	uint transforms_offset = 0;
+	float4x4* transforms = (float4x4*)ring.Allocate(num_transforms * sizeof(float4x4), sizeof(float4x4), transforms_offset);
+	if (frame_data == nullptr || transforms == nullptr)
+	{
+		lines.clear();
+		ring.EndFrame();
+		return;
+	}
+
+	memcpy(frame_data, &frame, sizeof(CoreFrameData));
+	glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ring.GetBuffer(), frame_offset, sizeof(CoreFrameData));
+
+	//Static draws can't pick a base instance, the identity goes first
+	transforms[0] = float4x4::identity;
+
+	glUseProgram(mesh_program);
+	glBindVertexArray(mesh_vao);
+	SetInstanceAttributes(transforms_offset);
+
+	glPolygonMode(GL_FRONT_AND_BACK, (wireframe) ? GL_LINE : GL_FILL);
+	if (indirect)
+	{
+		DrawIndirect(queue, batch, static_draws, transforms, jobs);
+	}
+	else
+	{
+		DrawCommands(queue, batch, static_draws, transforms);
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	DrawLines();
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	ring.EndFrame();
+}
+
+bool CoreRenderer::IsIndirect() const
+{
+	return indirect;
+}
+
+MeshArena& CoreRenderer::GetArena()
+{
+	return arena;
+}
+
+uint CoreRenderer::GetNumDrawCalls() const
+{
+	return num_draw_calls;
+}
+
+uint CoreRenderer::GetNumIndirectCommands() const
+{
+	return num_indirect_commands;
+}
+
+const GpuRingBuffer& CoreRenderer::GetRing() const
+{
+	return ring;
+}
+
+uint CoreRenderer::CreateProgram(const char* vertex_source, const char* fragment_source) const
+{
+	uint vertex = CompileShader(GL_VERTEX_SHADER, vertex_source);
+	uint fragment = CompileShader(GL_FRAGMENT_SHADER, fragment_source);
+	if (vertex == 0 || fragment == 0)
+	{
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return 0;
+	}
+
+	uint program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	glLinkProgram(program);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		char info[512];
+		glGetProgramInfoLog(program, sizeof(info), NULL, info);
+		LOG("Error linking a core shader: %s", info);
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	//GLSL 3.30 can't say the binding of a block
+	glUniformBlockBinding(program, glGetUniformBlockIndex(program, "Frame"), FRAME_BLOCK_BINDING);
+	return program;
+}
+
+uint CoreRenderer::CompileShader(uint type, const char* source) const
+{
+	//Every shader sees the frame block
+	const char* sources[3] = { "#version 330 core\n", frame_block, source };
+	uint shader = glCreateShader(type);
+	glShaderSource(shader, 3, sources, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled == GL_FALSE)
+	{
+		char info[512];
+		glGetShaderInfoLog(shader, sizeof(info), NULL, info);
+		LOG("Error compiling a core shader: %s", info);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+void CoreRenderer::SetInstanceAttributes(uint offset) const
+{
+	//One column of the matrix per attribute, advancing once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, ring.GetBuffer());
+	for (uint i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(ATTRIBUTE_TRANSFORM + i);
+		glVertexAttribPointer(ATTRIBUTE_TRANSFORM + i, 4, GL_FLOAT, GL_FALSE, sizeof(float4x4), (void*)(offset + i * 4 * sizeof(float)));
+		glVertexAttribDivisor(ATTRIBUTE_TRANSFORM + i, 1);
+	}
+}
+
+void CoreRenderer::SetMeshAttributes(const Mesh& mesh) const
+{
+	//Positions are snorm16 against the mesh AABB, the shader scales them back
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.id_vertices);
+	glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+	glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+	glEnableVertexAttribArray(ATTRIBUTE_UV);
+	glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_SHORT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, position));
+	glVertexAttribPointer(ATTRIBUTE_NORMAL, 3, GL_BYTE, GL_TRUE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, normal));
+	glVertexAttribPointer(ATTRIBUTE_UV, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, uv));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.id_indices);
+
+	SetDequantize(mesh.bounds.CenterPoint(), QuantizationExtents(mesh.bounds) / SNORM16_MAX);
+}
+
+void CoreRenderer::SetStaticAttributes(const StaticBatch& batch) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, batch.id_vertices);
+	glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+	glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+	glEnableVertexAttribArray(ATTRIBUTE_UV);
+	glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, position));
+	glVertexAttribPointer(ATTRIBUTE_NORMAL, 3, GL_BYTE, GL_TRUE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, normal));
+	glVertexAttribPointer(ATTRIBUTE_UV, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, uv));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.id_indices);
+
+	//Already in world space
+	SetDequantize(float3::zero, float3::one);
+}
+
+void CoreRenderer::SetArenaAttributes() const
+{
+	//Same layout as the buffers of every mesh, the base vertex of the command finds the mesh
+	glBindBuffer(GL_ARRAY_BUFFER, arena.GetVertexBuffer());
+	glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+	glEnableVertexAttribArray(ATTRIBUTE_NORMAL);
+	glEnableVertexAttribArray(ATTRIBUTE_UV);
+	glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_SHORT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, position));
+	glVertexAttribPointer(ATTRIBUTE_NORMAL, 3, GL_BYTE, GL_TRUE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, normal));
+	glVertexAttribPointer(ATTRIBUTE_UV, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, uv));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.GetIndexBuffer());
+
+	//The IndirectBuilder folds the dequantization in the transforms
+	SetDequantize(float3::zero, float3::one);
+}
+
+void CoreRenderer::SetDequantize(const float3& center, const float3& scale) const
+{
+	glUniform3f(dequantize_center_location, center.x, center.y, center.z);
+	glUniform3f(dequantize_scale_location, scale.x, scale.y, scale.z);
+}
+
+void CoreRenderer::DrawCommands(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, float4x4* transforms)
+{
+	//The instanced ranges go after the identity as the queue has them, then the single draws in command order
+	const std::vector<float4x4>& instances = queue.GetInstances();
+	if (instances.empty() == false)
+	{
+		memcpy(&transforms[1], instances.data(), instances.size() * sizeof(float4x4));
+	}
+
+	const std::vector<RenderCommand>& commands = queue.GetCommands();
+	uint single = 1 + instances.size();
+	for (uint i = 0; i < commands.size(); i++)
+	{
+		if (commands[i].type == RENDER_DRAW)
+		{
+			transforms[single++] = queue.GetPacket(commands[i].packet).transform;
+		}
+	}
+
+	DrawStatic(batch, static_draws);
+
+	single = 1 + instances.size();
+	for (uint i = 0; i < commands.size(); i++)
+	{
+		const RenderCommand& command = commands[i];
+		switch (command.type)
+		{
+		case RENDER_SET_SHADER:
+			glPolygonMode(GL_FRONT_AND_BACK, (command.value == RENDER_SHADER_WIREFRAME) ? GL_LINE : GL_FILL);
+			break;
+
+		case RENDER_BIND_TEXTURE:
+			glBindTexture(GL_TEXTURE_2D, command.value);
+			glUniform1i(use_texture_location, (command.value != 0) ? 1 : 0);
+			break;
+
+		case RENDER_BIND_MESH:
+			SetMeshAttributes(*command.mesh);
+			break;
+
+		case RENDER_DRAW:
+		case RENDER_DRAW_INSTANCED:
+		{
+			const Mesh& m = *command.mesh;
+			const MeshLod& level = m.lods[queue.GetPacket(command.packet).lod];
+			bool instanced = (command.type == RENDER_DRAW_INSTANCED);
+
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, level.num_indices, (m.index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+				(void*)(level.first_index * m.index_size), instanced ? command.num_instances : 1, instanced ? 1 + command.first_instance : single++);
+			num_draw_calls++;
+			break;
+		}
+		}
+	}
+}
+
+void CoreRenderer::DrawIndirect(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, float4x4* transforms, JobSystem* jobs)
+{
+	//Queue commands first, the static ones after them. Sized in Render, it fits
+	uint commands_offset = 0;
+	uint num_queued = indirect_builder.GetNumCommands();
+	DrawElementsIndirectCommand* commands = (DrawElementsIndirectCommand*)ring.Allocate(num_indirect_commands * sizeof(DrawElementsIndirectCommand), sizeof(uint), commands_offset);
+	if (commands == nullptr)
+	{
+		return;
+	}
+
+	indirect_builder.Write(queue, commands, transforms + 1, 1, jobs);
+
+	//Every static range reads the identity of instance 0
+	for (uint i = 0; i < static_draws.size(); i++)
+	{
+		DrawElementsIndirectCommand& command = commands[num_queued + i];
+		command.count = static_draws[i].num_indices;
+		command.instance_count = 1;
+		command.first_index = static_draws[i].first_index;
+		command.base_vertex = 0;
+		command.base_instance = 0;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ring.GetBuffer());
+
+	if (static_draws.empty() == false)
+	{
+		SetStaticAttributes(batch);
+
+		uint first = 0;
+		while (first < static_draws.size())
+		{
+			uint end = first;
+			while (end < static_draws.size() && static_draws[end].texture == static_draws[first].texture)
+			{
+				end++;
+			}
+
+			glBindTexture(GL_TEXTURE_2D, static_draws[first].texture);
+			glUniform1i(use_texture_location, (static_draws[first].texture != 0) ? 1 : 0);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(commands_offset + (num_queued + first) * sizeof(DrawElementsIndirectCommand)), end - first, 0);
+			num_draw_calls++;
+
+			first = end;
+		}
+	}
+
+	//The whole queue from the arena, a call per shader and texture
+	const std::vector<IndirectBatch>& batches = indirect_builder.GetBatches();
+	if (batches.empty() == false)
+	{
+		SetArenaAttributes();
+		for (uint i = 0; i < batches.size(); i++)
+		{
+			const IndirectBatch& draw = batches[i];
+			glPolygonMode(GL_FRONT_AND_BACK, (draw.shader == RENDER_SHADER_WIREFRAME) ? GL_LINE : GL_FILL);
+			glBindTexture(GL_TEXTURE_2D, draw.texture);
+			glUniform1i(use_texture_location, (draw.texture != 0) ? 1 : 0);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(commands_offset + draw.first_command * sizeof(DrawElementsIndirectCommand)), draw.num_commands, 0);
+			num_draw_calls++;
+		}
+	}
+
+	//Meshes the arena couldn't take, with no place there nothing was folded in their transform
+	const std::vector<uint>& missing = indirect_builder.GetMissing();
+	for (uint i = 0; i < missing.size(); i++)
+	{
+		const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(missing[i]));
+		const Mesh& m = *packet.mesh;
+		const MeshLod& level = m.lods[packet.lod];
+
+		SetMeshAttributes(m);
+		glPolygonMode(GL_FRONT_AND_BACK, (packet.shader == RENDER_SHADER_WIREFRAME) ? GL_LINE : GL_FILL);
+		glBindTexture(GL_TEXTURE_2D, packet.texture);
+		glUniform1i(use_texture_location, (packet.texture != 0) ? 1 : 0);
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, level.num_indices, (m.index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+			(void*)(level.first_index * m.index_size), 1, 1 + missing[i]);
+		num_draw_calls++;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void CoreRenderer::DrawStatic(const StaticBatch& batch, const std::vector<StaticDraw>& static_draws)
+{
+	if (static_draws.empty())
+	{
+		return;
+	}
+
+	SetStaticAttributes(batch);
+
+	//Every visible range of a material in one call, the transform is the identity of instance 0
+	uint first = 0;
+	while (first < static_draws.size())
+	{
+		multi_counts.clear();
+		multi_offsets.clear();
+
+		uint end = first;
+		while (end < static_draws.size() && static_draws[end].texture == static_draws[first].texture)
+		{
+			multi_counts.push_back(static_draws[end].num_indices);
+			multi_offsets.push_back((const void*)(static_draws[end].first_index * sizeof(uint)));
+			end++;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, static_draws[first].texture);
+		glUniform1i(use_texture_location, (static_draws[first].texture != 0) ? 1 : 0);
+		glMultiDrawElements(GL_TRIANGLES, multi_counts.data(), GL_UNSIGNED_INT, multi_offsets.data(), multi_counts.size());
+		num_draw_calls++;
+
+		first = end;
+	}
+}
+
+void CoreRenderer::DrawLines()
+{
+	if (lines.empty())
+	{
+		return;
+	}
+
+	uint offset = 0;
+	char* data = ring.Allocate(lines.size() * sizeof(DebugVertex), sizeof(float), offset);
+	if (data != nullptr)
+	{
+		memcpy(data, lines.data(), lines.size() * sizeof(DebugVertex));
+
+		glUseProgram(line_program);
+		glBindVertexArray(line_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, ring.GetBuffer());
+		glEnableVertexAttribArray(ATTRIBUTE_POSITION);
+		glEnableVertexAttribArray(ATTRIBUTE_COLOR);
+		glVertexAttribPointer(ATTRIBUTE_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)(offset + offsetof(DebugVertex, position)));
+		glVertexAttribPointer(ATTRIBUTE_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (void*)(offset + offsetof(DebugVertex, color)));
+		glDrawArrays(GL_LINES, 0, lines.size());
+		num_draw_calls++;
+	}
+
+	lines.clear();
+}
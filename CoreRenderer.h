@@ -0,0 +1,103 @@
+#ifndef __CORERENDERER_H__
+#define __CORERENDERER_H__
+
+#include "Globals.h"
+#include "Color.h"
+#include "GpuRingBuffer.h"
+#include "RenderQueue.h"
+#include "StaticBatch.h"
+#include "MeshArena.h"
+#include "IndirectBuilder.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <vector>
+
+#define CORE_RING_REGION_SIZE (1024 * 1024)		// Bytes per frame to start with, it grows if a frame needs more
+
+struct Light;
+class JobSystem;
+
+// Uniform block "Frame", std140
+struct CoreFrameData
+{
+	float view[16];
+	float projection[16];
+	float light_position[4];		// View space
+	float light_ambient[4];
+	float light_diffuse[4];
+};
+
+struct DebugVertex
+{
+	float position[3];
+	float color[3];
+};
+
+// Draws the render queue, the static batch and the debug lines with shaders
+// and VAOs only, what a core profile context allows. Everything that changes
+// per frame (camera, light, transforms, lines) is written in a persistently
+// mapped ring buffer, every draw is instanced and finds its transforms with
+// the base instance. Needs GL 4.4, or 3.3 with ARB_buffer_storage and
+// ARB_base_instance. With GL 4.3 or ARB_multi_draw_indirect the meshes also go
+// to a shared arena and the queue is drawn with a multi draw indirect per
+// shader and texture, the commands written by the IndirectBuilder
+class CoreRenderer
+{
+public:
+	static bool IsSupported();
+	static bool IsIndirectSupported();
+
+	bool Init(bool use_indirect);
+	void CleanUp();
+
+	void SetFrame(const float* view, const float* projection, const Light& light);
+	void AddBox(const float3* corners, const Color& color);		// The 12 edges, drawn with the next Render
+	void AddLine(const float3& from, const float3& to, const Color& color);
+	// Indirect, the queue only needs to be sorted. The jobs write the commands, nullptr does it here
+	void Render(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, bool wireframe, JobSystem* jobs);
+
+	bool IsIndirect() const;
+	MeshArena& GetArena();
+	uint GetNumDrawCalls() const;		// Last Render
+	uint GetNumIndirectCommands() const;		// Last Render, queue and static ones
+	const GpuRingBuffer& GetRing() const;
+
+private:
+	uint CreateProgram(const char* vertex_source, const char* fragment_source) const;
+	uint CompileShader(uint type, const char* source) const;
+	void SetInstanceAttributes(uint offset) const;
+	void SetMeshAttributes(const Mesh& mesh) const;
+	void SetStaticAttributes(const StaticBatch& batch) const;
+	void SetArenaAttributes() const;
+	void SetDequantize(const float3& center, const float3& scale) const;
+	void DrawCommands(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, float4x4* transforms);
+	void DrawIndirect(const RenderQueue& queue, const StaticBatch& batch, const std::vector<StaticDraw>& static_draws, float4x4* transforms, JobSystem* jobs);
+	void DrawStatic(const StaticBatch& batch, const std::vector<StaticDraw>& static_draws);
+	void DrawLines();
+
+private:
+	GpuRingBuffer ring;
+	int uniform_alignment = 256;
+
+	uint mesh_program = 0;
+	uint mesh_vao = 0;
+	int dequantize_center_location = -1;
+	int dequantize_scale_location = -1;
+	int use_texture_location = -1;
+
+	uint line_program = 0;
+	uint line_vao = 0;
+
+	CoreFrameData frame;
+	std::vector<DebugVertex> lines;
+	std::vector<int> multi_counts;		// Arguments of the glMultiDrawElements of a material
+	std::vector<const void*> multi_offsets;
+	uint num_draw_calls = 0;
+
+	//Multi draw indirect
+	bool indirect = false;
+	MeshArena arena;
+	IndirectBuilder indirect_builder;
+	uint num_indirect_commands = 0;
+};
+
+#endif // !__CORERENDERER_H__
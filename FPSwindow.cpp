@@ -41,6 +41,32 @@ void FPSwindow::Render()
 		sprintf_s(text, 50, "FPS: %d", fps);
 		ImGui::Text(text);
 
+		sprintf_s(text, 50, "%s path, submission: %.3f ms", App->renderer3D->IsCorePath() ? "Core" : "Fixed", App->renderer3D->GetSubmitMs());
+		ImGui::Text(text);
+
+		//Last frame of the render queue, indirect it's only sorted
+		const RenderQueue& queue = App->renderer3D->GetRenderQueue();
+		if (App->renderer3D->IsIndirect())
+		{
+			sprintf_s(text, 50, "Indirect commands: %d  Calls: %d", App->renderer3D->GetNumIndirectCommands(), App->renderer3D->GetNumDrawCalls());
+			ImGui::Text(text);
+		}
+		else
+		{
+			sprintf_s(text, 50, "Draws: %d  State changes: %d", queue.GetNumDraws(), queue.GetStateChanges());
+			ImGui::Text(text);
+			sprintf_s(text, 50, "Instanced meshes: %d", queue.GetNumInstanced());
+			ImGui::Text(text);
+		}
+		sprintf_s(text, 50, "Static draws: %d", App->renderer3D->GetNumStaticDraws());
+		ImGui::Text(text);
+
+		bool instancing = App->renderer3D->IsInstancing();
+		if (ImGui::Checkbox("Instancing", &instancing))
+		{
+			App->renderer3D->SetInstancing(instancing);
+		}
+
 		ImGui::PlotHistogram("Framerate", &frames[0], frames.size(), 0, NULL, 0.0f, 100.0f, ImVec2(400, 90));
 		if (ImGui::SliderInt("Max FPS", &max_fps, 0, 300, NULL))
 		{
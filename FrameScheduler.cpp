@@ -0,0 +1,213 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(JobSystem* jobs) : jobs(jobs), remaining(0), stopped_at(-1)
+{}
+
+FrameScheduler::~FrameScheduler()
+{
+	WaitSimulation();
+}
+
+update_status FrameScheduler::RunPhase(FramePhase phase, const std::list<Module*>& modules, float dt)
+{
+	this->phase = phase;
+	this->dt = dt;
+	tasks.clear();
+	main_ready.clear();
+	stopped_at = -1;
+	worker_tasks = 0;
+	main_tasks = 0;
+
+	std::list<Module*>::const_iterator it = modules.begin();
+	while (it != modules.end())
+	{
+		if ((*it)->IsEnabled())
+		{
+			Task task;
+			task.module = (*it);
+			(*it)->DeclareAccess(phase, task.access);
+			tasks.push_back(task);
+		}
+		++it;
+	}
+
+	//Every module waits for the earlier ones it conflicts with, and for the simulation if it needs it
+	std::vector<uint> ready;
+	for (uint i = 0; i < tasks.size(); i++)
+	{
+		for (uint j = 0; j < i; j++)
+		{
+			if (tasks[j].access.ConflictsWith(tasks[i].access))
+			{
+				tasks[j].dependents.push_back(i);
+				tasks[i].dependencies++;
+			}
+		}
+
+		tasks[i].wait_simulation = (simulation.pending > 0 && simulation_access.ConflictsWith(tasks[i].access));
+		if (tasks[i].dependencies == 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	remaining = tasks.size();
+	{
+		std::lock_guard<std::mutex> lock(tasks_mutex);
+		for (uint i = 0; i < ready.size(); i++)
+		{
+			Dispatch(ready[i]);
+		}
+	}
+
+	//The main thread runs its tasks in module order as they get ready
+	while (remaining > 0)
+	{
+		int index = -1;
+		{
+			std::lock_guard<std::mutex> lock(tasks_mutex);
+			std::vector<uint>::iterator first = main_ready.end();
+			for (std::vector<uint>::iterator ready_it = main_ready.begin(); ready_it != main_ready.end(); ++ready_it)
+			{
+				if (first == main_ready.end() || (*ready_it) < (*first))
+				{
+					first = ready_it;
+				}
+			}
+
+			if (first != main_ready.end())
+			{
+				index = (*first);
+				main_ready.erase(first);
+			}
+		}
+
+		if (index >= 0)
+		{
+			RunTask(index);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	int stop = stopped_at;
+	return (stop >= 0) ? tasks[stop].result : UPDATE_CONTINUE;
+}
+
+void FrameScheduler::StartSimulation(const std::list<Module*>& modules, float dt)
+{
+	WaitSimulation();
+
+	std::list<Module*>::const_iterator it = modules.begin();
+	while (it != modules.end())
+	{
+		FrameAccess access;
+		(*it)->DeclareAccess(FRAME_SIMULATE, access);
+		if ((*it)->IsEnabled() && access.IsEmpty() == false)
+		{
+			simulation_access.reads |= access.reads;
+			simulation_access.writes |= access.writes;
+
+			//On one core there's nothing to overlap with
+			Module* module = (*it);
+			if (jobs->GetNumWorkers() == 0)
+			{
+				module->Simulate(dt);
+			}
+			else
+			{
+				jobs->Schedule([module, dt]() { module->Simulate(dt); }, &simulation, true);
+			}
+		}
+		++it;
+	}
+}
+
+void FrameScheduler::WaitSimulation()
+{
+	jobs->Wait(simulation);
+	simulation_access = FrameAccess();
+}
+
+uint FrameScheduler::GetNumWorkerTasks() const
+{
+	return worker_tasks;
+}
+
+uint FrameScheduler::GetNumMainTasks() const
+{
+	return main_tasks;
+}
+
+void FrameScheduler::Dispatch(uint index)
+{
+	//Empty updates aren't worth a job
+	const FrameAccess& access = tasks[index].access;
+	if (access.OnMainThread() || access.IsEmpty() || jobs->GetNumWorkers() == 0)
+	{
+		main_ready.push_back(index);
+		main_tasks++;
+	}
+	else
+	{
+		jobs->Schedule([this, index]() { RunTask(index); }, nullptr, true);
+		worker_tasks++;
+	}
+}
+
+void FrameScheduler::RunTask(uint index)
+{
+	Task& task = tasks[index];
+
+	//Modules after one that stopped the frame don't update, like in a serial loop
+	int stop = stopped_at;
+	if (stop < 0 || (int)index < stop)
+	{
+		if (task.wait_simulation)
+		{
+			jobs->Wait(simulation);
+		}
+
+		task.result = RunModule(task.module, phase, dt);
+		if (task.result != UPDATE_CONTINUE)
+		{
+			while ((stop < 0 || (int)index < stop) && stopped_at.compare_exchange_weak(stop, index) == false)
+			{}
+		}
+	}
+
+	Finish(index);
+}
+
+void FrameScheduler::Finish(uint index)
+{
+	std::lock_guard<std::mutex> lock(tasks_mutex);
+
+	std::vector<uint>& dependents = tasks[index].dependents;
+	for (uint i = 0; i < dependents.size(); i++)
+	{
+		if (--tasks[dependents[i]].dependencies == 0)
+		{
+			Dispatch(dependents[i]);
+		}
+	}
+
+	remaining--;
+}
+
+update_status FrameScheduler::RunModule(Module* module, FramePhase phase, float dt)
+{
+	switch (phase)
+	{
+	case FRAME_PRE_UPDATE:
+		return module->PreUpdate(dt);
+	case FRAME_UPDATE:
+		return module->Update(dt);
+	case FRAME_POST_UPDATE:
+		return module->PostUpdate(dt);
+	default:
+		return UPDATE_CONTINUE;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef __FRAMESCHEDULER_H__
+#define __FRAMESCHEDULER_H__
+
+#include "Globals.h"
+#include "Module.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+
+// Runs every phase of the frame over the modules. A module waits only for the
+// earlier ones whose access conflicts with its own, the rest go at the same
+// time: the ones that touch GL on the main thread in module order, the others
+// on the workers. The phases stay in order, PreUpdate, Update and PostUpdate,
+// except for the simulation that overlaps the PostUpdate of the frame and the
+// next PreUpdate until something needs what it writes
+class FrameScheduler
+{
+public:
+	FrameScheduler(JobSystem* jobs);
+	~FrameScheduler();
+
+	// The first status other than UPDATE_CONTINUE, modules after it are skipped
+	update_status RunPhase(FramePhase phase, const std::list<Module*>& modules, float dt);
+
+	void StartSimulation(const std::list<Module*>& modules, float dt);
+	void WaitSimulation();
+
+	uint GetNumWorkerTasks() const;		// Last phase, on the workers
+	uint GetNumMainTasks() const;		// Last phase, on the main thread
+
+private:
+	struct Task
+	{
+		Module* module = nullptr;
+		FrameAccess access;
+		std::vector<uint> dependents;
+		uint dependencies = 0;		// Not finished yet
+		bool wait_simulation = false;
+		update_status result = UPDATE_CONTINUE;
+	};
+
+	void Dispatch(uint index);
+	void RunTask(uint index);
+	void Finish(uint index);
+	static update_status RunModule(Module* module, FramePhase phase, float dt);
+
+private:
+	JobSystem* jobs = nullptr;
+
+	FramePhase phase = FRAME_PRE_UPDATE;
+	float dt = 0.0f;
+	std::vector<Task> tasks;
+	std::mutex tasks_mutex;
+	std::vector<uint> main_ready;		// Tasks for the main thread, guarded by tasks_mutex
+	std::atomic<int> remaining;
+	std::atomic<int> stopped_at;		// Index of the first task that didn't continue, or -1
+
+	JobCounter simulation;
+	FrameAccess simulation_access;		// What the simulation in flight touches
+
+	uint worker_tasks = 0;
+	uint main_tasks = 0;
+};
+
+#endif // !__FRAMESCHEDULER_H__
@@ -0,0 +1,231 @@
+#include "FrustumCulling.h"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+//-- FrustumPlanes ---------------------------------
+
+void FrustumPlanes::Set(const Frustum& frustum)
+{
+	Plane planes[FRUSTUM_PLANES];
+	frustum.GetPlanes(planes);
+
+	for (uint i = 0; i < FRUSTUM_PLANES; i++)
+	{
+		normal_x[i] = planes[i].normal.x;
+		normal_y[i] = planes[i].normal.y;
+		normal_z[i] = planes[i].normal.z;
+		abs_x[i] = Abs(planes[i].normal.x);
+		abs_y[i] = Abs(planes[i].normal.y);
+		abs_z[i] = Abs(planes[i].normal.z);
+		d[i] = planes[i].d;
+	}
+}
+
+//-- AABBArray -------------------------------------
+
+void AABBArray::Push(const AABB& box)
+{
+	float3 center = box.CenterPoint();
+	float3 extents = box.HalfSize();
+
+	center_x.push_back(center.x);
+	center_y.push_back(center.y);
+	center_z.push_back(center.z);
+	extent_x.push_back(extents.x);
+	extent_y.push_back(extents.y);
+	extent_z.push_back(extents.z);
+}
+
+void AABBArray::Set(uint index, const AABB& box)
+{
+	float3 center = box.CenterPoint();
+	float3 extents = box.HalfSize();
+
+	center_x[index] = center.x;
+	center_y[index] = center.y;
+	center_z[index] = center.z;
+	extent_x[index] = extents.x;
+	extent_y[index] = extents.y;
+	extent_z[index] = extents.z;
+}
+
+void AABBArray::RemoveSwap(uint index)
+{
+	uint last = center_x.size() - 1;
+
+	center_x[index] = center_x[last];
+	center_y[index] = center_y[last];
+	center_z[index] = center_z[last];
+	extent_x[index] = extent_x[last];
+	extent_y[index] = extent_y[last];
+	extent_z[index] = extent_z[last];
+
+	center_x.pop_back();
+	center_y.pop_back();
+	center_z.pop_back();
+	extent_x.pop_back();
+	extent_y.pop_back();
+	extent_z.pop_back();
+}
+
+void AABBArray::Clear()
+{
+	center_x.clear();
+	center_y.clear();
+	center_z.clear();
+	extent_x.clear();
+	extent_y.clear();
+	extent_z.clear();
+}
+
+uint AABBArray::Size() const
+{
+	return center_x.size();
+}
+
+AABB AABBArray::Get(uint index) const
+{
+	float3 center(center_x[index], center_y[index], center_z[index]);
+	float3 extents(extent_x[index], extent_y[index], extent_z[index]);
+	return AABB(center - extents, center + extents);
+}
+
+//-- Tests -----------------------------------------
+
+CullResult CullAABB(const FrustumPlanes& planes, const float3& center, const float3& extents, uint& mask, uint& last_plane)
+{
+	for (uint n = 0; n < FRUSTUM_PLANES; n++)
+	{
+		//The plane that rejected the box last time goes first
+		uint i = (n == 0) ? last_plane : ((n == last_plane) ? 0 : n);
+		if ((mask & (1 << i)) == 0)
+		{
+			continue;
+		}
+
+		float distance = planes.normal_x[i] * center.x + planes.normal_y[i] * center.y + planes.normal_z[i] * center.z - planes.d[i];
+		float radius = planes.abs_x[i] * extents.x + planes.abs_y[i] * extents.y + planes.abs_z[i] * extents.z;
+
+		if (distance - radius > 0.0f)
+		{
+			last_plane = i;
+			return CULL_OUTSIDE;
+		}
+
+		if (distance + radius < 0.0f)
+		{
+			mask &= ~(1 << i);
+		}
+	}
+
+	return (mask == 0) ? CULL_INSIDE : CULL_INTERSECT;
+}
+
+uint CullAABBs(const FrustumPlanes& planes, uint mask, const AABBArray& boxes, uint* visible)
+{
+	uint count = boxes.Size();
+	uint num_visible = 0;
+	uint i = 0;
+
+	const float* cx = boxes.center_x.data();
+	const float* cy = boxes.center_y.data();
+	const float* cz = boxes.center_z.data();
+	const float* ex = boxes.extent_x.data();
+	const float* ey = boxes.extent_y.data();
+	const float* ez = boxes.extent_z.data();
+
+#ifdef __AVX__
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 center_x = _mm256_loadu_ps(cx + i);
+		__m256 center_y = _mm256_loadu_ps(cy + i);
+		__m256 center_z = _mm256_loadu_ps(cz + i);
+		__m256 extent_x = _mm256_loadu_ps(ex + i);
+		__m256 extent_y = _mm256_loadu_ps(ey + i);
+		__m256 extent_z = _mm256_loadu_ps(ez + i);
+		__m256 outside = _mm256_setzero_ps();
+
+		for (uint p = 0; p < FRUSTUM_PLANES; p++)
+		{
+			if ((mask & (1 << p)) == 0)
+			{
+				continue;
+			}
+
+			//distance - radius > 0 means the whole box is in front of the plane
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(center_x, _mm256_set1_ps(planes.normal_x[p])),
+				_mm256_mul_ps(center_y, _mm256_set1_ps(planes.normal_y[p]))),
+				_mm256_sub_ps(_mm256_mul_ps(center_z, _mm256_set1_ps(planes.normal_z[p])), _mm256_set1_ps(planes.d[p])));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extent_x, _mm256_set1_ps(planes.abs_x[p])),
+				_mm256_mul_ps(extent_y, _mm256_set1_ps(planes.abs_y[p]))),
+				_mm256_mul_ps(extent_z, _mm256_set1_ps(planes.abs_z[p])));
+
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_sub_ps(distance, radius), _mm256_setzero_ps(), _CMP_GT_OQ));
+		}
+
+		int inside_mask = ~_mm256_movemask_ps(outside) & 0xff;
+		for (uint k = 0; k < 8; k++)
+		{
+			if (inside_mask & (1 << k))
+			{
+				visible[num_visible++] = i + k;
+			}
+		}
+	}
+#else
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 center_x = _mm_loadu_ps(cx + i);
+		__m128 center_y = _mm_loadu_ps(cy + i);
+		__m128 center_z = _mm_loadu_ps(cz + i);
+		__m128 extent_x = _mm_loadu_ps(ex + i);
+		__m128 extent_y = _mm_loadu_ps(ey + i);
+		__m128 extent_z = _mm_loadu_ps(ez + i);
+		__m128 outside = _mm_setzero_ps();
+
+		for (uint p = 0; p < FRUSTUM_PLANES; p++)
+		{
+			if ((mask & (1 << p)) == 0)
+			{
+				continue;
+			}
+
+			//distance - radius > 0 means the whole box is in front of the plane
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(center_x, _mm_set1_ps(planes.normal_x[p])),
+				_mm_mul_ps(center_y, _mm_set1_ps(planes.normal_y[p]))),
+				_mm_sub_ps(_mm_mul_ps(center_z, _mm_set1_ps(planes.normal_z[p])), _mm_set1_ps(planes.d[p])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extent_x, _mm_set1_ps(planes.abs_x[p])),
+				_mm_mul_ps(extent_y, _mm_set1_ps(planes.abs_y[p]))),
+				_mm_mul_ps(extent_z, _mm_set1_ps(planes.abs_z[p])));
+
+			outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		int inside_mask = ~_mm_movemask_ps(outside) & 0xf;
+		for (uint k = 0; k < 4; k++)
+		{
+			if (inside_mask & (1 << k))
+			{
+				visible[num_visible++] = i + k;
+			}
+		}
+	}
+#endif
+
+	//Remaining boxes one by one
+	for (; i < count; i++)
+	{
+		uint box_mask = mask;
+		uint last_plane = 0;
+		if (CullAABB(planes, float3(cx[i], cy[i], cz[i]), float3(ex[i], ey[i], ez[i]), box_mask, last_plane) != CULL_OUTSIDE)
+		{
+			visible[num_visible++] = i;
+		}
+	}
+
+	return num_visible;
+}
@@ -0,0 +1,60 @@
+#ifndef __FRUSTUMCULLING_H__
+#define __FRUSTUMCULLING_H__
+
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "Globals.h"
+#include <vector>
+
+#define FRUSTUM_PLANES 6
+#define FRUSTUM_ALL_PLANES 0x3f
+
+// Frustum planes extracted once, one array per component so every plane can
+// be broadcast against several boxes. Normals point out of the frustum
+struct FrustumPlanes
+{
+	void Set(const Frustum& frustum);
+
+	float normal_x[FRUSTUM_PLANES];
+	float normal_y[FRUSTUM_PLANES];
+	float normal_z[FRUSTUM_PLANES];
+	float abs_x[FRUSTUM_PLANES];		// |normal|, projects the extents on the normal
+	float abs_y[FRUSTUM_PLANES];
+	float abs_z[FRUSTUM_PLANES];
+	float d[FRUSTUM_PLANES];
+};
+
+// Boxes in center/extents form, one array per component
+struct AABBArray
+{
+	void Push(const AABB& box);
+	void Set(uint index, const AABB& box);
+	void RemoveSwap(uint index);		// The last box takes the place of the removed one
+	void Clear();
+	uint Size() const;
+	AABB Get(uint index) const;
+
+	std::vector<float> center_x;
+	std::vector<float> center_y;
+	std::vector<float> center_z;
+	std::vector<float> extent_x;
+	std::vector<float> extent_y;
+	std::vector<float> extent_z;
+};
+
+enum CullResult
+{
+	CULL_OUTSIDE,
+	CULL_INTERSECT,
+	CULL_INSIDE
+};
+
+// One box against the planes in the mask. Planes the box is fully inside of are
+// removed from the mask, the plane that rejects it is stored in last_plane and
+// tested first the next time
+CullResult CullAABB(const FrustumPlanes& planes, const float3& center, const float3& extents, uint& mask, uint& last_plane);
+
+// Tests every box against the planes in the mask, 4 (SSE) or 8 (AVX) at a time.
+// Writes the indices of the boxes not fully outside and returns how many
+uint CullAABBs(const FrustumPlanes& planes, uint mask, const AABBArray& boxes, uint* visible);
+
+#endif // !__FRUSTUMCULLING_H__
@@ -6,38 +6,38 @@
 #include "ComponentMesh.h"
 #include "ComponentCamera.h"
 #include "JSON.h"
+#include "TriangleBVH.h"
+#include "Hash.h"
+#include "SceneFormat.h"
 
 using namespace std;
 
 GameObject::GameObject(GameObject* parent, const char * name) : parent(parent)
 {
 	name_object = name;
-	id = App->random_id->Int(1, MAX_INTEGER);
-}
+	id = App->go_manager->GenerateUID();
 
-GameObject::GameObject(GameObject * parent, const char * name, int id, bool enabled) : parent(parent), name_object(name), id(id), enabled(enabled)
-{
+	for (uint i = 0; i < Component::NONE; i++)
+	{
+		components_by_type[i] = nullptr;
+	}
 }
 
-GameObject::~GameObject()
+GameObject::GameObject(GameObject * parent, const char * name, UID id, bool enabled) : parent(parent), name_object(name), id(id), enabled(enabled)
 {
-
-	if (parent!= nullptr)
+	for (uint i = 0; i < Component::NONE; i++)
 	{
-		vector<GameObject*>::iterator it = childs.begin();
-		while (it != childs.end())
-		{
-			
-			delete (*it);
-			++it;
-		}
+		components_by_type[i] = nullptr;
 	}
-	
+}
 
+GameObject::~GameObject()
+{
+	//Childs are deleted by the GameObject manager, one by one or with the whole scene
 	vector<Component*>::iterator it2 = components.begin();
 	while (it2 != components.end())
 	{
-		delete(*it2);
+		App->go_manager->DestroyComponent(*it2);
 		++it2;
 	}
 
@@ -48,20 +48,43 @@ void GameObject::PreUpdate(float dt)
 	vector<Component*>::iterator it = to_delete.begin();
 	while (it != to_delete.end())
 	{
+		RemoveComponent(*it);
+		App->go_manager->DestroyComponent(*it);
+		++it;
+	}
+	to_delete.clear();
+}
+
+void GameObject::RemoveComponent(Component* comp)
+{
+	vector<Component*>::iterator it = components.begin();
+	while (it != components.end())
+	{
+		if ((*it) == comp)
+		{
+			components.erase(it);
+			break;
+		}
+		++it;
+	}
+
+	//The next component of the same type takes its place in the lookup
+	Component::Types type = comp->GetType();
+	if (type < Component::NONE && components_by_type[type] == comp)
+	{
+		components_by_type[type] = nullptr;
+
 		vector<Component*>::iterator it2 = components.begin();
 		while (it2 != components.end())
 		{
-			if ((*it2) == (*it))
+			if ((*it2)->GetType() == type)
 			{
-				components.erase(it2);
+				components_by_type[type] = (*it2);
 				break;
 			}
 			++it2;
 		}
-		delete(*it);
-		++it;
 	}
-	to_delete.clear();
 }
 
 void GameObject::Update(float dt)
@@ -93,20 +116,25 @@ void GameObject::Save(Json & file_data)
 {
 	Json data;
 	data.AddString("Name", name_object.data());
-	data.AddInt("ID Game Object", id);
+
+	//Json numbers are doubles, the 64 bit ids are saved as hex strings
+	char id_str[17];
+	HashToString(id, id_str);
+	data.AddString("ID Game Object", id_str);
 
 	if (this == App->go_manager->GetRoot())
 	{
-		data.AddInt("ID Parent", 0);
+		HashToString(0, id_str);
 	}
 	else if (parent == nullptr)
 	{
-		data.AddInt("ID Parent", App->go_manager->GetRoot()->id);
+		HashToString(App->go_manager->GetRoot()->id, id_str);
 	}
 	else
 	{
-		data.AddInt("ID Parent", parent->id);
+		HashToString(parent->id, id_str);
 	}
+	data.AddString("ID Parent", id_str);
 	
 	data.AddBool("Enabled", enabled);
 	data.AddArray("Components");
@@ -131,35 +159,56 @@ void GameObject::Save(Json & file_data)
 
 }
 
-
-Component* GameObject::AddComponent(Component::Types type)
+void GameObject::Save(SceneWriter & writer)
 {
-	Component* ret = nullptr;
+	UID parent_id = 0;
+	if (this == App->go_manager->GetRoot())
+	{
+		parent_id = 0;
+	}
+	else if (parent == nullptr)
+	{
+		parent_id = App->go_manager->GetRoot()->id;
+	}
+	else
+	{
+		parent_id = parent->id;
+	}
 
-	switch (type)
+	writer.AddObject(id, parent_id, name_object.data(), enabled);
+
+	vector<Component*>::iterator it = components.begin();
+	while (it != components.end())
+	{
+		SceneComponentRecord record;
+		(*it)->ToSave(record, writer);
+		writer.AddComponent(record);
+		++it;
+	}
+
+	vector<GameObject*>::iterator it2 = childs.begin();
+	while (it2 != childs.end())
 	{
-	case Component::MESH:
-		ret = new ComponentMesh(type);
-		break;
-	case Component::TRANSFORM:
-		ret = new ComponentTransform(type);
-		break;
-	case Component::MATERIAL:
-		ret = new ComponentMaterial(type);
-		break;
-	case Component::CAMERA:
-		ret = new ComponentCamera(type);
-		break;
-	case Component::NONE:
-		break;
-	default:
-		break;
+		(*it2)->Save(writer);
+		++it2;
 	}
+}
+
+
+Component* GameObject::AddComponent(Component::Types type)
+{
+	Component* ret = App->go_manager->CreateComponent(type);
 
 	if (ret != nullptr)
 	{
 		components.push_back(ret);
 		ret->go = this;
+
+		if (components_by_type[type] == nullptr)
+		{
+			components_by_type[type] = ret;
+		}
+		App->go_manager->NotifyChanged(this);
 	}
 
 
@@ -175,12 +224,26 @@ void GameObject::DeleteComponent(Component * comp)
 		if ((*it) == comp)
 		{
 			to_delete.push_back(comp);
+			App->go_manager->NotifyChanged(this);
 			break;
 		}
 		++it;
 	}
 }
 
+void GameObject::DestroyComponents()
+{
+	vector<Component*> all_components = components;
+	vector<Component*>::iterator it = all_components.begin();
+	while (it != all_components.end())
+	{
+		RemoveComponent(*it);
+		App->go_manager->DestroyComponent(*it);
+		++it;
+	}
+	to_delete.clear();
+}
+
 void GameObject::DeleteChilds(GameObject * child)
 {
 	if (child != nullptr)
@@ -200,14 +263,11 @@ void GameObject::DeleteChilds(GameObject * child)
 
 void GameObject::DeleteAllChildren()
 {
-	if (childs.size() > 0)
+	//Deleting a child erases it from childs, from the back nothing is skipped
+	while (childs.size() > 0)
 	{
-		for (uint i = 0; i < childs.size(); ++i)
-		{
-			App->go_manager->DeleteGameObject(childs[i]);
-		}
+		App->go_manager->DeleteGameObject(childs.back());
 	}
-	childs.clear();
 }
 
 bool GameObject::CheckHits(const LineSegment & ray, float & distance)
@@ -216,47 +276,28 @@ bool GameObject::CheckHits(const LineSegment & ray, float & distance)
 	ComponentMesh* mesh = (ComponentMesh*)GetComponent(Component::MESH);
 	ComponentTransform* cmp_trans = (ComponentTransform*)GetComponent(Component::TRANSFORM);
 
-	Mesh* m = mesh->GetMesh();
-
 	if (mesh != nullptr)
 	{
+		Mesh* m = mesh->GetMesh();
 		if (m != nullptr)
 		{
-
+			//The mesh BVH is in local space, the ray goes there instead of the triangles to world
+			float4x4 transform = cmp_trans->GetWorldTransformationMatrix();
 			LineSegment raycast = ray;
-			raycast.Transform(cmp_trans->GetWorldTransformationMatrix().Inverted());
+			raycast.Transform(transform.Inverted());
 
+			//Distance along the segment, 0 at its start and 1 at its end
 			float hit_dist;
-			float3 hit_point;
-			Triangle triangle;
-			int v1;
-			int v2;
-			int v3;
-			float3 a;
-			float3 b;
-			float3 c;
-
-			uint indices = m->num_indices / 3;
-			for (int i = 0; i < indices; i++)
+			if (m->GetBVH()->RayCast(raycast.a, raycast.b - raycast.a, 1.0f, hit_dist))
 			{
-				v1 = m->indices[i * 3];
-				v2 = m->indices[i * 3 + 1];
-				v3 = m->indices[i * 3 + 2];
-
-				a = float3(&m->vertices[v1]);
-				b = float3(&m->vertices[v2]);
-				c = float3(&m->vertices[v3]);
+				//Compared in world space so objects with different scales can be sorted
+				float3 hit_point = transform.TransformPos(raycast.GetPoint(hit_dist));
+				float world_dist = ray.a.Distance(hit_point);
 
-				triangle = Triangle(a, b, c);
-
-				if (raycast.Intersects(triangle, &hit_dist, &hit_point))
+				if (distance > world_dist)
 				{
-					if (distance > hit_dist)
-					{
-						distance = hit_dist;
-						
-						intersect = true;
-					}
+					distance = world_dist;
+					intersect = true;
 				}
 			}
 		}
@@ -273,7 +314,7 @@ void GameObject::CollectRayHits(GameObject * game_object, const LineSegment & ra
 		ComponentMesh* cmp_mesh = (ComponentMesh*)game_object->GetComponent(Component::MESH);
 		if (cmp_mesh->GetMesh() != nullptr)
 		{
-			hits = App->go_manager->quad.RayPicking(ray);
+			hits = App->go_manager->octree.RayPicking(ray);
 		}
 	}
 
@@ -288,25 +329,6 @@ void GameObject::CollectRayHits(GameObject * game_object, const LineSegment & ra
 	}
 }
 
-void GameObject::InsertNode()
-{
-	ComponentMesh* cmp_mesh = (ComponentMesh*)GetComponent(Component::MESH);
-	if (cmp_mesh != nullptr)
-	{
-		App->go_manager->quad.Insert(this);
-	}
-
-	if (childs.empty() == false)
-	{
-		vector<GameObject*>::iterator it = childs.begin();
-		while (it != childs.end())
-		{
-			(*it)->InsertNode();
-			it++;
-		}
-	}
-}
-
  const std::vector<GameObject*>* GameObject::GetChilds() const
 {
 	return &childs;
@@ -321,14 +343,9 @@ Component * GameObject::GetComponent(Component::Types type) const
 {
 	Component* ret = nullptr;
 
-	vector<Component*>::const_iterator it = components.begin();
-	while (it != components.end())
+	if (type >= 0 && type < Component::NONE)
 	{
-		if ((*it)->GetType() == type)
-		{
-			return (*it);
-		}
-		++it;
+		ret = components_by_type[type];
 	}
 	return ret;
 }
@@ -338,7 +355,7 @@ GameObject * GameObject::GetParent() const
 	return parent;
 }
 
-uint GameObject::GetID() const
+UID GameObject::GetID() const
 {
 	return id;
 }
@@ -351,12 +368,14 @@ bool GameObject::isEnabled()
 void GameObject::Enable()
 {
 	enabled = true;
+	App->go_manager->NotifyChanged(this);
 
 	vector<GameObject*>::iterator it = childs.begin();
 	while (it != childs.end())
 	{
 	
 		(*it)->enabled = true;
+		App->go_manager->NotifyChanged(*it);
 		++it;
 	}
 }
@@ -364,11 +383,13 @@ void GameObject::Enable()
 void GameObject::Disable()
 {
 	enabled = false;
+	App->go_manager->NotifyChanged(this);
 
 	vector<GameObject*>::iterator it = childs.begin();
 	while (it != childs.end())
 	{
 		(*it)->enabled = false;
+		App->go_manager->NotifyChanged(*it);
 		++it;
 	}
 }
@@ -8,13 +8,14 @@
 #include "JSON.h"
 
 class Component;
+class SceneWriter;
 enum Types;
 
 class GameObject
 {
 public:
 	GameObject(GameObject* parent, const char* name);
-	GameObject(GameObject* parent, const char* name, int id, bool enabled);
+	GameObject(GameObject* parent, const char* name, UID id, bool enabled);
 	virtual ~GameObject();
 
 	void PreUpdate(float dt);
@@ -22,21 +23,22 @@ public:
 	void ShowOnEditor();
 	void UpdateGameObjectTransform();
 	void Save(Json& file_data);
+	void Save(SceneWriter& writer);
 
 
 	Component* AddComponent(Component::Types type);
 	void DeleteComponent(Component* comp);
+	void DestroyComponents();		// Right away, DeleteComponent waits for the next PreUpdate
 	void DeleteChilds(GameObject* child);
 	void DeleteAllChildren();
 	bool CheckHits(const LineSegment& ray, float& distance);
 	void CollectRayHits(GameObject* game_object, const LineSegment& ray, std::vector<GameObject*>&hits);
-	void InsertNode();
 
 	const std::vector<GameObject*>* GetChilds() const;
 	const std::vector<Component*>* GetComponents() const;
 	Component* GetComponent(Component::Types type) const;
 	GameObject* GetParent() const;
-	uint GetID()const;
+	UID GetID()const;
 
 	bool isEnabled();
 	void Enable();
@@ -44,6 +46,9 @@ public:
 
 
 
+private:
+	void RemoveComponent(Component* comp);
+
 private:
 	GameObject* parent = nullptr;
 
@@ -53,9 +58,10 @@ public:
 	std::vector<GameObject*> childs;
 	std::vector<Component*> components;
 	std::vector<Component*> to_delete;
+	Component* components_by_type[Component::NONE];		// First component of every type, for O(1) GetComponent
 
 	bool enabled = true;
-	uint id = NULL;
+	UID id = 0;
 	float3 distance_hit = float3::zero;
 
 };
@@ -18,6 +18,7 @@ void log(const char file[], int line, const char* format, ...);
 #define MAX_INTEGER 2147483647
 
 typedef unsigned int uint;
+typedef unsigned long long UID;		// 64 bit unique id, 0 is never given
 
 enum update_status
 {
@@ -44,6 +45,7 @@ enum update_status
 #define SAVE_DIRECTORY "/Save/"
 #define TEXTURES_DIRECTORY "Library/Textures/"
 #define MESH_DIRECTORY "Library/Mesh/"
+#define IMPORT_DATABASE "Library/ImportDatabase.json"
 
 #define ASSETS_TEXTURES "Assets/Textures/"
 #define ASSETS_MESHES "Assets/Meshes"
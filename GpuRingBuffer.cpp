@@ -0,0 +1,142 @@
+#include "GpuRingBuffer.h"
+#include "Glew\include\glew.h"
+
+//A second, the GPU is gone if it takes longer
+#define GPU_RING_WAIT_NS 1000000000
+#define GPU_RING_ALIGNMENT 256
+
+GpuRingBuffer::GpuRingBuffer()
+{
+	for (uint i = 0; i < GPU_RING_REGIONS; i++)
+	{
+		fences[i] = nullptr;
+	}
+}
+
+GpuRingBuffer::~GpuRingBuffer()
+{
+	Destroy();
+}
+
+bool GpuRingBuffer::Create(uint region_size)
+{
+	Destroy();
+
+	//Every region starts aligned for uniform blocks and matrices
+	region_size = (region_size + GPU_RING_ALIGNMENT - 1) / GPU_RING_ALIGNMENT * GPU_RING_ALIGNMENT;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferStorage(GL_ARRAY_BUFFER, region_size * GPU_RING_REGIONS, nullptr, flags);
+	mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, region_size * GPU_RING_REGIONS, flags);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (mapped == nullptr)
+	{
+		LOG("Error mapping the ring buffer of %d bytes", region_size * GPU_RING_REGIONS);
+		Destroy();
+		return false;
+	}
+
+	this->region_size = region_size;
+	region = 0;
+	used = 0;
+	return true;
+}
+
+void GpuRingBuffer::Destroy()
+{
+	for (uint i = 0; i < GPU_RING_REGIONS; i++)
+	{
+		if (fences[i] != nullptr)
+		{
+			glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GPU_RING_WAIT_NS);
+			glDeleteSync(fences[i]);
+			fences[i] = nullptr;
+		}
+	}
+
+	if (buffer != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+
+	mapped = nullptr;
+	region_size = 0;
+	used = 0;
+}
+
+void GpuRingBuffer::BeginFrame()
+{
+	used = 0;
+
+	GLsync& fence = fences[region];
+	if (fence == nullptr)
+	{
+		return;
+	}
+
+	//Most frames the fence is long signaled, only count the ones that really wait
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		num_waits++;
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GPU_RING_WAIT_NS);
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void GpuRingBuffer::EndFrame()
+{
+	if (buffer == 0)
+	{
+		return;
+	}
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % GPU_RING_REGIONS;
+}
+
+char* GpuRingBuffer::Allocate(uint size, uint alignment, uint& offset)
+{
+	uint start = (used + alignment - 1) / alignment * alignment;
+	if (mapped == nullptr || start + size > region_size)
+	{
+		return nullptr;
+	}
+
+	used = start + size;
+	offset = region * region_size + start;
+	return mapped + offset;
+}
+
+bool GpuRingBuffer::Grow(uint region_size)
+{
+	LOG("Ring buffer grows to %d bytes per frame", region_size);
+	return Create(region_size);
+}
+
+uint GpuRingBuffer::GetBuffer() const
+{
+	return buffer;
+}
+
+uint GpuRingBuffer::GetRegionSize() const
+{
+	return region_size;
+}
+
+uint GpuRingBuffer::GetUsed() const
+{
+	return used;
+}
+
+uint GpuRingBuffer::GetNumWaits() const
+{
+	return num_waits;
+}
@@ -0,0 +1,45 @@
+#ifndef __GPURINGBUFFER_H__
+#define __GPURINGBUFFER_H__
+
+#include "Globals.h"
+
+#define GPU_RING_REGIONS 3		// Frames the GPU can be behind before the CPU waits
+
+typedef struct __GLsync* GLsync;
+
+// One buffer mapped once for the whole run (persistent and coherent), split in
+// a region per frame in flight. The CPU writes a frame in its region while the
+// GPU reads the ones before, a fence per region says when it can be reused.
+// Needs GL 4.4 or ARB_buffer_storage
+class GpuRingBuffer
+{
+public:
+	GpuRingBuffer();
+	~GpuRingBuffer();
+
+	bool Create(uint region_size);
+	void Destroy();
+
+	void BeginFrame();		// Waits until the GPU is done with the region coming up
+	void EndFrame();		// Fences what was written this frame
+
+	// Pointer to write into and its offset in the buffer, nullptr when the region is full
+	char* Allocate(uint size, uint alignment, uint& offset);
+	bool Grow(uint region_size);		// Waits for the GPU, what was allocated this frame is lost
+
+	uint GetBuffer() const;
+	uint GetRegionSize() const;
+	uint GetUsed() const;		// This frame, bytes
+	uint GetNumWaits() const;		// Frames that found their region still in use
+
+private:
+	uint buffer = 0;
+	char* mapped = nullptr;
+	uint region_size = 0;
+	uint region = 0;
+	uint used = 0;
+	GLsync fences[GPU_RING_REGIONS];
+	uint num_waits = 0;
+};
+
+#endif // !__GPURINGBUFFER_H__
@@ -0,0 +1,66 @@
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HASH_SEED 0x9E3779B97F4A7C15ULL
+
+// 64 bit content hash (reads 8 bytes per step, murmur style mixing)
+inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = HASH_SEED)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	uint64_t h = seed ^ (size * m);
+
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t blocks = size / 8;
+
+	for (size_t i = 0; i < blocks; i++)
+	{
+		uint64_t k;
+		memcpy(&k, bytes + i * 8, sizeof(k));
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	const unsigned char* tail = bytes + blocks * 8;
+	switch (size & 7)
+	{
+	case 7: h ^= uint64_t(tail[6]) << 48;
+	case 6: h ^= uint64_t(tail[5]) << 40;
+	case 5: h ^= uint64_t(tail[4]) << 32;
+	case 4: h ^= uint64_t(tail[3]) << 24;
+	case 3: h ^= uint64_t(tail[2]) << 16;
+	case 2: h ^= uint64_t(tail[1]) << 8;
+	case 1: h ^= uint64_t(tail[0]);
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
+// Json numbers are doubles, 64 bit values are stored as hex strings
+inline void HashToString(uint64_t hash, char out[17])
+{
+	sprintf_s(out, 17, "%016llx", (unsigned long long)hash);
+}
+
+inline uint64_t StringToHash(const char* str)
+{
+	return (str != nullptr) ? strtoull(str, nullptr, 16) : 0;
+}
+
+#endif // !__HASH_H__
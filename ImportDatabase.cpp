@@ -0,0 +1,112 @@
+#include "Application.h"
+#include "ImportDatabase.h"
+#include "Hash.h"
+#include "JSON.h"
+
+using namespace std;
+
+bool ImportDatabase::Load(const char* file)
+{
+	records.clear();
+
+	char* buff = nullptr;
+	if (App->fs->Exists(file) == false || App->fs->Load(file, &buff) == 0)
+	{
+		return false;
+	}
+
+	Json data(buff);
+	delete[] buff;
+
+	int num_records = (int)data.GetArraySize("Assets");
+	for (int i = 0; i < num_records; i++)
+	{
+		Json record_data = data.GetArray("Assets", i);
+
+		const char* source = record_data.GetString("Source");
+		if (source == nullptr)
+		{
+			continue;
+		}
+
+		ImportRecord& record = records[source];
+		record.hash = StringToHash(record_data.GetString("Hash"));
+		record.settings = StringToHash(record_data.GetString("Settings"));
+
+		int num_artifacts = (int)record_data.GetArraySize("Artifacts");
+		for (int j = 0; j < num_artifacts; j++)
+		{
+			Json artifact_data = record_data.GetArray("Artifacts", j);
+			const char* artifact_file = artifact_data.GetString("File");
+			if (artifact_file != nullptr)
+			{
+				record.artifacts[artifact_file].hash = StringToHash(artifact_data.GetString("Hash"));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool ImportDatabase::Save(const char* file) const
+{
+	Json data;
+	data.AddArray("Assets");
+
+	char hash[17];
+
+	unordered_map<string, ImportRecord>::const_iterator it = records.begin();
+	while (it != records.end())
+	{
+		Json record_data;
+		record_data.AddString("Source", it->first.data());
+		HashToString(it->second.hash, hash);
+		record_data.AddString("Hash", hash);
+		HashToString(it->second.settings, hash);
+		record_data.AddString("Settings", hash);
+		record_data.AddArray("Artifacts");
+
+		unordered_map<string, ImportArtifact>::const_iterator it2 = it->second.artifacts.begin();
+		while (it2 != it->second.artifacts.end())
+		{
+			Json artifact_data;
+			artifact_data.AddString("File", it2->first.data());
+			HashToString(it2->second.hash, hash);
+			artifact_data.AddString("Hash", hash);
+
+			record_data.AddArrayData(artifact_data);
+			++it2;
+		}
+
+		data.AddArrayData(record_data);
+		++it;
+	}
+
+	char* buff;
+	size_t size = data.Save(&buff);
+	bool ret = App->fs->Save(file, buff, size) > 0;
+	delete[] buff;
+
+	return ret;
+}
+
+const ImportRecord* ImportDatabase::Find(const char* source) const
+{
+	unordered_map<string, ImportRecord>::const_iterator it = records.find(source);
+	if (it != records.end())
+	{
+		return &it->second;
+	}
+	return nullptr;
+}
+
+ImportRecord& ImportDatabase::Get(const char* source)
+{
+	return records[source];
+}
+
+bool ImportDatabase::IsUpToDate(const char* source, uint64_t hash, uint64_t settings) const
+{
+	const ImportRecord* record = Find(source);
+	return record != nullptr && record->hash == hash && record->settings == settings;
+}
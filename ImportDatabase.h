@@ -0,0 +1,37 @@
+#ifndef __IMPORTDATABASE_H__
+#define __IMPORTDATABASE_H__
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+// File generated in the Library from a source asset
+struct ImportArtifact
+{
+	uint64_t hash = 0;			// Hash of the data the file was generated from
+};
+
+struct ImportRecord
+{
+	uint64_t hash = 0;			// Hash of the whole source file
+	uint64_t settings = 0;		// Hash of the import settings used
+	std::unordered_map<std::string, ImportArtifact> artifacts;		// Library file -> artifact
+};
+
+// Remembers what was imported from every source asset so unchanged
+// assets (or parts of them) are not imported again
+class ImportDatabase
+{
+public:
+	bool Load(const char* file);
+	bool Save(const char* file) const;
+
+	const ImportRecord* Find(const char* source) const;
+	ImportRecord& Get(const char* source);
+	bool IsUpToDate(const char* source, uint64_t hash, uint64_t settings) const;
+
+private:
+	std::unordered_map<std::string, ImportRecord> records;
+};
+
+#endif // !__IMPORTDATABASE_H__
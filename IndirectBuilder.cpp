@@ -0,0 +1,120 @@
+#include "IndirectBuilder.h"
+#include "RenderQueue.h"
+#include "ModuleMesh.h"
+#include "JobSystem.h"
+#include <xmmintrin.h>
+
+#define INDIRECT_PREFETCH 8		// Packets ahead, they're read in key order and not where they are in memory
+
+uint IndirectBuilder::Prepare(const RenderQueue& queue)
+{
+	batches.clear();
+	missing.clear();
+	num_commands = queue.GetNumPackets();
+
+	//A command per packet in key order, the batches only cut it where the state changes
+	uint pass = 0;
+	for (uint i = 0; i < num_commands; i++)
+	{
+		const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(i));
+		if (batches.empty() || packet.pass != pass || packet.shader != batches.back().shader || packet.texture != batches.back().texture)
+		{
+			IndirectBatch batch;
+			batch.shader = packet.shader;
+			batch.texture = packet.texture;
+			batch.first_command = i;
+			batches.push_back(batch);
+			pass = packet.pass;
+		}
+		batches.back().num_commands++;
+
+		if (packet.mesh->arena_vertex < 0)
+		{
+			missing.push_back(i);
+		}
+	}
+
+	return num_commands;
+}
+
+void IndirectBuilder::Write(const RenderQueue& queue, DrawElementsIndirectCommand* commands, float4x4* transforms, uint base_instance, JobSystem* jobs) const
+{
+	if (jobs == nullptr || jobs->GetNumWorkers() == 0 || num_commands <= INDIRECT_CHUNK)
+	{
+		WriteRange(queue, 0, num_commands, commands, transforms, base_instance);
+		return;
+	}
+
+	//Every chunk writes its own slots, nothing to merge afterwards
+	JobCounter counter;
+	for (uint begin = 0; begin < num_commands; begin += INDIRECT_CHUNK)
+	{
+		uint end = (begin + INDIRECT_CHUNK < num_commands) ? begin + INDIRECT_CHUNK : num_commands;
+		jobs->Schedule([this, &queue, begin, end, commands, transforms, base_instance]()
+		{
+			WriteRange(queue, begin, end, commands, transforms, base_instance);
+		}, &counter, true);
+	}
+	jobs->Wait(counter);
+}
+
+const std::vector<IndirectBatch>& IndirectBuilder::GetBatches() const
+{
+	return batches;
+}
+
+const std::vector<uint>& IndirectBuilder::GetMissing() const
+{
+	return missing;
+}
+
+uint IndirectBuilder::GetNumCommands() const
+{
+	return num_commands;
+}
+
+void IndirectBuilder::WriteRange(const RenderQueue& queue, uint begin, uint end, DrawElementsIndirectCommand* commands, float4x4* transforms, uint base_instance) const
+{
+	for (uint i = begin; i < end; i++)
+	{
+		if (i + INDIRECT_PREFETCH < end)
+		{
+			const char* ahead = (const char*)&queue.GetPacket(queue.GetSortedPacket(i + INDIRECT_PREFETCH));
+			_mm_prefetch(ahead, _MM_HINT_T0);
+			_mm_prefetch(ahead + 64, _MM_HINT_T0);
+			_mm_prefetch(ahead + sizeof(DrawPacket) - 1, _MM_HINT_T0);
+		}
+
+		const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(i));
+		const Mesh& m = *packet.mesh;
+		const MeshLod& level = m.lods[packet.lod];
+
+		//Meshes out of the arena draw nothing here, the renderer draws them from their own buffers
+		bool resident = (m.arena_vertex >= 0);
+		DrawElementsIndirectCommand command;
+		command.count = resident ? level.num_indices : 0;
+		command.instance_count = resident ? 1 : 0;
+		command.first_index = m.arena_index + level.first_index;
+		command.base_vertex = m.arena_vertex;
+		command.base_instance = base_instance + i;
+		commands[i] = command;
+
+		//transform * translate(center) * scale(extents), the shader takes the snorm16 positions as they are.
+		//A column per register, as GL reads the matrix
+		const float* in = packet.transform.v[0];
+		__m128 column_x = _mm_loadu_ps(in);
+		__m128 column_y = _mm_loadu_ps(in + 4);
+		__m128 column_z = _mm_loadu_ps(in + 8);
+		__m128 column_w = _mm_loadu_ps(in + 12);
+
+		column_w = _mm_add_ps(column_w, _mm_mul_ps(column_x, _mm_set1_ps(m.arena_center.x)));
+		column_w = _mm_add_ps(column_w, _mm_mul_ps(column_y, _mm_set1_ps(m.arena_center.y)));
+		column_w = _mm_add_ps(column_w, _mm_mul_ps(column_z, _mm_set1_ps(m.arena_center.z)));
+
+		float* out = transforms[i].v[0];
+		_mm_storeu_ps(out, _mm_mul_ps(column_x, _mm_set1_ps(m.arena_scale.x)));
+		_mm_storeu_ps(out + 4, _mm_mul_ps(column_y, _mm_set1_ps(m.arena_scale.y)));
+		_mm_storeu_ps(out + 8, _mm_mul_ps(column_z, _mm_set1_ps(m.arena_scale.z)));
+		_mm_storeu_ps(out + 12, column_w);
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef __INDIRECTBUILDER_H__
+#define __INDIRECTBUILDER_H__
+
+#include "Globals.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <vector>
+
+#define INDIRECT_CHUNK 1024		// Packets written by one job
+
+class RenderQueue;
+class JobSystem;
+
+// One draw of glMultiDrawElementsIndirect, laid out as GL reads it
+struct DrawElementsIndirectCommand
+{
+	uint count = 0;
+	uint instance_count = 0;
+	uint first_index = 0;
+	int base_vertex = 0;
+	uint base_instance = 0;
+};
+
+// Commands in a row with the same pass, shader and texture, one multi draw
+struct IndirectBatch
+{
+	uint shader = 0;
+	uint texture = 0;
+	uint first_command = 0;
+	uint num_commands = 0;
+};
+
+// Turns the sorted render queue, what culling left visible, into indirect
+// commands over the mesh arena plus the transform every command reads with
+// its base instance. The dequantization of the mesh is folded in the
+// transform so no uniform changes between the draws of a batch. Finding the
+// batches is a pass over the packets, the commands and transforms are written
+// in chunks on the job system straight where the GPU reads them.
+// No GL in here, it runs the same without a context
+class IndirectBuilder
+{
+public:
+	uint Prepare(const RenderQueue& queue);		// Batches of the sorted queue, returns the commands Write needs room for
+
+	// Command i goes with transforms[i] and reads it as base_instance + i
+	void Write(const RenderQueue& queue, DrawElementsIndirectCommand* commands, float4x4* transforms, uint base_instance, JobSystem* jobs) const;
+
+	const std::vector<IndirectBatch>& GetBatches() const;
+	const std::vector<uint>& GetMissing() const;		// Commands of meshes out of the arena, written empty to draw apart
+	uint GetNumCommands() const;
+
+private:
+	void WriteRange(const RenderQueue& queue, uint begin, uint end, DrawElementsIndirectCommand* commands, float4x4* transforms, uint base_instance) const;
+
+private:
+	std::vector<IndirectBatch> batches;
+	std::vector<uint> missing;
+	uint num_commands = 0;
+};
+
+#endif // !__INDIRECTBUILDER_H__
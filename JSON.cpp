@@ -123,6 +123,12 @@ bool Json::GetBool(const char * field) const
 	return json_object_get_boolean(this->json_object, field);
 }
 
+bool Json::GetBool(const char * field, bool default_value) const
+{
+	int value = json_object_get_boolean(this->json_object, field);
+	return (value < 0) ? default_value : (value != 0);
+}
+
 float Json::GetFloat(const char * field) const
 {
 	return (float) json_object_get_number(this->json_object,field);
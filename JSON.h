@@ -35,6 +35,7 @@ public:
 	const char* GetString(const char* field) const;
 	int GetInt(const char* field) const;
 	bool GetBool(const char* field) const;
+	bool GetBool(const char* field, bool default_value) const;		// When the field isn't there
 	float GetFloat(const char* field) const;
 	float3 GetFloat3(const char* field) const;
 	float4x4 GetMatrix(const char*field) const;
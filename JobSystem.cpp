@@ -0,0 +1,228 @@
+#include "JobSystem.h"
+
+//Which worker of which system is running on this thread, none on the others
+static thread_local JobSystem* current_system = nullptr;
+static thread_local uint current_worker = 0;
+
+JobSystem::JobSystem(int num_workers) : num_queued(0)
+{
+	if (num_workers < 0)
+	{
+		uint cores = std::thread::hardware_concurrency();
+		num_workers = (cores > 1) ? cores - 1 : 1;
+	}
+
+	for (int i = 0; i < num_workers; i++)
+	{
+		queues.push_back(new JobQueue());
+	}
+
+	for (int i = 0; i < num_workers; i++)
+	{
+		workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		running = false;
+	}
+	jobs_available.notify_all();
+
+	std::vector<std::thread>::iterator it = workers.begin();
+	while (it != workers.end())
+	{
+		(*it).join();
+		++it;
+	}
+	workers.clear();
+
+	//Without workers nobody ran what's left
+	Job job;
+	while (PopJob(job, true))
+	{
+		RunJob(job);
+	}
+
+	std::vector<JobQueue*>::iterator queue = queues.begin();
+	while (queue != queues.end())
+	{
+		delete (*queue);
+		++queue;
+	}
+	queues.clear();
+}
+
+void JobSystem::Schedule(const std::function<void()>& task, JobCounter* counter, bool urgent)
+{
+	Job job;
+	job.task = task;
+	job.counter = counter;
+
+	if (counter != nullptr)
+	{
+		counter->pending++;
+	}
+
+	//Workers keep what they spawn, it's likely to use what they just touched.
+	//They take their newest job first, so only the shared queue needs the urgent ones in front
+	JobQueue& queue = (current_system == this) ? *queues[current_worker] : shared;
+	Push(queue, job, urgent && &queue == &shared);
+}
+
+void JobSystem::ScheduleBackground(const std::function<void()>& task, JobCounter* counter)
+{
+	Job job;
+	job.task = task;
+	job.counter = counter;
+
+	if (counter != nullptr)
+	{
+		counter->pending++;
+	}
+
+	Push(background, job, false);
+}
+
+void JobSystem::Wait(JobCounter& counter, bool with_background)
+{
+	while (counter.pending > 0)
+	{
+		if (RunPendingJob(with_background) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::RunPendingJob(bool with_background)
+{
+	Job job;
+	if (PopJob(job, with_background))
+	{
+		RunJob(job);
+		return true;
+	}
+	return false;
+}
+
+uint JobSystem::GetNumWorkers() const
+{
+	return workers.size();
+}
+
+void JobSystem::Push(JobQueue& queue, const Job& job, bool front)
+{
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (front)
+		{
+			queue.jobs.push_front(job);
+		}
+		else
+		{
+			queue.jobs.push_back(job);
+		}
+	}
+	num_queued++;
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	jobs_available.notify_one();
+}
+
+bool JobSystem::PopJob(Job& job, bool with_background)
+{
+	uint first = 0;
+
+	//Own queue from the back, the newest job
+	if (current_system == this)
+	{
+		JobQueue& own = *queues[current_worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.jobs.empty() == false)
+		{
+			job = own.jobs.back();
+			own.jobs.pop_back();
+			num_queued--;
+			return true;
+		}
+		first = current_worker + 1;
+	}
+
+	if (PopFront(shared, job))
+	{
+		return true;
+	}
+
+	//Steal the oldest job of the others, starting by the next worker
+	for (uint i = 0; i < queues.size(); i++)
+	{
+		if (PopFront(*queues[(first + i) % queues.size()], job))
+		{
+			return true;
+		}
+	}
+
+	//Loads last, and only for the worker loop or whoever waits for them
+	if (with_background && PopFront(background, job))
+	{
+		return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::PopFront(JobQueue& queue, Job& job)
+{
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+	{
+		return false;
+	}
+
+	job = queue.jobs.front();
+	queue.jobs.pop_front();
+	num_queued--;
+	return true;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+	job.task();
+
+	if (job.counter != nullptr)
+	{
+		job.counter->pending--;
+	}
+}
+
+void JobSystem::WorkerLoop(uint index)
+{
+	current_system = this;
+	current_worker = index;
+
+	while (true)
+	{
+		Job job;
+		if (PopJob(job, true))
+		{
+			RunJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		while (running && num_queued <= 0)
+		{
+			jobs_available.wait(lock);
+		}
+
+		if (running == false && num_queued <= 0)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#ifndef __JOBSYSTEM_H__
+#define __JOBSYSTEM_H__
+
+#include "Globals.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define JOB_WORKERS_AUTO -1		// One worker per core, minus the main thread
+
+// Jobs scheduled with the same counter can be waited together
+struct JobCounter
+{
+	JobCounter() : pending(0) {}
+
+	std::atomic<int> pending;
+};
+
+// Work stealing pool. Every worker has its own queue: jobs scheduled from a
+// worker go there and it takes the newest first, idle workers steal the oldest
+// from the others. Jobs from any other thread go to a shared queue. Background
+// jobs (streaming loads) have their own queue that only the workers take from
+// when they have nothing else, or whoever waits for them
+class JobSystem
+{
+public:
+	// 0 workers runs every job on the threads that wait for them
+	JobSystem(int num_workers = JOB_WORKERS_AUTO);
+	~JobSystem();
+
+	// Urgent jobs go before whatever is queued, i.e. the frame before the loads
+	void Schedule(const std::function<void()>& task, JobCounter* counter = nullptr, bool urgent = false);
+	void ScheduleBackground(const std::function<void()>& task, JobCounter* counter = nullptr);
+
+	// The calling thread runs pending jobs until the counter reaches zero. Background
+	// jobs only when asked, a frame waiting for its own jobs can't end up loading a texture
+	void Wait(JobCounter& counter, bool with_background = false);
+	bool RunPendingJob(bool with_background = false);		// One job on the calling thread, false if there was none
+
+	uint GetNumWorkers() const;
+
+private:
+	struct Job
+	{
+		std::function<void()> task;
+		JobCounter* counter = nullptr;
+	};
+
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void Push(JobQueue& queue, const Job& job, bool front);
+	bool PopJob(Job& job, bool with_background);
+	bool PopFront(JobQueue& queue, Job& job);
+	void RunJob(Job& job);
+	void WorkerLoop(uint index);
+
+private:
+	std::vector<std::thread> workers;
+	std::vector<JobQueue*> queues;		// One per worker
+	JobQueue shared;
+	JobQueue background;
+	std::atomic<int> num_queued;
+
+	std::mutex sleep_mutex;
+	std::condition_variable jobs_available;
+	bool running = true;
+};
+
+#endif // !__JOBSYSTEM_H__
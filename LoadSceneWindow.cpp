@@ -38,14 +38,26 @@ void LoadSceneWindow::Render()
 	vector<string>::iterator it = saved_files.begin();
 	while (it != saved_files.end())
 	{
+		string library = LIBRARY_DIRECTORY;
+		save_directory = SAVE_DIRECTORY;
+		library.append(save_directory.data());
+		library.append((*it).data());
+
+		//Convert writes the .json of a .scn or the .scn of a .json next to it
+		ImGui::PushID((*it).data());
+		bool convert = ImGui::SmallButton("Convert");
+		ImGui::PopID();
+		ImGui::SameLine();
+		if (convert)
+		{
+			App->go_manager->ConvertScene(library.data());
+			found_files = false;
+			break;
+		}
+
 		ImGui::Selectable((*it).data());
 		if (ImGui::IsItemClicked())
 		{
-			string library = LIBRARY_DIRECTORY;
-			save_directory = SAVE_DIRECTORY;
-			library.append(save_directory.data());
-			library.append((*it).data());
-
 			App->go_manager->LoadScene(library.data());
 
 			found_files = false;
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include "Application.h"
 #include "Globals.h"
 #include "MemLeaks.h"
@@ -27,6 +28,22 @@ int main(int argc, char ** argv)
 	int main_return = EXIT_FAILURE;
 	main_states state = MAIN_CREATION;
 
+	//-benchmark: hidden window, frame throughput with 1 to 8 cores and out
+	//-fixed: render with the fixed pipeline even if the GL has a core profile
+	bool benchmark = false;
+	bool fixed_pipeline = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-benchmark") == 0)
+		{
+			benchmark = true;
+		}
+		else if (strcmp(argv[i], "-fixed") == 0)
+		{
+			fixed_pipeline = true;
+		}
+	}
+
 	while (state != MAIN_EXIT)
 	{
 		switch (state)
@@ -35,6 +52,8 @@ int main(int argc, char ** argv)
 
 			LOG("-------------- Application Creation --------------");
 			App = new Application();
+			App->headless = benchmark;
+			App->fixed_pipeline = fixed_pipeline;
 			state = MAIN_START;
 			break;
 
@@ -56,7 +75,12 @@ int main(int argc, char ** argv)
 
 		case MAIN_UPDATE:
 		{
-			int update_return = App->Update();
+			int update_return = (benchmark) ? App->Benchmark() : App->Update();
+
+			if (benchmark && update_return == UPDATE_CONTINUE)
+			{
+				update_return = UPDATE_STOP;
+			}
 
 			if (update_return == UPDATE_ERROR)
 			{
@@ -0,0 +1,246 @@
+#include "MeshArena.h"
+#include "ModuleMesh.h"
+#include "Glew\include\glew.h"
+#include <vector>
+
+void ArenaAllocator::Reset(uint capacity)
+{
+	free_ranges.clear();
+	this->capacity = 0;
+	used = 0;
+	Grow(capacity);
+}
+
+bool ArenaAllocator::Allocate(uint size, uint& offset)
+{
+	for (std::map<uint, uint>::iterator it = free_ranges.begin(); it != free_ranges.end(); ++it)
+	{
+		if (it->second < size)
+		{
+			continue;
+		}
+
+		//What's left of the range stays free after the allocation
+		offset = it->first;
+		uint left = it->second - size;
+		free_ranges.erase(it);
+		if (left > 0)
+		{
+			free_ranges[offset + size] = left;
+		}
+		used += size;
+		return true;
+	}
+	return false;
+}
+
+void ArenaAllocator::Free(uint offset, uint size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	used -= size;
+
+	std::map<uint, uint>::iterator next = free_ranges.lower_bound(offset);
+	if (next != free_ranges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		next = free_ranges.erase(next);
+	}
+
+	if (next != free_ranges.begin())
+	{
+		std::map<uint, uint>::iterator previous = next;
+		--previous;
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += size;
+			return;
+		}
+	}
+	free_ranges[offset] = size;
+}
+
+void ArenaAllocator::Grow(uint capacity)
+{
+	if (capacity <= this->capacity)
+	{
+		return;
+	}
+
+	//Counted as used so Free can merge it with the range before
+	used += capacity - this->capacity;
+	uint start = this->capacity;
+	this->capacity = capacity;
+	Free(start, capacity - start);
+}
+
+uint ArenaAllocator::GetCapacity() const
+{
+	return capacity;
+}
+
+uint ArenaAllocator::GetUsed() const
+{
+	return used;
+}
+
+MeshArena::MeshArena()
+{}
+
+MeshArena::~MeshArena()
+{
+	Destroy();
+}
+
+bool MeshArena::Create(uint num_vertices, uint num_indices)
+{
+	Destroy();
+
+	glGenBuffers(1, &vertex_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, num_vertices * sizeof(RenderVertex), nullptr, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &index_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, num_indices * sizeof(uint), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	vertex_space.Reset(num_vertices);
+	index_space.Reset(num_indices);
+	return true;
+}
+
+void MeshArena::Destroy()
+{
+	if (vertex_buffer != 0)
+	{
+		glDeleteBuffers(1, &vertex_buffer);
+		glDeleteBuffers(1, &index_buffer);
+		vertex_buffer = 0;
+		index_buffer = 0;
+	}
+
+	vertex_space.Reset(0);
+	index_space.Reset(0);
+	num_meshes = 0;
+}
+
+bool MeshArena::IsCreated() const
+{
+	return vertex_buffer != 0;
+}
+
+bool MeshArena::Add(Mesh* mesh, const RenderVertex* vertices)
+{
+	if (IsCreated() == false || mesh->arena_vertex >= 0)
+	{
+		return false;
+	}
+
+	uint num_indices = mesh->GetTotalIndices();
+	uint first_vertex = 0;
+	uint first_index = 0;
+	if (Reserve(vertex_space, vertex_buffer, sizeof(RenderVertex), mesh->num_vertices, first_vertex) == false)
+	{
+		return false;
+	}
+	if (Reserve(index_space, index_buffer, sizeof(uint), num_indices, first_index) == false)
+	{
+		vertex_space.Free(first_vertex, mesh->num_vertices);
+		return false;
+	}
+
+	//The copy targets, binding the element array would change the VAO bound
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, first_vertex * sizeof(RenderVertex), mesh->num_vertices * sizeof(RenderVertex), vertices);
+
+	std::vector<uint> indices(num_indices);
+	for (uint i = 0; i < num_indices; i++)
+	{
+		indices[i] = mesh->GetIndex(i);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, first_index * sizeof(uint), num_indices * sizeof(uint), indices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	mesh->arena_vertex = first_vertex;
+	mesh->arena_index = first_index;
+	mesh->arena_center = mesh->bounds.CenterPoint();
+	mesh->arena_scale = QuantizationExtents(mesh->bounds) / SNORM16_MAX;
+	num_meshes++;
+	return true;
+}
+
+void MeshArena::Remove(Mesh* mesh)
+{
+	//The arena may be gone already, the renderer cleans up before the meshes
+	if (mesh->arena_vertex < 0)
+	{
+		return;
+	}
+
+	if (IsCreated())
+	{
+		vertex_space.Free(mesh->arena_vertex, mesh->num_vertices);
+		index_space.Free(mesh->arena_index, mesh->GetTotalIndices());
+		num_meshes--;
+	}
+	mesh->arena_vertex = -1;
+	mesh->arena_index = 0;
+	mesh->arena_center = float3::zero;
+	mesh->arena_scale = float3::one;
+}
+
+uint MeshArena::GetVertexBuffer() const
+{
+	return vertex_buffer;
+}
+
+uint MeshArena::GetIndexBuffer() const
+{
+	return index_buffer;
+}
+
+uint MeshArena::GetNumMeshes() const
+{
+	return num_meshes;
+}
+
+uint MeshArena::GetUsedBytes() const
+{
+	return vertex_space.GetUsed() * sizeof(RenderVertex) + index_space.GetUsed() * sizeof(uint);
+}
+
+bool MeshArena::Reserve(ArenaAllocator& space, uint& buffer, uint element_size, uint size, uint& offset)
+{
+	if (space.Allocate(size, offset))
+	{
+		return true;
+	}
+
+	//A bigger buffer with the old contents copied in, the GPU does the copy.
+	//The new space alone has to fit it, the free ranges before may be scattered
+	uint old_capacity = space.GetCapacity();
+	uint capacity = (old_capacity > 0) ? old_capacity * 2 : size;
+	while (capacity - old_capacity < size)
+	{
+		capacity *= 2;
+	}
+
+	uint grown = 0;
+	glGenBuffers(1, &grown);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity * element_size, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_capacity * element_size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	LOG("Mesh arena grows to %d elements of %d bytes", capacity, element_size);
+	glDeleteBuffers(1, &buffer);
+	buffer = grown;
+	space.Grow(capacity);
+	return space.Allocate(size, offset);
+}
@@ -0,0 +1,66 @@
+#ifndef __MESHARENA_H__
+#define __MESHARENA_H__
+
+#include "Globals.h"
+#include <map>
+
+#define MESH_ARENA_VERTICES (1 << 20)		// To start with, the buffers double when they're full
+#define MESH_ARENA_INDICES (3 << 20)
+
+struct Mesh;
+struct RenderVertex;
+
+// Free ranges of a buffer counted in elements, first fit. Freed ranges are
+// merged with their neighbours so the space doesn't break up in pieces
+class ArenaAllocator
+{
+public:
+	void Reset(uint capacity);
+	bool Allocate(uint size, uint& offset);
+	void Free(uint offset, uint size);
+	void Grow(uint capacity);		// The new space is free, what's allocated stays
+
+	uint GetCapacity() const;
+	uint GetUsed() const;
+
+private:
+	std::map<uint, uint> free_ranges;		// Offset -> size
+	uint capacity = 0;
+	uint used = 0;
+};
+
+// Vertices and indices of every loaded mesh in one buffer each, so a single
+// VAO draws them all and one multi draw indirect call covers any number of
+// meshes. Indices are widened to 32 bits, the draws find the vertices of their
+// mesh with the base vertex. The meshes keep their own buffers too, the fixed
+// pipeline and the draws that can't go indirect use those
+class MeshArena
+{
+public:
+	MeshArena();
+	~MeshArena();
+
+	bool Create(uint num_vertices, uint num_indices);
+	void Destroy();
+	bool IsCreated() const;
+
+	bool Add(Mesh* mesh, const RenderVertex* vertices);		// Sets mesh->arena_vertex and arena_index
+	void Remove(Mesh* mesh);
+
+	uint GetVertexBuffer() const;
+	uint GetIndexBuffer() const;
+	uint GetNumMeshes() const;
+	uint GetUsedBytes() const;
+
+private:
+	bool Reserve(ArenaAllocator& space, uint& buffer, uint element_size, uint size, uint& offset);
+
+private:
+	uint vertex_buffer = 0;
+	uint index_buffer = 0;
+	ArenaAllocator vertex_space;
+	ArenaAllocator index_space;
+	uint num_meshes = 0;
+};
+
+#endif // !__MESHARENA_H__
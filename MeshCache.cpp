@@ -0,0 +1,135 @@
+#include "MeshCache.h"
+#include "ModuleMesh.h"
+
+MeshCache::MeshCache(const LoadFunction& load, const FreeFunction& free) : load_mesh(load), free_mesh(free)
+{}
+
+MeshCache::~MeshCache()
+{
+	Clear();
+}
+
+Mesh* MeshCache::Acquire(const char* path)
+{
+	if (path == nullptr)
+	{
+		return nullptr;
+	}
+
+	std::unordered_map<std::string, Entry>::iterator it = entries.find(path);
+	if (it != entries.end())
+	{
+		it->second.references++;
+		hits++;
+		return it->second.mesh;
+	}
+
+	misses++;
+	Mesh* mesh = load_mesh(path);
+	if (mesh == nullptr)
+	{
+		return nullptr;
+	}
+
+	Entry& entry = entries[path];
+	entry.mesh = mesh;
+	entry.references = 1;
+	entry.bytes = mesh->IsReady() ? MeshBytes(mesh) : 0;
+	paths[mesh] = path;
+	resident_bytes += entry.bytes;
+
+	return mesh;
+}
+
+void MeshCache::AddReference(Mesh* mesh)
+{
+	std::unordered_map<const Mesh*, std::string>::const_iterator path = paths.find(mesh);
+	if (path != paths.end())
+	{
+		entries[path->second].references++;
+	}
+}
+
+void MeshCache::UpdateBytes(const Mesh* mesh)
+{
+	std::unordered_map<const Mesh*, std::string>::const_iterator path = paths.find(mesh);
+	if (path != paths.end())
+	{
+		Entry& entry = entries[path->second];
+		resident_bytes -= entry.bytes;
+		entry.bytes = MeshBytes(mesh);
+		resident_bytes += entry.bytes;
+	}
+}
+
+void MeshCache::Release(Mesh* mesh)
+{
+	//Meshes the cache doesn't know (already cleared) are ignored, never read
+	std::unordered_map<const Mesh*, std::string>::iterator path = paths.find(mesh);
+	if (path == paths.end())
+	{
+		return;
+	}
+
+	std::unordered_map<std::string, Entry>::iterator it = entries.find(path->second);
+	if (--it->second.references == 0)
+	{
+		resident_bytes -= it->second.bytes;
+		evicted++;
+		free_mesh(it->second.mesh);
+
+		entries.erase(it);
+		paths.erase(path);
+	}
+}
+
+void MeshCache::Clear()
+{
+	std::unordered_map<std::string, Entry>::iterator it = entries.begin();
+	while (it != entries.end())
+	{
+		free_mesh(it->second.mesh);
+		++it;
+	}
+
+	entries.clear();
+	paths.clear();
+	resident_bytes = 0;
+}
+
+uint MeshCache::GetReferences(const char* path) const
+{
+	std::unordered_map<std::string, Entry>::const_iterator it = entries.find(path);
+	return (it != entries.end()) ? it->second.references : 0;
+}
+
+uint MeshCache::GetNumResident() const
+{
+	return entries.size();
+}
+
+uint MeshCache::GetResidentBytes() const
+{
+	return resident_bytes;
+}
+
+uint MeshCache::GetHits() const
+{
+	return hits;
+}
+
+uint MeshCache::GetMisses() const
+{
+	return misses;
+}
+
+uint MeshCache::GetNumEvicted() const
+{
+	return evicted;
+}
+
+uint MeshCache::MeshBytes(const Mesh* mesh)
+{
+	uint index_bytes = mesh->index_size * mesh->GetTotalIndices();
+	return mesh->num_vertices * (sizeof(PackedVertex) + sizeof(RenderVertex)) + index_bytes * 2;
+}
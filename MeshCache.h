@@ -0,0 +1,59 @@
+#ifndef __MESHCACHE_H__
+#define __MESHCACHE_H__
+
+#include "Globals.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+struct Mesh;
+
+// One Mesh per file, shared by every component that uses it. Acquire counts
+// a reference and only loads the file the first time, Release gives it back
+// and the mesh is freed when nobody uses it anymore
+class MeshCache
+{
+public:
+	typedef std::function<Mesh*(const char* path)> LoadFunction;
+	typedef std::function<void(Mesh* mesh)> FreeFunction;
+
+	MeshCache(const LoadFunction& load, const FreeFunction& free);
+	~MeshCache();
+
+	Mesh* Acquire(const char* path);		// nullptr if the load function gives nothing, it may still be streaming
+	void AddReference(Mesh* mesh);
+	void UpdateBytes(const Mesh* mesh);		// Streamed meshes have their size once they're loaded
+	void Release(Mesh* mesh);
+	void Clear();		// Frees every mesh, referenced or not
+
+	uint GetReferences(const char* path) const;
+	uint GetNumResident() const;
+	uint GetResidentBytes() const;
+	uint GetHits() const;
+	uint GetMisses() const;		// Loads that actually happened
+	uint GetNumEvicted() const;
+
+private:
+	struct Entry
+	{
+		Mesh* mesh = nullptr;
+		uint references = 0;
+		uint bytes = 0;
+	};
+
+	static uint MeshBytes(const Mesh* mesh);		// File data plus GPU buffers
+
+private:
+	LoadFunction load_mesh;
+	FreeFunction free_mesh;
+
+	std::unordered_map<std::string, Entry> entries;
+	std::unordered_map<const Mesh*, std::string> paths;
+
+	uint resident_bytes = 0;
+	uint hits = 0;
+	uint misses = 0;
+	uint evicted = 0;
+};
+
+#endif // !__MESHCACHE_H__
@@ -0,0 +1,445 @@
+#include "MeshOptimizer.h"
+#include "Hash.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#define INVALID_INDEX 0xffffffff
+
+//-- Analysis --------------------------------------
+
+float AnalyzeVertexCache(const uint* indices, uint num_indices, uint num_vertices, uint cache_size)
+{
+	if (num_indices < 3)
+	{
+		return 0.0f;
+	}
+
+	//FIFO cache simulated with timestamps, a vertex is in the cache while it's
+	//one of the last cache_size vertices transformed
+	std::vector<uint> cache_time(num_vertices, 0);
+	uint time = cache_size + 1;
+	uint misses = 0;
+
+	for (uint i = 0; i < num_indices; i++)
+	{
+		uint v = indices[i];
+		if (time - cache_time[v] > cache_size)
+		{
+			cache_time[v] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (float)(num_indices / 3);
+}
+
+//-- Vertex deduplication --------------------------
+
+uint GenerateVertexRemap(uint* remap, const uint* indices, uint num_indices, const void* vertices, uint num_vertices, uint vertex_size)
+{
+	const char* data = (const char*)vertices;
+
+	//Open addressing table of vertex indices, at most half full
+	uint table_size = 1;
+	while (table_size < num_vertices * 2)
+	{
+		table_size <<= 1;
+	}
+	std::vector<uint> table(table_size, INVALID_INDEX);
+
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		remap[i] = INVALID_INDEX;
+	}
+
+	//Only the referenced vertices are kept, in order of first use
+	uint unique = 0;
+	for (uint i = 0; i < num_indices; i++)
+	{
+		uint v = indices[i];
+		if (remap[v] != INVALID_INDEX)
+		{
+			continue;
+		}
+
+		const char* vertex = data + v * vertex_size;
+		uint slot = (uint)Hash64(vertex, vertex_size) & (table_size - 1);
+
+		while (table[slot] != INVALID_INDEX && memcmp(data + table[slot] * vertex_size, vertex, vertex_size) != 0)
+		{
+			slot = (slot + 1) & (table_size - 1);
+		}
+
+		if (table[slot] == INVALID_INDEX)
+		{
+			table[slot] = v;
+			remap[v] = unique++;
+		}
+		else
+		{
+			remap[v] = remap[table[slot]];
+		}
+	}
+
+	return unique;
+}
+
+void RemapIndexBuffer(uint* destination, const uint* indices, uint num_indices, const uint* remap)
+{
+	for (uint i = 0; i < num_indices; i++)
+	{
+		destination[i] = remap[indices[i]];
+	}
+}
+
+void RemapVertexBuffer(void* destination, const void* vertices, uint num_vertices, uint vertex_size, const uint* remap)
+{
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		if (remap[i] != INVALID_INDEX)
+		{
+			memcpy((char*)destination + remap[i] * vertex_size, (const char*)vertices + i * vertex_size, vertex_size);
+		}
+	}
+}
+
+//-- Vertex cache (Forsyth) ------------------------
+
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_MAX_VALENCE 32
+
+// Score of a vertex from its LRU position and the triangles that still use it
+static float ForsythVertexScore(int cache_position, uint remaining)
+{
+	if (remaining == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cache_position >= 0)
+	{
+		//The last triangle's vertices get a fixed score so the strip doesn't double back
+		if (cache_position < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score = pow(1.0f - (cache_position - 3) * scale, 1.5f);
+		}
+	}
+
+	//Boost vertices with few triangles left so they are finished and leave the cache
+	score += 2.0f / sqrt((float)Min(remaining, (uint)FORSYTH_MAX_VALENCE));
+
+	return score;
+}
+
+void OptimizeVertexCache(uint* destination, const uint* indices, uint num_indices, uint num_vertices)
+{
+	uint num_triangles = num_indices / 3;
+	if (num_triangles == 0)
+	{
+		return;
+	}
+
+	//Triangles of every vertex, remaining[v] of them are still to be emitted
+	std::vector<uint> remaining(num_vertices, 0);
+	for (uint i = 0; i < num_indices; i++)
+	{
+		remaining[indices[i]]++;
+	}
+
+	std::vector<uint> offsets(num_vertices, 0);
+	uint offset = 0;
+	for (uint v = 0; v < num_vertices; v++)
+	{
+		offsets[v] = offset;
+		offset += remaining[v];
+	}
+
+	std::vector<uint> adjacency(num_indices);
+	std::vector<uint> filled(num_vertices, 0);
+	for (uint i = 0; i < num_indices; i++)
+	{
+		uint v = indices[i];
+		adjacency[offsets[v] + filled[v]++] = i / 3;
+	}
+
+	std::vector<int> cache_position(num_vertices, -1);
+	std::vector<float> vertex_score(num_vertices);
+	for (uint v = 0; v < num_vertices; v++)
+	{
+		vertex_score[v] = ForsythVertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangle_score(num_triangles);
+	std::vector<bool> emitted(num_triangles, false);
+	uint best_triangle = 0;
+	for (uint t = 0; t < num_triangles; t++)
+	{
+		triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+		if (triangle_score[t] > triangle_score[best_triangle])
+		{
+			best_triangle = t;
+		}
+	}
+
+	uint cache[FORSYTH_CACHE_SIZE + 3];
+	uint cache_count = 0;
+	uint input_cursor = 0;
+
+	for (uint output = 0; output < num_triangles; output++)
+	{
+		//Nothing in the cache can continue, take the next triangle in input order
+		if (best_triangle == INVALID_INDEX)
+		{
+			while (emitted[input_cursor])
+			{
+				input_cursor++;
+			}
+			best_triangle = input_cursor;
+		}
+
+		const uint* triangle = &indices[best_triangle * 3];
+		memcpy(&destination[output * 3], triangle, sizeof(uint) * 3);
+		emitted[best_triangle] = true;
+
+		//Remove the triangle from its vertices
+		for (uint k = 0; k < 3; k++)
+		{
+			uint v = triangle[k];
+			uint* begin = &adjacency[offsets[v]];
+			for (uint j = 0; j < remaining[v]; j++)
+			{
+				if (begin[j] == best_triangle)
+				{
+					begin[j] = begin[remaining[v] - 1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		//The triangle's vertices go to the front of the LRU cache
+		uint new_cache[FORSYTH_CACHE_SIZE + 3];
+		uint new_count = 0;
+		new_cache[new_count++] = triangle[0];
+		new_cache[new_count++] = triangle[1];
+		new_cache[new_count++] = triangle[2];
+		for (uint i = 0; i < cache_count; i++)
+		{
+			uint v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				new_cache[new_count++] = v;
+			}
+		}
+
+		//Rescore the cached vertices, the ones pushed out get their score without cache
+		for (uint i = 0; i < new_count; i++)
+		{
+			uint v = new_cache[i];
+			int position = (i < FORSYTH_CACHE_SIZE) ? (int)i : -1;
+			cache_position[v] = position;
+
+			float score = ForsythVertexScore(position, remaining[v]);
+			float delta = score - vertex_score[v];
+			vertex_score[v] = score;
+
+			for (uint j = 0; j < remaining[v]; j++)
+			{
+				triangle_score[adjacency[offsets[v] + j]] += delta;
+			}
+		}
+
+		cache_count = Min(new_count, (uint)FORSYTH_CACHE_SIZE);
+		memcpy(cache, new_cache, sizeof(uint) * cache_count);
+
+		//Only triangles touching the cache changed, the best one is among them
+		best_triangle = INVALID_INDEX;
+		float best_score = 0.0f;
+		for (uint i = 0; i < cache_count; i++)
+		{
+			uint v = cache[i];
+			for (uint j = 0; j < remaining[v]; j++)
+			{
+				uint t = adjacency[offsets[v] + j];
+				if (best_triangle == INVALID_INDEX || triangle_score[t] > best_score)
+				{
+					best_triangle = t;
+					best_score = triangle_score[t];
+				}
+			}
+		}
+	}
+}
+
+//-- Overdraw --------------------------------------
+
+struct TriangleCluster
+{
+	uint begin = 0;
+	uint end = 0;
+	float sort_key = 0.0f;
+};
+
+static bool SortClusters(const TriangleCluster& a, const TriangleCluster& b)
+{
+	return a.sort_key > b.sort_key;
+}
+
+void OptimizeOverdraw(uint* destination, const uint* indices, uint num_indices, const float* positions, uint num_vertices, uint position_stride, float threshold)
+{
+	uint num_triangles = num_indices / 3;
+	if (num_triangles == 0)
+	{
+		return;
+	}
+
+	//Hard boundaries: triangles that miss the cache with all 3 vertices start a cluster
+	std::vector<uint> cache_time(num_vertices, 0);
+	uint time = VERTEX_CACHE_SIZE + 1;
+	std::vector<uint> hard_starts;
+
+	for (uint t = 0; t < num_triangles; t++)
+	{
+		uint misses = 0;
+		for (uint k = 0; k < 3; k++)
+		{
+			uint v = indices[t * 3 + k];
+			if (time - cache_time[v] > VERTEX_CACHE_SIZE)
+			{
+				cache_time[v] = time++;
+				misses++;
+			}
+		}
+
+		if (t == 0 || misses == 3)
+		{
+			hard_starts.push_back(t);
+		}
+	}
+	hard_starts.push_back(num_triangles);
+
+	//Soft boundaries: split a hard cluster once its ACMR is close enough to the whole cluster's
+	std::vector<TriangleCluster> clusters;
+	for (uint h = 0; h + 1 < hard_starts.size(); h++)
+	{
+		uint begin = hard_starts[h];
+		uint end = hard_starts[h + 1];
+		float target = AnalyzeVertexCache(&indices[begin * 3], (end - begin) * 3, num_vertices) * threshold;
+
+		TriangleCluster cluster;
+		cluster.begin = begin;
+		uint misses = 0;
+		time += VERTEX_CACHE_SIZE + 1;
+
+		for (uint t = begin; t < end; t++)
+		{
+			for (uint k = 0; k < 3; k++)
+			{
+				uint v = indices[t * 3 + k];
+				if (time - cache_time[v] > VERTEX_CACHE_SIZE)
+				{
+					cache_time[v] = time++;
+					misses++;
+				}
+			}
+
+			uint count = t + 1 - cluster.begin;
+			if (t + 1 < end && (float)misses / count <= target)
+			{
+				cluster.end = t + 1;
+				clusters.push_back(cluster);
+				cluster.begin = t + 1;
+				misses = 0;
+				time += VERTEX_CACHE_SIZE + 1;
+			}
+		}
+
+		cluster.end = end;
+		clusters.push_back(cluster);
+	}
+
+	//Area weighted centroid of the mesh
+	float3 mesh_centroid = float3::zero;
+	float mesh_area = 0.0f;
+	for (uint t = 0; t < num_triangles; t++)
+	{
+		float3 a(&positions[indices[t * 3] * position_stride]);
+		float3 b(&positions[indices[t * 3 + 1] * position_stride]);
+		float3 c(&positions[indices[t * 3 + 2] * position_stride]);
+		float area = (b - a).Cross(c - a).Length();
+		mesh_centroid += (a + b + c) * (area / 3.0f);
+		mesh_area += area;
+	}
+	if (mesh_area > 0.0f)
+	{
+		mesh_centroid /= mesh_area;
+	}
+
+	//Clusters facing away from the center are drawn first, they occlude the rest
+	for (uint i = 0; i < clusters.size(); i++)
+	{
+		float3 centroid = float3::zero;
+		float3 normal = float3::zero;
+		float area_sum = 0.0f;
+
+		for (uint t = clusters[i].begin; t < clusters[i].end; t++)
+		{
+			float3 a(&positions[indices[t * 3] * position_stride]);
+			float3 b(&positions[indices[t * 3 + 1] * position_stride]);
+			float3 c(&positions[indices[t * 3 + 2] * position_stride]);
+			float3 cross = (b - a).Cross(c - a);
+			float area = cross.Length();
+
+			centroid += (a + b + c) * (area / 3.0f);
+			normal += cross;
+			area_sum += area;
+		}
+
+		if (area_sum > 0.0f)
+		{
+			centroid /= area_sum;
+		}
+		normal.Normalize();
+
+		clusters[i].sort_key = (centroid - mesh_centroid).Dot(normal);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), SortClusters);
+
+	uint output = 0;
+	for (uint i = 0; i < clusters.size(); i++)
+	{
+		uint count = (clusters[i].end - clusters[i].begin) * 3;
+		memcpy(&destination[output], &indices[clusters[i].begin * 3], sizeof(uint) * count);
+		output += count;
+	}
+}
+
+//-- Vertex fetch ----------------------------------
+
+uint OptimizeVertexFetch(void* destination, uint* indices, uint num_indices, const void* vertices, uint num_vertices, uint vertex_size)
+{
+	std::vector<uint> remap(num_vertices, INVALID_INDEX);
+	uint next = 0;
+
+	for (uint i = 0; i < num_indices; i++)
+	{
+		uint v = indices[i];
+		if (remap[v] == INVALID_INDEX)
+		{
+			memcpy((char*)destination + next * vertex_size, (const char*)vertices + v * vertex_size, vertex_size);
+			remap[v] = next++;
+		}
+		indices[i] = remap[v];
+	}
+
+	return next;
+}
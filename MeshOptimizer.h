@@ -0,0 +1,30 @@
+#ifndef __MESHOPTIMIZER_H__
+#define __MESHOPTIMIZER_H__
+
+#include "Globals.h"
+
+// Index buffer optimizations run at import time. Every function works on
+// 32 bit triangle lists and opaque vertices of vertex_size bytes, so they
+// don't depend on the vertex format stored in the .shl
+
+#define VERTEX_CACHE_SIZE 16		// FIFO size used to measure ACMR
+#define OVERDRAW_THRESHOLD 1.05f	// ACMR a cluster can lose to get better overdraw
+
+// Average cache miss ratio, vertices transformed per triangle. 0.5 is the best possible, 3 the worst
+float AnalyzeVertexCache(const uint* indices, uint num_indices, uint num_vertices, uint cache_size = VERTEX_CACHE_SIZE);
+
+// Finds binary equal vertices, remap[i] is the new index of vertex i. Returns the unique vertex count
+uint GenerateVertexRemap(uint* remap, const uint* indices, uint num_indices, const void* vertices, uint num_vertices, uint vertex_size);
+void RemapIndexBuffer(uint* destination, const uint* indices, uint num_indices, const uint* remap);
+void RemapVertexBuffer(void* destination, const void* vertices, uint num_vertices, uint vertex_size, const uint* remap);
+
+// Forsyth's linear speed vertex cache optimization
+void OptimizeVertexCache(uint* destination, const uint* indices, uint num_indices, uint num_vertices);
+
+// Sorts clusters of a cache optimized list so the outer faces are drawn first
+void OptimizeOverdraw(uint* destination, const uint* indices, uint num_indices, const float* positions, uint num_vertices, uint position_stride, float threshold = OVERDRAW_THRESHOLD);
+
+// Orders the vertices as the indices use them and rewrites the indices. Returns the used vertex count
+uint OptimizeVertexFetch(void* destination, uint* indices, uint num_indices, const void* vertices, uint num_vertices, uint vertex_size);
+
+#endif // !__MESHOPTIMIZER_H__
@@ -0,0 +1,395 @@
+#include "MeshSimplifier.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <algorithm>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#define INVALID_INDEX 0xffffffff
+#define MAX_SIMPLIFY_PASSES 64
+#define BORDER_WEIGHT 10.0f
+
+enum VertexKind
+{
+	VERTEX_MANIFOLD,
+	VERTEX_BORDER,
+	VERTEX_LOCKED
+};
+
+// Sum of squared distances to a set of planes: pAp + 2bp + c, weighted by area
+struct Quadric
+{
+	float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+	float a01 = 0.0f, a02 = 0.0f, a12 = 0.0f;
+	float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+	float c = 0.0f;
+	float w = 0.0f;
+};
+
+static void QuadricAddPlane(Quadric& q, const float3& n, float d, float w)
+{
+	q.a00 += w * n.x * n.x;
+	q.a11 += w * n.y * n.y;
+	q.a22 += w * n.z * n.z;
+	q.a01 += w * n.x * n.y;
+	q.a02 += w * n.x * n.z;
+	q.a12 += w * n.y * n.z;
+	q.b0 += w * n.x * d;
+	q.b1 += w * n.y * d;
+	q.b2 += w * n.z * d;
+	q.c += w * d * d;
+	q.w += w;
+}
+
+static void QuadricAdd(Quadric& q, const Quadric& other)
+{
+	q.a00 += other.a00;
+	q.a11 += other.a11;
+	q.a22 += other.a22;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a12 += other.a12;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.w += other.w;
+}
+
+// Mean squared distance from p to the planes of the quadric
+static float QuadricError(const Quadric& q, const float3& p)
+{
+	float rx = q.a00 * p.x + q.a01 * p.y + q.a02 * p.z + 2.0f * q.b0;
+	float ry = q.a01 * p.x + q.a11 * p.y + q.a12 * p.z + 2.0f * q.b1;
+	float rz = q.a02 * p.x + q.a12 * p.y + q.a22 * p.z + 2.0f * q.b2;
+	float error = p.x * rx + p.y * ry + p.z * rz + q.c;
+
+	return (q.w > 0.0f) ? Abs(error) / q.w : 0.0f;
+}
+
+static uint64_t EdgeKey(uint a, uint b)
+{
+	return (a < b) ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+struct Collapse
+{
+	uint source = 0;		// Vertex removed
+	uint target = 0;		// Vertex it's moved onto
+	float error = 0.0f;
+};
+
+static bool SortCollapses(const Collapse& a, const Collapse& b)
+{
+	return a.error < b.error;
+}
+
+// Wedges with the same position share a representative, the first one found
+static void BuildPositionRemap(std::vector<uint>& position_rep, const std::vector<float3>& positions)
+{
+	uint num_vertices = positions.size();
+	uint table_size = 1;
+	while (table_size < num_vertices * 2)
+	{
+		table_size <<= 1;
+	}
+	std::vector<uint> table(table_size, INVALID_INDEX);
+
+	position_rep.resize(num_vertices);
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		uint bits[3];
+		memcpy(bits, positions[i].ptr(), sizeof(bits));
+		uint hash = (bits[0] * 73856093) ^ (bits[1] * 19349663) ^ (bits[2] * 83492791);
+		uint slot = hash & (table_size - 1);
+
+		while (table[slot] != INVALID_INDEX && memcmp(positions[table[slot]].ptr(), positions[i].ptr(), sizeof(float3)) != 0)
+		{
+			slot = (slot + 1) & (table_size - 1);
+		}
+
+		if (table[slot] == INVALID_INDEX)
+		{
+			table[slot] = i;
+		}
+		position_rep[i] = table[slot];
+	}
+}
+
+uint SimplifyMesh(uint* destination, const uint* indices, uint num_indices, const float* positions, uint num_vertices, uint position_stride,
+	uint target_indices, float target_error, float* result_error)
+{
+	std::vector<uint> result(indices, indices + num_indices);
+	float max_error = 0.0f;
+
+	if (num_indices < 3 || num_vertices == 0)
+	{
+		memcpy(destination, indices, sizeof(uint) * num_indices);
+		if (result_error != nullptr)
+		{
+			*result_error = 0.0f;
+		}
+		return num_indices;
+	}
+
+	//Work in a unit box so the errors are relative to the mesh size
+	AABB bounds;
+	bounds.SetNegativeInfinity();
+	for (uint i = 0; i < num_indices; i++)
+	{
+		bounds.Enclose(float3(&positions[indices[i] * position_stride]));
+	}
+	float3 size = bounds.Size();
+	float scale = Max(Max(size.x, size.y), size.z);
+	scale = (scale > 0.0f) ? 1.0f / scale : 1.0f;
+
+	std::vector<float3> points(num_vertices);
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		points[i] = (float3(&positions[i * position_stride]) - bounds.minPoint) * scale;
+	}
+
+	std::vector<uint> rep;
+	BuildPositionRemap(rep, points);
+
+	//Positions with more than one used wedge are on a seam and never move
+	std::vector<uint> wedges(num_vertices, 0);
+	std::vector<bool> referenced(num_vertices, false);
+	for (uint i = 0; i < num_indices; i++)
+	{
+		if (referenced[indices[i]] == false)
+		{
+			referenced[indices[i]] = true;
+			wedges[rep[indices[i]]]++;
+		}
+	}
+
+	//Plane quadrics of every triangle go to its corners
+	std::vector<Quadric> quadrics(num_vertices);
+	for (uint i = 0; i + 2 < num_indices; i += 3)
+	{
+		uint r0 = rep[indices[i]], r1 = rep[indices[i + 1]], r2 = rep[indices[i + 2]];
+		float3 normal = (points[r1] - points[r0]).Cross(points[r2] - points[r0]);
+		float area = normal.Normalize();
+		if (area <= 0.0f)
+		{
+			continue;
+		}
+
+		float d = -normal.Dot(points[r0]);
+		QuadricAddPlane(quadrics[r0], normal, d, area);
+		QuadricAddPlane(quadrics[r1], normal, d, area);
+		QuadricAddPlane(quadrics[r2], normal, d, area);
+	}
+
+	std::vector<uint> remap(num_vertices);
+	std::vector<uint8_t> kind(num_vertices);
+	std::vector<bool> used(num_vertices);
+	std::vector<uint> adjacency_offsets(num_vertices + 1);
+	std::vector<uint> adjacency;
+	std::unordered_map<uint64_t, uint> edges;
+	std::vector<Collapse> collapses;
+	bool border_quadrics_added = false;
+
+	for (uint pass = 0; pass < MAX_SIMPLIFY_PASSES && result.size() > target_indices; pass++)
+	{
+		uint num_triangles = result.size() / 3;
+
+		//Edge use counts: 1 is a border, more than 2 is non manifold
+		edges.clear();
+		for (uint t = 0; t < num_triangles; t++)
+		{
+			for (uint k = 0; k < 3; k++)
+			{
+				edges[EdgeKey(rep[result[t * 3 + k]], rep[result[t * 3 + (k + 1) % 3]])]++;
+			}
+		}
+
+		for (uint v = 0; v < num_vertices; v++)
+		{
+			kind[v] = (wedges[v] > 1) ? VERTEX_LOCKED : VERTEX_MANIFOLD;
+		}
+
+		for (uint t = 0; t < num_triangles; t++)
+		{
+			for (uint k = 0; k < 3; k++)
+			{
+				uint a = rep[result[t * 3 + k]];
+				uint b = rep[result[t * 3 + (k + 1) % 3]];
+				uint count = edges[EdgeKey(a, b)];
+
+				if (count > 2)
+				{
+					kind[a] = kind[b] = VERTEX_LOCKED;
+				}
+				else if (count == 1)
+				{
+					if (kind[a] == VERTEX_MANIFOLD) kind[a] = VERTEX_BORDER;
+					if (kind[b] == VERTEX_MANIFOLD) kind[b] = VERTEX_BORDER;
+
+					//Borders keep their shape with a plane perpendicular to the triangle
+					if (border_quadrics_added == false)
+					{
+						uint c = rep[result[t * 3 + (k + 2) % 3]];
+						float3 edge = points[b] - points[a];
+						float3 normal = edge.Cross((points[c] - points[a]).Cross(edge));
+						float length = edge.Length();
+						if (normal.Normalize() > 0.0f)
+						{
+							float d = -normal.Dot(points[a]);
+							QuadricAddPlane(quadrics[a], normal, d, length * length * BORDER_WEIGHT);
+							QuadricAddPlane(quadrics[b], normal, d, length * length * BORDER_WEIGHT);
+						}
+					}
+				}
+			}
+		}
+		border_quadrics_added = true;
+
+		//Triangles around every position
+		std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+		for (uint i = 0; i < result.size(); i++)
+		{
+			adjacency_offsets[rep[result[i]] + 1]++;
+		}
+		for (uint v = 0; v < num_vertices; v++)
+		{
+			adjacency_offsets[v + 1] += adjacency_offsets[v];
+		}
+		adjacency.resize(result.size());
+		std::vector<uint> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (uint i = 0; i < result.size(); i++)
+		{
+			adjacency[fill[rep[result[i]]]++] = i / 3;
+		}
+
+		//Both directions of every edge are candidates, the source must be free to move
+		collapses.clear();
+		for (uint t = 0; t < num_triangles; t++)
+		{
+			for (uint k = 0; k < 6; k++)
+			{
+				uint source = result[t * 3 + k % 3];
+				uint target = result[t * 3 + (k + ((k < 3) ? 1 : 2)) % 3];
+				uint rs = rep[source], rt = rep[target];
+
+				if (rs == rt || kind[rs] == VERTEX_LOCKED)
+				{
+					continue;
+				}
+
+				if (kind[rs] == VERTEX_BORDER && edges[EdgeKey(rs, rt)] != 1)
+				{
+					continue;
+				}
+
+				Quadric q = quadrics[rs];
+				QuadricAdd(q, quadrics[rt]);
+
+				Collapse collapse;
+				collapse.source = source;
+				collapse.target = target;
+				collapse.error = QuadricError(q, points[rt]);
+				collapses.push_back(collapse);
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), SortCollapses);
+
+		for (uint v = 0; v < num_vertices; v++)
+		{
+			remap[v] = v;
+			used[v] = false;
+		}
+
+		uint triangles_needed = num_triangles - target_indices / 3;
+		uint triangles_removed = 0;
+		uint num_collapses = 0;
+		float error_limit = target_error * target_error;
+
+		for (uint i = 0; i < collapses.size() && triangles_removed < triangles_needed; i++)
+		{
+			const Collapse& collapse = collapses[i];
+			if (collapse.error > error_limit)
+			{
+				break;
+			}
+
+			uint rs = rep[collapse.source], rt = rep[collapse.target];
+			if (used[rs] || used[rt])
+			{
+				continue;
+			}
+
+			//Reject collapses that flip a triangle around the source
+			bool valid = true;
+			uint removed = 0;
+			for (uint j = adjacency_offsets[rs]; j < adjacency_offsets[rs + 1] && valid; j++)
+			{
+				const uint* triangle = &result[adjacency[j] * 3];
+				uint r[3] = { rep[triangle[0]], rep[triangle[1]], rep[triangle[2]] };
+
+				if (r[0] == rt || r[1] == rt || r[2] == rt)
+				{
+					removed++;
+					continue;
+				}
+
+				float3 before = (points[r[1]] - points[r[0]]).Cross(points[r[2]] - points[r[0]]);
+				for (uint k = 0; k < 3; k++)
+				{
+					if (r[k] == rs) r[k] = rt;
+				}
+				float3 after = (points[r[1]] - points[r[0]]).Cross(points[r[2]] - points[r[0]]);
+
+				valid = before.Dot(after) > 0.0f;
+			}
+
+			if (valid == false)
+			{
+				continue;
+			}
+
+			//The one ring of the source is left alone for the rest of the pass
+			for (uint j = adjacency_offsets[rs]; j < adjacency_offsets[rs + 1]; j++)
+			{
+				const uint* triangle = &result[adjacency[j] * 3];
+				used[rep[triangle[0]]] = used[rep[triangle[1]]] = used[rep[triangle[2]]] = true;
+			}
+
+			remap[collapse.source] = collapse.target;
+			QuadricAdd(quadrics[rt], quadrics[rs]);
+			max_error = Max(max_error, collapse.error);
+			triangles_removed += removed;
+			num_collapses++;
+		}
+
+		if (num_collapses == 0)
+		{
+			break;
+		}
+
+		//Apply the collapses and drop the triangles that became degenerate
+		uint write = 0;
+		for (uint t = 0; t < num_triangles; t++)
+		{
+			uint a = remap[result[t * 3]], b = remap[result[t * 3 + 1]], c = remap[result[t * 3 + 2]];
+			if (rep[a] != rep[b] && rep[b] != rep[c] && rep[a] != rep[c])
+			{
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+		}
+		result.resize(write);
+	}
+
+	memcpy(destination, result.data(), sizeof(uint) * result.size());
+
+	if (result_error != nullptr)
+	{
+		*result_error = sqrt(max_error);
+	}
+
+	return result.size();
+}
@@ -0,0 +1,18 @@
+#ifndef __MESHSIMPLIFIER_H__
+#define __MESHSIMPLIFIER_H__
+
+#include "Globals.h"
+
+// Quadric error metric simplification by edge collapse. Vertices are only
+// removed, never moved, so every level shares the vertex buffer of the
+// original mesh. Vertices on UV/normal seams and non manifold edges are kept,
+// borders only collapse along themselves.
+//
+// Writes at most num_indices indices to destination and returns how many were
+// written. The error is relative to the biggest extent of the mesh, 0.01 means
+// 1% of the mesh size. Simplification stops at target_indices or when the next
+// collapse would be over target_error, result_error gets the error reached.
+uint SimplifyMesh(uint* destination, const uint* indices, uint num_indices, const float* positions, uint num_vertices, uint position_stride,
+	uint target_indices, float target_error, float* result_error = nullptr);
+
+#endif // !__MESHSIMPLIFIER_H__
@@ -6,6 +6,47 @@
 class Application;
 struct PhysBody3D;
 
+enum FramePhase
+{
+	FRAME_PRE_UPDATE,
+	FRAME_UPDATE,
+	FRAME_POST_UPDATE,
+	FRAME_SIMULATE		// Between Update and the next PreUpdate, at the same time as the render
+};
+
+// What the modules touch while they update
+enum FrameResource
+{
+	RESOURCE_INPUT = 1 << 0,
+	RESOURCE_CAMERA = 1 << 1,		// Editor camera
+	RESOURCE_SCENE = 1 << 2,		// GameObjects, components, octree
+	RESOURCE_PHYSICS = 1 << 3,		// Bullet world and bodies
+	RESOURCE_ASSETS = 1 << 4,		// Mesh and texture caches
+	RESOURCE_GL = 1 << 5,		// GL context, window and ImGui, only on the main thread
+	RESOURCE_ALL = 0xFFFFFFFF
+};
+
+struct FrameAccess
+{
+	uint reads = 0;
+	uint writes = 0;
+
+	bool IsEmpty() const
+	{
+		return (reads | writes) == 0;
+	}
+
+	bool OnMainThread() const
+	{
+		return ((reads | writes) & RESOURCE_GL) != 0;
+	}
+
+	bool ConflictsWith(const FrameAccess& other) const
+	{
+		return (writes & (other.reads | other.writes)) != 0 || (reads & other.writes) != 0;
+	}
+};
+
 
 class Module
 {
@@ -79,6 +120,22 @@ public:
 		return true;
 	}
 
+	// Work that can go ahead on a worker while the frame renders, its results
+	// are there for the next PreUpdate. Declare what it touches as FRAME_SIMULATE
+	virtual void Simulate(float dt)
+	{ }
+
+	// What every phase touches, modules that don't conflict update at the same
+	// time. Until a module says otherwise it touches everything, in order
+	virtual void DeclareAccess(FramePhase phase, FrameAccess& access) const
+	{
+		if (phase != FRAME_SIMULATE)
+		{
+			access.reads = RESOURCE_ALL;
+			access.writes = RESOURCE_ALL;
+		}
+	}
+
 	virtual void OnCollision(PhysBody3D* body1, PhysBody3D* body2)
 	{ }
 };
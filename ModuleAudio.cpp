@@ -69,6 +69,11 @@ bool ModuleAudio::CleanUp()
 	return true;
 }
 
+void ModuleAudio::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Nothing to do in the frame
+}
+
 // Play a music file
 bool ModuleAudio::PlayMusic(const char* path, float fade_time)
 {
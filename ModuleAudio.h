@@ -18,6 +18,7 @@ public:
 
 	bool Init(Json& config);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	// Play a music file
 	bool PlayMusic(const char* path, float fade_time = DEFAULT_MUSIC_FADE_TIME);
@@ -31,6 +31,16 @@ bool ModuleCamera3D::CleanUp()
 	return true;
 }
 
+void ModuleCamera3D::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Only moves the editor camera, it can go on a worker
+	if (phase == FRAME_UPDATE)
+	{
+		access.reads = RESOURCE_INPUT;
+		access.writes = RESOURCE_CAMERA;
+	}
+}
+
 // -----------------------------------------------------------------
 update_status ModuleCamera3D::Update(float dt)
 {
@@ -17,6 +17,7 @@ public:
 	bool Start();
 	update_status Update(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	void MoveCamera(float dt);
 	void LookAt(float dx, float dy, float sensitivity);
@@ -73,6 +73,16 @@ bool ModuleEditor::CleanUp()
 	return true;
 }
 
+void ModuleEditor::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//The windows can change anything
+	if (phase == FRAME_UPDATE)
+	{
+		access.reads = RESOURCE_ALL;
+		access.writes = RESOURCE_ALL;
+	}
+}
+
 // Update: draw background
 update_status ModuleEditor::Update(float dt)
 {
@@ -208,7 +218,7 @@ void ModuleEditor::TimerManagerMenu()
 
 	if (ImGui::Button("Play"))
 	{
-		App->go_manager->SaveGameObjectsOnScene("Library/Save/Scene.json");
+		App->go_manager->TakeSnapshot();
 		App->GameState(PLAY);	
 	}
 	ImGui::SameLine();
@@ -221,7 +231,7 @@ void ModuleEditor::TimerManagerMenu()
 	{
 		if (App->time_manager->TimeStart() > 0)
 		{
-			App->go_manager->LoadScene("Library/Save/Scene.json");
+			App->go_manager->RestoreSnapshot();
 			App->GameState(STOP);
 		}
 	}
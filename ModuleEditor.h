@@ -28,6 +28,7 @@ public:
 	update_status Update(float dt);
 	update_status PostUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	update_status UpdateEditor();
 	void Log(const char* text);
@@ -1,6 +1,7 @@
 #include "Application.h"
 #include "Globals.h"
 #include "ModuleFileSystem.h"
+#include "SceneFormat.h"
 #include "PhysFS/include/physfs.h"
 #include "SDL/include/SDL.h"
 
@@ -59,6 +60,11 @@ bool ModuleFileSystem::CleanUp()
 	return true;
 }
 
+void ModuleFileSystem::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Nothing to do in the frame
+}
+
 // Add a new zip file or folder
 bool ModuleFileSystem::AddPath(const char* path_or_zip, const char* mount_point)
 {
@@ -130,8 +136,8 @@ unsigned int ModuleFileSystem::Load(const char* file, char** buffer) const
 			if (readed != size)
 			{
 				LOG("File System error while reading from file %s: %s\n", file, PHYSFS_getLastError());
-				if (buffer)
-					delete[] buffer;
+				delete[] *buffer;
+				*buffer = nullptr;
 			}
 			else
 				ret = (uint)readed;
@@ -165,6 +171,83 @@ SDL_RWops* ModuleFileSystem::Load(const char* file) const
 		return NULL;
 }
 
+// Map a whole file in memory without copying it
+bool ModuleFileSystem::Map(const char* file, MappedFile& mapped) const
+{
+	bool ret = false;
+
+	const char* real_dir = PHYSFS_getRealDir(file);
+	if (real_dir == NULL)
+	{
+		LOG("File System error while mapping file %s: %s\n", file, PHYSFS_getLastError());
+		return ret;
+	}
+
+	std::string real_path = real_dir;
+	if (real_path.empty() == false && real_path.back() != '/' && real_path.back() != '\\')
+	{
+		real_path.append(PHYSFS_getDirSeparator());
+	}
+	real_path.append(file);
+
+	HANDLE file_handle = CreateFileA(real_path.data(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		LOG("File System error while mapping file %s: can't open %s\n", file, real_path.data());
+		return ret;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file_handle, &size) == 0 || size.QuadPart <= 0)
+	{
+		CloseHandle(file_handle);
+		return ret;
+	}
+
+	HANDLE map_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map_handle == NULL)
+	{
+		LOG("File System error while mapping file %s: error %d\n", file, GetLastError());
+		CloseHandle(file_handle);
+		return ret;
+	}
+
+	const char* data = (const char*)MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL)
+	{
+		LOG("File System error while mapping view of file %s: error %d\n", file, GetLastError());
+		CloseHandle(map_handle);
+		CloseHandle(file_handle);
+		return ret;
+	}
+
+	mapped.data = data;
+	mapped.size = (uint)size.QuadPart;
+	mapped.file_handle = file_handle;
+	mapped.map_handle = map_handle;
+	ret = true;
+
+	return ret;
+}
+
+void ModuleFileSystem::Unmap(MappedFile& mapped) const
+{
+	if (mapped.data != nullptr)
+	{
+		UnmapViewOfFile(mapped.data);
+	}
+	if (mapped.map_handle != nullptr)
+	{
+		CloseHandle(mapped.map_handle);
+	}
+	if (mapped.file_handle != nullptr)
+	{
+		CloseHandle(mapped.file_handle);
+	}
+
+	mapped = MappedFile();
+}
+
 int close_sdl_rwops(SDL_RWops *rw)
 {
 	if (rw->hidden.mem.base)
@@ -199,55 +282,6 @@ unsigned int ModuleFileSystem::Save(const char* file, const void* buffer, unsign
 	return ret;
 }
 
-bool ModuleFileSystem::SaveUnique(const char * file, string & output_name, const void * buffer, unsigned int size, const char * path, const char * extension)
-{
-	bool ret = false;
-	bool no_save = false;
-	char copy_name[100];
-	sprintf_s(copy_name, 100, "%s.%s", file, extension);
-
-	std::vector<string> files_in_directory;
-	EnumerateFiles(path, files_in_directory);
-
-	int copy = 0;
-
-	bool name_taken = false;
-	while (name_taken == false)
-	{
-		name_taken = true;
-
-		std::vector<string>::iterator it = files_in_directory.begin();
-		while (it != files_in_directory.end())
-		{
-			if ((*it).compare(copy_name) == 0)
-			{
-				no_save = true;
-				break;
-			}
-			it++;
-		}
-	}
-
-	char output_n[100];
-	sprintf_s(output_n, 100, "%s%s", path, copy_name);
-
-	if (no_save)
-	{
-		output_name = output_n;
-		ret = true;
-	}
-	else
-	{
-		if (Save(output_n, buffer, size) >0)
-		{
-			output_name = output_n;
-			ret = true;
-		}
-	}
-
-	return ret;
-}
-
 bool ModuleFileSystem::EnumerateFiles(const char * directory, std::vector<string>& buff)
 {
 	char** enumerated_files = PHYSFS_enumerateFiles(directory);
@@ -274,7 +308,8 @@ bool ModuleFileSystem::EnumerateFiles(const char * directory, std::vector<string
 	for (uint i = 0; i < files_in_directory.size(); i++)
 	{
 		size_t size = files_in_directory[i].find(".json");
-		if (size != string::npos)
+		size_t size_binary = files_in_directory[i].find("." SCENE_EXTENSION);
+		if (size != string::npos || size_binary != string::npos)
 		{
 			files_found.push_back((files_in_directory[i]));
 		}
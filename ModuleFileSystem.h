@@ -10,6 +10,15 @@ struct SDL_RWops;
 
 int close_sdl_rwops(SDL_RWops *rw);
 
+// Read-only view of a whole file mapped into memory
+struct MappedFile
+{
+	const char* data = nullptr;
+	unsigned int size = 0;
+	void* file_handle = nullptr;
+	void* map_handle = nullptr;
+};
+
 class ModuleFileSystem : public Module
 {
 public:
@@ -24,6 +33,7 @@ public:
 
 	// Called before quitting
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	// Utility functions
 	bool AddPath(const char* path_or_zip, const char* mount_point = nullptr);
@@ -40,8 +50,11 @@ public:
 	unsigned int Load(const char* file, char** buffer) const;
 	SDL_RWops* Load(const char* file) const;
 
+	// Map for Read, data stays valid until Unmap
+	bool Map(const char* file, MappedFile& mapped) const;
+	void Unmap(MappedFile& mapped) const;
+
 	unsigned int Save(const char* file, const void* buffer, unsigned int size) const;
-	bool SaveUnique(const char* file,std::string& output_name, const void* buffer, unsigned int size,const char* path,const char* extension);
 	bool EnumerateFiles(const char* directory, std::vector<std::string>&buff);
 	std::vector<std::string> GetFilesFromDirectory(const char* path) ;
 private:
@@ -3,7 +3,10 @@
 #include "GameObject.h"
 #include "Component.h"
 #include "ComponentTransform.h"
-#include "Quadtree.h"
+#include "ComponentMesh.h"
+#include "Octree.h"
+#include "Hash.h"
+#include "SceneFormat.h"
 #include "Imgui\imgui.h"
 #include <algorithm>
 
@@ -12,6 +15,8 @@ using namespace std;
 
 ModuleGOManager::ModuleGOManager(Application * app, const char* name, bool start_enabled) : Module(app, name, start_enabled)
 {
+	std::random_device seed;
+	uid_generator.seed(((unsigned long long)seed() << 32) ^ seed());
 
 }
 
@@ -25,12 +30,10 @@ bool ModuleGOManager::Init(Json& config)
 	bool ret = true;
 	LOG("Init Game Object Manager");
 
-	root = new GameObject(nullptr, "root");
+	root = scene_objects.New(nullptr, "root");
+	RegisterGameObject(root);
 	root->AddComponent(Component::TRANSFORM);
 
-	quad.Create(100.0f);
-
-
 	return ret;
 }
 
@@ -44,15 +47,7 @@ bool ModuleGOManager::Start(float dt)
 
 update_status ModuleGOManager::PreUpdate(float dt)
 {
-	//Delete game objects in the vector to delete 
-	vector<GameObject*>::iterator it = to_delete.begin();
-	while (it != to_delete.end())
-	{
-		delete(*it);
-		++it;
-	}
-
-	to_delete.clear();
+	FlushDeletedGameObjects();
 
 	if (root)
 	{
@@ -66,10 +61,19 @@ update_status ModuleGOManager::PreUpdate(float dt)
 update_status ModuleGOManager::Update(float dt)
 {
 
-	if (root)
+	//World matrices of what moved, before the components use them
+	transforms.Update(root);
+
+	UpdateComponents(dt);
+
+	if (static_batch_dirty)
 	{
-		UpdateChilds(dt, root);
+		BuildStaticBatch();
 	}
+
+	FrustumCulling();
+	DrawVisible();
+
 	HierarchyInfo();
 	EditorWindow();
 
@@ -79,7 +83,7 @@ update_status ModuleGOManager::Update(float dt)
 		game_object_on_editor = SelectGameObject(raycast, CollectHits(raycast));
 	}
 
-	quad.Render();
+	octree.Render();
 
 	return UPDATE_CONTINUE;
 }
@@ -88,27 +92,100 @@ bool ModuleGOManager::CleanUp()
 {
 	bool ret = true;
 
-	delete root;
+	//Meshes stop going to the snapshot before the scene goes
+	snapshot.Clear();
+	DeleteScene();
 
-	game_object_on_editor = nullptr;
-	root = nullptr;
+	//What the scene didn't delete goes now, while the octree and the transforms are still alive
+	mesh_pool.Clear();
+	material_pool.Clear();
+	camera_pool.Clear();
+	transform_pool.Clear();
 
 	return ret;
 }
 
+void ModuleGOManager::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Components free GL objects and the scene is drawn from here
+	if (phase == FRAME_PRE_UPDATE)
+	{
+		access.writes = RESOURCE_SCENE | RESOURCE_ASSETS | RESOURCE_GL;
+	}
+	else if (phase == FRAME_UPDATE)
+	{
+		access.reads = RESOURCE_INPUT | RESOURCE_CAMERA;
+		access.writes = RESOURCE_SCENE | RESOURCE_ASSETS | RESOURCE_GL;
+	}
+}
+
 GameObject* ModuleGOManager::CreateGameObject(GameObject* parent, const char* name)
 {
-	GameObject* ret = new GameObject(parent, name);
+	GameObject* ret = scene_objects.New(parent, name);
+	RegisterGameObject(ret);
 	if (parent == nullptr)
 	{
 		parent = root;
 	}
 
 	parent->childs.push_back(ret);
+	transforms.Invalidate();
+	NotifyChanged(ret);
+
+	return ret;
+}
+
+Component* ModuleGOManager::CreateComponent(Component::Types type)
+{
+	Component* ret = nullptr;
+
+	switch (type)
+	{
+	case Component::MESH:
+		ret = mesh_pool.Create(type);
+		break;
+	case Component::TRANSFORM:
+		ret = transform_pool.Create(type);
+		break;
+	case Component::MATERIAL:
+		ret = material_pool.Create(type);
+		break;
+	case Component::CAMERA:
+		ret = camera_pool.Create(type);
+		break;
+	default:
+		break;
+	}
 
 	return ret;
 }
 
+void ModuleGOManager::DestroyComponent(Component* component)
+{
+	if (component == nullptr)
+	{
+		return;
+	}
+
+	switch (component->GetType())
+	{
+	case Component::MESH:
+		mesh_pool.Destroy(component);
+		break;
+	case Component::TRANSFORM:
+		transform_pool.Destroy(component);
+		break;
+	case Component::MATERIAL:
+		material_pool.Destroy(component);
+		break;
+	case Component::CAMERA:
+		camera_pool.Destroy(component);
+		break;
+	default:
+		break;
+	}
+}
+
 void ModuleGOManager::DeleteGameObject(GameObject * go)
 {
 
@@ -121,6 +198,8 @@ void ModuleGOManager::DeleteGameObject(GameObject * go)
 		}
 		go->DeleteAllChildren();
 		to_delete.push_back(go);
+		transforms.Invalidate();
+		NotifyChanged(go);
 	}
 }
 
@@ -209,7 +288,7 @@ void ModuleGOManager::EditorWindow()
 		ImGui::SameLine();
 		ImGui::TextColored(IMGUI_GREEN,"ID object: ");
 		ImGui::SameLine();
-		ImGui::Text("%d", game_object_on_editor->GetID());
+		ImGui::Text("%016llx", game_object_on_editor->GetID());
 
 		const vector<Component*>* components = game_object_on_editor->GetComponents();
 		for (vector<Component*>::const_iterator component = (*components).begin(); component != (*components).end(); ++component)
@@ -258,13 +337,25 @@ vector<GameObject*> ModuleGOManager::CollectHits(const LineSegment & ray) const
 
 void ModuleGOManager::SaveGameObjectsOnScene(const char* name_file) const
 {
-	Json data;
-	data.AddArray("Game Objects");
+	char* buff;
+	size_t size = 0;
 
-	root->Save(data);
+	const char* extension = strrchr(name_file, '.');
+	if (extension != nullptr && _stricmp(extension + 1, SCENE_EXTENSION) == 0)
+	{
+		//Records are written as the scene is walked, no json document in between
+		SceneWriter writer;
+		root->Save(writer);
+		size = writer.Save(&buff);
+	}
+	else
+	{
+		Json data;
+		data.AddArray("Game Objects");
 
-	char* buff;
-	size_t size = data.Save(&buff);
+		root->Save(data);
+		size = data.Save(&buff);
+	}
 
 	App->fs->Save(name_file, buff, size);
 	delete[] buff;
@@ -273,24 +364,18 @@ void ModuleGOManager::SaveGameObjectsOnScene(const char* name_file) const
 GameObject * ModuleGOManager::LoadGameObjectsOnScene(Json & game_objects)
 {
 	const char* name = game_objects.GetString("Name");
-	int id = game_objects.GetInt("ID Game Object");
-	int parent_id = game_objects.GetInt("ID Parent");
-	bool enabled = game_objects.GetBool("enabled");
+	bool enabled = game_objects.GetBool("Enabled");
 
-	//Search the parent of the game object
-	GameObject* parent = nullptr;
-	if (parent_id != 0 && root != nullptr)
+	//Ids are hex strings, scenes saved before that have them as numbers
+	UID id = StringToHash(game_objects.GetString("ID Game Object"));
+	UID parent_id = StringToHash(game_objects.GetString("ID Parent"));
+	if (game_objects.GetString("ID Game Object") == nullptr)
 	{
-		parent = SearchGameObjectsByID(root, parent_id);
+		id = (UID)game_objects.GetInt("ID Game Object");
+		parent_id = (UID)game_objects.GetInt("ID Parent");
 	}
 
-	//Create the childs 
-	GameObject* child = new GameObject(parent, name, id, enabled);
-
-	if (parent != nullptr)
-	{
-		parent->childs.push_back(child);
-	}
+	GameObject* child = AddLoadedGameObject(name, id, parent_id, enabled);
 
 	//Attach the components
 	Json component_data;
@@ -307,47 +392,163 @@ GameObject * ModuleGOManager::LoadGameObjectsOnScene(Json & game_objects)
 	return child;
 }
 
-GameObject * ModuleGOManager::SearchGameObjectsByID(GameObject * first_go, int id) const
+GameObject * ModuleGOManager::LoadGameObjectsOnScene(const SceneReader & scene, uint index)
 {
-	GameObject* ret = nullptr;
-	if (first_go != nullptr)
+	SceneObjectRecord object;
+	scene.GetObjectRecord(index, object);
+
+	const char* name = scene.GetString(object.name);
+	GameObject* child = AddLoadedGameObject((name != nullptr) ? name : "", object.id, object.parent_id, object.enabled != 0);
+
+	//Attach the components, unknown types from newer files are skipped
+	SceneComponentRecord component;
+	for (uint i = 0; i < object.num_components; i++)
 	{
-		if (first_go->id == id)
+		scene.GetComponentRecord(object.first_component + i, component);
+		if (component.type >= Component::NONE)
 		{
-			ret = first_go;
+			continue;
 		}
-		else
-		{
-			const std::vector<GameObject*>* game_objects = first_go->GetChilds();
-			vector<GameObject*>::const_iterator it = game_objects->begin();
 
-			while (it != game_objects->end())
-			{
-				ret = SearchGameObjectsByID((*it), id);				
-				if (ret != nullptr)
-				{
-					break;
-				}
-				++it;
-			}
-		}
+		Component* cmp_go = child->AddComponent((Component::Types)(component.type));
+		cmp_go->ToLoad(component, scene);
 	}
 
-	return ret;
+	return child;
 }
 
-void ModuleGOManager::InsertObjects()
+GameObject * ModuleGOManager::AddLoadedGameObject(const char * name, UID id, UID parent_id, bool enabled)
 {
-	if (root->childs.empty() == false)
+	//Parents are saved before their childs, they are already registered
+	GameObject* parent = nullptr;
+	if (parent_id != 0)
+	{
+		parent = FindGameObject(parent_id);
+	}
+
+	if (id == 0 || FindGameObject(id) != nullptr)
+	{
+		LOG("Game object %s has a repeated id, it gets a new one", name);
+		id = GenerateUID();
+	}
+
+	GameObject* child = scene_objects.New(parent, name, id, enabled);
+	RegisterGameObject(child);
+
+	if (parent != nullptr)
+	{
+		parent->childs.push_back(child);
+	}
+	transforms.Invalidate();
+
+	return child;
+}
+
+UID ModuleGOManager::GenerateUID()
+{
+	//64 random bits, checked against the scene so two objects never share one
+	UID id = 0;
+	while (id == 0 || game_objects_by_id.find(id) != game_objects_by_id.end())
+	{
+		id = uid_generator();
+	}
+	return id;
+}
+
+GameObject* ModuleGOManager::FindGameObject(UID id) const
+{
+	std::unordered_map<UID, GameObject*>::const_iterator it = game_objects_by_id.find(id);
+	return (it != game_objects_by_id.end()) ? it->second : nullptr;
+}
+
+void ModuleGOManager::RegisterGameObject(GameObject* go)
+{
+	game_objects_by_id[go->GetID()] = go;
+}
+
+bool ModuleGOManager::ConvertScene(const char* directory) const
+{
+	const char* extension = strrchr(directory, '.');
+	if (extension == nullptr)
+	{
+		LOG("Can't convert scene %s, it has no extension", directory);
+		return false;
+	}
+
+	char* buff;
+	uint size = App->fs->Load(directory, &buff);
+	if (size == 0)
+	{
+		LOG("Error loading scene %s", directory);
+		return false;
+	}
+
+	char* converted = nullptr;
+	uint converted_size = 0;
+	string converted_path(directory, extension - directory);
+	if (SceneReader::IsSceneFile(buff, size))
+	{
+		converted_size = SceneBinaryToJson(buff, size, &converted);
+		converted_path.append(".json");
+	}
+	else
+	{
+		converted_size = SceneJsonToBinary(buff, &converted);
+		converted_path.append(".");
+		converted_path.append(SCENE_EXTENSION);
+	}
+	delete[] buff;
+
+	if (converted_size == 0)
 	{
-		root->InsertNode();
+		LOG("Error converting scene %s", directory);
+		return false;
 	}
+
+	App->fs->Save(converted_path.data(), converted, converted_size);
+	delete[] converted;
+	LOG("Scene %s converted to %s", directory, converted_path.data());
+	return true;
 }
 
 void ModuleGOManager::LoadScene(const char * directory)
 {
 	char* buff;
 	uint size = App->fs->Load(directory, &buff);
+	if (size == 0)
+	{
+		LOG("Error loading scene %s", directory);
+		return;
+	}
+
+	//Binary scenes are checked before anything is deleted
+	SceneReader binary_scene;
+	bool binary = SceneReader::IsSceneFile(buff, size);
+	if (binary && binary_scene.Open(buff, size) == false)
+	{
+		LOG("Error loading scene %s", directory);
+		delete[] buff;
+		return;
+	}
+
+	//The loaded scene replaces the current one
+	DeleteScene();
+
+	if (binary)
+	{
+		//the first one will be the root node, always.
+		for (uint i = 0; i < binary_scene.GetNumObjects(); i++)
+		{
+			GameObject* go = LoadGameObjectsOnScene(binary_scene, i);
+			if (i == 0)
+			{
+				this->root = go;
+			}
+		}
+
+		delete[] buff;
+		return;
+	}
 	
 	Json scene(buff);
 	Json root;
@@ -374,9 +575,200 @@ void ModuleGOManager::LoadScene(const char * directory)
 
 void ModuleGOManager::DeleteScene()
 {
-	DeleteGameObject(root);
+	Timer timer;
+	uint num_objects = scene_objects.GetNumObjects();
+
+	//The octree goes first, so the meshes leaving don't have to find themselves in it
+	octree.Clear();
+	visible.clear();
+	to_delete.clear();
+	game_objects_by_id.clear();
 	game_object_on_editor = nullptr;
+	culling_camera = nullptr;
 	root = nullptr;
+	snapshot.MarkSceneReplaced();
+	App->scene_intro->OnSceneDeleted();
+
+	scene_objects.Reset();
+	transforms.Invalidate();
+
+	LOG("Scene deleted, %d game objects in %d ms", num_objects, timer.Read());
+}
+
+void ModuleGOManager::TakeSnapshot()
+{
+	//Play after Pause keeps the snapshot taken when the game started
+	if (snapshot.IsActive() == false && root != nullptr)
+	{
+		Timer timer;
+		snapshot.Take(root);
+		LOG("Scene snapshot, %d game objects in %d ms", snapshot.GetScene().GetNumObjects(), timer.Read());
+	}
+}
+
+void ModuleGOManager::RestoreSnapshot()
+{
+	if (snapshot.IsActive() == false)
+	{
+		return;
+	}
+
+	Timer timer;
+	FlushDeletedGameObjects();
+
+	//Records to restore in file order, so parents come before their childs
+	const SceneReader& scene = snapshot.GetScene();
+	vector<uint> restore;
+	if (snapshot.IsSceneReplaced())
+	{
+		DeleteScene();
+		for (uint i = 0; i < scene.GetNumObjects(); i++)
+		{
+			restore.push_back(i);
+		}
+	}
+	else
+	{
+		//Restoring notifies changes too, the list is copied first
+		vector<UID> changed = snapshot.GetChanged();
+		vector<UID>::const_iterator it = changed.begin();
+		while (it != changed.end())
+		{
+			uint index = 0;
+			if (snapshot.FindObject(*it, index))
+			{
+				restore.push_back(index);
+			}
+			else
+			{
+				//Created while playing
+				RemoveGameObjectNow(FindGameObject(*it));
+			}
+			++it;
+		}
+		sort(restore.begin(), restore.end());
+	}
+
+	vector<uint>::const_iterator it = restore.begin();
+	while (it != restore.end())
+	{
+		RestoreGameObject(scene, *it);
+		++it;
+	}
+
+	visible.clear();
+	transforms.Invalidate();
+
+	LOG("Scene restored, %d of %d game objects in %d ms", restore.size(), scene.GetNumObjects(), timer.Read());
+	snapshot.Clear();
+}
+
+void ModuleGOManager::NotifyChanged(const GameObject* go)
+{
+	if (go != nullptr && snapshot.IsActive())
+	{
+		snapshot.MarkChanged(go->id);
+	}
+}
+
+void ModuleGOManager::RestoreGameObject(const SceneReader& scene, uint index)
+{
+	SceneObjectRecord object;
+	scene.GetObjectRecord(index, object);
+	const char* name = scene.GetString(object.name);
+
+	//Deleted while playing, it comes back with the same id
+	GameObject* go = FindGameObject(object.id);
+	if (go == nullptr)
+	{
+		go = AddLoadedGameObject((name != nullptr) ? name : "", object.id, object.parent_id, object.enabled != 0);
+		if (object.parent_id == 0)
+		{
+			root = go;
+		}
+	}
+	else
+	{
+		go->name_object = (name != nullptr) ? name : "";
+		go->enabled = object.enabled != 0;
+	}
+
+	//Components are restored in place when they are the same ones, else rebuilt
+	SceneComponentRecord component;
+	bool same_components = go->to_delete.empty() && go->components.size() == object.num_components;
+	for (uint i = 0; i < object.num_components && same_components; i++)
+	{
+		scene.GetComponentRecord(object.first_component + i, component);
+		same_components = (go->components[i]->GetType() == component.type);
+	}
+
+	if (same_components == false)
+	{
+		go->DestroyComponents();
+	}
+
+	for (uint i = 0; i < object.num_components; i++)
+	{
+		scene.GetComponentRecord(object.first_component + i, component);
+		if (component.type >= Component::NONE)
+		{
+			continue;
+		}
+
+		Component* cmp_go = (same_components) ? go->components[i] : go->AddComponent((Component::Types)(component.type));
+		cmp_go->Restore(component, scene);
+	}
+}
+
+void ModuleGOManager::RemoveGameObjectNow(GameObject* go)
+{
+	if (go == nullptr || go == root)
+	{
+		return;
+	}
+
+	//Childs first, nothing points to them once the parent goes
+	vector<GameObject*> childs = go->childs;
+	vector<GameObject*>::iterator it = childs.begin();
+	while (it != childs.end())
+	{
+		RemoveGameObjectNow(*it);
+		++it;
+	}
+	go->childs.clear();
+
+	//Objects created without parent hang from the root
+	GameObject* parent = (go->GetParent() != nullptr) ? go->GetParent() : root;
+	if (parent != nullptr)
+	{
+		parent->DeleteChilds(go);
+	}
+
+	if (game_object_on_editor == go)
+	{
+		game_object_on_editor = nullptr;
+	}
+
+	game_objects_by_id.erase(go->GetID());
+	scene_objects.Delete(go);
+}
+
+void ModuleGOManager::FlushDeletedGameObjects()
+{
+	//Delete game objects in the vector to delete 
+	vector<GameObject*>::iterator it = to_delete.begin();
+	while (it != to_delete.end())
+	{
+		if (game_object_on_editor == *it)
+		{
+			game_object_on_editor = nullptr;
+		}
+		game_objects_by_id.erase((*it)->GetID());
+		scene_objects.Delete(*it);
+		++it;
+	}
+
+	to_delete.clear();
 }
 
 GameObject* ModuleGOManager::GetRoot() const
@@ -398,20 +790,80 @@ void ModuleGOManager::DoPreUpdate(float dt	,GameObject * go)
 	}
 }
 
-void ModuleGOManager::UpdateChilds(float dt, GameObject * go)
+void ModuleGOManager::UpdateComponents(float dt)
 {
-	if (root != go)
+	//Every pool in memory order instead of walking the tree, transforms are already done
+	mesh_pool.ForEach([dt](ComponentMesh* component) { component->Update(dt); });
+	material_pool.ForEach([dt](ComponentMaterial* component) { component->Update(dt); });
+	camera_pool.ForEach([dt](ComponentCamera* component) { component->Update(dt); });
+}
+
+void ModuleGOManager::FrustumCulling()
+{
+	visible.clear();
+
+	if (culling_camera != nullptr && culling_camera->culling)
 	{
-		go->Update(dt);
+		if (hierarchical_culling)
+		{
+			octree.FrustumCulling(culling_camera, visible);
+		}
+		else
+		{
+			octree.FrustumCullingBruteForce(culling_camera, visible);
+		}
 	}
-
-	vector<GameObject*>::const_iterator it = go->childs.begin();
-	while (it != go->childs.end())
+	else
 	{
-		UpdateChilds(dt, (*it));
-		++it;
+		octree.CollectObjects(visible);
 	}
 }
 
+void ModuleGOManager::InvalidateStaticBatch()
+{
+	static_batch_dirty = true;
+}
+
+void ModuleGOManager::BuildStaticBatch()
+{
+	std::vector<ComponentMesh*> static_meshes;
+	bool streaming = false;
 
+	mesh_pool.ForEach([&static_meshes, &streaming](ComponentMesh* component)
+	{
+		component->static_range = -1;
+		if (component->is_static == false || component->mesh == nullptr)
+		{
+			return;
+		}
 
+		if (component->placed)
+		{
+			static_meshes.push_back(component);
+		}
+		else if (component->mesh->request == nullptr || component->mesh->request->GetState() != LoadRequest::FAILED)
+		{
+			streaming = true;
+		}
+	});
+
+	//Drawn one by one until every static mesh is in
+	if (streaming)
+	{
+		return;
+	}
+
+	App->renderer3D->BuildStaticBatch(static_meshes);
+	static_batch_dirty = false;
+}
+
+void ModuleGOManager::DrawVisible() const
+{
+	vector<GameObject*>::const_iterator it = visible.begin();
+	while (it != visible.end())
+	{
+		ComponentMesh* cmp_mesh = (ComponentMesh*)(*it)->GetComponent(Component::MESH);
+		cmp_mesh->Draw();
+		++it;
+	}
+}
@@ -4,10 +4,21 @@
 #include "Globals.h"
 #include "Module.h"
 #include "ComponentCamera.h"
-#include "Quadtree.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "ComponentTransform.h"
+#include "ComponentPool.h"
+#include "Octree.h"
+#include "TransformSystem.h"
+#include "SceneArena.h"
+#include "SceneSnapshot.h"
+#include "GameObject.h"
 #include <list>
+#include <unordered_map>
+#include <random>
 
 class GameObject;
+class SceneReader;
 
 class ModuleGOManager : public Module
 {
@@ -21,10 +32,15 @@ public:
 	update_status PreUpdate(float dt);
 	update_status Update(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	GameObject* CreateGameObject(GameObject* parent,const char* name);
 	void DeleteGameObject(GameObject* go);
 
+	//Components live in one pool per type, GameObject::AddComponent comes here
+	Component* CreateComponent(Component::Types type);
+	void DestroyComponent(Component* component);
+
 	void HierarchyInfo();
 	void ShowGameObjectsOnEditor(const std::vector<GameObject*>* childs);
 	void EditorWindow();
@@ -32,27 +48,65 @@ public:
 	GameObject* SelectGameObject(const LineSegment& ray, const vector<GameObject*> hits);
 	vector<GameObject*> CollectHits(const LineSegment& ray) const;
 
+	//Files ending in .scn are saved binary, loading looks at the file itself
 	void SaveGameObjectsOnScene(const char* name_file) const;
 	GameObject* LoadGameObjectsOnScene(Json& game_objects);
-	GameObject* SearchGameObjectsByID(GameObject* first_go, int id) const;
-	void InsertObjects();
+	GameObject* LoadGameObjectsOnScene(const SceneReader& scene, uint index);
+
+	//Every GameObject of the scene by its id, ids are never repeated
+	UID GenerateUID();
+	GameObject* FindGameObject(UID id) const;
 
 
 	void LoadScene(const char* directory);
-	void DeleteScene();
+	bool ConvertScene(const char* directory) const;		// .json to .scn or back, next to it and without loading it
+	void DeleteScene();		// Everything at once, the arena is reset
+
+	//Play keeps the scene in memory, Stop puts back only the objects changed since then
+	void TakeSnapshot();
+	void RestoreSnapshot();
+	void NotifyChanged(const GameObject* go);
 
 	GameObject* GetRoot() const;
 
 	void DoPreUpdate(float dt, GameObject* go);
-	void UpdateChilds(float dt, GameObject* go);
+	void UpdateComponents(float dt);
+	void FrustumCulling();
+	void DrawVisible() const;
+
+	//Static meshes are merged again in the next Update
+	void InvalidateStaticBatch();
 
 public:
-	Quadtree quad;
+	ComponentCamera* culling_camera = nullptr;		// Set by the scene, cleared when its camera goes
+	Octree octree;
+	TransformSystem transforms;
+
+	ComponentPool<ComponentTransform> transform_pool;
+	ComponentPool<ComponentMesh> mesh_pool;
+	ComponentPool<ComponentMaterial> material_pool;
+	ComponentPool<ComponentCamera> camera_pool;
+
+	SceneArena<GameObject> scene_objects;		// Every GameObject of the scene
+	SceneSnapshot snapshot;
+
+private:
+	void RegisterGameObject(GameObject* go);
+	GameObject* AddLoadedGameObject(const char* name, UID id, UID parent_id, bool enabled);
+	void RestoreGameObject(const SceneReader& scene, uint index);
+	void RemoveGameObjectNow(GameObject* go);		// With its childs, no waiting for PreUpdate
+	void FlushDeletedGameObjects();
+	void BuildStaticBatch();
+	bool hierarchical_culling = true;		// False tests every box, no octree pruning
+	std::vector<GameObject*> visible;		// Objects that passed the culling this frame
+	bool static_batch_dirty = false;
 
 private:
 	GameObject* root = nullptr;
 	GameObject* game_object_on_editor = nullptr;
 	vector<GameObject*> to_delete;
+	std::unordered_map<UID, GameObject*> game_objects_by_id;
+	std::mt19937_64 uid_generator;
 
 
 
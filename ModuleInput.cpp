@@ -136,6 +136,15 @@ bool ModuleInput::CleanUp()
 	return true;
 }
 
+void ModuleInput::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//SDL events and ImGui, resizing changes the camera too
+	if (phase == FRAME_PRE_UPDATE)
+	{
+		access.writes = RESOURCE_INPUT | RESOURCE_CAMERA | RESOURCE_GL;
+	}
+}
+
 void ModuleInput::getMousePosition(float2 & p) const
 {
 	p.x = mouse_x;
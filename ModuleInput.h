@@ -25,6 +25,7 @@ public:
 	bool Init(Json& config);
 	update_status PreUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	KEY_STATE GetKey(int id) const
 	{
@@ -6,11 +6,20 @@
 #include "ComponentMesh.h"
 #include "ComponentMaterial.h"
 #include "ModuleTextures.h"
+#include "Timer.h"
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "TriangleBVH.h"
 #include "Glew\include\glew.h"
 #include <gl/GL.h>
+#include <psapi.h>
 
+#pragma comment (lib, "psapi.lib")
 
-ModuleMesh::ModuleMesh(Application * app, const char* name, bool start_enabled) : Module(app, name, start_enabled)
+
+ModuleMesh::ModuleMesh(Application * app, const char* name, bool start_enabled) : Module(app, name, start_enabled),
+	mesh_cache([this](const char* path) { return RequestMesh(path); }, [this](Mesh* m) { FreeMesh(m); })
 {
 }
 
@@ -28,6 +37,8 @@ bool ModuleMesh::Init(Json& config)
 	stream = aiGetPredefinedLogStream(aiDefaultLogStream_DEBUGGER, nullptr);
 	aiAttachLogStream(&stream);
 
+	import_db.Load(IMPORT_DATABASE);
+
 	return ret;
 }
 
@@ -40,10 +51,17 @@ bool ModuleMesh::Start()
 
 bool ModuleMesh::CleanUp()
 {
+	LOG("Mesh cache: %d hits, %d loads, %d evicted", mesh_cache.GetHits(), mesh_cache.GetMisses(), mesh_cache.GetNumEvicted());
+	mesh_cache.Clear();
 	aiDetachAllLogStreams();
 	return true;
 }
 
+void ModuleMesh::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Loads are streamed by the loader, nothing to do in the frame
+}
+
 
 update_status ModuleMesh::PreUpdate(float dt)
 {
@@ -63,44 +81,48 @@ update_status ModuleMesh::PostUpdate(float dt)
 
 bool ModuleMesh::LoadFBX(const char* path)
 {
-	bool ret;
-	char* buffer;
+	bool ret = false;
+	char* buffer = nullptr;
+	Timer load_timer;
+	bytes_loaded = 0;
+	meshes_loaded = 0;
+
 	string path_s = path;
 	string scene_folder = LIBRARY_DIRECTORY;
 
 	uint size = App->fs->Load(path, &buffer);
+	uint64_t source_hash = 0;
+	bool up_to_date = false;
 
 	if (size > 0)
 	{		
 		scene_folder.append(path_s.substr(path_s.find_last_of("/\\") + 1));
 
-		size_t name_size = scene_folder.find(".fbx");
+		size_t name_size = scene_folder.find_last_of(".");
 		if (name_size != string::npos)
 		{
 		scene_folder = scene_folder.substr(0, name_size);
 		}
 
-		// We check if the scene is already in our library folder
-			if (App->fs->Exists(scene_folder.data()) == false)
-			{
-				// Is not there so we create the folder
-				App->fs->MakeDirectory(scene_folder.data());
-
-				//Append the mesh folder to the directory folder
-				string mesh_folder = scene_folder;
-				mesh_folder.append(MESH_FOLDER);
-				App->fs->MakeDirectory(mesh_folder.data());
-
-				//Append the texture folder to the directory folder
-				string tx_folder = scene_folder;
-				tx_folder.append(TEXTURE_FOLDER);
-				App->fs->MakeDirectory(tx_folder.data());
-			}
-			else
-			{
-				//Scene folder already exists
-				scene_found = true;
-			}
+		//Skip the import when the same file was already imported with the same settings
+		source_hash = Hash64(buffer, size);
+		up_to_date = import_db.IsUpToDate(path, source_hash, GetImportSettings()) && App->fs->Exists(scene_folder.data());
+
+		if (up_to_date == false)
+		{
+			//Make sure the library folders are there
+			App->fs->MakeDirectory(scene_folder.data());
+
+			//Append the mesh folder to the directory folder
+			string mesh_folder = scene_folder;
+			mesh_folder.append(MESH_FOLDER);
+			App->fs->MakeDirectory(mesh_folder.data());
+
+			//Append the texture folder to the directory folder
+			string tx_folder = scene_folder;
+			tx_folder.append(TEXTURE_FOLDER);
+			App->fs->MakeDirectory(tx_folder.data());
+		}
 	}
 
 	const aiScene* scene = aiImportFileFromMemory(buffer, size, aiProcessPreset_TargetRealtime_MaxQuality, NULL);
@@ -109,26 +131,305 @@ bool ModuleMesh::LoadFBX(const char* path)
 	if (scene != nullptr && scene->HasMeshes())
 	{
 		aiNode* root_node = scene->mRootNode;
+
+		ImportPlan plan;
+		plan.scene_folder = scene_folder;
+		plan.mesh_files.resize(scene->mNumMeshes);
+		plan.mesh_hashes.resize(scene->mNumMeshes, 0);
+
+		for (int i = 0; i < root_node->mNumChildren; i++)
+		{
+			PlanImport(root_node->mChildren[i], scene, plan);
+		}
+
+		if (up_to_date == false)
+		{
+			//Old results can only be reused if they were made with the same settings
+			const ImportRecord* previous = import_db.Find(path);
+			if (previous != nullptr && previous->settings != GetImportSettings())
+			{
+				previous = nullptr;
+			}
+
+			RunImport(scene, plan, previous);
+			UpdateImportRecord(path, source_hash, plan);
+		}
+
+		//GameObjects and GL buffers are created on the main thread
 		for (int i = 0; i < root_node->mNumChildren; i++)
 		{
-			Load(root_node->mChildren[i], scene, nullptr, scene_folder.data());
+			Load(root_node->mChildren[i], scene, nullptr, plan);
 		}	
 		aiReleaseImport(scene);
 
 		ret = true;
-		scene_found = false;
 	}
 	else
 	{
-		LOG("Error: %s", path, aiGetErrorString());
+		LOG("Error loading %s: %s", path, aiGetErrorString());
 	}
 
 	delete[] buffer;
 	buffer = nullptr;
+
+	LogLoadStats(path, load_timer.Read());
+
 	return ret;
 }
 
-void ModuleMesh::Load(aiNode * node, const aiScene * scene, GameObject* parent, const char* scene_folder)
+void ModuleMesh::LogLoadStats(const char* path, uint ms) const
+{
+	float mb = bytes_loaded / (1024.0f * 1024.0f);
+	float mb_per_second = (ms > 0) ? mb / (ms / 1000.0f) : 0.0f;
+
+	PROCESS_MEMORY_COUNTERS memory;
+	memory.cb = sizeof(memory);
+	float peak_rss = 0.0f;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory)))
+	{
+		peak_rss = memory.PeakWorkingSetSize / (1024.0f * 1024.0f);
+	}
+
+	LOG("Loaded %s: %d meshes, %.2f MB in %d ms (%.2f MB/s), peak RSS %.2f MB, %d loads still streaming", path, meshes_loaded, mb, ms, mb_per_second, peak_rss, App->loader->GetNumInFlight());
+	LOG("Mesh cache: %d resident, %.2f MB, %d hits, %d loads", mesh_cache.GetNumResident(), mesh_cache.GetResidentBytes() / (1024.0f * 1024.0f), mesh_cache.GetHits(), mesh_cache.GetMisses());
+}
+
+bool ModuleMesh::IsDummyNode(const aiNode* node) const
+{
+	//Ignore Assimp trash
+	static const char* dummies[5] = { "$AssimpFbx$_PreRotation","$AssimpFbx$_Rotation","$AssimpFbx$_PostRotation","$AssimpFbx$_Scaling","$AssimpFbx$_Translation" };
+
+	if (node->mNumChildren == 1)
+	{
+		for (int i = 0; i < 5; ++i)
+		{
+			if (((string)(node->mName.C_Str())).find(dummies[i]) != string::npos)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+string ModuleMesh::GetMeshName(const aiNode* node) const
+{
+	if (node->mName.length > 0)
+	{
+		return node->mName.C_Str();
+	}
+	return "Unnamed_mesh";
+}
+
+string ModuleMesh::GetTextureName(const aiScene* scene, const aiMesh* mesh) const
+{
+	string name_texture;
+
+	if (scene->HasMaterials())
+	{
+		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+		aiString path;
+		material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
+		if (path.length > 0)
+		{
+			string directory = path.data;
+			name_texture.assign(directory.substr(directory.find_last_of("/\\") + 1));
+		}
+	}
+
+	return name_texture;
+}
+
+void ModuleMesh::PlanImport(aiNode* node, const aiScene* scene, ImportPlan& plan) const
+{
+	while (IsDummyNode(node))
+	{
+		node = node->mChildren[0];
+	}
+
+	for (uint i = 0; i < node->mNumMeshes; i++)
+	{
+		uint mesh_index = node->mMeshes[i];
+		aiMesh* mesh = scene->mMeshes[mesh_index];
+
+		//Meshes shared by several nodes are imported once, with the first name found
+		if (plan.mesh_files[mesh_index].empty())
+		{
+			string name = GetMeshName(node);
+			mesh->mName = name;
+
+			string path_mesh = plan.scene_folder;
+			path_mesh.append(MESH_FOLDER);
+			path_mesh.append(name);
+			path_mesh.append(".shl");
+
+			//Different meshes with the same name end up in the same file, the first one wins
+			bool file_taken = false;
+			for (uint j = 0; j < plan.meshes_to_import.size(); j++)
+			{
+				if (plan.mesh_files[plan.meshes_to_import[j]] == path_mesh)
+				{
+					file_taken = true;
+					break;
+				}
+			}
+
+			plan.mesh_files[mesh_index] = path_mesh;
+			if (file_taken == false)
+			{
+				plan.meshes_to_import.push_back(mesh_index);
+			}
+		}
+
+		string name_texture = GetTextureName(scene, mesh);
+		if (name_texture.empty() == false)
+		{
+			//Inserted now so the workers never modify the map, only its values
+			PlannedTexture& texture = plan.textures[name_texture];
+			texture.file = plan.scene_folder;
+			texture.file.append(TEXTURE_FOLDER);
+			texture.file.append(name_texture);
+			texture.file.append(".dds");
+		}
+	}
+
+	for (uint i = 0; i < node->mNumChildren; i++)
+	{
+		PlanImport(node->mChildren[i], scene, plan);
+	}
+}
+
+void ModuleMesh::RunImport(const aiScene* scene, ImportPlan& plan, const ImportRecord* previous)
+{
+	Timer import_timer;
+	JobCounter counter;
+	std::atomic<int> meshes_imported(0);
+	std::atomic<int> textures_imported(0);
+
+	for (uint i = 0; i < plan.meshes_to_import.size(); i++)
+	{
+		const aiMesh* mesh = scene->mMeshes[plan.meshes_to_import[i]];
+		string* output_file = &plan.mesh_files[plan.meshes_to_import[i]];
+		uint64_t* hash = &plan.mesh_hashes[plan.meshes_to_import[i]];
+		const char* scene_folder = plan.scene_folder.data();
+
+		App->jobs->Schedule([this, mesh, output_file, hash, scene_folder, previous, &meshes_imported]()
+		{
+			//Only the meshes that changed since the last import are converted
+			*hash = HashMesh(mesh);
+			if (previous != nullptr)
+			{
+				unordered_map<string, ImportArtifact>::const_iterator artifact = previous->artifacts.find(*output_file);
+				if (artifact != previous->artifacts.end() && artifact->second.hash == *hash && App->fs->Exists(output_file->data()))
+				{
+					return;
+				}
+			}
+
+			ImportMesh(mesh, *output_file, scene_folder);
+			meshes_imported++;
+		}, &counter);
+	}
+
+	map<string, PlannedTexture>::iterator it = plan.textures.begin();
+	while (it != plan.textures.end())
+	{
+		const string* name_texture = &it->first;
+		PlannedTexture* texture = &it->second;
+
+		App->jobs->Schedule([this, name_texture, texture, previous, &textures_imported]()
+		{
+			string tx_directory = ASSETS_TEXTURES;
+			tx_directory.append(*name_texture);
+
+			char* buffer = nullptr;
+			uint size = App->fs->Load(tx_directory.data(), &buffer);
+			texture->hash = (size > 0) ? Hash64(buffer, size) : 0;
+			delete[] buffer;
+
+			if (previous != nullptr)
+			{
+				unordered_map<string, ImportArtifact>::const_iterator artifact = previous->artifacts.find(texture->file);
+				if (artifact != previous->artifacts.end() && artifact->second.hash == texture->hash && App->fs->Exists(texture->file.data()))
+				{
+					return;
+				}
+			}
+
+			App->tex->ImportTexture(tx_directory.data(), texture->file);
+			textures_imported++;
+		}, &counter);
+		++it;
+	}
+
+	//The main thread helps until everything is done
+	App->jobs->Wait(counter);
+
+	LOG("Imported %d of %d meshes and %d of %d textures in %d ms using %d workers", meshes_imported.load(), plan.meshes_to_import.size(), textures_imported.load(), plan.textures.size(), import_timer.Read(), App->jobs->GetNumWorkers());
+}
+
+void ModuleMesh::UpdateImportRecord(const char* path, uint64_t hash, const ImportPlan& plan)
+{
+	ImportRecord& record = import_db.Get(path);
+	record.hash = hash;
+	record.settings = GetImportSettings();
+	record.artifacts.clear();
+
+	for (uint i = 0; i < plan.meshes_to_import.size(); i++)
+	{
+		uint mesh_index = plan.meshes_to_import[i];
+		record.artifacts[plan.mesh_files[mesh_index]].hash = plan.mesh_hashes[mesh_index];
+	}
+
+	map<string, PlannedTexture>::const_iterator it = plan.textures.begin();
+	while (it != plan.textures.end())
+	{
+		record.artifacts[it->second.file].hash = it->second.hash;
+		++it;
+	}
+
+	import_db.Save(IMPORT_DATABASE);
+}
+
+uint64_t ModuleMesh::HashMesh(const aiMesh* mesh) const
+{
+	uint64_t hash = Hash64(mesh->mVertices, sizeof(aiVector3D) * mesh->mNumVertices);
+
+	if (mesh->HasNormals())
+	{
+		hash = Hash64(mesh->mNormals, sizeof(aiVector3D) * mesh->mNumVertices, hash);
+	}
+
+	if (mesh->HasTextureCoords(0))
+	{
+		hash = Hash64(mesh->mTextureCoords[0], sizeof(aiVector3D) * mesh->mNumVertices, hash);
+	}
+
+	for (uint i = 0; i < mesh->mNumFaces; i++)
+	{
+		hash = Hash64(mesh->mFaces[i].mIndices, sizeof(uint) * mesh->mFaces[i].mNumIndices, hash);
+	}
+
+	return hash;
+}
+
+uint64_t ModuleMesh::GetImportSettings() const
+{
+	//Anything that changes the generated files must be here
+	uint settings[5] =
+	{
+		aiProcessPreset_TargetRealtime_MaxQuality,
+		SHL_VERSION,
+		DDS_IMPORT_VERSION,
+		(optimize_meshes) ? 1u : 0u,
+		(generate_lods) ? 1u : 0u
+	};
+
+	return Hash64(settings, sizeof(settings));
+}
+
+void ModuleMesh::Load(aiNode * node, const aiScene * scene, GameObject* parent, const ImportPlan& plan)
 {
 	//Transform
 
@@ -164,19 +465,13 @@ void ModuleMesh::Load(aiNode * node, const aiScene * scene, GameObject* parent,
 
 
 	//Ignore Assimp trash
-	static const char* dummies[5] =	{"$AssimpFbx$_PreRotation","$AssimpFbx$_Rotation","$AssimpFbx$_PostRotation","$AssimpFbx$_Scaling","$AssimpFbx$_Translation"};
-
-	for (int i = 0; i < 5; ++i)
+	while (IsDummyNode(node))
 	{
-		if (((string)(node->mName.C_Str())).find(dummies[i]) != string::npos && node->mNumChildren == 1)
-		{
-			node = node->mChildren[0];
-			node->mTransformation.Decompose(scaling, rotation, translation);
-			translate += float3(translation.x, translation.y, translation.z);
-			scale = float3(scale.x * scaling.x, scale.y * scaling.y, scale.z * scaling.z);
-			rot = rot * Quat(rotation.x, rotation.y, rotation.z, rotation.w);
-			i = -1;
-		}
+		node = node->mChildren[0];
+		node->mTransformation.Decompose(scaling, rotation, translation);
+		translate += float3(translation.x, translation.y, translation.z);
+		scale = float3(scale.x * scaling.x, scale.y * scaling.y, scale.z * scaling.z);
+		rot = rot * Quat(rotation.x, rotation.y, rotation.z, rotation.w);
 	}
 
 	transformation->SetTranslation(translate);
@@ -201,40 +496,14 @@ void ModuleMesh::Load(aiNode * node, const aiScene * scene, GameObject* parent,
 				game_object = root_game_object;
 			}
 
-			if (node->mName.length >0)
-			{
-				game_object->name_object = node->mName.C_Str();
-			}
-			else
-			{
-				game_object->name_object = "Unnamed_mesh";
-			}
+			game_object->name_object = GetMeshName(node);
 		
 
 		//Meshes
 		ComponentMesh* comp_mesh = (ComponentMesh*)game_object->AddComponent(Component::MESH);
 
-		new_mesh->mName = game_object->name_object;
-
-		//Import the meshes 
-
-		string path_mesh;
-
-		if (!scene_found)
-		{
-			ImportMesh(new_mesh, path_mesh, scene_folder);
-		}
-		else
-		{
-			const char* ext = ".shl";
-			path_mesh = scene_folder;
-			path_mesh.append(MESH_FOLDER);
-			path_mesh.append(new_mesh->mName.C_Str());
-			path_mesh.append(ext);
-		}
-
 		Mesh* m = nullptr;
-		m = LoadMesh(path_mesh.data());
+		m = AcquireMesh(plan.mesh_files[node->mMeshes[i]].data());
 		
 		// Set mesh with all the information
 		comp_mesh->SetMesh(m);
@@ -242,35 +511,24 @@ void ModuleMesh::Load(aiNode * node, const aiScene * scene, GameObject* parent,
 		
 
 		//Copy Materials------------------------------------------------------------------------------
-		if (scene->HasMaterials())
+		string name_texture = GetTextureName(scene, new_mesh);
+		if (m != nullptr && name_texture.empty() == false)
 		{
-			aiMaterial* material = scene->mMaterials[new_mesh->mMaterialIndex];
+			m->tx_directory.assign(ASSETS_TEXTURES);
+			m->tx_directory.append(name_texture);
 
-	
-				aiString path;
-				material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
-				if (path.length > 0)
-				{
-					string directory = path.data;
-					string name_texture;
-
-					m->tx_directory.assign(ASSETS_TEXTURES);
-					name_texture.assign(directory.substr(directory.find_last_of("/\\") + 1));
-					m->tx_directory.append(name_texture);
-
-					ComponentMaterial* comp_material = (ComponentMaterial*)game_object->AddComponent(Component::MATERIAL);
-					string name_tex_of;
-					App->tex->ImportTexture(name_texture.data(), m->tx_directory.data(), name_tex_of, scene_folder);
-					comp_material->texture_id = App->tex->LoadTexture(name_tex_of.data());
-					comp_material->directory = name_tex_of;
-			}
+			const string& name_tex_of = plan.textures.at(name_texture).file;
+
+			ComponentMaterial* comp_material = (ComponentMaterial*)game_object->AddComponent(Component::MATERIAL);
+			comp_material->RequestTexture(name_tex_of.data());
+			comp_material->directory = name_tex_of;
 		}	
 	}
 
 	//Load for all the childs 
 	for (uint i = 0; i < node->mNumChildren; i++)
 	{
-		Load(node->mChildren[i], scene, root_game_object,scene_folder);
+		Load(node->mChildren[i], scene, root_game_object, plan);
 	}
 
 }
@@ -280,114 +538,320 @@ bool ModuleMesh::ImportMesh(const aiMesh * mesh, string & output_file, const cha
 	bool ret = false;
 	Mesh m;
 
-	//Copy vertices
-	m.num_vertices = mesh->mNumVertices;
-	m.vertices = new float[m.num_vertices*3];
-	memcpy(m.vertices, mesh->mVertices, sizeof(float) * m.num_vertices*3);
-
-	//Copy Normals
-	if (mesh->HasNormals())
-	{
-		m.num_normal = mesh->mNumVertices;
-		m.normals = new float[m.num_normal*3];
-		memcpy(m.normals, mesh->mNormals, sizeof(float) * m.num_normal*3);
-	}
-
-
 	//Copy indices
+	uint num_indices = 0;
+	uint* indices = nullptr;
 	if (mesh->HasFaces())
 	{
-		m.num_indices = mesh->mNumFaces * 3;
-		m.indices = new uint[m.num_indices];
+		num_indices = mesh->mNumFaces * 3;
+		indices = new uint[num_indices];
 		for (unsigned int j = 0; j < mesh->mNumFaces; j++)
 		{
 			if (mesh->mFaces[j].mNumIndices != 3)
 			{
 				LOG("WARNING, Geometry with more/less than 3 faces wants to be loaded");
+				memset(&indices[j * 3], 0, sizeof(uint) * 3);
 			}
 			else
 			{
-				memcpy(&m.indices[j * 3], mesh->mFaces[j].mIndices, sizeof(uint) * 3);
+				memcpy(&indices[j * 3], mesh->mFaces[j].mIndices, sizeof(uint) * 3);
 			}
 		}
 	}
 
-	//Copy UV
+	//Vertices, normals and UVs are read in place from Assimp and packed
 	uint uv_id = 0;
-	if (mesh->HasTextureCoords(uv_id))
+	const float* normals = (mesh->HasNormals()) ? (const float*)mesh->mNormals : nullptr;
+	const float* uvs = (mesh->HasTextureCoords(uv_id)) ? (const float*)mesh->mTextureCoords[uv_id] : nullptr;
+
+	PackMesh(&m, (const float*)mesh->mVertices, normals, uvs, 3, mesh->mNumVertices, indices, num_indices);
+
+	m.name_mesh = mesh->mName.C_Str();
+
+	if (optimize_meshes)
 	{
-		m.num_uv = mesh->mNumVertices;
-		m.uvs = new float[m.num_uv*2];
-		for (uint k = 0; k < m.num_uv; k++)
-		{
-			memcpy(&m.uvs[k*2], &mesh->mTextureCoords[uv_id][k].x, sizeof(float));
-			memcpy(&m.uvs[(k*2) + 1], &mesh->mTextureCoords[uv_id][k].y, sizeof(float));
-		
-		}
+		OptimizeMesh(&m, indices);
 	}
 
-	m.name_mesh = mesh->mName.C_Str();
+	if (generate_lods)
+	{
+		GenerateLods(&m, indices);
+	}
 
 	ret = SaveMesh(m, output_file, scene_folder);
 
+	delete[] indices;
+
 	return ret;
 }
 
-bool ModuleMesh::SaveMesh(Mesh& mesh, string& output_file, const char* scene_folder)
+// Next offset aligned to SHL_ALIGNMENT
+//In 64 bits, a corrupt count can't wrap the end back inside the file
+static bool InFile(uint offset, uint count, uint element_size, uint size)
 {
-	bool ret = false;
-	uint header[4] =
+	return offset + (unsigned long long)count * element_size <= size;
+}
+
+// Every index of the range points to one of the vertices
+static bool IndicesInRange(const void* indices, uint index_size, uint first, uint count, uint num_vertices)
+{
+	uint max_index = 0;
+	if (index_size == sizeof(unsigned short))
 	{
-		mesh.num_indices,
-		mesh.num_vertices,
-		(mesh.normals) ? mesh.num_vertices : 0,
-		mesh.num_uv
-	};
+		const unsigned short* short_indices = (const unsigned short*)indices + first;
+		for (uint i = 0; i < count; i++)
+		{
+			max_index = (short_indices[i] > max_index) ? short_indices[i] : max_index;
+		}
+	}
+	else
+	{
+		const uint* uint_indices = (const uint*)indices + first;
+		for (uint i = 0; i < count; i++)
+		{
+			max_index = (uint_indices[i] > max_index) ? uint_indices[i] : max_index;
+		}
+	}
+	return count == 0 || max_index < num_vertices;
+}
+
+static uint AlignOffset(uint offset)
+{
+	return (offset + SHL_ALIGNMENT - 1) & ~(SHL_ALIGNMENT - 1);
+}
+
+// Allocates the mesh buffer for the given counts and points the mesh to it
+static void AllocateMeshBuffer(Mesh* m, uint num_vertices, uint num_indices)
+{
+	m->num_vertices = num_vertices;
+	m->num_indices = num_indices;
+	m->index_size = (num_vertices < 65536) ? sizeof(unsigned short) : sizeof(uint);
+
+	m->num_lods = 1;
+	m->lods[0].first_index = 0;
+	m->lods[0].num_indices = num_indices;
+	m->lods[0].error = 0.0f;
 
-	uint size = sizeof(header) + sizeof(uint) * header[0] + sizeof(float)  * header[1] * 3;
-	if (header[2] != 0)
+	uint indices_offset = AlignOffset(sizeof(PackedVertex) * num_vertices);
+	delete[] m->buffer;
+	m->buffer = new char[indices_offset + m->index_size * num_indices];
+
+	m->vertices = (const PackedVertex*)m->buffer;
+	m->indices = m->buffer + indices_offset;
+}
+
+// Writes 32 bit indices with the index size of the mesh
+static void WriteMeshIndices(Mesh* m, const uint* indices, uint num_indices)
+{
+	if (m->index_size == sizeof(unsigned short))
 	{
-		size += sizeof(float)  * header[2] * 3;
+		unsigned short* short_indices = (unsigned short*)m->indices;
+		for (uint i = 0; i < num_indices; i++)
+		{
+			short_indices[i] = (unsigned short)indices[i];
+		}
 	}
+	else
+	{
+		memcpy((void*)m->indices, indices, sizeof(uint) * num_indices);
+	}
+}
 
-	size += sizeof(float) * header[3] * 2;
+void ModuleMesh::PackMesh(Mesh* m, const float* vertices, const float* normals, const float* uvs, uint uv_stride, uint num_vertices, const uint* indices, uint num_indices) const
+{
+	AllocateMeshBuffer(m, num_vertices, num_indices);
+	m->num_normal = (normals != nullptr) ? num_vertices : 0;
+	m->num_uv = (uvs != nullptr) ? num_vertices : 0;
 
-	char* data = new char[size];
-	char* cursor = data;
+	m->bounds.SetNegativeInfinity();
+	if (num_vertices > 0)
+	{
+		m->bounds.Enclose((const float3*)vertices, num_vertices);
+	}
+	else
+	{
+		m->bounds.SetFromCenterAndSize(float3::zero, float3::zero);
+	}
 
-	//Header
-	uint bytes = sizeof(header);
-	memcpy(cursor, header, bytes);
+	PackedVertex* packed = (PackedVertex*)m->buffer;
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		QuantizePosition(float3(&vertices[i * 3]), m->bounds, packed[i].position);
 
-	cursor += bytes;
-	
-	//Indices
-	bytes = sizeof(uint) * header[0];
-	memcpy(cursor, mesh.indices, bytes);
+		if (normals != nullptr)
+		{
+			OctahedralEncode(float3(&normals[i * 3]), packed[i].normal);
+		}
+		else
+		{
+			packed[i].normal[0] = packed[i].normal[1] = 0;
+		}
 
-	cursor += bytes;
+		if (uvs != nullptr)
+		{
+			packed[i].uv[0] = FloatToHalf(uvs[i * uv_stride]);
+			packed[i].uv[1] = FloatToHalf(uvs[i * uv_stride + 1]);
+		}
+		else
+		{
+			packed[i].uv[0] = packed[i].uv[1] = 0;
+		}
+	}
 
-	//Vertices
-	bytes = sizeof(float) * header[1] * 3;
-	memcpy(cursor, mesh.vertices, bytes);
+	WriteMeshIndices(m, indices, num_indices);
+}
+
+void ModuleMesh::OptimizeMesh(Mesh* m, uint* indices) const
+{
+	uint num_indices = m->num_indices;
+	uint num_vertices = m->num_vertices;
+	if (num_indices < 3)
+	{
+		return;
+	}
+
+	float acmr_start = AnalyzeVertexCache(indices, num_indices, num_vertices);
+
+	//Deduplicate on the packed data, vertices that quantize the same are merged too
+	std::vector<uint> remap(num_vertices);
+	std::vector<PackedVertex> vertices(num_vertices);
+	uint unique_vertices = GenerateVertexRemap(remap.data(), indices, num_indices, m->vertices, num_vertices, sizeof(PackedVertex));
+	RemapVertexBuffer(vertices.data(), m->vertices, num_vertices, sizeof(PackedVertex), remap.data());
+	RemapIndexBuffer(indices, indices, num_indices, remap.data());
+	vertices.resize(unique_vertices);
+	float acmr_dedup = AnalyzeVertexCache(indices, num_indices, unique_vertices);
+
+	//Vertex cache
+	std::vector<uint> reordered(num_indices);
+	OptimizeVertexCache(reordered.data(), indices, num_indices, unique_vertices);
+	float acmr_cache = AnalyzeVertexCache(reordered.data(), num_indices, unique_vertices);
+
+	//Overdraw, the quantized positions keep the same shape
+	std::vector<float3> positions(unique_vertices);
+	for (uint i = 0; i < unique_vertices; i++)
+	{
+		positions[i] = DequantizePosition(vertices[i].position, m->bounds);
+	}
+	OptimizeOverdraw(indices, reordered.data(), num_indices, positions[0].ptr(), unique_vertices, 3);
+	float acmr_overdraw = AnalyzeVertexCache(indices, num_indices, unique_vertices);
+
+	//Vertex fetch
+	AllocateMeshBuffer(m, unique_vertices, num_indices);
+	unique_vertices = OptimizeVertexFetch((void*)m->vertices, indices, num_indices, vertices.data(), unique_vertices, sizeof(PackedVertex));
+	m->num_vertices = unique_vertices;
+	m->num_normal = (m->num_normal != 0) ? unique_vertices : 0;
+	m->num_uv = (m->num_uv != 0) ? unique_vertices : 0;
+	WriteMeshIndices(m, indices, num_indices);
+	float acmr_fetch = AnalyzeVertexCache(indices, num_indices, unique_vertices);
+
+	LOG("Optimized %s: %d -> %d vertices, ACMR %.3f -> dedup %.3f -> cache %.3f -> overdraw %.3f -> fetch %.3f", m->name_mesh, num_vertices, unique_vertices, acmr_start, acmr_dedup, acmr_cache, acmr_overdraw, acmr_fetch);
+}
 
-	cursor += bytes;
+void ModuleMesh::GenerateLods(Mesh* m, const uint* indices) const
+{
+	uint num_indices = m->num_indices;
+	uint num_vertices = m->num_vertices;
+	if (num_indices < 3)
+	{
+		return;
+	}
+
+	std::vector<float3> positions(num_vertices);
+	for (uint i = 0; i < num_vertices; i++)
+	{
+		positions[i] = DequantizePosition(m->vertices[i].position, m->bounds);
+	}
+
+	//Every level is simplified from the full mesh so its error is the real one
+	std::vector<uint> all_indices(indices, indices + num_indices);
+	std::vector<uint> simplified(num_indices);
+	std::vector<uint> reordered(num_indices);
+	MeshLod lods[SHL_MAX_LODS];
+	lods[0].num_indices = num_indices;
+	uint num_lods = 1;
 
-	//Normals -- Same as vertices so, do nothing on bytes
-	if (header[2] != 0)
+	while (num_lods < SHL_MAX_LODS)
 	{
-		memcpy(cursor, mesh.normals, bytes);
-		cursor += bytes;
+		uint previous = lods[num_lods - 1].num_indices;
+		uint target = (previous / 2) / 3 * 3;
+		float error = 0.0f;
+		uint count = SimplifyMesh(simplified.data(), indices, num_indices, positions[0].ptr(), num_vertices, 3, target, LOD_MAX_ERROR, &error);
+
+		//Not worth a level if it barely removes anything
+		if (count == 0 || count > previous * 3 / 4)
+		{
+			break;
+		}
+
+		OptimizeVertexCache(reordered.data(), simplified.data(), count, num_vertices);
+
+		lods[num_lods].first_index = all_indices.size();
+		lods[num_lods].num_indices = count;
+		lods[num_lods].error = error;
+		all_indices.insert(all_indices.end(), reordered.begin(), reordered.begin() + count);
+		num_lods++;
 	}
 
-	//UVs
-	bytes = sizeof(float) * header[3] * 2;
-	memcpy(cursor, mesh.uvs, bytes);
+	if (num_lods == 1)
+	{
+		return;
+	}
+
+	std::vector<PackedVertex> vertices(m->vertices, m->vertices + num_vertices);
+	AllocateMeshBuffer(m, num_vertices, all_indices.size());
+	memcpy((void*)m->vertices, vertices.data(), sizeof(PackedVertex) * num_vertices);
+	WriteMeshIndices(m, all_indices.data(), all_indices.size());
+
+	m->num_indices = num_indices;
+	m->num_lods = num_lods;
+	memcpy(m->lods, lods, sizeof(lods));
+
+	for (uint i = 1; i < num_lods; i++)
+	{
+		LOG("LOD %d of %s: %d triangles, error %.4f", i, m->name_mesh, lods[i].num_indices / 3, lods[i].error);
+	}
+}
+
+bool ModuleMesh::SaveMesh(Mesh& mesh, string& output_file, const char* scene_folder)
+{
+	bool ret = false;
+
+	ShlHeader header;
+	header.num_indices = mesh.GetTotalIndices();
+	header.num_lods = mesh.num_lods;
+	memcpy(header.lods, mesh.lods, sizeof(header.lods));
+	header.num_vertices = mesh.num_vertices;
+	header.index_size = mesh.index_size;
+	header.flags = ((mesh.num_normal != 0) ? SHL_HAS_NORMALS : 0) | ((mesh.num_uv != 0) ? SHL_HAS_UVS : 0) | ((optimize_meshes) ? SHL_OPTIMIZED : 0);
+	memcpy(header.aabb_min, mesh.bounds.minPoint.ptr(), sizeof(float) * 3);
+	memcpy(header.aabb_max, mesh.bounds.maxPoint.ptr(), sizeof(float) * 3);
+
+	//Layout
+	uint offset = AlignOffset(sizeof(ShlHeader));
+	header.vertices_offset = offset;
+	offset = AlignOffset(offset + sizeof(PackedVertex) * header.num_vertices);
+	header.indices_offset = offset;
+	offset = AlignOffset(offset + header.index_size * header.num_indices);
+	header.file_size = offset;
+
+	char* data = new char[header.file_size];
+	memset(data, 0, header.file_size);
+
+	//Header
+	memcpy(data, &header, sizeof(ShlHeader));
+
+	//Vertices
+	memcpy(data + header.vertices_offset, mesh.vertices, sizeof(PackedVertex) * header.num_vertices);
+
+	//Indices
+	memcpy(data + header.indices_offset, mesh.indices, header.index_size * header.num_indices);
 
-	string scene_directory = scene_folder;
-	scene_directory.append(MESH_FOLDER);
+	output_file = scene_folder;
+	output_file.append(MESH_FOLDER);
+	output_file.append(mesh.name_mesh);
+	output_file.append(".shl");
 
-	ret = App->fs->SaveUnique(mesh.name_mesh, output_file, data, size, scene_directory.data(), "shl");
+	ret = App->fs->Save(output_file.data(), data, header.file_size) > 0;
 
 	delete[] data;
 	data = nullptr;
@@ -396,88 +860,417 @@ bool ModuleMesh::SaveMesh(Mesh& mesh, string& output_file, const char* scene_fol
 	return ret;
 }
 
+Mesh* ModuleMesh::AcquireMesh(const char* path)
+{
+	return mesh_cache.Acquire(path);
+}
+
+void ModuleMesh::ReleaseMesh(Mesh* m)
+{
+	if (m != nullptr)
+	{
+		mesh_cache.Release(m);
+	}
+}
+
+const MeshCache& ModuleMesh::GetMeshCache() const
+{
+	return mesh_cache;
+}
+
 Mesh* ModuleMesh::LoadMesh(const char* path)
 {
-	Mesh* m;
-	char* buffer;
+	Mesh* m = new Mesh();
+	m->directory = path;
+
+	uint size = 0;
+	if (ReadMeshFile(m, path, size) == false)
+	{
+		LOG("Error loading mesh %s", path);
+		delete m;
+		return nullptr;
+	}
+
+	GenerateBuffers(m);
+	m->ready = true;
+	bytes_loaded += size;
+	meshes_loaded++;
+
+	return m;
+}
+
+Mesh* ModuleMesh::RequestMesh(const char* path)
+{
+	Mesh* m = new Mesh();
+	m->directory = path;
+
+	//The worker reads and decodes, the main thread only creates the buffers
+	std::shared_ptr<std::vector<RenderVertex>> render_vertices = std::make_shared<std::vector<RenderVertex>>();
+	std::shared_ptr<uint> size = std::make_shared<uint>(0);
+
+	m->request = App->loader->Request([this, m, render_vertices, size]()
+	{
+		if (ReadMeshFile(m, m->directory.data(), *size) == false)
+		{
+			return false;
+		}
+		DecodeVertices(m, *render_vertices);
+		return true;
+	},
+	[this, m, render_vertices, size](bool loaded)
+	{
+		if (loaded == false)
+		{
+			LOG("Error loading mesh %s", m->directory.data());
+			return 0u;
+		}
+
+		CreateBuffers(m, render_vertices->data());
+		m->ready = true;
+		mesh_cache.UpdateBytes(m);
+		bytes_loaded += *size;
+		meshes_loaded++;
+		return 1u;
+	},
+	[this, m](uint result)
+	{
+		FreeMesh(m);
+	});
+
+	return m;
+}
+
+bool ModuleMesh::ReadMeshFile(Mesh* m, const char* path, uint& size) const
+{
+	bool loaded = false;
+	const char* data = nullptr;
+	size = 0;
 
-	if (App->fs->Load(path, &buffer) != 0)
+	//Map the file and point the mesh to it, nothing is copied on the CPU side
+	if (App->fs->Map(path, m->file))
 	{
-		m = new Mesh();
+		data = m->file.data;
+		size = m->file.size;
+	}
+	else
+	{
+		//Can't be mapped (i.e. inside a zip), read it and point to the buffer
+		size = App->fs->Load(path, &m->buffer);
+		data = m->buffer;
+	}
 
-		m->directory = path;
+	if (size > 0)
+	{
+		loaded = ReadMeshData(m, data, size);
 
-		char* cursor = buffer;
+		if (loaded == false)
+		{
+			//Files written by older versions are converted to the current layout
+			char* old_buffer = m->buffer;
+			m->buffer = nullptr;
+
+			loaded = ReadLegacyMeshData(m, data, size);
 
+			delete[] old_buffer;
+			App->fs->Unmap(m->file);
+		}
+	}
+
+	return loaded;
+}
+
+bool ModuleMesh::ReadMeshData(Mesh* m, const char* data, uint size) const
+{
+	//Revision 2 files end their header before the LODs
+	if (size < offsetof(ShlHeader, num_lods))
+	{
+		return false;
+	}
+
+	const ShlHeader* header = (const ShlHeader*)data;
+	if (header->magic != SHL_MAGIC || (header->version != SHL_VERSION && header->version != 2) || header->file_size > size)
+	{
+		return false;
+	}
+
+	if ((header->index_size != sizeof(unsigned short) && header->index_size != sizeof(uint)) ||
+		InFile(header->vertices_offset, header->num_vertices, sizeof(PackedVertex), size) == false ||
+		InFile(header->indices_offset, header->num_indices, header->index_size, size) == false)
+	{
+		LOG("Mesh file corrupted, data out of bounds");
+		return false;
+	}
+
+	m->num_lods = 1;
+	m->lods[0].first_index = 0;
+	m->lods[0].num_indices = header->num_indices;
+	m->lods[0].error = 0.0f;
+
+	if (header->version == SHL_VERSION)
+	{
+		if (header->header_size < sizeof(ShlHeader) || header->num_lods == 0 || header->num_lods > SHL_MAX_LODS)
+		{
+			LOG("Mesh file corrupted, wrong LOD count");
+			return false;
+		}
+
+		for (uint i = 0; i < header->num_lods; i++)
+		{
+			if (InFile(header->lods[i].first_index, header->lods[i].num_indices, 1, header->num_indices) == false)
+			{
+				LOG("Mesh file corrupted, LOD out of bounds");
+				return false;
+			}
+		}
+
+		m->num_lods = header->num_lods;
+		memcpy(m->lods, header->lods, sizeof(m->lods));
+	}
+
+	for (uint i = 0; i < m->num_lods; i++)
+	{
+		if (IndicesInRange(data + header->indices_offset, header->index_size, m->lods[i].first_index, m->lods[i].num_indices, header->num_vertices) == false)
+		{
+			LOG("Mesh file corrupted, index out of bounds");
+			return false;
+		}
+	}
+
+	m->num_indices = m->lods[0].num_indices;
+	m->num_vertices = header->num_vertices;
+	m->index_size = header->index_size;
+	m->num_normal = (header->flags & SHL_HAS_NORMALS) ? header->num_vertices : 0;
+	m->num_uv = (header->flags & SHL_HAS_UVS) ? header->num_vertices : 0;
+	m->bounds = AABB(float3(header->aabb_min), float3(header->aabb_max));
+
+	m->vertices = (const PackedVertex*)(data + header->vertices_offset);
+	m->indices = data + header->indices_offset;
+
+	return true;
+}
+
+bool ModuleMesh::ReadLegacyMeshData(Mesh* m, const char* data, uint size) const
+{
+	const uint* indices = nullptr;
+	const float* vertices = nullptr;
+	const float* normals = nullptr;
+	const float* uvs = nullptr;
+	uint num_indices = 0;
+	uint num_vertices = 0;
+
+	if (size >= sizeof(uint) * 2 && ((const uint*)data)[0] == SHL_MAGIC && ((const uint*)data)[1] == 1)
+	{
+		//Version 1: separated float arrays with explicit offsets
+		struct ShlHeaderV1
+		{
+			uint magic, version, header_size, alignment, file_size;
+			uint num_indices, num_vertices, num_normals, num_uvs;
+			uint indices_offset, vertices_offset, normals_offset, uvs_offset;
+		};
+
+		if (size < sizeof(ShlHeaderV1))
+		{
+			return false;
+		}
+
+		const ShlHeaderV1* header = (const ShlHeaderV1*)data;
+		//Normals and UVs are read for every vertex when they're there
+		if (InFile(header->indices_offset, header->num_indices, sizeof(uint), size) == false ||
+			InFile(header->vertices_offset, header->num_vertices, sizeof(float) * 3, size) == false ||
+			InFile(header->normals_offset, header->num_normals, sizeof(float) * 3, size) == false ||
+			InFile(header->uvs_offset, header->num_uvs, sizeof(float) * 2, size) == false ||
+			(header->num_normals != 0 && header->num_normals < header->num_vertices) ||
+			(header->num_uvs != 0 && header->num_uvs < header->num_vertices))
+		{
+			return false;
+		}
+
+		num_indices = header->num_indices;
+		num_vertices = header->num_vertices;
+		indices = (const uint*)(data + header->indices_offset);
+		vertices = (const float*)(data + header->vertices_offset);
+		normals = (header->num_normals != 0) ? (const float*)(data + header->normals_offset) : nullptr;
+		uvs = (header->num_uvs != 0) ? (const float*)(data + header->uvs_offset) : nullptr;
+	}
+	else
+	{
+		//No header: 4 counters followed by the packed arrays
 		uint header[4];
 		uint bytes = sizeof(header);
-		memcpy(header, cursor, bytes);
-
-		m->num_indices = header[0];
-		m->num_vertices = header[1];
-		m->num_normal = header[2];
-		m->num_uv = header[3];
-		
-		cursor += bytes;
+		if (size < bytes)
+		{
+			return false;
+		}
+		memcpy(header, data, bytes);
 
-		//Indices
-		bytes = sizeof(uint) * m->num_indices;
-		m->indices = new uint[m->num_indices];
-		memcpy(m->indices, cursor, bytes);
+		unsigned long long needed = bytes + sizeof(uint) * (unsigned long long)header[0] +
+			sizeof(float) * ((unsigned long long)header[1] * 3 + (unsigned long long)header[2] * 3 + (unsigned long long)header[3] * 2);
+		if (needed > size || (header[2] != 0 && header[2] < header[1]) || (header[3] != 0 && header[3] < header[1]))
+		{
+			return false;
+		}
 
-		cursor += bytes;
+		num_indices = header[0];
+		num_vertices = header[1];
 
-		//Vertices
-		bytes = sizeof(float) * m->num_vertices*3;
-		m->vertices = new float[m->num_vertices*3];
-		memcpy(m->vertices, cursor, bytes);
+		const char* cursor = data + bytes;
+		indices = (const uint*)cursor;
+		cursor += sizeof(uint) * num_indices;
 
-		cursor += bytes;
+		vertices = (const float*)cursor;
+		cursor += sizeof(float) * num_vertices * 3;
 
-		//Normals
 		if (header[2] != 0)
 		{
-			bytes = sizeof(float) * m->num_normal*3;
-			m->normals = new float[m->num_normal*3];
-			memcpy(m->normals, cursor, bytes);
-		
-			cursor += bytes;
+			normals = (const float*)cursor;
+			cursor += sizeof(float) * header[2] * 3;
 		}
-	
 
-		//UVs
-		bytes = sizeof(float) * m->num_uv*2;
-		m->uvs = new float[m->num_uv*2];
-		memcpy(m->uvs, cursor, bytes);
+		if (header[3] != 0)
+		{
+			uvs = (const float*)cursor;
+		}
+	}
 
-		//Generate buffers 
+	if (IndicesInRange(indices, sizeof(uint), 0, num_indices, num_vertices) == false)
+	{
+		return false;
+	}
+
+	PackMesh(m, vertices, normals, uvs, 2, num_vertices, indices, num_indices);
 
-		glGenBuffers(1, (GLuint*)&(m->id_vertices));
-		glBindBuffer(GL_ARRAY_BUFFER, m->id_vertices);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * m->num_vertices * 3, m->vertices, GL_STATIC_DRAW);
+	return true;
+}
 
-		glGenBuffers(1, (GLuint*)&(m->id_normal));
-		glBindBuffer(GL_ARRAY_BUFFER, m->id_normal);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float)* m->num_normal * 3, m->normals, GL_STATIC_DRAW);
+void ModuleMesh::FreeMesh(Mesh* m) const
+{
+	//A worker may still be writing it, the load frees it when it's back
+	if (m != nullptr && m->request != nullptr && m->request->IsDone() == false)
+	{
+		m->request->Cancel();
+		return;
+	}
 
-		glGenBuffers(1, (GLuint*)&(m->id_indices));
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->id_indices);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(float) * m->num_indices, m->indices, GL_STATIC_DRAW);
+	if (m != nullptr)
+	{
+		App->renderer3D->RemoveFromMeshArena(m);
+		glDeleteBuffers(1, (GLuint*)&(m->id_vertices));
+		glDeleteBuffers(1, (GLuint*)&(m->id_indices));
+		delete m;
+	}
+}
 
-		glGenBuffers(1, (GLuint*)&(m->id_uv));
-		glBindBuffer(GL_ARRAY_BUFFER, m->id_uv);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * m->num_uv * 2, m->uvs, GL_STATIC_DRAW);
+void ModuleMesh::GenerateBuffers(Mesh* m) const
+{
+	std::vector<RenderVertex> render_vertices;
+	DecodeVertices(m, render_vertices);
+	CreateBuffers(m, render_vertices.data());
+}
 
+void ModuleMesh::DecodeVertices(const Mesh* m, std::vector<RenderVertex>& render_vertices) const
+{
+	//Decode the normals, positions and UVs go to the GPU as they are
+	render_vertices.resize(m->num_vertices);
+	for (uint i = 0; i < m->num_vertices; i++)
+	{
+		const PackedVertex& packed = m->vertices[i];
+		RenderVertex& vertex = render_vertices[i];
+
+		memcpy(vertex.position, packed.position, sizeof(vertex.position));
+		memcpy(vertex.uv, packed.uv, sizeof(vertex.uv));
+
+		float3 normal = (m->num_normal != 0) ? OctahedralDecode(packed.normal) : float3::zero;
+		vertex.normal[0] = FloatToSnorm8(normal.x);
+		vertex.normal[1] = FloatToSnorm8(normal.y);
+		vertex.normal[2] = FloatToSnorm8(normal.z);
+		vertex.normal[3] = 0;
 	}
+}
+
+void ModuleMesh::CreateBuffers(Mesh* m, const RenderVertex* render_vertices) const
+{
+	glGenBuffers(1, (GLuint*)&(m->id_vertices));
+	glBindBuffer(GL_ARRAY_BUFFER, m->id_vertices);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(RenderVertex) * m->num_vertices, render_vertices, GL_STATIC_DRAW);
+
+	glGenBuffers(1, (GLuint*)&(m->id_indices));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->id_indices);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m->index_size * m->GetTotalIndices(), m->indices, GL_STATIC_DRAW);
+
+	//A copy in the shared buffers too when the renderer draws indirect
+	App->renderer3D->AddToMeshArena(m, render_vertices);
+}
+
+Mesh::~Mesh()
+{
+	delete bvh;
+	bvh = nullptr;
+
+	App->fs->Unmap(file);
 
 	delete[] buffer;
 	buffer = nullptr;
+}
 
-	return m;
+float3 Mesh::GetVertex(uint index) const
+{
+	return DequantizePosition(vertices[index].position, bounds);
 }
 
+uint Mesh::GetIndex(uint i) const
+{
+	if (index_size == sizeof(unsigned short))
+	{
+		return ((const unsigned short*)indices)[i];
+	}
+	return ((const uint*)indices)[i];
+}
+
+const TriangleBVH* Mesh::GetBVH() const
+{
+	if (bvh == nullptr)
+	{
+		std::vector<float3> positions(num_vertices);
+		for (uint i = 0; i < num_vertices; i++)
+		{
+			positions[i] = GetVertex(i);
+		}
+
+		std::vector<uint> triangles(num_indices);
+		for (uint i = 0; i < num_indices; i++)
+		{
+			triangles[i] = GetIndex(i);
+		}
+
+		bvh = new TriangleBVH();
+		bvh->Build(positions.data(), triangles.data(), num_indices / 3);
+	}
 
+	return bvh;
+}
 
+bool Mesh::IsReady() const
+{
+	return ready;
+}
 
+uint Mesh::GetTotalIndices() const
+{
+	return lods[num_lods - 1].first_index + lods[num_lods - 1].num_indices;
+}
 
+uint Mesh::SelectLod(float pixel_size) const
+{
+	//Coarsest level whose error still covers less than LOD_PIXEL_ERROR pixels
+	uint lod = 0;
+	for (uint i = 1; i < num_lods; i++)
+	{
+		if (lods[i].error * pixel_size > LOD_PIXEL_ERROR)
+		{
+			break;
+		}
+		lod = i;
+	}
 
+	return lod;
+}
@@ -4,47 +4,149 @@
 #include "Module.h"
 #include "Globals.h"
 #include "GameObject.h"
+#include "ModuleFileSystem.h"
+#include "VertexCompression.h"
+#include "ImportDatabase.h"
+#include "MeshCache.h"
+#include "AsyncLoader.h"
 #include "Assimp/include/cimport.h"
 #include "Assimp/include/scene.h"
 #include "Assimp/include/postprocess.h"
 #include "Assimp/include/cfileio.h"
 #include <string>
+#include <vector>
+#include <map>
 #include"MathGeoLib\include\MathGeoLib.h"
 #pragma comment (lib, "Assimp/libx86/assimp.lib")
 
 class GameObject;
+class TriangleBVH;
 class aiNode;
 class aiScene;
 
+//.shl file layout: ShlHeader followed by the data blocks, every block starts
+//at a multiple of SHL_ALIGNMENT so the mapped file can be used in place
+#define SHL_MAGIC 0x4D4C4853 // "SHLM"
+#define SHL_VERSION 3
+#define SHL_ALIGNMENT 16
+#define SHL_MAX_LODS 4
+
+#define LOD_MAX_ERROR 0.1f		// Simplified levels stop at 10% of the mesh size
+#define LOD_PIXEL_ERROR 1.0f	// A level is drawn while its error stays under a pixel
+
+#define SHL_HAS_NORMALS (1 << 0)
+#define SHL_HAS_UVS (1 << 1)
+#define SHL_OPTIMIZED (1 << 2)		// Vertices and indices reordered by the importer
+
+//Range of the index block drawn for one level of detail, all levels share the vertices
+struct MeshLod
+{
+	uint first_index = 0;
+	uint num_indices = 0;
+	float error = 0.0f;		// Relative to the biggest extent of the mesh
+};
+
+struct ShlHeader
+{
+	uint magic = SHL_MAGIC;
+	uint version = SHL_VERSION;
+	uint header_size = sizeof(ShlHeader);
+	uint alignment = SHL_ALIGNMENT;
+	uint file_size = 0;
+	uint flags = 0;
+
+	uint num_indices = 0;
+	uint num_vertices = 0;
+	uint index_size = 0;
+
+	//Positions are quantized against this box
+	float aabb_min[3];
+	float aabb_max[3];
+
+	uint indices_offset = 0;
+	uint vertices_offset = 0;
+
+	//Revision 3, num_indices above counts the indices of every level
+	uint num_lods = 1;
+	MeshLod lods[SHL_MAX_LODS];
+};
+
 struct Mesh
 {
+	Mesh() {}
+	~Mesh();
+
+	float3 GetVertex(uint index) const;
+	uint GetIndex(uint i) const;
+	uint GetTotalIndices() const;
+	uint SelectLod(float pixel_size) const;
+	const TriangleBVH* GetBVH() const;
+	bool IsReady() const;		// Data and GL buffers are there, streamed meshes start without them
+
 	const char* name_mesh = nullptr;
 
-	//--Vertices
+	//--Vertices, interleaved PackedVertex stream
 	uint id_vertices = 0;
 	uint num_vertices = 0;
-	float* vertices = nullptr;
+	const PackedVertex* vertices = nullptr;
+	AABB bounds;
 
-	//-- Indices
+	//-- Indices, 16 bits when num_vertices < 65536. num_indices is the full
+	//detail level, the simplified levels follow it in the same buffer
 	uint id_indices = 0;
 	uint num_indices = 0;
-	uint* indices = nullptr;
-
-
-	//-- UVs
-	uint id_uv = 0;
+	uint num_lods = 1;
+	MeshLod lods[SHL_MAX_LODS];
+	uint index_size = sizeof(uint);
+	const void* indices = nullptr;
+
+	//-- Place in the shared buffers of the renderer, -1 when it isn't there. The
+	//dequantization is kept there too, the indirect draws fold it in the transforms
+	int arena_vertex = -1;
+	uint arena_index = 0;
+	float3 arena_center = float3::zero;
+	float3 arena_scale = float3::one;
+
+	//-- Attributes present in the stream
 	uint num_uv = 0;
-	float* uvs = nullptr;
-
-
-	//-- Normals
-	uint id_normal = 0;
 	uint num_normal = 0;
-	float* normals = nullptr;
 
 	std::string directory;
 	std::string tx_directory;
 
+	//-- Storage the arrays above point into
+	MappedFile file;
+	char* buffer = nullptr;
+
+	//-- Triangles of the full detail level for ray casts, built the first time it's asked
+	mutable TriangleBVH* bvh = nullptr;
+
+	//-- Streaming, the load in flight while the mesh isn't ready
+	bool ready = false;
+	LoadHandle request;
+
+private:
+	//The mesh owns its storage, never copy it
+	Mesh(const Mesh&);
+	Mesh& operator=(const Mesh&);
+};
+
+// Work needed to import one fbx. It's planned and run without touching GL so
+// the conversions can go to the worker threads, the main thread only makes the
+// GameObjects and their meshes and textures stream in afterwards
+struct PlannedTexture
+{
+	std::string file;				// .dds file in the library
+	uint64_t hash = 0;				// Hash of the source image
+};
+
+struct ImportPlan
+{
+	std::string scene_folder;
+	std::vector<std::string> mesh_files;			// .shl file of every aiMesh in the scene
+	std::vector<uint64_t> mesh_hashes;				// Hash of the data of every aiMesh
+	std::vector<uint> meshes_to_import;				// aiMesh indices with their own file
+	std::map<std::string, PlannedTexture> textures;	// Texture name -> texture
 };
 
 class ModuleMesh : public Module
@@ -59,19 +161,54 @@ public:
 	update_status Update(float dt);
 	update_status PostUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	bool  LoadFBX(const char* path);
-	Mesh* LoadMesh(const char* path);
 
-	void  Load(aiNode* node, const aiScene* scene, GameObject* parent,const char* scene_folder);
+	//Components share the meshes, every Acquire needs its Release
+	Mesh* AcquireMesh(const char* path);
+	void  ReleaseMesh(Mesh* m);
+	const MeshCache& GetMeshCache() const;
+
+	Mesh* LoadMesh(const char* path);		// Right away, the main thread waits for the file
+	Mesh* RequestMesh(const char* path);		// Streamed, the mesh is returned empty and is ready in a later frame
+	bool  ReadMeshFile(Mesh* m, const char* path, uint& size) const;		// Maps the file and points the mesh into it, no GL
+	void  FreeMesh(Mesh* m) const;		// Mesh and GL buffers, a mesh still streaming goes once its load is back
+	void  GenerateBuffers(Mesh* m) const;
+
+	void  PlanImport(aiNode* node, const aiScene* scene, ImportPlan& plan) const;
+	void  RunImport(const aiScene* scene, ImportPlan& plan, const ImportRecord* previous);
+	void  Load(aiNode* node, const aiScene* scene, GameObject* parent, const ImportPlan& plan);
 
 	bool ImportMesh(const aiMesh* mesh, std::string& output_file, const char* scene_folder);
 	bool SaveMesh(Mesh& mesh, std::string& output_file,const char* scene_folder);
 
+private:
+	uint64_t HashMesh(const aiMesh* mesh) const;
+	uint64_t GetImportSettings() const;
+	void UpdateImportRecord(const char* path, uint64_t hash, const ImportPlan& plan);
+	bool IsDummyNode(const aiNode* node) const;
+	std::string GetMeshName(const aiNode* node) const;
+	std::string GetTextureName(const aiScene* scene, const aiMesh* mesh) const;
+	void LogLoadStats(const char* path, uint ms) const;
+	bool ReadMeshData(Mesh* m, const char* data, uint size) const;
+	bool ReadLegacyMeshData(Mesh* m, const char* data, uint size) const;
+	void OptimizeMesh(Mesh* m, uint* indices) const;
+	void GenerateLods(Mesh* m, const uint* indices) const;
+	void PackMesh(Mesh* m, const float* vertices, const float* normals, const float* uvs, uint uv_stride, uint num_vertices, const uint* indices, uint num_indices) const;
+	void DecodeVertices(const Mesh* m, std::vector<RenderVertex>& render_vertices) const;
+	void CreateBuffers(Mesh* m, const RenderVertex* render_vertices) const;
 
 
 public:
-	bool scene_found = false;
+	bool optimize_meshes = true;
+	bool generate_lods = true;
+
+private:
+	ImportDatabase import_db;
+	MeshCache mesh_cache;
+	uint bytes_loaded = 0;
+	uint meshes_loaded = 0;
 
 };
 
@@ -322,12 +322,15 @@ void ModulePhysics3D::DeleteBody(btRigidBody * body)
 }
 
 // ---------------------------------------------------------
-update_status ModulePhysics3D::PreUpdate(float dt)
+// Step the physics world, on a worker while the last frame renders
+void ModulePhysics3D::Simulate(float dt)
 {
-	// Step the physics world
 	world->stepSimulation(dt, 15);
+}
 
-	// Detect collisions
+update_status ModulePhysics3D::PreUpdate(float dt)
+{
+	// Detect collisions of the last step
 	int numManifolds = world->getDispatcher()->getNumManifolds();
 	for(int i = 0; i<numManifolds; i++)
 	{
@@ -477,6 +480,25 @@ bool ModulePhysics3D::CleanUp()
 	return true;
 }
 
+void ModulePhysics3D::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	switch (phase)
+	{
+	case FRAME_SIMULATE:
+		access.writes = RESOURCE_PHYSICS;
+		break;
+	case FRAME_PRE_UPDATE:
+		//Collision listeners can be anything, they stay on the main thread
+		access.reads = RESOURCE_PHYSICS;
+		access.writes = RESOURCE_SCENE | RESOURCE_GL;
+		break;
+	case FRAME_UPDATE:
+		access.reads = RESOURCE_INPUT | RESOURCE_PHYSICS;
+		access.writes = RESOURCE_GL;
+		break;
+	}
+}
+
 // =============================================
 void DebugDrawer::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
 {
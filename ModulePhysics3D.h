@@ -37,10 +37,12 @@ public:
 
 	bool Init(Json& config);
 	bool Start();
+	void Simulate(float dt);
 	update_status PreUpdate(float dt);
 	update_status Update(float dt);
 	update_status PostUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	PhysBody3D*		AddBody(const Cube_Prim& cube, float mass = 1.0f);
 	PhysBody3D*		AddBody(const Sphere_Prim& sphere, float mass = 1.0f);
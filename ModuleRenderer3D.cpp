@@ -3,6 +3,9 @@
 #include "ModuleRenderer3D.h"
 #include "ModuleMesh.h"
 #include "ComponentCamera.h"
+#include "ComponentMesh.h"
+#include "ComponentMaterial.h"
+#include "GameObject.h"
 #include "Glew\include\glew.h"
 #include "SDL\include\SDL_opengl.h"
 #include <gl/GL.h>
@@ -15,6 +18,40 @@
 #pragma comment (lib, "opengl32.lib") /* link Microsoft OpenGL lib   */
 #pragma comment (lib, "Glew/libx86/glew32.lib")
 
+//The instance transform takes four attributes from here, away from 0 that some drivers alias with gl_Vertex
+#define INSTANCE_TRANSFORM_LOCATION 4
+
+//Same light and texture as the fixed pipeline, with the transform of each instance from an attribute
+static const char* instance_vertex_shader =
+	"#version 120\n"
+	"attribute mat4 instance_transform;\n"
+	"uniform vec3 dequantize_center;\n"
+	"uniform vec3 dequantize_scale;\n"
+	"varying vec2 uv;\n"
+	"varying vec3 light;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 world = instance_transform * vec4(dequantize_center + gl_Vertex.xyz * dequantize_scale, 1.0);\n"
+	"	vec4 view = gl_ModelViewMatrix * world;\n"
+	"	gl_Position = gl_ProjectionMatrix * view;\n"
+	"	vec3 normal = normalize(gl_NormalMatrix * (mat3(instance_transform) * gl_Normal));\n"
+	"	float diffuse = max(dot(normal, normalize(gl_LightSource[0].position.xyz - view.xyz)), 0.0);\n"
+	"	light = gl_Color.rgb * (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb + gl_LightSource[0].diffuse.rgb * diffuse);\n"
+	"	uv = gl_MultiTexCoord0.xy;\n"
+	"}\n";
+
+static const char* instance_fragment_shader =
+	"#version 120\n"
+	"uniform sampler2D diffuse_map;\n"
+	"uniform bool use_texture;\n"
+	"varying vec2 uv;\n"
+	"varying vec3 light;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 color = (use_texture) ? texture2D(diffuse_map, uv) : vec4(1.0);\n"
+	"	gl_FragColor = vec4(color.rgb * light, color.a);\n"
+	"}\n";
+
 
 
 ModuleRenderer3D::ModuleRenderer3D(Application* app, const char* name, bool start_enabled) : Module(app, name, start_enabled)
@@ -31,20 +68,45 @@ bool ModuleRenderer3D::Init(Json& config)
 	LOG("Creating 3D Renderer context");
 	bool ret = true;
 	
-	//Create context
-	context = SDL_GL_CreateContext(App->window->window);
-	if(context == NULL)
+	//The core profile path when the GL has it, the fixed pipeline if not or if it's asked for
+	core_path = (App->fixed_pipeline == false && config.GetBool("core_profile", true));
+	if (core_path && CreateContext(true) && core_renderer.Init(config.GetBool("multi_draw_indirect", true)))
 	{
-		LOG("OpenGL context could not be created! SDL_Error: %s\n", SDL_GetError());
-		ret = false;
+		LOG("Rendering with the core profile path");
+	}
+	else
+	{
+		if (core_path)
+		{
+			LOG("No GL 4.4 core profile, falling back to the fixed pipeline");
+		}
+		core_path = false;
+		ret = CreateContext(false);
 	}
 
-	GLenum gl_init = glewInit();
-	
-	if(ret == true)
+	if(ret == true && core_path)
+	{
+		if(VSYNC && App->headless == false && SDL_GL_SetSwapInterval(1) < 0)
+			LOG("Warning: Unable to set VSync! SDL Error: %s\n", SDL_GetError());
+
+		//Matrices, light and material go to the shaders, only the light values are kept
+		glClearDepth(1.0f);
+		glClearColor(0.f, 0.f, 0.f, 1.f);
+		glEnable(GL_DEPTH_TEST);
+
+		lights[0].ambient.Set(0.25f, 0.25f, 0.25f, 1.0f);
+		lights[0].diffuse.Set(0.75f, 0.75f, 0.75f, 1.0f);
+		lights[0].SetPos(0.0f, 0.0f, 2.5f);
+		lights[0].on = true;
+
+		//Every core draw is instanced, grouping the copies only saves calls
+		instancing_supported = true;
+		render_queue.SetInstancing(true);
+	}
+	else if(ret == true)
 	{
 		//Use Vsync
-		if(VSYNC && SDL_GL_SetSwapInterval(1) < 0)
+		if(VSYNC && App->headless == false && SDL_GL_SetSwapInterval(1) < 0)
 			LOG("Warning: Unable to set VSync! SDL Error: %s\n", SDL_GetError());
 
 		//Initialize Projection Matrix
@@ -102,9 +164,16 @@ bool ModuleRenderer3D::Init(Json& config)
 
 		glEnable(GL_DEPTH_TEST);
 		glEnable(GL_CULL_FACE);
+		//Meshes are drawn with the dequantization scale on the modelview
+		glEnable(GL_NORMALIZE);
 		lights[0].Active(true);
 		glEnable(GL_LIGHTING);
 		glEnable(GL_COLOR_MATERIAL);
+
+		//Repeated meshes go in one draw when the GL can do it, one by one if not
+		instancing_supported = GLEW_VERSION_3_3 && CreateInstanceProgram();
+		render_queue.SetInstancing(instancing_supported);
+		LOG("Instancing %s", (instancing_supported) ? "enabled" : "not available");
 	}
 
 	// Projection matrix for
@@ -127,6 +196,14 @@ update_status ModuleRenderer3D::PreUpdate(float dt)
 	UpdateCamera();
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	//The core path takes the camera and the light when the queue is flushed
+	if (core_path)
+	{
+		lights[0].SetPos(camera->frustum.pos.x, camera->frustum.pos.y, camera->frustum.pos.z);
+		return UPDATE_CONTINUE;
+	}
+
 	glLoadIdentity();
 
 	glMatrixMode(GL_MODELVIEW);
@@ -154,6 +231,7 @@ update_status ModuleRenderer3D::Update(float dt)
 // PostUpdate present buffer to screen
 update_status ModuleRenderer3D::PostUpdate(float dt)
 {
+	FlushQueue();
 	ImGui::Render();
 	SDL_GL_SwapWindow(App->window->window);
 	return UPDATE_CONTINUE;
@@ -163,15 +241,50 @@ update_status ModuleRenderer3D::PostUpdate(float dt)
 bool ModuleRenderer3D::CleanUp()
 {
 	LOG("Destroying 3D Renderer");
+	core_renderer.CleanUp();
+	if (instance_program != 0)
+	{
+		glDeleteProgram(instance_program);
+		instance_program = 0;
+	}
+	if (instance_buffer != 0)
+	{
+		glDeleteBuffers(1, &instance_buffer);
+		instance_buffer = 0;
+	}
+	FreeStaticBuffers();
 	ImGui_ImplSdlGL3_Shutdown();
-	SDL_GL_DeleteContext(context);
 
+	//The renderer cleans up first, the scene still frees meshes and textures after this
 	return true;
 }
 
+void ModuleRenderer3D::DeleteContext()
+{
+	if (context != NULL)
+	{
+		SDL_GL_DeleteContext(context);
+		context = NULL;
+	}
+}
+
+void ModuleRenderer3D::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	if (phase == FRAME_PRE_UPDATE)
+	{
+		access.reads = RESOURCE_CAMERA;
+		access.writes = RESOURCE_GL;
+	}
+	else if (phase == FRAME_POST_UPDATE)
+	{
+		access.writes = RESOURCE_GL;
+	}
+}
+
 void ModuleRenderer3D::OnResize(int width, int height)
 {
 	glViewport(0, 0, width, height);
+	viewport_height = height;
 
 	ComponentCamera* camera = App->editor->main_camera_component;
 	camera->SetAspectRatio((float)width / (float)height);
@@ -179,55 +292,431 @@ void ModuleRenderer3D::OnResize(int width, int height)
 	UpdateCamera();
 }
 
-void ModuleRenderer3D::Render(Mesh m,float4x4 mtrx,uint tex_id,bool wire)
+void ModuleRenderer3D::Submit(DrawPacket& packet)
 {
-	glPushMatrix();
-	glMultMatrixf(*mtrx.v);
+	render_queue.Submit(packet);
+}
 
-	wireframe = wire;
+void ModuleRenderer3D::FlushQueue()
+{
+	Uint64 submit_start = SDL_GetPerformanceCounter();
 
-	if (wire)
+	//Drawn indirect the queue is only sorted, the commands are never run
+	if (IsIndirect())
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		glDisable(GL_CULL_FACE);
-		glColor3f(1, 1, 1);
+		render_queue.Sort();
 	}
 	else
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-		glDisable(GL_CULL_FACE);
-		glColor3f(1, 1, 1);
+		render_queue.Build();
 	}
+	static_draws.clear();
+	static_batch.CollectDraws(static_draws);
 
+	if (core_path)
+	{
+		ComponentCamera* camera = App->editor->main_camera_component;
+		core_renderer.SetFrame(camera->GetViewMatrix(), camera->GetProjectionMatrix(), lights[0]);
+		core_renderer.Render(render_queue, static_batch, static_draws, wireframe, App->jobs);
+	}
+	else
+	{
+		FlushFixed();
+	}
+	render_queue.Clear();
+
+	//Only the CPU side, the driver may still be drawing
+	submit_ms = (float)((SDL_GetPerformanceCounter() - submit_start) * 1000.0 / SDL_GetPerformanceFrequency());
+	submit_total_ms += submit_ms;
+	submit_frames++;
+}
+
+void ModuleRenderer3D::FlushFixed()
+{
+	const std::vector<RenderCommand>& commands = render_queue.GetCommands();
+
+	//Every instanced draw of the frame reads its transforms from the same buffer
+	const std::vector<float4x4>& instances = render_queue.GetInstances();
+	if (instances.empty() == false)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+		glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(float4x4), instances.data(), GL_STREAM_DRAW);
+	}
+
+	//Set once for the whole queue, the commands only change what differs between draws
+	glMatrixMode(GL_MODELVIEW);
+	glDisable(GL_CULL_FACE);
+	glColor3f(1, 1, 1);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnable(GL_TEXTURE_2D);
-//----------------------------------------------	
-	glBindBuffer(GL_ARRAY_BUFFER, m.id_vertices);
-	glVertexPointer(3, GL_FLOAT, 0, NULL);
 
-	glBindBuffer(GL_ARRAY_BUFFER, m.id_normal);
-	glNormalPointer(GL_FLOAT, 0, NULL);
+	DrawStaticBatch();
 
-	glBindBuffer(GL_ARRAY_BUFFER, m.id_uv);
-	glTexCoordPointer(2, GL_FLOAT, 0, NULL);
-	
-	glBindTexture(GL_TEXTURE_2D, tex_id);
+	std::vector<RenderCommand>::const_iterator it = commands.begin();
+	while (it != commands.end())
+	{
+		switch ((*it).type)
+		{
+		case RENDER_SET_SHADER:
+			glPolygonMode(GL_FRONT_AND_BACK, ((*it).value == RENDER_SHADER_WIREFRAME) ? GL_LINE : GL_FILL);
+			break;
+
+		case RENDER_BIND_TEXTURE:
+			glBindTexture(GL_TEXTURE_2D, (*it).value);
+			break;
+
+		case RENDER_BIND_MESH:
+			glBindBuffer(GL_ARRAY_BUFFER, (*it).mesh->id_vertices);
+			glVertexPointer(3, GL_SHORT, sizeof(RenderVertex), (void*)offsetof(RenderVertex, position));
+			glNormalPointer(GL_BYTE, sizeof(RenderVertex), (void*)offsetof(RenderVertex, normal));
+			glTexCoordPointer(2, GL_HALF_FLOAT, sizeof(RenderVertex), (void*)offsetof(RenderVertex, uv));
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (*it).mesh->id_indices);
+			break;
+
+		case RENDER_DRAW:
+		{
+			const DrawPacket& packet = render_queue.GetPacket((*it).packet);
+			const Mesh& m = *packet.mesh;
+
+			glPushMatrix();
+			glMultMatrixf(*packet.transform.v);
+
+			//Positions are snorm16 against the mesh AABB
+			float3 center = m.bounds.CenterPoint();
+			float3 extents = QuantizationExtents(m.bounds) / SNORM16_MAX;
+			glTranslatef(center.x, center.y, center.z);
+			glScalef(extents.x, extents.y, extents.z);
+
+			const MeshLod& level = m.lods[packet.lod];
+			glDrawElements(GL_TRIANGLES, level.num_indices, (m.index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(level.first_index * m.index_size));
+
+			glPopMatrix();
+			break;
+		}
+
+		case RENDER_DRAW_INSTANCED:
+			DrawInstanced(*it);
+			break;
+		}
+		++it;
+	}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.id_indices);
-	glDrawElements(GL_TRIANGLES, m.num_indices, GL_UNSIGNED_INT, NULL);  
-//---------------------------------------------
 	glDisable(GL_TEXTURE_2D);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
 
-	glPopMatrix();
+const RenderQueue& ModuleRenderer3D::GetRenderQueue() const
+{
+	return render_queue;
+}
+
+bool ModuleRenderer3D::IsCorePath() const
+{
+	return core_path;
+}
+
+bool ModuleRenderer3D::IsIndirect() const
+{
+	return core_path && core_renderer.IsIndirect();
+}
+
+uint ModuleRenderer3D::GetNumIndirectCommands() const
+{
+	return core_renderer.GetNumIndirectCommands();
+}
+
+uint ModuleRenderer3D::GetNumDrawCalls() const
+{
+	return core_renderer.GetNumDrawCalls();
+}
+
+void ModuleRenderer3D::AddToMeshArena(Mesh* mesh, const RenderVertex* vertices)
+{
+	if (IsIndirect() && core_renderer.GetArena().Add(mesh, vertices) == false)
+	{
+		LOG("A mesh of %d vertices isn't in the arena, it's drawn on its own", mesh->num_vertices);
+	}
+}
+
+void ModuleRenderer3D::RemoveFromMeshArena(Mesh* mesh)
+{
+	core_renderer.GetArena().Remove(mesh);
+}
+
+float ModuleRenderer3D::GetSubmitMs() const
+{
+	return submit_ms;
+}
+
+float ModuleRenderer3D::GetAverageSubmitMs() const
+{
+	return (submit_frames > 0) ? (float)(submit_total_ms / submit_frames) : 0.0f;
+}
+
+void ModuleRenderer3D::ResetSubmitStats()
+{
+	submit_total_ms = 0.0;
+	submit_frames = 0;
+}
+
+bool ModuleRenderer3D::CreateContext(bool core)
+{
+	if (context != NULL)
+	{
+		SDL_GL_DeleteContext(context);
+		context = NULL;
+	}
+
+	if (core)
+	{
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 4);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+	}
+	else
+	{
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, 0);
+	}
+
+	context = SDL_GL_CreateContext(App->window->window);
+	if(context == NULL)
+	{
+		LOG("OpenGL context could not be created! SDL_Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	//Core profiles don't list their extensions the old way, glew has to look for the functions anyway
+	glewExperimental = GL_TRUE;
+	glewInit();
+	glGetError();
+	return true;
+}
+
+void ModuleRenderer3D::SetInstancing(bool enabled)
+{
+	render_queue.SetInstancing(enabled && instancing_supported);
+}
+
+bool ModuleRenderer3D::IsInstancing() const
+{
+	return render_queue.IsInstancing();
+}
+
+void ModuleRenderer3D::BuildStaticBatch(const std::vector<ComponentMesh*>& meshes)
+{
+	static_batch.Clear();
+
+	std::vector<ComponentMesh*>::const_iterator it = meshes.begin();
+	while (it != meshes.end())
+	{
+		ComponentMaterial* material = (ComponentMaterial*)(*it)->go->GetComponent(Component::MATERIAL);
+		uint texture = (material != nullptr) ? material->texture_id : 0;
+		static_batch.Add((*it)->mesh, (*it)->transformation->GetWorldTransformationMatrix(), texture, (*it));
+		++it;
+	}
+	static_batch.Build();
+
+	if (static_batch.IsEmpty())
+	{
+		FreeStaticBuffers();
+		return;
+	}
+
+	if (static_batch.id_vertices == 0)
+	{
+		glGenBuffers(1, &static_batch.id_vertices);
+		glGenBuffers(1, &static_batch.id_indices);
+	}
+
+	const std::vector<StaticVertex>& vertices = static_batch.GetVertices();
+	const std::vector<uint>& indices = static_batch.GetIndices();
+	glBindBuffer(GL_ARRAY_BUFFER, static_batch.id_vertices);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(StaticVertex), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_batch.id_indices);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	LOG("Static batch: %d meshes in %d materials, %d vertices, %d triangles", static_batch.GetRanges().size(), static_batch.GetGroups().size(), vertices.size(), indices.size() / 3);
+	static_batch.ReleaseGeometry();
+}
+
+void ModuleRenderer3D::SubmitStatic(uint range)
+{
+	static_batch.SetVisible(range);
+}
+
+const StaticBatch& ModuleRenderer3D::GetStaticBatch() const
+{
+	return static_batch;
+}
+
+uint ModuleRenderer3D::GetNumStaticDraws() const
+{
+	return num_static_draws;
+}
+
+void ModuleRenderer3D::DrawStaticBatch()
+{
+	if (static_draws.empty())
+	{
+		num_static_draws = 0;
+		return;
+	}
+
+	//Already in world space, the modelview is just the camera
+	glBindBuffer(GL_ARRAY_BUFFER, static_batch.id_vertices);
+	glVertexPointer(3, GL_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, position));
+	glNormalPointer(GL_BYTE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, normal));
+	glTexCoordPointer(2, GL_HALF_FLOAT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, uv));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_batch.id_indices);
+	glPolygonMode(GL_FRONT_AND_BACK, (wireframe) ? GL_LINE : GL_FILL);
+
+	//Every visible range of a material in one call, however culling split them
+	num_static_draws = 0;
+	uint first = 0;
+	while (first < static_draws.size())
+	{
+		static_counts.clear();
+		static_offsets.clear();
+
+		uint end = first;
+		while (end < static_draws.size() && static_draws[end].texture == static_draws[first].texture)
+		{
+			static_counts.push_back(static_draws[end].num_indices);
+			static_offsets.push_back((const void*)(static_draws[end].first_index * sizeof(uint)));
+			end++;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, static_draws[first].texture);
+		glMultiDrawElements(GL_TRIANGLES, static_counts.data(), GL_UNSIGNED_INT, static_offsets.data(), static_counts.size());
+		num_static_draws++;
+
+		first = end;
+	}
+}
+
+void ModuleRenderer3D::FreeStaticBuffers()
+{
+	if (static_batch.id_vertices != 0)
+	{
+		glDeleteBuffers(1, &static_batch.id_vertices);
+		glDeleteBuffers(1, &static_batch.id_indices);
+		static_batch.id_vertices = 0;
+		static_batch.id_indices = 0;
+	}
+}
+
+void ModuleRenderer3D::DrawInstanced(const RenderCommand& command)
+{
+	const DrawPacket& packet = render_queue.GetPacket(command.packet);
+	const Mesh& m = *command.mesh;
+
+	glUseProgram(instance_program);
+
+	//Positions are snorm16 against the mesh AABB
+	float3 center = m.bounds.CenterPoint();
+	float3 extents = QuantizationExtents(m.bounds) / SNORM16_MAX;
+	glUniform3f(dequantize_center_location, center.x, center.y, center.z);
+	glUniform3f(dequantize_scale_location, extents.x, extents.y, extents.z);
+	glUniform1i(use_texture_location, (packet.texture != 0) ? 1 : 0);
+
+	//One column of the matrix per attribute, advancing once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+	for (uint i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + i);
+		glVertexAttribPointer(INSTANCE_TRANSFORM_LOCATION + i, 4, GL_FLOAT, GL_FALSE, sizeof(float4x4), (void*)(command.first_instance * sizeof(float4x4) + i * 4 * sizeof(float)));
+		glVertexAttribDivisor(INSTANCE_TRANSFORM_LOCATION + i, 1);
+	}
+
+	const MeshLod& level = m.lods[packet.lod];
+	glDrawElementsInstanced(GL_TRIANGLES, level.num_indices, (m.index_size == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(level.first_index * m.index_size), command.num_instances);
+
+	for (uint i = 0; i < 4; i++)
+	{
+		glVertexAttribDivisor(INSTANCE_TRANSFORM_LOCATION + i, 0);
+		glDisableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + i);
+	}
+
+	glUseProgram(0);
+}
+
+bool ModuleRenderer3D::CreateInstanceProgram()
+{
+	uint vertex = CompileShader(GL_VERTEX_SHADER, instance_vertex_shader);
+	uint fragment = CompileShader(GL_FRAGMENT_SHADER, instance_fragment_shader);
+	if (vertex == 0 || fragment == 0)
+	{
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return false;
+	}
+
+	instance_program = glCreateProgram();
+	glAttachShader(instance_program, vertex);
+	glAttachShader(instance_program, fragment);
+	glBindAttribLocation(instance_program, INSTANCE_TRANSFORM_LOCATION, "instance_transform");
+	glLinkProgram(instance_program);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(instance_program, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		char info[512];
+		glGetProgramInfoLog(instance_program, sizeof(info), NULL, info);
+		LOG("Error linking the instancing shader: %s", info);
+		glDeleteProgram(instance_program);
+		instance_program = 0;
+		return false;
+	}
+
+	dequantize_center_location = glGetUniformLocation(instance_program, "dequantize_center");
+	dequantize_scale_location = glGetUniformLocation(instance_program, "dequantize_scale");
+	use_texture_location = glGetUniformLocation(instance_program, "use_texture");
+
+	glGenBuffers(1, &instance_buffer);
+	return true;
+}
+
+uint ModuleRenderer3D::CompileShader(uint type, const char* source)
+{
+	uint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled == GL_FALSE)
+	{
+		char info[512];
+		glGetShaderInfoLog(shader, sizeof(info), NULL, info);
+		LOG("Error compiling a shader: %s", info);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
 }
 
 void ModuleRenderer3D::UpdateCamera()
 {
+	if (core_path)
+	{
+		return;
+	}
+
 	ComponentCamera* camera = App->editor->main_camera_component;
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -241,6 +730,12 @@ void ModuleRenderer3D::UpdateCamera()
 
 void ModuleRenderer3D::DebugDrawBox(const float3 * corners, Color color)
 {
+	if (core_path)
+	{
+		core_renderer.AddBox(corners, color);
+		return;
+	}
+
 	glColor3f(color.r, color.g, color.b);
 
 	glBegin(GL_QUADS);
@@ -278,6 +773,22 @@ void ModuleRenderer3D::DebugDrawBox(const float3 * corners, Color color)
 	glEnd();
 }
 
+void ModuleRenderer3D::DebugDrawLine(const float3& from, const float3& to, Color color)
+{
+	if (core_path)
+	{
+		core_renderer.AddLine(from, to, color);
+		return;
+	}
+
+	glColor3f(color.r, color.g, color.b);
+
+	glBegin(GL_LINES);
+	glVertex3fv((GLfloat*)&from);
+	glVertex3fv((GLfloat*)&to);
+	glEnd();
+}
+
 void ModuleRenderer3D::RenderBoundingBox(const math::AABB & aabb, Color color)
 {
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
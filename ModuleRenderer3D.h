@@ -5,11 +5,16 @@
 #include "Globals.h"
 #include"MathGeoLib\include\MathGeoLib.h"
 #include "Light.h"
+#include "RenderQueue.h"
+#include "StaticBatch.h"
+#include "CoreRenderer.h"
 
 #define MAX_LIGHTS 8
 
-class Mesh;
+struct Mesh;
+struct RenderVertex;
 class ComponentCamera;
+class ComponentMesh;
 
 class ModuleRenderer3D : public Module
 {
@@ -22,13 +27,41 @@ public:
 	update_status Update(float dt);
 	update_status PostUpdate(float dt);
 	bool CleanUp();
+	void DeleteContext();		// The window calls it once every module freed its GL objects
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	void OnResize(int width, int height);
-	void Render(Mesh m, float4x4 mtrx, uint tex_id,bool wire = false);
 	void UpdateCamera();
 
+	//Meshes are queued during the frame and drawn sorted in PostUpdate
+	void Submit(DrawPacket& packet);
+	void FlushQueue();
+	const RenderQueue& GetRenderQueue() const;
+	bool IsCorePath() const;		// False on the fixed pipeline fallback
+	bool IsIndirect() const;		// The core path with multi draw indirect
+	uint GetNumIndirectCommands() const;		// Last frame, indirect path
+	uint GetNumDrawCalls() const;		// Last frame, core path
+
+	//Every mesh is copied in the shared buffers the indirect draws read
+	void AddToMeshArena(Mesh* mesh, const RenderVertex* vertices);
+	void RemoveFromMeshArena(Mesh* mesh);
+
+	//CPU time of FlushQueue, what it takes to hand the frame to the driver
+	float GetSubmitMs() const;		// Last frame
+	float GetAverageSubmitMs() const;		// Since ResetSubmitStats
+	void ResetSubmitStats();
+	void SetInstancing(bool enabled);		// Only if the GL has it
+	bool IsInstancing() const;
+
+	//Static meshes are merged once and drawn by visible ranges
+	void BuildStaticBatch(const std::vector<ComponentMesh*>& meshes);
+	void SubmitStatic(uint range);
+	const StaticBatch& GetStaticBatch() const;
+	uint GetNumStaticDraws() const;		// Last frame, one per material with something visible
+
 	//--DEBUG DRAW-------------------
 	void DebugDrawBox(const float3* corners, Color color);
+	void DebugDrawLine(const float3& from, const float3& to, Color color);
 	void RenderBoundingBox(const math::AABB& aabb, Color color);
 	void RenderFrustum(const Frustum& frustum, Color color);
 
@@ -36,7 +69,43 @@ public:
 
 	ComponentCamera* camera_enabled = nullptr;
 	Light lights[MAX_LIGHTS];
-	SDL_GLContext context;
+	SDL_GLContext context = NULL;
 	bool wireframe = false;
+	int viewport_height = SCREEN_HEIGHT;
+
+private:
+	bool CreateContext(bool core);
+	void FlushFixed();
+	bool CreateInstanceProgram();
+	static uint CompileShader(uint type, const char* source);
+	void DrawInstanced(const RenderCommand& command);
+	void DrawStaticBatch();
+	void FreeStaticBuffers();
+
+private:
+	RenderQueue render_queue;
+
+	//Static batching
+	StaticBatch static_batch;
+	std::vector<StaticDraw> static_draws;
+	std::vector<int> static_counts;		// Arguments of the glMultiDrawElements of a material
+	std::vector<const void*> static_offsets;
+	uint num_static_draws = 0;
+
+	//Core profile path
+	bool core_path = false;
+	CoreRenderer core_renderer;
+
+	float submit_ms = 0.0f;
+	double submit_total_ms = 0.0;
+	uint submit_frames = 0;
+
+	//Instancing
+	bool instancing_supported = false;
+	uint instance_program = 0;
+	uint instance_buffer = 0;		// Orphaned and filled again every frame
+	int dequantize_center_location = -1;
+	int dequantize_scale_location = -1;
+	int use_texture_location = -1;
 };
 #endif // !__MODULERENDERER3D_H__
@@ -34,6 +34,7 @@ bool ModuleSceneIntro::Start()
 	camera = App->go_manager->CreateGameObject(App->go_manager->GetRoot() , "camera_test");
 	camera->AddComponent(Component::TRANSFORM);
 	camera_test_cmp = (ComponentCamera*)camera->AddComponent(Component::CAMERA);
+	App->go_manager->culling_camera = camera_test_cmp;
 
 	return ret;
 }
@@ -42,11 +43,23 @@ bool ModuleSceneIntro::Start()
 bool ModuleSceneIntro::CleanUp()
 {
 	LOG("Unloading Intro scene");
-	delete camera;
-	camera = nullptr;
 	return true;
 }
 
+void ModuleSceneIntro::OnSceneDeleted()
+{
+	camera = nullptr;
+	camera_test_cmp = nullptr;
+}
+
+void ModuleSceneIntro::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	if (phase == FRAME_UPDATE)
+	{
+		access.writes = RESOURCE_GL;
+	}
+}
+
 // Update: draw background
 update_status ModuleSceneIntro::Update(float dt)
 {
@@ -55,18 +68,7 @@ update_status ModuleSceneIntro::Update(float dt)
 	p.axis = true;
 	p.Render();
 
-	//Insert Objects in Quadtree
-	if (!on)
-	{
-		if (App->input->GetKey(SDL_SCANCODE_Q) == KEY_DOWN)
-		{
-			on = true;
-			App->go_manager->InsertObjects();
-		}
-	}
-
 
-	App->go_manager->quad.FrustumCulling(camera_test_cmp);
 
 	return UPDATE_CONTINUE;
 }
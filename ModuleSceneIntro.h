@@ -24,13 +24,15 @@ public:
 	update_status Update(float dt);
 	update_status PostUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	void OnCollision(PhysBody3D* body1, PhysBody3D* body2);
+	void OnSceneDeleted();		// The test camera went with the scene
 
 public:
+	//Owned by the scene, go_manager frees them
 	GameObject* camera = nullptr;
 	ComponentCamera* camera_test_cmp = nullptr;
-	bool on = false;
 };
 
 
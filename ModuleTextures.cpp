@@ -1,6 +1,7 @@
 #include "ModuleTextures.h"
 #include "ModuleFileSystem.h"
 #include "Application.h"
+#include "Hash.h"
 #include <string>
 #include <gl\GL.h>
 #include "Devil\include\il.h"
@@ -12,7 +13,8 @@
 
 
 
-ModuleTextures::ModuleTextures(Application * app, const char* name, bool start_enabled) : Module(app, name, start_enabled)
+ModuleTextures::ModuleTextures(Application * app, const char* name, bool start_enabled) : Module(app, name, start_enabled),
+	texture_cache(TEXTURE_CPU_CACHE_MB * 1024 * 1024, TEXTURE_UPLOAD_BUDGET_KB * 1024)
 {
 	ilInit();
 	iluInit();
@@ -31,60 +33,258 @@ bool ModuleTextures::Init(Json& config)
 
 	LOG("Init Image library using DevIL lib version %d", IL_VERSION);
 
-
+	//Budgets from the config, the defaults when they aren't there
+	int cpu_cache_mb = config.GetInt("cpu_cache_mb");
+	int upload_budget_kb = config.GetInt("upload_budget_kb");
+	texture_cache.SetBudgets(((cpu_cache_mb > 0) ? cpu_cache_mb : TEXTURE_CPU_CACHE_MB) * 1024 * 1024,
+		((upload_budget_kb > 0) ? upload_budget_kb : TEXTURE_UPLOAD_BUDGET_KB) * 1024);
 
 	return ret;
 }
 
+update_status ModuleTextures::PreUpdate(float dt)
+{
+	texture_cache.Upload([this](uint id, const TextureImage& image) { UploadTexture(id, image); });
+
+	return UPDATE_CONTINUE;
+}
+
 bool ModuleTextures::CleanUp()
 {
 	bool ret = true;
 	LOG("Freeing textures and DevIL");
-
-
+	LOG("Texture cache: %d textures, %d shared, %d decoded images (%.2f MB)", texture_cache.GetNumTextures(), texture_cache.GetHits(),
+		texture_cache.GetNumImages(), texture_cache.GetCPUBytes() / (1024.0f * 1024.0f));
 
 	return ret;
 }
 
+void ModuleTextures::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	if (phase == FRAME_PRE_UPDATE)
+	{
+		access.writes = RESOURCE_ASSETS | RESOURCE_GL;
+	}
+}
+
 uint ModuleTextures::LoadTexture(const char* path)
 {
-	ILuint id;
-	ilGenImages(1, &id);
-	ilBindImage(id);
-	ilLoadImage(path);
+	//Files are read once to know their hash, and only decoded if nothing has that content
+	char* buffer = nullptr;
+	uint size = 0;
+	uint64_t hash = 0;
+	if (texture_cache.FindPath(path, hash) == false)
+	{
+		size = App->fs->Load(path, &buffer);
+		if (size == 0)
+		{
+			LOG("Error loading texture %s", path);
+			return 0;
+		}
+
+		hash = Hash64(buffer, size);
+		texture_cache.AddPath(path, hash);
+	}
+
+	uint id = texture_cache.Acquire(hash);
+	if (id == 0)
+	{
+		if (texture_cache.GetImage(hash) == nullptr)
+		{
+			if (buffer == nullptr)
+			{
+				size = App->fs->Load(path, &buffer);
+			}
+
+			TextureImage image;
+			if (size == 0 || DecodeTexture(buffer, size, image) == false)
+			{
+				LOG("Error decoding texture %s", path);
+				delete[] buffer;
+				return 0;
+			}
+			texture_cache.StoreImage(hash, image);
+		}
+
+		glGenTextures(1, (GLuint*)&id);
+		texture_cache.Add(hash, id);
+	}
+
+	delete[] buffer;
+	return id;
+}
+
+void ModuleTextures::ReleaseTexture(uint id)
+{
+	if (id == 0)
+	{
+		return;
+	}
 
-	return ilutGLBindTexImage();
+	uint unused = texture_cache.Release(id);
+	if (unused != 0)
+	{
+		glDeleteTextures(1, (GLuint*)&unused);
+	}
 }
 
-bool ModuleTextures::ImportTexture(const char * file, const char * path, std::string& output_file, const char* scene_folder)
+LoadHandle ModuleTextures::RequestTexture(const char* path)
 {
-	bool ret = false;
+	//Decided now, the cache can't be asked from the workers. Files never seen
+	//are read for their hash, and decoded unless their image is still cached
+	std::string file = path;
+	uint64_t hash = 0;
+	bool known = texture_cache.FindPath(path, hash);
+	bool decode = (known == false || (texture_cache.GetReferences(hash) == 0 && texture_cache.GetImage(hash) == nullptr));
+
+	std::shared_ptr<TextureImage> image = std::make_shared<TextureImage>();
+	std::shared_ptr<uint64_t> file_hash = std::make_shared<uint64_t>(hash);
+
+	return App->loader->Request([this, file, known, decode, image, file_hash]()
+	{
+		if (decode == false)
+		{
+			return true;
+		}
+
+		char* buffer = nullptr;
+		uint size = App->fs->Load(file.data(), &buffer);
+		if (known == false && size > 0)
+		{
+			*file_hash = Hash64(buffer, size);
+		}
+
+		bool ret = (size > 0 && DecodeTexture(buffer, size, *image));
+		delete[] buffer;
+		return ret;
+	},
+	[this, file, known, image, file_hash](bool loaded)
+	{
+		if (loaded == false)
+		{
+			LOG("Error loading texture %s", file.data());
+			return 0u;
+		}
+
+		if (known == false)
+		{
+			texture_cache.AddPath(file.data(), *file_hash);
+		}
 
-	ILuint id;
-	ilGenImages(1, &id);
-	ilBindImage(id);
-	ilLoadImage(path);
+		if (image->mips.empty() == false && texture_cache.GetImage(*file_hash) == nullptr)
+		{
+			texture_cache.StoreImage(*file_hash, *image);
+		}
+
+		//Shared with a texture of the same contents if there's one by now. If
+		//the image left the cache meanwhile it's decoded here, it's rare
+		return LoadTexture(file.data());
+	},
+	[this](uint id)
+	{
+		ReleaseTexture(id);
+	});
+}
+
+const TextureCache& ModuleTextures::GetTextureCache() const
+{
+	return texture_cache;
+}
 
-	ILuint size;
-	ILubyte* data;
-	ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
-	size = ilSaveL(IL_DDS, NULL, 0);
+bool ModuleTextures::DecodeTexture(const char* data, uint size, TextureImage& image)
+{
+	bool ret = false;
+	image.mips.resize(1);
+	TextureMip& mip = image.mips[0];
 
-	if (size > 0)
 	{
-		data = new ILubyte[size];
-		if (ilSaveL(IL_DDS,data,size) > 0)
+		std::lock_guard<std::mutex> lock(devil_mutex);
+
+		ILuint id;
+		ilGenImages(1, &id);
+		ilBindImage(id);
+
+		if (ilLoadL(IL_TYPE_UNKNOWN, data, size) && ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
 		{
-			//string name = file;
-			string scene_dir = scene_folder;
-			scene_dir.append(TEXTURE_FOLDER);
-			ret = App->fs->SaveUnique(file, output_file, data, size, scene_dir.data() , "dds");
+			//GL starts the rows at the bottom
+			if (ilGetInteger(IL_IMAGE_ORIGIN) == IL_ORIGIN_UPPER_LEFT)
+			{
+				iluFlipImage();
+			}
+
+			mip.width = ilGetInteger(IL_IMAGE_WIDTH);
+			mip.height = ilGetInteger(IL_IMAGE_HEIGHT);
+			mip.pixels.assign(ilGetData(), ilGetData() + mip.width * mip.height * 4);
+			ret = (mip.width > 0 && mip.height > 0);
 		}
 
-		delete[] data;
-		data = nullptr;
+		//The decoded copy is ours now, DevIL's goes
+		ilDeleteImages(1, &id);
+	}
+
+	//Out of the lock, other decodes can go meanwhile
+	if (ret)
+	{
+		image.BuildMips();
+	}
+	else
+	{
+		image.mips.clear();
+	}
+
+	return ret;
+}
+
+void ModuleTextures::UploadTexture(uint id, const TextureImage& image) const
+{
+	glBindTexture(GL_TEXTURE_2D, id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (uint i = 0; i < image.mips.size(); i++)
+	{
+		const TextureMip& mip = image.mips[i];
+		glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data());
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool ModuleTextures::ImportTexture(const char * path, const std::string& output_file)
+{
+	ILuint size = 0;
+	ILubyte* data = nullptr;
+
+	//Only DevIL goes in the lock, the encoded file is written after it
+	{
+		std::lock_guard<std::mutex> lock(devil_mutex);
+
+		ILuint id;
+		ilGenImages(1, &id);
+		ilBindImage(id);
+		ilLoadImage(path);
+
+		ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
+		size = ilSaveL(IL_DDS, NULL, 0);
+
+		if (size > 0)
+		{
+			data = new ILubyte[size];
+			if (ilSaveL(IL_DDS, data, size) == 0)
+			{
+				size = 0;
+			}
+		}
+		ilDeleteImages(1, &id);
 	}
-	ilDeleteImages(1, &id);
+
+	bool ret = (size > 0) && App->fs->Save(output_file.data(), data, size) > 0;
+
+	delete[] data;
+	data = nullptr;
 
 	return ret;
 }
@@ -3,9 +3,16 @@
 
 #include "Globals.h"
 #include "Module.h"
+#include "TextureCache.h"
+#include "AsyncLoader.h"
 #include <string>
+#include <mutex>
 
+//Bump when the .dds conversion changes so old imports are redone
+#define DDS_IMPORT_VERSION 1
 
+#define TEXTURE_CPU_CACHE_MB 64		// Decoded images kept after their texture is freed
+#define TEXTURE_UPLOAD_BUDGET_KB 4096		// Per frame, at least one texture goes every frame
 
 class ModuleTextures : public Module
 {
@@ -14,12 +21,30 @@ public:
 	~ModuleTextures();
 
 	bool Init(Json& config);
+	update_status PreUpdate(float dt);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
+	//Same contents, same texture. The id is valid right away, the image is
+	//uploaded within the next frames. Every load needs its release
 	uint LoadTexture(const char* path);
-	bool ImportTexture(const char* file, const char* path, std::string& output_file, const char* scene_folder);
+	void ReleaseTexture(uint id);
 
+	//Streamed, the file is read and decoded by a worker. The result of the
+	//handle is the texture, a reference taken for whoever asked for it
+	LoadHandle RequestTexture(const char* path);
+	bool ImportTexture(const char* path, const std::string& output_file);
 
+	const TextureCache& GetTextureCache() const;
+
+private:
+	bool DecodeTexture(const char* data, uint size, TextureImage& image);
+	void UploadTexture(uint id, const TextureImage& image) const;
+
+private:
+	//DevIL keeps the bound image as global state, only one thread can use it
+	std::mutex devil_mutex;
+	TextureCache texture_cache;		// Main thread only
 
 
 };
@@ -32,7 +32,7 @@ bool ModuleWindow::Init(Json& config)
 		//Create window
 		int width = SCREEN_WIDTH * SCREEN_SIZE;
 		int height = SCREEN_HEIGHT * SCREEN_SIZE;
-		Uint32 flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN;
+		Uint32 flags = SDL_WINDOW_OPENGL | ((App->headless) ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
 
 		//Use OpenGL 2.1
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
@@ -80,6 +80,9 @@ bool ModuleWindow::CleanUp()
 {
 	LOG("Destroying SDL window and quitting all SDL systems");
 
+	//The GL context goes with its window, every module before has freed its GL objects
+	App->renderer3D->DeleteContext();
+
 	//Destroy window
 	if(window != NULL)
 	{
@@ -91,6 +94,11 @@ bool ModuleWindow::CleanUp()
 	return true;
 }
 
+void ModuleWindow::DeclareAccess(FramePhase phase, FrameAccess& access) const
+{
+	//Nothing to do in the frame
+}
+
 void ModuleWindow::SetTitle(const char* title)
 {
 	SDL_SetWindowTitle(window, title);
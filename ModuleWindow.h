@@ -17,6 +17,7 @@ public:
 
 	bool Init(Json& config);
 	bool CleanUp();
+	void DeclareAccess(FramePhase phase, FrameAccess& access) const;
 
 	void SetTitle(const char* title);
 
@@ -0,0 +1,480 @@
+#include "Octree.h"
+#include "Application.h"
+#include "GameObject.h"
+#include "Component.h"
+#include "ComponentMesh.h"
+#include "ComponentCamera.h"
+
+//OCTREENODE-------------------------------------------------
+
+OctreeNode::OctreeNode(OctreeNode* parent, const float3& center, float half_size) : parent(parent), center(center), half_size(half_size)
+{
+	for (uint i = 0; i < 8; i++)
+	{
+		childs[i] = nullptr;
+	}
+}
+
+OctreeNode::~OctreeNode()
+{
+	for (uint i = 0; i < 8; i++)
+	{
+		delete childs[i];
+		childs[i] = nullptr;
+	}
+}
+
+bool OctreeNode::IsLeaf() const
+{
+	return childs[0] == nullptr;
+}
+
+bool OctreeNode::Fits(const AABB& box) const
+{
+	//Center inside the node and not bigger than it, so the box is inside the loose bounds
+	float3 box_center = box.CenterPoint();
+	float3 box_half = box.HalfSize();
+
+	return Abs(box_center.x - center.x) <= half_size && Abs(box_center.y - center.y) <= half_size && Abs(box_center.z - center.z) <= half_size &&
+		box_half.x <= half_size && box_half.y <= half_size && box_half.z <= half_size;
+}
+
+bool OctreeNode::FitsInChild(const AABB& box) const
+{
+	float3 box_half = box.HalfSize();
+	float child_half = half_size * 0.5f;
+
+	return box_half.x <= child_half && box_half.y <= child_half && box_half.z <= child_half;
+}
+
+uint OctreeNode::ChildIndex(const float3& point) const
+{
+	return ((point.x >= center.x) ? 1 : 0) | ((point.y >= center.y) ? 2 : 0) | ((point.z >= center.z) ? 4 : 0);
+}
+
+AABB OctreeNode::GetBox() const
+{
+	return AABB(center - float3(half_size), center + float3(half_size));
+}
+
+AABB OctreeNode::GetLooseBox() const
+{
+	return AABB(center - float3(half_size * 2.0f), center + float3(half_size * 2.0f));
+}
+
+void OctreeNode::Divide()
+{
+	float child_half = half_size * 0.5f;
+
+	for (uint i = 0; i < 8; i++)
+	{
+		float3 child_center = center;
+		child_center.x += (i & 1) ? child_half : -child_half;
+		child_center.y += (i & 2) ? child_half : -child_half;
+		child_center.z += (i & 4) ? child_half : -child_half;
+
+		childs[i] = new OctreeNode(this, child_center, child_half);
+	}
+}
+
+//OCTREE------------------------------------------------------------------------
+
+Octree::Octree()
+{
+}
+
+Octree::~Octree()
+{
+	Clear();
+}
+
+bool Octree::Insert(GameObject* object)
+{
+	ComponentMesh* cmp_mesh = (ComponentMesh*)object->GetComponent(Component::MESH);
+	if (cmp_mesh != nullptr && cmp_mesh->GetMesh() != nullptr)
+	{
+		return Insert(object, cmp_mesh->world_bb);
+	}
+	return false;
+}
+
+bool Octree::Insert(GameObject* object, const AABB& box)
+{
+	if (object == nullptr || box.IsFinite() == false || box.minPoint.x > box.maxPoint.x)
+	{
+		return false;
+	}
+
+	if (locations.find(object) != locations.end())
+	{
+		return Update(object, box);
+	}
+
+	//The first object decides where the world starts, it grows from there
+	if (root == nullptr)
+	{
+		float3 half = box.HalfSize();
+		root = new OctreeNode(nullptr, box.CenterPoint(), Max(Max(Max(half.x, half.y), half.z), OCTREE_MIN_SIZE));
+		num_nodes = 1;
+	}
+
+	while (root->Fits(box) == false)
+	{
+		Grow(box.CenterPoint());
+	}
+
+	//Go down while a child can hold the object
+	OctreeNode* node = root;
+	while (node->IsLeaf() == false && node->FitsInChild(box))
+	{
+		node = node->childs[node->ChildIndex(box.CenterPoint())];
+	}
+
+	AddObject(node, object, box);
+
+	return true;
+}
+
+void Octree::AddObject(OctreeNode* node, GameObject* object, const AABB& box)
+{
+	node->objects.push_back(object);
+	node->boxes.Push(box);
+	locations[object] = node;
+
+	//Full leaf, divide it if it's not too deep and move down what fits
+	bool too_deep = node->half_size * (1 << OCTREE_MAX_DEPTH) <= root->half_size;
+	if (node->IsLeaf() && node->objects.size() > OCTREE_BUCKET && too_deep == false)
+	{
+		node->Divide();
+		num_nodes += 8;
+
+		std::vector<GameObject*> objects;
+		objects.swap(node->objects);
+		AABBArray boxes;
+		std::swap(boxes, node->boxes);
+
+		for (uint i = 0; i < objects.size(); i++)
+		{
+			AABB object_box = boxes.Get(i);
+
+			OctreeNode* target = node;
+			if (node->FitsInChild(object_box))
+			{
+				target = node->childs[node->ChildIndex(object_box.CenterPoint())];
+			}
+
+			target->objects.push_back(objects[i]);
+			target->boxes.Push(object_box);
+			locations[objects[i]] = target;
+		}
+	}
+}
+
+void Octree::Grow(const float3& point)
+{
+	//The new root doubles the size towards the point, the old root is one of its childs
+	float3 center = root->center;
+	center.x += (point.x >= root->center.x) ? root->half_size : -root->half_size;
+	center.y += (point.y >= root->center.y) ? root->half_size : -root->half_size;
+	center.z += (point.z >= root->center.z) ? root->half_size : -root->half_size;
+
+	OctreeNode* new_root = new OctreeNode(nullptr, center, root->half_size * 2.0f);
+	new_root->Divide();
+	num_nodes += 8;
+
+	uint index = new_root->ChildIndex(root->center);
+	delete new_root->childs[index];
+	new_root->childs[index] = root;
+	root->parent = new_root;
+	num_nodes -= 1;
+
+	root = new_root;
+}
+
+bool Octree::Remove(GameObject* object)
+{
+	std::unordered_map<GameObject*, OctreeNode*>::iterator location = locations.find(object);
+	if (location == locations.end())
+	{
+		return false;
+	}
+
+	OctreeNode* node = location->second;
+	locations.erase(location);
+
+	for (uint i = 0; i < node->objects.size(); i++)
+	{
+		if (node->objects[i] == object)
+		{
+			node->objects[i] = node->objects.back();
+			node->objects.pop_back();
+			node->boxes.RemoveSwap(i);
+			break;
+		}
+	}
+
+	Merge(node->IsLeaf() ? node->parent : node);
+
+	return true;
+}
+
+void Octree::Merge(OctreeNode* node)
+{
+	//Childs that are leaves and hold few objects go back to their parent
+	while (node != nullptr)
+	{
+		uint count = node->objects.size();
+		for (uint i = 0; i < 8; i++)
+		{
+			if (node->childs[i]->IsLeaf() == false)
+			{
+				return;
+			}
+			count += node->childs[i]->objects.size();
+		}
+
+		if (count > OCTREE_BUCKET)
+		{
+			return;
+		}
+
+		for (uint i = 0; i < 8; i++)
+		{
+			OctreeNode* child = node->childs[i];
+			for (uint j = 0; j < child->objects.size(); j++)
+			{
+				node->objects.push_back(child->objects[j]);
+				node->boxes.Push(child->boxes.Get(j));
+				locations[child->objects[j]] = node;
+			}
+
+			delete node->childs[i];
+			node->childs[i] = nullptr;
+		}
+		num_nodes -= 8;
+
+		node = node->parent;
+	}
+}
+
+bool Octree::Update(GameObject* object)
+{
+	ComponentMesh* cmp_mesh = (ComponentMesh*)object->GetComponent(Component::MESH);
+	if (cmp_mesh != nullptr && cmp_mesh->GetMesh() != nullptr)
+	{
+		return Update(object, cmp_mesh->world_bb);
+	}
+	return Remove(object);
+}
+
+bool Octree::Update(GameObject* object, const AABB& box)
+{
+	std::unordered_map<GameObject*, OctreeNode*>::iterator location = locations.find(object);
+	if (location == locations.end())
+	{
+		return false;
+	}
+
+	//Small moves stay in the same node, only the box is updated
+	OctreeNode* node = location->second;
+	if (node->Fits(box) && (node->IsLeaf() || node->FitsInChild(box) == false))
+	{
+		for (uint i = 0; i < node->objects.size(); i++)
+		{
+			if (node->objects[i] == object)
+			{
+				node->boxes.Set(i, box);
+				return true;
+			}
+		}
+	}
+
+	Remove(object);
+	return Insert(object, box);
+}
+
+bool Octree::Contains(GameObject* object) const
+{
+	return locations.find(object) != locations.end();
+}
+
+void Octree::Clear()
+{
+	delete root;
+	root = nullptr;
+	locations.clear();
+	num_nodes = 0;
+}
+
+void Octree::Render() const
+{
+	if (root == nullptr)
+	{
+		return;
+	}
+
+	std::vector<const OctreeNode*> stack;
+	stack.push_back(root);
+
+	while (stack.empty() == false)
+	{
+		const OctreeNode* node = stack.back();
+		stack.pop_back();
+
+		App->renderer3D->RenderBoundingBox(node->GetBox(), Blue);
+
+		if (node->IsLeaf() == false)
+		{
+			for (uint i = 0; i < 8; i++)
+			{
+				stack.push_back(node->childs[i]);
+			}
+		}
+	}
+}
+
+void Octree::FrustumCulling(const ComponentCamera* cmp_cam, std::vector<GameObject*>& visible)
+{
+	if (root == nullptr)
+	{
+		return;
+	}
+
+	const FrustumPlanes& planes = cmp_cam->GetFrustumPlanes();
+
+	std::vector<std::pair<OctreeNode*, uint>> stack;
+	stack.push_back(std::pair<OctreeNode*, uint>(root, FRUSTUM_ALL_PLANES));
+
+	while (stack.empty() == false)
+	{
+		OctreeNode* node = stack.back().first;
+		uint mask = stack.back().second;
+		stack.pop_back();
+
+		CullResult result = CullAABB(planes, node->center, float3(node->half_size * 2.0f), mask, node->last_plane);
+
+		if (result == CULL_OUTSIDE)
+		{
+			continue;
+		}
+
+		if (result == CULL_INSIDE)
+		{
+			CollectSubtree(node, visible);
+			continue;
+		}
+
+		//Only the planes the node crosses are tested on its objects
+		CullNode(node, planes, mask, visible);
+
+		if (node->IsLeaf() == false)
+		{
+			for (uint i = 0; i < 8; i++)
+			{
+				stack.push_back(std::pair<OctreeNode*, uint>(node->childs[i], mask));
+			}
+		}
+	}
+}
+
+void Octree::FrustumCullingBruteForce(const ComponentCamera* cmp_cam, std::vector<GameObject*>& visible)
+{
+	if (root == nullptr)
+	{
+		return;
+	}
+
+	const FrustumPlanes& planes = cmp_cam->GetFrustumPlanes();
+
+	std::vector<const OctreeNode*> stack;
+	stack.push_back(root);
+
+	while (stack.empty() == false)
+	{
+		const OctreeNode* node = stack.back();
+		stack.pop_back();
+
+		CullNode(node, planes, FRUSTUM_ALL_PLANES, visible);
+
+		if (node->IsLeaf() == false)
+		{
+			for (uint i = 0; i < 8; i++)
+			{
+				stack.push_back(node->childs[i]);
+			}
+		}
+	}
+}
+
+void Octree::CullNode(const OctreeNode* node, const FrustumPlanes& planes, uint mask, std::vector<GameObject*>& visible)
+{
+	if (node->objects.empty())
+	{
+		return;
+	}
+
+	if (cull_indices.size() < node->objects.size())
+	{
+		cull_indices.resize(node->objects.size());
+	}
+
+	uint num_visible = CullAABBs(planes, mask, node->boxes, cull_indices.data());
+	for (uint i = 0; i < num_visible; i++)
+	{
+		visible.push_back(node->objects[cull_indices[i]]);
+	}
+}
+
+void Octree::CollectObjects(std::vector<GameObject*>& objects) const
+{
+	if (root != nullptr)
+	{
+		CollectSubtree(root, objects);
+	}
+}
+
+void Octree::CollectSubtree(const OctreeNode* node, std::vector<GameObject*>& objects) const
+{
+	objects.insert(objects.end(), node->objects.begin(), node->objects.end());
+
+	if (node->IsLeaf() == false)
+	{
+		for (uint i = 0; i < 8; i++)
+		{
+			CollectSubtree(node->childs[i], objects);
+		}
+	}
+}
+
+std::vector<GameObject*> Octree::RayPicking(const LineSegment& raycast) const
+{
+	std::vector<GameObject*> hits;
+	CollectIntersections(hits, raycast);
+
+	std::vector<GameObject*>::iterator it = hits.begin();
+	while (it != hits.end())
+	{
+		ComponentMesh* cmp_mesh = (ComponentMesh*)(*it)->GetComponent(Component::MESH);
+		(*it)->distance_hit = (App->editor->main_camera_component->frustum.pos - cmp_mesh->world_bb.CenterPoint());
+		++it;
+	}
+
+	return hits;
+}
+
+uint Octree::GetNumObjects() const
+{
+	return locations.size();
+}
+
+uint Octree::GetNumNodes() const
+{
+	return num_nodes;
+}
+
+uint Octree::GetMemoryUsage() const
+{
+	uint bytes = sizeof(Octree) + num_nodes * sizeof(OctreeNode);
+	bytes += locations.size() * (sizeof(GameObject*) + sizeof(float) * 6 + sizeof(std::pair<GameObject*, OctreeNode*>) + sizeof(void*) * 2);
+	return bytes;
+}
@@ -0,0 +1,126 @@
+#ifndef __OCTREE_H__
+#define __OCTREE_H__
+
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "Globals.h"
+#include "FrustumCulling.h"
+#include <unordered_map>
+#include <vector>
+
+class GameObject;
+class ComponentCamera;
+
+#define OCTREE_BUCKET 8			// Objects a leaf holds before it's divided
+#define OCTREE_MAX_DEPTH 16
+#define OCTREE_MIN_SIZE 1.0f	// Half size of the first root
+
+// Loose octree node: it holds the objects whose center is inside its box and
+// that are not bigger than it, so they always fit in twice its size
+class OctreeNode
+{
+public:
+	OctreeNode(OctreeNode* parent, const float3& center, float half_size);
+	~OctreeNode();
+
+	bool IsLeaf() const;
+	bool Fits(const AABB& box) const;
+	bool FitsInChild(const AABB& box) const;
+	uint ChildIndex(const float3& point) const;
+	AABB GetBox() const;
+	AABB GetLooseBox() const;
+	void Divide();
+
+public:
+	float3 center;
+	float half_size = 0.0f;
+	OctreeNode* parent = nullptr;
+	OctreeNode* childs[8];
+	std::vector<GameObject*> objects;
+	AABBArray boxes;			// Box of every object, same order, culled in batches
+	uint last_plane = 0;		// Plane that culled it last time, tested first
+};
+
+class Octree
+{
+public:
+	Octree();
+	~Octree();
+
+	bool Insert(GameObject* object);
+	bool Insert(GameObject* object, const AABB& box);
+	bool Remove(GameObject* object);
+	bool Update(GameObject* object);
+	bool Update(GameObject* object, const AABB& box);
+	bool Contains(GameObject* object) const;
+	void Clear();
+	void Render() const;
+
+	// Visible objects are appended, nodes fully inside are taken without more tests
+	void FrustumCulling(const ComponentCamera* cmp_cam, std::vector<GameObject*>& visible);
+	// Every node's boxes through the batched test, no hierarchy. Reference for the culling above
+	void FrustumCullingBruteForce(const ComponentCamera* cmp_cam, std::vector<GameObject*>& visible);
+	void CollectObjects(std::vector<GameObject*>& objects) const;
+	std::vector<GameObject*> RayPicking(const LineSegment& raycast) const;
+
+	// Objects whose box intersects the primitive, any MathGeoLib shape with Intersects(AABB)
+	template<typename T>
+	void CollectIntersections(std::vector<GameObject*>& objects, const T& primitive) const;
+
+	uint GetNumObjects() const;
+	uint GetNumNodes() const;
+	uint GetMemoryUsage() const;
+
+private:
+	void Grow(const float3& point);
+	void AddObject(OctreeNode* node, GameObject* object, const AABB& box);
+	void CullNode(const OctreeNode* node, const FrustumPlanes& planes, uint mask, std::vector<GameObject*>& visible);
+	void Merge(OctreeNode* node);
+	void CollectSubtree(const OctreeNode* node, std::vector<GameObject*>& objects) const;
+
+private:
+	OctreeNode* root = nullptr;
+	std::unordered_map<GameObject*, OctreeNode*> locations;		// Node of every object, for O(1) remove/update
+	uint num_nodes = 0;
+	std::vector<uint> cull_indices;		// Output of the batched test, reused every frame
+};
+
+template<typename T>
+void Octree::CollectIntersections(std::vector<GameObject*>& objects, const T& primitive) const
+{
+	if (root == nullptr)
+	{
+		return;
+	}
+
+	std::vector<const OctreeNode*> stack;
+	stack.push_back(root);
+
+	while (stack.empty() == false)
+	{
+		const OctreeNode* node = stack.back();
+		stack.pop_back();
+
+		if (primitive.Intersects(node->GetLooseBox()) == false)
+		{
+			continue;
+		}
+
+		for (uint i = 0; i < node->objects.size(); i++)
+		{
+			if (primitive.Intersects(node->boxes.Get(i)))
+			{
+				objects.push_back(node->objects[i]);
+			}
+		}
+
+		if (node->IsLeaf() == false)
+		{
+			for (uint i = 0; i < 8; i++)
+			{
+				stack.push_back(node->childs[i]);
+			}
+		}
+	}
+}
+
+#endif // !__OCTREE_H__
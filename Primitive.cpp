@@ -3,6 +3,7 @@
 #include <gl/GL.h>
 #include <gl/GLU.h>
 #include "Primitive.h"
+#include "Application.h"
 #include "glut/glut.h"
 
 #pragma comment (lib, "glut/glut32.lib")
@@ -20,6 +21,30 @@ PrimitiveTypes Primitive::GetType() const
 // ------------------------------------------------------------
 void Primitive::Render() const
 {
+	if (App->renderer3D->IsCorePath())
+	{
+		//GL reads transform as it is, column major
+		float4x4 world = transform.Transposed();
+		if (axis == true)
+		{
+			Line(world, vec(0.0f, 0.0f, 0.0f), vec(1.0f, 0.0f, 0.0f), Red);
+			Line(world, vec(1.0f, 0.1f, 0.0f), vec(1.1f, -0.1f, 0.0f), Red);
+			Line(world, vec(1.1f, 0.1f, 0.0f), vec(1.0f, -0.1f, 0.0f), Red);
+
+			Line(world, vec(0.0f, 0.0f, 0.0f), vec(0.0f, 1.0f, 0.0f), Green);
+			Line(world, vec(-0.05f, 1.25f, 0.0f), vec(0.0f, 1.15f, 0.0f), Green);
+			Line(world, vec(0.05f, 1.25f, 0.0f), vec(0.0f, 1.15f, 0.0f), Green);
+			Line(world, vec(0.0f, 1.15f, 0.0f), vec(0.0f, 1.05f, 0.0f), Green);
+
+			Line(world, vec(0.0f, 0.0f, 0.0f), vec(0.0f, 0.0f, 1.0f), Blue);
+			Line(world, vec(-0.05f, 0.1f, 1.05f), vec(0.05f, 0.1f, 1.05f), Blue);
+			Line(world, vec(0.05f, 0.1f, 1.05f), vec(-0.05f, -0.1f, 1.05f), Blue);
+			Line(world, vec(-0.05f, -0.1f, 1.05f), vec(0.05f, -0.1f, 1.05f), Blue);
+		}
+		InnerLines(world);
+		return;
+	}
+
 	glPushMatrix();
 	glMultMatrixf(*transform.v);
 
@@ -81,6 +106,22 @@ void Primitive::InnerRender() const
 	glPointSize(1.0f);
 }
 
+// ------------------------------------------------------------
+void Primitive::InnerLines(const float4x4& world) const
+{
+	//A small cross for the point
+	float s = 0.05f;
+	Line(world, vec(-s, 0.0f, 0.0f), vec(s, 0.0f, 0.0f), color);
+	Line(world, vec(0.0f, -s, 0.0f), vec(0.0f, s, 0.0f), color);
+	Line(world, vec(0.0f, 0.0f, -s), vec(0.0f, 0.0f, s), color);
+}
+
+// ------------------------------------------------------------
+void Primitive::Line(const float4x4& world, const vec& from, const vec& to, const Color& line_color) const
+{
+	App->renderer3D->DebugDrawLine(world.TransformPos(from), world.TransformPos(to), line_color);
+}
+
 // ------------------------------------------------------------
 void Primitive::SetPos(float x, float y, float z)
 {
@@ -171,6 +212,17 @@ void Cube_Prim::InnerRender() const
 	glEnd();
 }
 
+void Cube_Prim::InnerLines(const float4x4& world) const
+{
+	float3 corners[8];
+	AABB(size * -0.5f, size * 0.5f).GetCornerPoints(corners);
+	for (uint i = 0; i < 8; i++)
+	{
+		corners[i] = world.TransformPos(corners[i]);
+	}
+	App->renderer3D->DebugDrawBox(corners, color);
+}
+
 // SPHERE ============================================
 Sphere_Prim::Sphere_Prim() : Primitive(), radius(1.0f)
 {
@@ -187,6 +239,20 @@ void Sphere_Prim::InnerRender() const
 	glutSolidSphere(radius, 25, 25);
 }
 
+void Sphere_Prim::InnerLines(const float4x4& world) const
+{
+	//A circle around every axis
+	int n = 24;
+	for (int i = 0; i < n; i++)
+	{
+		float a = i * 2.0f * pi / n;
+		float b = (i + 1) * 2.0f * pi / n;
+		Line(world, vec(radius * cos(a), radius * sin(a), 0.0f), vec(radius * cos(b), radius * sin(b), 0.0f), color);
+		Line(world, vec(radius * cos(a), 0.0f, radius * sin(a)), vec(radius * cos(b), 0.0f, radius * sin(b)), color);
+		Line(world, vec(0.0f, radius * cos(a), radius * sin(a)), vec(0.0f, radius * cos(b), radius * sin(b)), color);
+	}
+}
+
 
 // CYLINDER ============================================
 Cylinder_Prim::Cylinder_Prim() : Primitive(), radius(1.0f), height(1.0f)
@@ -235,6 +301,24 @@ void Cylinder_Prim::InnerRender() const
 	glEnd();
 }
 
+void Cylinder_Prim::InnerLines(const float4x4& world) const
+{
+	//Both caps and a line along the side every few of their segments
+	int n = 30;
+	float h = height * 0.5f;
+	for (int i = 0; i < n; i++)
+	{
+		float a = i * 2.0f * pi / n;
+		float b = (i + 1) * 2.0f * pi / n;
+		Line(world, vec(-h, radius * cos(a), radius * sin(a)), vec(-h, radius * cos(b), radius * sin(b)), color);
+		Line(world, vec(h, radius * cos(a), radius * sin(a)), vec(h, radius * cos(b), radius * sin(b)), color);
+		if (i % 5 == 0)
+		{
+			Line(world, vec(-h, radius * cos(a), radius * sin(a)), vec(h, radius * cos(a), radius * sin(a)), color);
+		}
+	}
+}
+
 // LINE ==================================================
 Line_Prim::Line_Prim() : Primitive(), origin(0, 0, 0), destination(1, 1, 1)
 {
@@ -260,6 +344,11 @@ void Line_Prim::InnerRender() const
 	glLineWidth(1.0f);
 }
 
+void Line_Prim::InnerLines(const float4x4& world) const
+{
+	Line(world, origin, destination, color);
+}
+
 // PLANE ==================================================
 Plane_Prim::Plane_Prim() : Primitive(), normal(0, 1, 0), constant(1)
 {
@@ -288,4 +377,15 @@ void Plane_Prim::InnerRender() const
 	}
 
 	glEnd();
-}
\ No newline at end of file
+}
+
+void Plane_Prim::InnerLines(const float4x4& world) const
+{
+	float d = 200.0f;
+
+	for (float i = -d; i <= d; i += 1.0f)
+	{
+		Line(world, vec(i, 0.0f, -d), vec(i, 0.0f, d), color);
+		Line(world, vec(-d, 0.0f, i), vec(d, 0.0f, i), color);
+	}
+}
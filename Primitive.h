@@ -22,6 +22,7 @@ public:
 
 	virtual void	Render() const;
 	virtual void	InnerRender() const;
+	virtual void	InnerLines(const float4x4& world) const;		// The core profile path has no immediate mode, the shape goes as debug lines
 	void			SetPos(float x, float y, float z);
 	vec				GetPos();
 	void			SetRotation(float angle, const vec &u);
@@ -34,6 +35,9 @@ public:
 	float4x4 transform;
 	bool axis, wire;
 
+protected:
+	void			Line(const float4x4& world, const vec& from, const vec& to, const Color& line_color) const;
+
 protected:
 	PrimitiveTypes type;
 };
@@ -45,6 +49,7 @@ public:
 	Cube_Prim();
 	Cube_Prim(float sizeX, float sizeY, float sizeZ);
 	void InnerRender() const;
+	void InnerLines(const float4x4& world) const;
 public:
 	vec size;
 };
@@ -56,6 +61,7 @@ public:
 	Sphere_Prim();
 	Sphere_Prim(float radius);
 	void InnerRender() const;
+	void InnerLines(const float4x4& world) const;
 public:
 	float radius;
 };
@@ -67,6 +73,7 @@ public:
 	Cylinder_Prim();
 	Cylinder_Prim(float radius, float height);
 	void InnerRender() const;
+	void InnerLines(const float4x4& world) const;
 public:
 	float radius;
 	float height;
@@ -79,6 +86,7 @@ public:
 	Line_Prim();
 	Line_Prim(float x, float y, float z);
 	void InnerRender() const;
+	void InnerLines(const float4x4& world) const;
 public:
 	vec origin;
 	vec destination;
@@ -91,6 +99,7 @@ public:
 	Plane_Prim();
 	Plane_Prim(float x, float y, float z, float d);
 	void InnerRender() const;
+	void InnerLines(const float4x4& world) const;
 public:
 	vec normal;
 	float constant;
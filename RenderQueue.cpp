@@ -0,0 +1,180 @@
+#include "RenderQueue.h"
+#include "ModuleMesh.h"
+#include <algorithm>
+
+uint64_t RenderQueue::MakeKey(uint pass, uint shader, uint texture, uint mesh, uint lod, float depth)
+{
+	//Transparent draws go from the back, what's behind has to be there first
+	depth = (depth < 0.0f) ? 0.0f : ((depth > 1.0f) ? 1.0f : depth);
+	if (pass == RENDER_PASS_TRANSPARENT)
+	{
+		depth = 1.0f - depth;
+	}
+	uint64_t quantized_depth = (uint64_t)(depth * 0xFFFFF);
+
+	return ((uint64_t)(pass & 0xF) << 60) | ((uint64_t)(shader & 0xF) << 56) | ((uint64_t)(texture & 0xFFFF) << 40) |
+		((uint64_t)(mesh & 0xFFFF) << 24) | ((uint64_t)(lod & 0xF) << 20) | quantized_depth;
+}
+
+void RenderQueue::SetInstancing(bool enabled)
+{
+	instancing = enabled;
+}
+
+bool RenderQueue::IsInstancing() const
+{
+	return instancing;
+}
+
+void RenderQueue::Submit(DrawPacket& packet)
+{
+	packet.key = MakeKey(packet.pass, packet.shader, packet.texture, (packet.mesh != nullptr) ? packet.mesh->id_vertices : 0, packet.lod, packet.depth);
+	packets.push_back(packet);
+}
+
+void RenderQueue::Sort()
+{
+	//Keys and indices are sorted, the packets don't move
+	order.resize(packets.size());
+	for (uint i = 0; i < packets.size(); i++)
+	{
+		order[i].key = packets[i].key;
+		order[i].packet = i;
+	}
+	std::sort(order.begin(), order.end());
+}
+
+const std::vector<RenderCommand>& RenderQueue::Build()
+{
+	Sort();
+
+	commands.clear();
+	instances.clear();
+	num_draws = 0;
+	num_instanced = 0;
+	state_changes = 0;
+
+	//Nothing is assumed of the state left by whatever drew before
+	bool first = true;
+	uint shader = 0;
+	uint texture = 0;
+	const Mesh* mesh = nullptr;
+
+	uint i = 0;
+	while (i < order.size())
+	{
+		const DrawPacket& packet = packets[order[i].packet];
+		RenderCommand command;
+
+		if (first || packet.shader != shader)
+		{
+			command.type = RENDER_SET_SHADER;
+			command.value = shader = packet.shader;
+			commands.push_back(command);
+			state_changes++;
+		}
+
+		if (first || packet.texture != texture)
+		{
+			command.type = RENDER_BIND_TEXTURE;
+			command.value = texture = packet.texture;
+			commands.push_back(command);
+			state_changes++;
+		}
+
+		if (first || packet.mesh != mesh)
+		{
+			command.type = RENDER_BIND_MESH;
+			command.value = 0;
+			command.mesh = mesh = packet.mesh;
+			commands.push_back(command);
+			state_changes++;
+		}
+		first = false;
+
+		//The key sorts the copies of a mesh together, only the depth tells them apart
+		uint end = i + 1;
+		while (instancing && end < order.size() && SameBatch(packet, packets[order[end].packet]))
+		{
+			end++;
+		}
+
+		command.value = 0;
+		command.mesh = packet.mesh;
+		command.packet = order[i].packet;
+		if (end - i > 1)
+		{
+			command.type = RENDER_DRAW_INSTANCED;
+			command.first_instance = instances.size();
+			command.num_instances = end - i;
+			for (uint j = i; j < end; j++)
+			{
+				instances.push_back(packets[order[j].packet].transform);
+			}
+			num_instanced += end - i;
+		}
+		else
+		{
+			command.type = RENDER_DRAW;
+		}
+		commands.push_back(command);
+		num_draws++;
+
+		i = end;
+	}
+
+	return commands;
+}
+
+void RenderQueue::Clear()
+{
+	packets.clear();
+	order.clear();
+	commands.clear();
+	instances.clear();
+}
+
+uint RenderQueue::GetNumPackets() const
+{
+	return packets.size();
+}
+
+const DrawPacket& RenderQueue::GetPacket(uint index) const
+{
+	return packets[index];
+}
+
+uint RenderQueue::GetSortedPacket(uint position) const
+{
+	return order[position].packet;
+}
+
+const std::vector<RenderCommand>& RenderQueue::GetCommands() const
+{
+	return commands;
+}
+
+const std::vector<float4x4>& RenderQueue::GetInstances() const
+{
+	return instances;
+}
+
+uint RenderQueue::GetNumDraws() const
+{
+	return num_draws;
+}
+
+uint RenderQueue::GetNumInstanced() const
+{
+	return num_instanced;
+}
+
+uint RenderQueue::GetStateChanges() const
+{
+	return state_changes;
+}
+
+bool RenderQueue::SameBatch(const DrawPacket& a, const DrawPacket& b)
+{
+	return a.pass == b.pass && a.shader == b.shader && a.texture == b.texture && a.mesh == b.mesh && a.lod == b.lod;
+}
@@ -0,0 +1,108 @@
+#ifndef __RENDERQUEUE_H__
+#define __RENDERQUEUE_H__
+
+#include "Globals.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <stdint.h>
+#include <vector>
+
+struct Mesh;
+
+enum RenderPass
+{
+	RENDER_PASS_OPAQUE,		// Front to back
+	RENDER_PASS_TRANSPARENT		// Back to front
+};
+
+// Pipeline state of a draw, without shaders it's the polygon mode
+enum RenderShader
+{
+	RENDER_SHADER_SOLID,
+	RENDER_SHADER_WIREFRAME
+};
+
+// What a component wants drawn this frame
+struct DrawPacket
+{
+	uint64_t key = 0;		// Filled by Submit
+	uint pass = RENDER_PASS_OPAQUE;
+	uint shader = RENDER_SHADER_SOLID;
+	uint texture = 0;
+	const Mesh* mesh = nullptr;
+	uint lod = 0;
+	float depth = 0.0f;		// 0 at the camera, 1 at the far plane
+	float4x4 transform;		// As glMultMatrixf takes it
+};
+
+enum RenderCommandType
+{
+	RENDER_SET_SHADER,
+	RENDER_BIND_TEXTURE,
+	RENDER_BIND_MESH,
+	RENDER_DRAW,
+	RENDER_DRAW_INSTANCED
+};
+
+struct RenderCommand
+{
+	RenderCommandType type = RENDER_DRAW;
+	uint value = 0;		// Shader or texture
+	const Mesh* mesh = nullptr;
+	uint packet = 0;		// Draws, index of their packet. Instanced, the first one
+	uint first_instance = 0;		// Instanced, range in GetInstances()
+	uint num_instances = 0;
+};
+
+// Draws of a frame sorted by a 64 bit key, then turned into a stream of
+// commands where a state is only set when it changes. Packets next to each
+// other with the same mesh, level and material become one instanced draw.
+// No GL in here, the renderer runs the commands
+class RenderQueue
+{
+public:
+	// pass 4 bits | shader 4 | texture 16 | mesh 16 | lod 4 | depth 20
+	static uint64_t MakeKey(uint pass, uint shader, uint texture, uint mesh, uint lod, float depth);
+
+	void SetInstancing(bool enabled);		// Off, every packet is its own draw
+	bool IsInstancing() const;
+
+	void Submit(DrawPacket& packet);
+	void Sort();		// Only the order, for renderers that don't run the commands
+	const std::vector<RenderCommand>& Build();		// Sorts and records the commands
+	void Clear();		// The stats of the last Build stay
+
+	uint GetNumPackets() const;
+	const DrawPacket& GetPacket(uint index) const;
+	uint GetSortedPacket(uint position) const;		// Index of the packet at that place of the key order
+	const std::vector<RenderCommand>& GetCommands() const;
+	const std::vector<float4x4>& GetInstances() const;		// Transforms of the instanced draws
+	uint GetNumDraws() const;		// Draw calls, an instanced one counts once
+	uint GetNumInstanced() const;		// Packets drawn by instanced draws
+	uint GetStateChanges() const;		// Every command that isn't a draw
+
+private:
+	static bool SameBatch(const DrawPacket& a, const DrawPacket& b);
+
+	struct SortItem
+	{
+		uint64_t key;
+		uint packet;
+
+		bool operator<(const SortItem& other) const
+		{
+			return key < other.key || (key == other.key && packet < other.packet);
+		}
+	};
+
+private:
+	std::vector<DrawPacket> packets;
+	std::vector<SortItem> order;
+	std::vector<RenderCommand> commands;
+	std::vector<float4x4> instances;
+	bool instancing = false;
+	uint num_draws = 0;
+	uint num_instanced = 0;
+	uint state_changes = 0;
+};
+
+#endif // !__RENDERQUEUE_H__
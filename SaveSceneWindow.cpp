@@ -1,6 +1,7 @@
 #include "SaveSceneWindow.h"
 #include "Globals.h"
 #include "Application.h"
+#include "SceneFormat.h"
 
 SaveSceneWindow::SaveSceneWindow()
 {
@@ -27,6 +28,7 @@ void SaveSceneWindow::Render()
 	ImGui::Begin("Save Scene", &active);
 
 	ImGui::InputText("##save", name, sizeof(name));
+	ImGui::Checkbox("Binary", &binary);
 
 	if (ImGui::Button("SAVE"))
 	{	
@@ -38,7 +40,7 @@ void SaveSceneWindow::Render()
 			{
 				App->fs->MakeDirectory(library.data());
 			}
-			sprintf_s(name, 100, "%s.%s", name, "json");
+			sprintf_s(name, 100, "%s.%s", name, binary ? SCENE_EXTENSION : "json");
 			library.append(name);
 
 			App->go_manager->SaveGameObjectsOnScene(library.data());
@@ -15,6 +15,7 @@ public:
 
 private:
 	char name[100] = "";
+	bool binary = false;		// .scn instead of .json
 	std::string save_directory;
 };
 
@@ -0,0 +1,165 @@
+#ifndef __SCENEARENA_H__
+#define __SCENEARENA_H__
+
+#include "Globals.h"
+#include <algorithm>
+#include <vector>
+#include <new>
+#include <utility>
+
+#define SCENE_ARENA_BLOCK 1024		// Objects per block
+
+// Holds the objects of a scene. New objects are bump allocated one after the
+// other in big blocks, a single object can be deleted and its slot is reused,
+// and Reset destroys everything and gives the blocks back at once
+template<typename T>
+class SceneArena
+{
+public:
+	SceneArena() {}
+	~SceneArena() { Reset(); }
+
+	template<typename... Args>
+	T* New(Args&&... args);
+	void Delete(T* object);
+	void Reset();
+
+	uint GetNumObjects() const { return num_objects; }
+	uint GetNumAllocations() const { return num_allocations; }		// Since the last reset
+	uint GetNumBlocks() const { return blocks.size(); }
+	uint GetMemoryUsage() const { return blocks.size() * sizeof(Block); }
+
+private:
+	struct Block
+	{
+		alignas(T) unsigned char data[sizeof(T) * SCENE_ARENA_BLOCK];
+		bool alive[SCENE_ARENA_BLOCK];
+	};
+
+	T* Slot(uint index) const { return (T*)(blocks[index / SCENE_ARENA_BLOCK]->data) + index % SCENE_ARENA_BLOCK; }
+	bool& Alive(uint index) const { return blocks[index / SCENE_ARENA_BLOCK]->alive[index % SCENE_ARENA_BLOCK]; }
+	uint IndexOf(const T* object) const;		// next when it isn't in the arena
+
+	// Blocks by address, an object finds its block with a binary search
+	struct BlockAddress
+	{
+		const unsigned char* data;
+		uint block;
+
+		bool operator<(const BlockAddress& other) const { return data < other.data; }
+	};
+
+private:
+	std::vector<Block*> blocks;
+	std::vector<BlockAddress> addresses;
+	std::vector<uint> free_slots;
+	uint next = 0;				// First slot never used, the bump pointer
+	uint num_objects = 0;
+	uint num_allocations = 0;
+
+	SceneArena(const SceneArena&);
+	SceneArena& operator=(const SceneArena&);
+};
+
+template<typename T>
+template<typename... Args>
+T* SceneArena<T>::New(Args&&... args)
+{
+	uint index = 0;
+	if (free_slots.empty() == false)
+	{
+		index = free_slots.back();
+		free_slots.pop_back();
+	}
+	else
+	{
+		if (next == blocks.size() * SCENE_ARENA_BLOCK)
+		{
+			Block* block = new Block();
+			BlockAddress address;
+			address.data = block->data;
+			address.block = blocks.size();
+			blocks.push_back(block);
+			addresses.insert(std::upper_bound(addresses.begin(), addresses.end(), address), address);
+		}
+		index = next++;
+	}
+
+	T* object = new (Slot(index)) T(std::forward<Args>(args)...);
+	Alive(index) = true;
+	num_objects++;
+	num_allocations++;
+
+	return object;
+}
+
+template<typename T>
+uint SceneArena<T>::IndexOf(const T* object) const
+{
+	//Last block starting at or before the object, if it's inside it
+	BlockAddress key;
+	key.data = (const unsigned char*)object;
+	typename std::vector<BlockAddress>::const_iterator it = std::upper_bound(addresses.begin(), addresses.end(), key);
+	if (it == addresses.begin())
+	{
+		return next;
+	}
+	--it;
+
+	const T* first = (const T*)it->data;
+	if (object >= first + SCENE_ARENA_BLOCK)
+	{
+		return next;
+	}
+	return it->block * SCENE_ARENA_BLOCK + (object - first);
+}
+
+template<typename T>
+void SceneArena<T>::Delete(T* object)
+{
+	uint index = IndexOf(object);
+	if (index >= next || Alive(index) == false)
+	{
+		return;
+	}
+
+	Alive(index) = false;
+	object->~T();
+	free_slots.push_back(index);
+	num_objects--;
+}
+
+template<typename T>
+void SceneArena<T>::Reset()
+{
+	//Objects are marked dead first, their destructors can ask to delete others
+	std::vector<T*> objects;
+	objects.reserve(num_objects);
+	for (uint i = 0; i < next; i++)
+	{
+		if (Alive(i))
+		{
+			Alive(i) = false;
+			objects.push_back(Slot(i));
+		}
+	}
+
+	for (uint i = 0; i < objects.size(); i++)
+	{
+		objects[i]->~T();
+	}
+
+	for (uint i = 0; i < blocks.size(); i++)
+	{
+		delete blocks[i];
+	}
+
+	blocks.clear();
+	addresses.clear();
+	free_slots.clear();
+	next = 0;
+	num_objects = 0;
+	num_allocations = 0;
+}
+
+#endif // !__SCENEARENA_H__
@@ -0,0 +1,346 @@
+#include "SceneFormat.h"
+#include "Component.h"
+#include "JSON.h"
+#include "Hash.h"
+#include <stddef.h>
+
+SceneComponentRecord::SceneComponentRecord()
+{
+	memset(&transform, 0, sizeof(SceneComponentRecord) - offsetof(SceneComponentRecord, transform));
+}
+
+// SceneWriter -----------------------------------------------
+
+uint SceneWriter::AddString(const char* string)
+{
+	if (string == nullptr)
+	{
+		return SCENE_NO_STRING;
+	}
+
+	std::unordered_map<std::string, uint>::iterator it = string_offsets.find(string);
+	if (it != string_offsets.end())
+	{
+		return it->second;
+	}
+
+	uint offset = strings.size();
+	strings.append(string);
+	strings.push_back('\0');
+	string_offsets[string] = offset;
+
+	return offset;
+}
+
+void SceneWriter::AddObject(UID id, UID parent_id, const char* name, bool enabled)
+{
+	SceneObjectRecord object;
+	object.id = id;
+	object.parent_id = parent_id;
+	object.name = AddString(name);
+	object.enabled = enabled ? 1 : 0;
+	object.first_component = components.size();
+	objects.push_back(object);
+}
+
+void SceneWriter::AddComponent(const SceneComponentRecord& component)
+{
+	if (objects.empty() == false)
+	{
+		components.push_back(component);
+		objects.back().num_components++;
+	}
+}
+
+uint SceneWriter::Save(char** buffer) const
+{
+	SceneHeader header;
+	header.object_size = sizeof(SceneObjectRecord);
+	header.component_size = sizeof(SceneComponentRecord);
+	header.num_objects = objects.size();
+	header.num_components = components.size();
+	header.strings_size = strings.size();
+
+	header.objects_offset = sizeof(SceneHeader);
+	header.components_offset = header.objects_offset + header.num_objects * header.object_size;
+	header.strings_offset = header.components_offset + header.num_components * header.component_size;
+	header.file_size = header.strings_offset + header.strings_size;
+
+	char* data = new char[header.file_size];
+	memcpy(data, &header, sizeof(SceneHeader));
+	if (objects.empty() == false)
+	{
+		memcpy(data + header.objects_offset, objects.data(), header.num_objects * header.object_size);
+	}
+	if (components.empty() == false)
+	{
+		memcpy(data + header.components_offset, components.data(), header.num_components * header.component_size);
+	}
+	if (strings.empty() == false)
+	{
+		memcpy(data + header.strings_offset, strings.data(), header.strings_size);
+	}
+
+	*buffer = data;
+	return header.file_size;
+}
+
+// SceneReader -----------------------------------------------
+
+bool SceneReader::IsSceneFile(const char* data, uint size)
+{
+	uint magic = 0;
+	if (data != nullptr && size >= sizeof(magic))
+	{
+		memcpy(&magic, data, sizeof(magic));
+	}
+	return magic == SCENE_MAGIC;
+}
+
+bool SceneReader::Open(const char* data, uint size)
+{
+	this->data = nullptr;
+	header = SceneHeader();
+
+	//Everything up to the string table size is there since the first revision
+	if (IsSceneFile(data, size) == false || size < sizeof(SceneHeader))
+	{
+		LOG("Scene file not recognized");
+		return false;
+	}
+
+	SceneHeader file_header;
+	memcpy(&file_header, data, sizeof(SceneHeader));
+	if (file_header.version == 0 || file_header.header_size < sizeof(SceneHeader) || file_header.file_size > size)
+	{
+		LOG("Scene file header is not valid");
+		return false;
+	}
+
+	//Records need at least their first fields, the rest can come from another revision
+	unsigned long long objects_end = file_header.objects_offset + (unsigned long long)file_header.num_objects * file_header.object_size;
+	unsigned long long components_end = file_header.components_offset + (unsigned long long)file_header.num_components * file_header.component_size;
+	unsigned long long strings_end = file_header.strings_offset + (unsigned long long)file_header.strings_size;
+	if (file_header.object_size < offsetof(SceneObjectRecord, first_component) || file_header.component_size < offsetof(SceneComponentRecord, transform) ||
+		objects_end > file_header.file_size || components_end > file_header.file_size || strings_end > file_header.file_size ||
+		(file_header.strings_size > 0 && data[file_header.strings_offset + file_header.strings_size - 1] != '\0'))
+	{
+		LOG("Scene file is truncated or corrupted");
+		return false;
+	}
+
+	if (file_header.version > SCENE_VERSION)
+	{
+		LOG("Scene file revision %d is newer than %d, only the known fields are read", file_header.version, SCENE_VERSION);
+	}
+
+	this->data = data;
+	header = file_header;
+	return true;
+}
+
+uint SceneReader::GetNumObjects() const
+{
+	return header.num_objects;
+}
+
+uint SceneReader::GetNumComponents() const
+{
+	return header.num_components;
+}
+
+void SceneReader::GetObjectRecord(uint index, SceneObjectRecord& object) const
+{
+	object = SceneObjectRecord();
+	if (data != nullptr && index < header.num_objects)
+	{
+		uint size = (header.object_size < sizeof(SceneObjectRecord)) ? header.object_size : sizeof(SceneObjectRecord);
+		memcpy(&object, data + header.objects_offset + index * header.object_size, size);
+	}
+}
+
+void SceneReader::GetComponentRecord(uint index, SceneComponentRecord& component) const
+{
+	component = SceneComponentRecord();
+	component.type = Component::NONE;
+	if (data != nullptr && index < header.num_components)
+	{
+		uint size = (header.component_size < sizeof(SceneComponentRecord)) ? header.component_size : sizeof(SceneComponentRecord);
+		memcpy(&component, data + header.components_offset + index * header.component_size, size);
+	}
+}
+
+const char* SceneReader::GetString(uint offset) const
+{
+	if (data == nullptr || offset >= header.strings_size)
+	{
+		return nullptr;
+	}
+	return data + header.strings_offset + offset;
+}
+
+// Converters ------------------------------------------------
+
+//Same fields the components write with ToSave
+static void ComponentFromJson(Json& component_data, SceneComponentRecord& component, SceneWriter& writer)
+{
+	component.type = component_data.GetInt("type");
+	component.id = component_data.GetInt("ID Component");
+	component.enabled = component_data.GetBool("enabled") ? 1 : 0;
+
+	switch (component.type)
+	{
+	case Component::TRANSFORM:
+	{
+		float4x4 local = component_data.GetMatrix("transf_matrix");
+		memcpy(component.transform.local, local.ptr(), sizeof(component.transform.local));
+		break;
+	}
+	case Component::MESH:
+		component.flags |= component_data.GetBool("Bounding box") ? SCENE_BOUNDING_BOX : 0;
+		component.flags |= component_data.GetBool("Static", false) ? SCENE_STATIC : 0;
+		component.mesh.directory = writer.AddString(component_data.GetString("Directory"));
+		break;
+	case Component::MATERIAL:
+		component.material.directory = writer.AddString(component_data.GetString("Directory"));
+		component.material.texture_id = component_data.GetInt("ID Material");
+		break;
+	case Component::CAMERA:
+		component.flags |= component_data.GetBool("Culling") ? SCENE_CULLING : 0;
+		component.flags |= component_data.GetBool("Debug Frustum") ? SCENE_DEBUG_FRUSTUM : 0;
+		memcpy(component.camera.pos, component_data.GetFloat3("Frustum Pos").ptr(), sizeof(float) * 3);
+		memcpy(component.camera.front, component_data.GetFloat3("Frustum front").ptr(), sizeof(float) * 3);
+		memcpy(component.camera.up, component_data.GetFloat3("Frustum up").ptr(), sizeof(float) * 3);
+		component.camera.near_plane = component_data.GetFloat("Near plane");
+		component.camera.far_plane = component_data.GetFloat("Far plane");
+		component.camera.fov = component_data.GetFloat("FOV");
+		component.camera.aspect_ratio = component_data.GetFloat("Aspect ratio");
+		break;
+	}
+}
+
+static void ComponentToJson(const SceneComponentRecord& component, const SceneReader& reader, Json& component_data)
+{
+	component_data.AddInt("type", component.type);
+	component_data.AddInt("ID Component", component.id);
+	component_data.AddBool("enabled", component.enabled != 0);
+
+	switch (component.type)
+	{
+	case Component::TRANSFORM:
+	{
+		float4x4 local = float4x4::identity;
+		memcpy(local.ptr(), component.transform.local, sizeof(component.transform.local));
+		float3 rotation_deg = RadToDeg(local.ToEulerXYZ());
+
+		component_data.AddFloatArray("Translation", local.TranslatePart().ptr());
+		component_data.AddFloatArray("Rotation", rotation_deg.ptr());
+		component_data.AddFloatArray("Scale", local.GetScale().ptr());
+		component_data.AddMatrix("transf_matrix", local);
+		break;
+	}
+	case Component::MESH:
+		component_data.AddBool("Bounding box", (component.flags & SCENE_BOUNDING_BOX) != 0);
+		component_data.AddBool("Static", (component.flags & SCENE_STATIC) != 0);
+		component_data.AddString("Directory", reader.GetString(component.mesh.directory));
+		break;
+	case Component::MATERIAL:
+		component_data.AddInt("ID Material", component.material.texture_id);
+		component_data.AddString("Directory", reader.GetString(component.material.directory));
+		break;
+	case Component::CAMERA:
+		component_data.AddBool("Culling", (component.flags & SCENE_CULLING) != 0);
+		component_data.AddBool("Debug Frustum", (component.flags & SCENE_DEBUG_FRUSTUM) != 0);
+		component_data.AddFloatArray("Frustum Pos", component.camera.pos);
+		component_data.AddFloatArray("Frustum front", component.camera.front);
+		component_data.AddFloatArray("Frustum up", component.camera.up);
+		component_data.AddFloat("Near plane", component.camera.near_plane);
+		component_data.AddFloat("Far plane", component.camera.far_plane);
+		component_data.AddFloat("FOV", component.camera.fov);
+		component_data.AddFloat("Aspect ratio", component.camera.aspect_ratio);
+		break;
+	}
+}
+
+uint SceneJsonToBinary(const char* json, char** buffer)
+{
+	Json scene(json);
+	SceneWriter writer;
+
+	uint num_objects = scene.GetArraySize("Game Objects");
+	if (num_objects == (uint)-1)
+	{
+		LOG("Scene json has no game objects");
+		return 0;
+	}
+
+	for (uint i = 0; i < num_objects; i++)
+	{
+		Json object = scene.GetArray("Game Objects", i);
+
+		//Ids are hex strings, scenes saved before that have them as numbers
+		UID id = StringToHash(object.GetString("ID Game Object"));
+		UID parent_id = StringToHash(object.GetString("ID Parent"));
+		if (object.GetString("ID Game Object") == nullptr)
+		{
+			id = (UID)object.GetInt("ID Game Object");
+			parent_id = (UID)object.GetInt("ID Parent");
+		}
+
+		writer.AddObject(id, parent_id, object.GetString("Name"), object.GetBool("Enabled"));
+
+		uint num_components = object.GetArraySize("Components");
+		for (uint c = 0; c < num_components && num_components != (uint)-1; c++)
+		{
+			Json component_data = object.GetArray("Components", c);
+			SceneComponentRecord component;
+			ComponentFromJson(component_data, component, writer);
+			writer.AddComponent(component);
+		}
+	}
+
+	return writer.Save(buffer);
+}
+
+uint SceneBinaryToJson(const char* data, uint size, char** buffer)
+{
+	SceneReader reader;
+	if (reader.Open(data, size) == false)
+	{
+		return 0;
+	}
+
+	Json scene;
+	scene.AddArray("Game Objects");
+
+	char id_str[17];
+	for (uint i = 0; i < reader.GetNumObjects(); i++)
+	{
+		SceneObjectRecord object;
+		reader.GetObjectRecord(i, object);
+
+		Json object_data;
+		const char* name = reader.GetString(object.name);
+		object_data.AddString("Name", (name != nullptr) ? name : "");
+		HashToString(object.id, id_str);
+		object_data.AddString("ID Game Object", id_str);
+		HashToString(object.parent_id, id_str);
+		object_data.AddString("ID Parent", id_str);
+		object_data.AddBool("Enabled", object.enabled != 0);
+		object_data.AddArray("Components");
+
+		for (uint c = 0; c < object.num_components; c++)
+		{
+			SceneComponentRecord component;
+			reader.GetComponentRecord(object.first_component + c, component);
+
+			Json component_data;
+			ComponentToJson(component, reader, component_data);
+			object_data.AddArrayData(component_data);
+		}
+
+		scene.AddArrayData(object_data);
+	}
+
+	return scene.Save(buffer);
+}
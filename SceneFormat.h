@@ -0,0 +1,136 @@
+#ifndef __SCENEFORMAT_H__
+#define __SCENEFORMAT_H__
+
+#include "Globals.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//.scn file layout: SceneHeader, the object records, the component records and
+//the string table. Objects are in save order (parents before childs) and own a
+//contiguous range of components. Records are flat, strings are offsets into the
+//table. Sizes of the header and records are in the header, so a reader takes
+//the part it knows of a newer record and keeps the defaults for what an older
+//one misses
+#define SCENE_MAGIC 0x4E435353 // "SSCN"
+#define SCENE_VERSION 1
+#define SCENE_EXTENSION "scn"
+#define SCENE_NO_STRING 0xffffffff
+
+//Component record flags
+#define SCENE_BOUNDING_BOX (1 << 0)		// Mesh
+#define SCENE_CULLING (1 << 1)			// Camera
+#define SCENE_DEBUG_FRUSTUM (1 << 2)	// Camera
+#define SCENE_STATIC (1 << 3)			// Mesh
+
+class Json;
+
+struct SceneHeader
+{
+	uint magic = SCENE_MAGIC;
+	uint version = SCENE_VERSION;
+	uint header_size = sizeof(SceneHeader);
+	uint object_size = 0;
+	uint component_size = 0;
+	uint file_size = 0;
+
+	uint num_objects = 0;
+	uint objects_offset = 0;
+	uint num_components = 0;
+	uint components_offset = 0;
+	uint strings_offset = 0;
+	uint strings_size = 0;
+};
+
+struct SceneObjectRecord
+{
+	UID id = 0;
+	UID parent_id = 0;		// 0 for the root
+	uint name = SCENE_NO_STRING;
+	uint enabled = 1;
+	uint first_component = 0;
+	uint num_components = 0;
+};
+
+struct SceneComponentRecord
+{
+	uint type = 0;
+	uint id = 0;
+	uint enabled = 1;
+	uint flags = 0;
+
+	union
+	{
+		struct
+		{
+			float local[12];		// Local matrix, first three rows
+		} transform;
+
+		struct
+		{
+			uint directory;
+		} mesh;
+
+		struct
+		{
+			uint directory;
+			uint texture_id;
+		} material;
+
+		struct
+		{
+			float pos[3];
+			float front[3];
+			float up[3];
+			float near_plane;
+			float far_plane;
+			float fov;
+			float aspect_ratio;
+		} camera;
+	};
+
+	SceneComponentRecord();
+};
+
+// Builds a scene file record by record, no document is kept in memory
+class SceneWriter
+{
+public:
+	uint AddString(const char* string);		// Repeated strings are stored once
+	void AddObject(UID id, UID parent_id, const char* name, bool enabled);
+	void AddComponent(const SceneComponentRecord& component);		// To the last object added
+
+	// Lays out the file, buffer is allocated with new[]
+	uint Save(char** buffer) const;
+
+private:
+	std::vector<SceneObjectRecord> objects;
+	std::vector<SceneComponentRecord> components;
+	std::string strings;
+	std::unordered_map<std::string, uint> string_offsets;
+};
+
+// Reads the records straight from the file data, which must outlive the reader
+class SceneReader
+{
+public:
+	bool Open(const char* data, uint size);
+
+	uint GetNumObjects() const;
+	uint GetNumComponents() const;
+	void GetObjectRecord(uint index, SceneObjectRecord& object) const;
+	void GetComponentRecord(uint index, SceneComponentRecord& component) const;
+	const char* GetString(uint offset) const;		// nullptr for SCENE_NO_STRING or out of the table
+
+	static bool IsSceneFile(const char* data, uint size);
+
+private:
+	const char* data = nullptr;
+	SceneHeader header;
+};
+
+// Converters between the binary and the json scenes, buffer is allocated with new[]
+uint SceneJsonToBinary(const char* json, char** buffer);
+uint SceneBinaryToJson(const char* data, uint size, char** buffer);
+
+#endif // !__SCENEFORMAT_H__
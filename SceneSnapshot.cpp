@@ -0,0 +1,125 @@
+#include "Application.h"
+#include "SceneSnapshot.h"
+#include "GameObject.h"
+#include "ModuleMesh.h"
+
+SceneSnapshot::SceneSnapshot()
+{}
+
+SceneSnapshot::~SceneSnapshot()
+{
+	Clear();
+}
+
+void SceneSnapshot::Take(GameObject* root)
+{
+	Clear();
+
+	SceneWriter writer;
+	root->Save(writer);
+	size = writer.Save(&buffer);
+
+	if (scene.Open(buffer, size) == false)
+	{
+		Clear();
+		return;
+	}
+
+	objects.reserve(scene.GetNumObjects());
+	SceneObjectRecord object;
+	for (uint i = 0; i < scene.GetNumObjects(); i++)
+	{
+		scene.GetObjectRecord(i, object);
+		objects[object.id] = i;
+	}
+}
+
+void SceneSnapshot::Clear()
+{
+	delete[] buffer;
+	buffer = nullptr;
+	size = 0;
+	scene = SceneReader();
+	objects.clear();
+
+	changed.clear();
+	changed_ids.clear();
+	scene_replaced = false;
+
+	std::unordered_multimap<std::string, Mesh*>::iterator it = kept_meshes.begin();
+	while (it != kept_meshes.end())
+	{
+		App->meshes->ReleaseMesh(it->second);
+		++it;
+	}
+	kept_meshes.clear();
+}
+
+bool SceneSnapshot::IsActive() const
+{
+	return buffer != nullptr;
+}
+
+void SceneSnapshot::MarkChanged(UID id)
+{
+	if (buffer != nullptr && changed_ids.insert(id).second)
+	{
+		changed.push_back(id);
+	}
+}
+
+void SceneSnapshot::MarkSceneReplaced()
+{
+	scene_replaced = (buffer != nullptr);
+}
+
+bool SceneSnapshot::IsSceneReplaced() const
+{
+	return scene_replaced;
+}
+
+const std::vector<UID>& SceneSnapshot::GetChanged() const
+{
+	return changed;
+}
+
+bool SceneSnapshot::FindObject(UID id, uint& index) const
+{
+	std::unordered_map<UID, uint>::const_iterator it = objects.find(id);
+	if (it != objects.end())
+	{
+		index = it->second;
+		return true;
+	}
+	return false;
+}
+
+const SceneReader& SceneSnapshot::GetScene() const
+{
+	return scene;
+}
+
+void SceneSnapshot::KeepMesh(Mesh* mesh)
+{
+	if (mesh != nullptr)
+	{
+		kept_meshes.insert(std::pair<std::string, Mesh*>(mesh->directory, mesh));
+	}
+}
+
+Mesh* SceneSnapshot::TakeMesh(const char* directory)
+{
+	Mesh* ret = nullptr;
+	std::unordered_multimap<std::string, Mesh*>::iterator it = kept_meshes.find(directory);
+	if (it != kept_meshes.end())
+	{
+		ret = it->second;
+		kept_meshes.erase(it);
+	}
+	return ret;
+}
+
+uint SceneSnapshot::GetMemoryUsage() const
+{
+	return size + objects.size() * (sizeof(UID) + sizeof(uint)) + changed.capacity() * sizeof(UID);
+}
@@ -0,0 +1,54 @@
+#ifndef __SCENESNAPSHOT_H__
+#define __SCENESNAPSHOT_H__
+
+#include "Globals.h"
+#include "SceneFormat.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class GameObject;
+struct Mesh;
+
+// Copy of the scene taken when the game starts playing, kept in memory as
+// scene records. Objects that change while playing are marked, so Stop only
+// restores those. Components deleted meanwhile leave their mesh reference
+// here instead of releasing it, the restored components take it back
+class SceneSnapshot
+{
+public:
+	SceneSnapshot();
+	~SceneSnapshot();
+
+	void Take(GameObject* root);
+	void Clear();		// Kept meshes nobody took back are released
+	bool IsActive() const;
+
+	void MarkChanged(UID id);
+	void MarkSceneReplaced();		// Everything is restored, i.e. another scene was loaded
+	bool IsSceneReplaced() const;
+	const std::vector<UID>& GetChanged() const;
+
+	bool FindObject(UID id, uint& index) const;
+	const SceneReader& GetScene() const;
+
+	void KeepMesh(Mesh* mesh);
+	Mesh* TakeMesh(const char* directory);		// nullptr when no mesh of that file was kept
+
+	uint GetMemoryUsage() const;
+
+private:
+	char* buffer = nullptr;
+	uint size = 0;
+	SceneReader scene;
+	std::unordered_map<UID, uint> objects;		// Id -> record index
+
+	std::vector<UID> changed;
+	std::unordered_set<UID> changed_ids;
+	bool scene_replaced = false;
+
+	std::unordered_multimap<std::string, Mesh*> kept_meshes;
+};
+
+#endif // !__SCENESNAPSHOT_H__
@@ -0,0 +1,204 @@
+#include "StaticBatch.h"
+#include "ModuleMesh.h"
+#include "ComponentMesh.h"
+#include "VertexCompression.h"
+#include <algorithm>
+
+void StaticBatch::Add(const Mesh* mesh, const float4x4& world, uint texture, ComponentMesh* owner)
+{
+	Entry entry;
+	entry.mesh = mesh;
+	entry.world = world;
+	entry.texture = texture;
+	entry.owner = owner;
+	entry.bounds = mesh->bounds.Transform(world).MinimalEnclosingAABB();
+	entries.push_back(entry);
+}
+
+void StaticBatch::Build()
+{
+	vertices.clear();
+	indices.clear();
+	ranges.clear();
+	groups.clear();
+
+	AABB batch_bounds;
+	batch_bounds.SetNegativeInfinity();
+	for (uint i = 0; i < entries.size(); i++)
+	{
+		batch_bounds.Enclose(entries[i].bounds);
+	}
+
+	//10 bits per axis is plenty to keep neighbours together
+	for (uint i = 0; i < entries.size(); i++)
+	{
+		float3 cell = (entries[i].bounds.CenterPoint() - batch_bounds.minPoint).Div(Max(batch_bounds.Size(), float3(1e-6f, 1e-6f, 1e-6f))) * 1023.0f;
+		entries[i].order = SpreadBits((uint)cell.x) | (SpreadBits((uint)cell.y) << 1) | (SpreadBits((uint)cell.z) << 2);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+	{
+		return a.texture < b.texture || (a.texture == b.texture && a.order < b.order);
+	});
+
+	for (uint i = 0; i < entries.size(); i++)
+	{
+		const Entry& entry = entries[i];
+		if (groups.empty() || groups.back().texture != entry.texture)
+		{
+			StaticGroup group;
+			group.texture = entry.texture;
+			group.first_range = ranges.size();
+			groups.push_back(group);
+		}
+
+		StaticRange range;
+		range.owner = entry.owner;
+		range.first_index = indices.size();
+		range.bounds = entry.bounds;
+		AppendGeometry(entry);
+		range.num_indices = indices.size() - range.first_index;
+
+		entry.owner->static_range = ranges.size();
+		ranges.push_back(range);
+		groups.back().num_ranges++;
+	}
+
+	num_indices = indices.size();
+	entries.clear();
+}
+
+void StaticBatch::Clear()
+{
+	entries.clear();
+	vertices.clear();
+	indices.clear();
+	ranges.clear();
+	groups.clear();
+	num_indices = 0;
+}
+
+void StaticBatch::ReleaseGeometry()
+{
+	std::vector<StaticVertex>().swap(vertices);
+	std::vector<uint>().swap(indices);
+}
+
+void StaticBatch::SetVisible(uint range)
+{
+	ranges[range].visible = true;
+}
+
+void StaticBatch::CollectDraws(std::vector<StaticDraw>& draws)
+{
+	for (uint g = 0; g < groups.size(); g++)
+	{
+		const StaticGroup& group = groups[g];
+		bool open = false;
+
+		for (uint r = group.first_range; r < group.first_range + group.num_ranges; r++)
+		{
+			StaticRange& range = ranges[r];
+			if (range.visible == false)
+			{
+				open = false;
+				continue;
+			}
+
+			//The ranges of a group are contiguous, a visible one right after another extends its draw
+			if (open)
+			{
+				draws.back().num_indices += range.num_indices;
+			}
+			else
+			{
+				StaticDraw draw;
+				draw.texture = group.texture;
+				draw.first_index = range.first_index;
+				draw.num_indices = range.num_indices;
+				draws.push_back(draw);
+				open = true;
+			}
+			range.visible = false;
+		}
+	}
+}
+
+bool StaticBatch::IsEmpty() const
+{
+	return ranges.empty();
+}
+
+const std::vector<StaticVertex>& StaticBatch::GetVertices() const
+{
+	return vertices;
+}
+
+const std::vector<uint>& StaticBatch::GetIndices() const
+{
+	return indices;
+}
+
+const std::vector<StaticRange>& StaticBatch::GetRanges() const
+{
+	return ranges;
+}
+
+const std::vector<StaticGroup>& StaticBatch::GetGroups() const
+{
+	return groups;
+}
+
+uint StaticBatch::GetNumIndices() const
+{
+	return num_indices;
+}
+
+void StaticBatch::AppendGeometry(const Entry& entry)
+{
+	const Mesh* m = entry.mesh;
+	uint base = vertices.size();
+
+	//Normals go through the inverse transpose, scaled objects keep them right
+	float3x3 normal_matrix = entry.world.Float3x3Part();
+	normal_matrix.Inverse();
+	normal_matrix.Transpose();
+
+	vertices.resize(base + m->num_vertices);
+	for (uint i = 0; i < m->num_vertices; i++)
+	{
+		const PackedVertex& packed = m->vertices[i];
+		StaticVertex& vertex = vertices[base + i];
+
+		float3 position = entry.world.TransformPos(m->GetVertex(i));
+		vertex.position[0] = position.x;
+		vertex.position[1] = position.y;
+		vertex.position[2] = position.z;
+
+		float3 normal = (normal_matrix * OctahedralDecode(packed.normal)).Normalized();
+		vertex.normal[0] = FloatToSnorm8(normal.x);
+		vertex.normal[1] = FloatToSnorm8(normal.y);
+		vertex.normal[2] = FloatToSnorm8(normal.z);
+		vertex.normal[3] = 0;
+
+		vertex.uv[0] = packed.uv[0];
+		vertex.uv[1] = packed.uv[1];
+	}
+
+	//Only the full detail level, the batch is drawn as one
+	const MeshLod& level = m->lods[0];
+	for (uint i = level.first_index; i < level.first_index + level.num_indices; i++)
+	{
+		indices.push_back(base + m->GetIndex(i));
+	}
+}
+
+uint StaticBatch::SpreadBits(uint value)
+{
+	value &= 0x3FF;
+	value = (value | (value << 16)) & 0x030000FF;
+	value = (value | (value << 8)) & 0x0300F00F;
+	value = (value | (value << 4)) & 0x030C30C3;
+	value = (value | (value << 2)) & 0x09249249;
+	return value;
+}
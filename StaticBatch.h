@@ -0,0 +1,94 @@
+#ifndef __STATICBATCH_H__
+#define __STATICBATCH_H__
+
+#include "Globals.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <vector>
+
+struct Mesh;
+class ComponentMesh;
+
+// Vertex of the static geometry, already in world space (20 bytes)
+struct StaticVertex
+{
+	float position[3];
+	signed char normal[4];
+	unsigned short uv[2];		// Half floats
+};
+
+// Geometry of one mesh component inside the batch, culled on its own
+struct StaticRange
+{
+	ComponentMesh* owner = nullptr;
+	uint first_index = 0;
+	uint num_indices = 0;
+	AABB bounds;		// World
+	bool visible = false;		// This frame
+};
+
+// Ranges that share a material, one after the other in the index buffer
+struct StaticGroup
+{
+	uint texture = 0;
+	uint first_range = 0;
+	uint num_ranges = 0;
+};
+
+// What a group draws this frame, visible ranges next to each other are merged
+struct StaticDraw
+{
+	uint texture = 0;
+	uint first_index = 0;
+	uint num_indices = 0;
+};
+
+// Meshes that never move, transformed once and merged into one vertex and one
+// index buffer grouped by material. Inside a group the ranges follow a Morton
+// order so what the culling leaves visible tends to stay contiguous. No GL in
+// here, the renderer uploads the buffers
+class StaticBatch
+{
+public:
+	void Add(const Mesh* mesh, const float4x4& world, uint texture, ComponentMesh* owner);
+	void Build();		// Lays out what was added, owners get their range index
+	void Clear();		// Keeps the GL buffer ids
+	void ReleaseGeometry();		// Once uploaded, the CPU copy isn't needed
+
+	void SetVisible(uint range);
+	void CollectDraws(std::vector<StaticDraw>& draws);		// And resets the visibility
+
+	bool IsEmpty() const;
+	const std::vector<StaticVertex>& GetVertices() const;
+	const std::vector<uint>& GetIndices() const;
+	const std::vector<StaticRange>& GetRanges() const;
+	const std::vector<StaticGroup>& GetGroups() const;
+	uint GetNumIndices() const;
+
+public:
+	uint id_vertices = 0;
+	uint id_indices = 0;
+
+private:
+	struct Entry
+	{
+		const Mesh* mesh = nullptr;
+		float4x4 world;
+		uint texture = 0;
+		ComponentMesh* owner = nullptr;
+		AABB bounds;
+		uint order = 0;		// Morton code of the center in the batch box
+	};
+
+	void AppendGeometry(const Entry& entry);
+	static uint SpreadBits(uint value);
+
+private:
+	std::vector<Entry> entries;
+	std::vector<StaticVertex> vertices;
+	std::vector<uint> indices;
+	std::vector<StaticRange> ranges;
+	std::vector<StaticGroup> groups;
+	uint num_indices = 0;
+};
+
+#endif // !__STATICBATCH_H__
@@ -0,0 +1,176 @@
+#include "Tests.h"
+#include "AsyncLoader.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define LOAD_TEST_REQUESTS 400
+#define LOAD_TEST_WORK_MS 1.0f		// Reading and decoding one file on a worker
+#define LOAD_TEST_FINISH_MS 0.25f		// Creating its GL objects on the main thread
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static float MsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+// Busy, like decoding would be. A sleep could give the core away for much longer
+static void Spin(float ms)
+{
+	Clock::time_point start = Clock::now();
+	while (MsSince(start) < ms)
+	{}
+}
+
+TEST(LoaderKeepsFramesWithinTheBudget)
+{
+	JobSystem jobs(3);
+	AsyncLoader loader(&jobs);
+	std::thread::id main_thread = std::this_thread::get_id();
+	std::atomic<int> work_on_main(0);
+	uint finish_off_main = 0;
+
+	LoadHandle requests[LOAD_TEST_REQUESTS];
+	for (uint i = 0; i < LOAD_TEST_REQUESTS; i++)
+	{
+		requests[i] = loader.Request([&work_on_main, main_thread]()
+		{
+			Spin(LOAD_TEST_WORK_MS);
+			work_on_main += (std::this_thread::get_id() == main_thread) ? 1 : 0;
+			return true;
+		},
+		[&finish_off_main, main_thread, i](bool loaded)
+		{
+			Spin(LOAD_TEST_FINISH_MS);
+			finish_off_main += (std::this_thread::get_id() != main_thread) ? 1 : 0;
+			return loaded ? i + 1 : 0;
+		});
+	}
+
+	//The frames go on while the workers load, none waits for them. Each one
+	//counts its finish steps, wall time would count whatever else the core did
+	uint num_frames = 0;
+	uint max_frame_finished = 0;
+	Clock::time_point batch_start = Clock::now();
+	while (loader.GetNumInFlight() > 0 && MsSince(batch_start) < 10000.0f)
+	{
+		uint finished = loader.Update(LOAD_FINISH_BUDGET_MS);
+		if (finished > max_frame_finished)
+		{
+			max_frame_finished = finished;
+		}
+		num_frames++;
+	}
+
+	//Over the budget by one finish step at most
+	CHECK(max_frame_finished >= 1);
+	CHECK(max_frame_finished <= (uint)(LOAD_FINISH_BUDGET_MS / LOAD_TEST_FINISH_MS) + 1);
+	CHECK(num_frames >= LOAD_TEST_REQUESTS / ((uint)(LOAD_FINISH_BUDGET_MS / LOAD_TEST_FINISH_MS) + 1));
+
+	CHECK(loader.GetNumInFlight() == 0);
+	CHECK(loader.GetNumFinished() == LOAD_TEST_REQUESTS);
+	CHECK(work_on_main == 0);
+	CHECK(finish_off_main == 0);
+
+	bool all_ready = true;
+	for (uint i = 0; i < LOAD_TEST_REQUESTS; i++)
+	{
+		all_ready = all_ready && requests[i]->GetState() == LoadRequest::READY && requests[i]->GetResult() == i + 1;
+	}
+	CHECK(all_ready);
+}
+
+TEST(LoaderWithoutWorkersLoadsOnePerFrame)
+{
+	JobSystem jobs(0);
+	AsyncLoader loader(&jobs);
+	uint num_loaded = 0;
+
+	for (uint i = 0; i < 20; i++)
+	{
+		loader.Request([&num_loaded]() { num_loaded++; return true; }, [](bool loaded) { return 1u; });
+	}
+
+	//Nothing runs until the frames do, then one read each
+	CHECK(num_loaded == 0);
+	uint num_frames = 0;
+	while (loader.GetNumInFlight() > 0 && num_frames < 100)
+	{
+		CHECK(loader.Update(LOAD_FINISH_BUDGET_MS) == 1);
+		num_frames++;
+		CHECK(num_loaded == num_frames);
+	}
+	CHECK(num_frames == 20);
+}
+
+TEST(LoaderDiscardsCancelledLoads)
+{
+	JobSystem jobs(2);
+	AsyncLoader loader(&jobs);
+	std::atomic<int> num_work(0);
+	uint num_finish = 0;
+	uint num_discard = 0;
+
+	LoadHandle kept = loader.Request([&num_work]() { num_work++; return true; }, [&num_finish](bool loaded) { num_finish++; return 5u; }, [&num_discard](uint result) { num_discard++; });
+	LoadHandle dropped = loader.Request([&num_work]() { num_work++; return true; }, [&num_finish](bool loaded) { num_finish++; return 6u; }, [&num_discard](uint result) { num_discard++; });
+	dropped->Cancel();
+	loader.Flush();
+
+	//Whether or not its work ran, its finish step never does
+	CHECK(kept->GetState() == LoadRequest::READY && kept->GetResult() == 5);
+	CHECK(dropped->GetState() == LoadRequest::CANCELLED && dropped->GetResult() == 0);
+	CHECK(num_finish == 1);
+	CHECK(num_discard == 1);
+
+	//Cancelled once it's there, what it made is freed
+	kept->Cancel();
+	CHECK(kept->GetState() == LoadRequest::CANCELLED);
+	CHECK(num_discard == 2);
+}
+
+TEST(LoaderStaysOffTheFrameWaits)
+{
+	JobSystem jobs(1);
+	AsyncLoader loader(&jobs);
+	std::thread::id main_thread = std::this_thread::get_id();
+	std::atomic<int> work_on_main(0);
+
+	for (uint i = 0; i < 20; i++)
+	{
+		loader.Request([&work_on_main, main_thread]()
+		{
+			Spin(5.0f);
+			work_on_main += (std::this_thread::get_id() == main_thread) ? 1 : 0;
+			return true;
+		},
+		[](bool loaded) { return 1u; });
+	}
+
+	//The frame waits for its own jobs, queued after the loads, and helps with them only
+	JobCounter frame;
+	std::atomic<int> frame_jobs(0);
+	for (uint i = 0; i < 100; i++)
+	{
+		jobs.Schedule([&frame_jobs]() { Spin(0.05f); frame_jobs++; }, &frame);
+	}
+	jobs.Wait(frame);
+	CHECK(frame_jobs == 100);
+	CHECK(work_on_main == 0);
+	CHECK(loader.GetNumInFlight() == 20);
+
+	//Without workers they wait for Update
+	JobSystem no_workers(0);
+	AsyncLoader idle_loader(&no_workers);
+	uint num_loaded = 0;
+	idle_loader.Request([&num_loaded]() { num_loaded++; return true; }, [](bool loaded) { return 1u; });
+	JobCounter idle_frame;
+	no_workers.Schedule([]() {}, &idle_frame);
+	no_workers.Wait(idle_frame);
+	CHECK(num_loaded == 0);
+
+	loader.Flush();
+	idle_loader.Flush();
+	CHECK(num_loaded == 1);
+	CHECK(loader.GetNumFinished() == 20);
+}
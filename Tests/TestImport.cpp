@@ -0,0 +1,112 @@
+#include "Tests.h"
+#include "ModuleMesh.h"
+#include "Assimp/include/material.h"
+
+#define TEST_SCENE_FOLDER "Library/Test"
+
+static aiNode* AddNode(aiNode* parent, const char* name, int mesh_index)
+{
+	aiNode* node = new aiNode(name);
+	if (mesh_index >= 0)
+	{
+		node->mNumMeshes = 1;
+		node->mMeshes = new unsigned int[1];
+		node->mMeshes[0] = mesh_index;
+	}
+
+	//Four children at most in these scenes
+	if (parent->mChildren == nullptr)
+	{
+		parent->mChildren = new aiNode*[4];
+	}
+	parent->mChildren[parent->mNumChildren++] = node;
+	node->mParent = parent;
+	return node;
+}
+
+// Chair under the fbx pivots, two different meshes named Table, a Lamp that
+// shares the Chair mesh and a mesh without name. Only the Chair has a texture
+static aiScene* CreateTestScene()
+{
+	aiScene* scene = new aiScene();
+
+	scene->mNumMaterials = 2;
+	scene->mMaterials = new aiMaterial*[2];
+	scene->mMaterials[0] = new aiMaterial();
+	scene->mMaterials[1] = new aiMaterial();
+	aiString texture_path(std::string("C:\\textures\\wood.png"));
+	scene->mMaterials[1]->AddProperty(&texture_path, AI_MATKEY_TEXTURE_DIFFUSE(0));
+
+	scene->mNumMeshes = 4;
+	scene->mMeshes = new aiMesh*[4];
+	for (uint i = 0; i < 4; i++)
+	{
+		scene->mMeshes[i] = new aiMesh();
+		scene->mMeshes[i]->mMaterialIndex = (i == 0) ? 1 : 0;
+	}
+
+	scene->mRootNode = new aiNode("RootNode");
+	aiNode* pivot = AddNode(scene->mRootNode, "Chair_$AssimpFbx$_Translation", -1);
+	pivot = AddNode(pivot, "Chair_$AssimpFbx$_Rotation", -1);
+	AddNode(pivot, "Chair", 0);
+	AddNode(scene->mRootNode, "Table", 1);
+	AddNode(scene->mRootNode, "Table", 2);
+	AddNode(scene->mRootNode, "Lamp", 0);
+	AddNode(scene->mRootNode, "", 3);
+	return scene;
+}
+
+static void PlanTestScene(const aiScene* scene, ImportPlan& plan)
+{
+	//PlanImport touches nothing of the Application
+	ModuleMesh meshes(nullptr, "meshes");
+	plan.scene_folder = TEST_SCENE_FOLDER;
+	plan.mesh_files.resize(scene->mNumMeshes);
+	plan.mesh_hashes.resize(scene->mNumMeshes, 0);
+	meshes.PlanImport(scene->mRootNode, scene, plan);
+}
+
+TEST(PlanImportNamesMeshFiles)
+{
+	aiScene* scene = CreateTestScene();
+	ImportPlan plan;
+	PlanTestScene(scene, plan);
+
+	std::string folder = TEST_SCENE_FOLDER MESH_FOLDER;
+	CHECK(plan.mesh_files[0] == folder + "Chair.shl");
+	CHECK(plan.mesh_files[3] == folder + "Unnamed_mesh.shl");
+	CHECK(std::string(scene->mMeshes[0]->mName.C_Str()) == "Chair");
+	delete scene;
+}
+
+TEST(PlanImportConvertsEveryFileOnce)
+{
+	aiScene* scene = CreateTestScene();
+	ImportPlan plan;
+	PlanTestScene(scene, plan);
+
+	//The Lamp reuses the Chair file, the second Table writes to the first one's file
+	std::string folder = TEST_SCENE_FOLDER MESH_FOLDER;
+	CHECK(plan.mesh_files[1] == folder + "Table.shl");
+	CHECK(plan.mesh_files[2] == folder + "Table.shl");
+	CHECK(plan.meshes_to_import.size() == 3);
+	CHECK(plan.meshes_to_import.size() == 3 && plan.meshes_to_import[0] == 0 && plan.meshes_to_import[1] == 1 && plan.meshes_to_import[2] == 3);
+	delete scene;
+}
+
+TEST(PlanImportCollectsTextures)
+{
+	aiScene* scene = CreateTestScene();
+	ImportPlan plan;
+	PlanTestScene(scene, plan);
+
+	//The texture map is filled before the workers start, they only write the values
+	CHECK(plan.textures.size() == 1);
+	CHECK(plan.textures.count("wood.png") == 1);
+	if (plan.textures.count("wood.png") == 1)
+	{
+		CHECK(plan.textures["wood.png"].file == TEST_SCENE_FOLDER TEXTURE_FOLDER "wood.png.dds");
+		CHECK(plan.textures["wood.png"].hash == 0);
+	}
+	delete scene;
+}
@@ -0,0 +1,103 @@
+#include "Tests.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(JobsRunOnceEach)
+{
+	JobSystem jobs(3);
+	std::vector<int> runs(1000, 0);
+	JobCounter counter;
+
+	for (uint i = 0; i < runs.size(); i++)
+	{
+		jobs.Schedule([&runs, i]() { runs[i]++; }, &counter);
+	}
+	jobs.Wait(counter);
+
+	CHECK(counter.pending == 0);
+	bool once = true;
+	for (uint i = 0; i < runs.size(); i++)
+	{
+		once = once && runs[i] == 1;
+	}
+	CHECK(once);
+}
+
+TEST(JobsWithoutWorkersRunOnTheWaiter)
+{
+	JobSystem jobs(0);
+	CHECK(jobs.GetNumWorkers() == 0);
+
+	std::thread::id waiter = std::this_thread::get_id();
+	std::atomic<int> on_waiter(0);
+	JobCounter counter;
+	for (int i = 0; i < 10; i++)
+	{
+		jobs.Schedule([&on_waiter, waiter]()
+		{
+			if (std::this_thread::get_id() == waiter)
+			{
+				on_waiter++;
+			}
+		}, &counter);
+	}
+
+	//Nothing runs them until somebody waits
+	CHECK(counter.pending == 10);
+	jobs.Wait(counter);
+	CHECK(on_waiter == 10);
+}
+
+TEST(JobsUrgentGoFirst)
+{
+	JobSystem jobs(0);
+	std::vector<int> order;
+	JobCounter counter;
+
+	jobs.Schedule([&order]() { order.push_back(0); }, &counter);
+	jobs.Schedule([&order]() { order.push_back(1); }, &counter);
+	jobs.Schedule([&order]() { order.push_back(2); }, &counter, true);
+	jobs.Wait(counter);
+
+	CHECK(order.size() == 3);
+	CHECK(order.size() == 3 && order[0] == 2 && order[1] == 0 && order[2] == 1);
+}
+
+TEST(JobsNestedWaitsFinish)
+{
+	//Every job waits for the ones it spawns, the workers run them meanwhile
+	JobSystem jobs(2);
+	std::atomic<int> leaves(0);
+	JobCounter counter;
+
+	for (int i = 0; i < 16; i++)
+	{
+		jobs.Schedule([&jobs, &leaves]()
+		{
+			JobCounter children;
+			for (int j = 0; j < 16; j++)
+			{
+				jobs.Schedule([&leaves]() { leaves++; }, &children);
+			}
+			jobs.Wait(children);
+		}, &counter);
+	}
+	jobs.Wait(counter);
+
+	CHECK(leaves == 16 * 16);
+}
+
+TEST(JobsLeftQueuedRunOnDestruction)
+{
+	std::atomic<int> runs(0);
+	{
+		JobSystem jobs(0);
+		for (int i = 0; i < 5; i++)
+		{
+			jobs.Schedule([&runs]() { runs++; });
+		}
+	}
+	CHECK(runs == 5);
+}
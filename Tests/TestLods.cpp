@@ -0,0 +1,201 @@
+#include "Tests.h"
+#include "ModuleMesh.h"
+#include "MeshSimplifier.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <vector>
+
+// Unit sphere of rings x segments quads, the poles are one vertex each and
+// the seam is shared, so the whole surface is manifold
+static void MakeSphere(uint rings, uint segments, std::vector<float3>& positions, std::vector<uint>& indices)
+{
+	positions.push_back(float3(0.0f, 1.0f, 0.0f));
+	for (uint r = 1; r < rings; r++)
+	{
+		float theta = pi * r / rings;
+		for (uint s = 0; s < segments; s++)
+		{
+			float phi = 2.0f * pi * s / segments;
+			positions.push_back(float3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)));
+		}
+	}
+	positions.push_back(float3(0.0f, -1.0f, 0.0f));
+	uint bottom = positions.size() - 1;
+
+	for (uint s = 0; s < segments; s++)
+	{
+		uint next = (s + 1) % segments;
+		indices.push_back(0);
+		indices.push_back(1 + next);
+		indices.push_back(1 + s);
+
+		uint last_ring = 1 + (rings - 2) * segments;
+		indices.push_back(bottom);
+		indices.push_back(last_ring + s);
+		indices.push_back(last_ring + next);
+	}
+
+	for (uint r = 0; r + 2 < rings; r++)
+	{
+		uint ring = 1 + r * segments;
+		for (uint s = 0; s < segments; s++)
+		{
+			uint next = (s + 1) % segments;
+			indices.push_back(ring + s);
+			indices.push_back(ring + next);
+			indices.push_back(ring + segments + s);
+			indices.push_back(ring + next);
+			indices.push_back(ring + segments + next);
+			indices.push_back(ring + segments + s);
+		}
+	}
+}
+
+// Flat n x n quads on y = 0
+static void MakeGrid(uint n, std::vector<float3>& positions, std::vector<uint>& indices)
+{
+	for (uint z = 0; z <= n; z++)
+	{
+		for (uint x = 0; x <= n; x++)
+		{
+			positions.push_back(float3((float)x, 0.0f, (float)z));
+		}
+	}
+
+	for (uint z = 0; z < n; z++)
+	{
+		for (uint x = 0; x < n; x++)
+		{
+			uint corner = z * (n + 1) + x;
+			indices.push_back(corner);
+			indices.push_back(corner + n + 1);
+			indices.push_back(corner + 1);
+			indices.push_back(corner + 1);
+			indices.push_back(corner + n + 1);
+			indices.push_back(corner + n + 2);
+		}
+	}
+}
+
+// Farthest any original vertex is from the simplified surface, relative to
+// the biggest extent as SimplifyMesh measures it. Every triangle is tested
+static float SurfaceError(const std::vector<float3>& positions, const uint* indices, uint num_indices)
+{
+	AABB bounds;
+	bounds.SetFrom(positions.data(), positions.size());
+	float extent = bounds.Size().MaxElement();
+
+	float max_distance = 0.0f;
+	for (uint v = 0; v < positions.size(); v++)
+	{
+		float distance = FLOAT_INF;
+		for (uint i = 0; i < num_indices; i += 3)
+		{
+			Triangle triangle(positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]);
+			distance = Min(distance, triangle.Distance(positions[v]));
+		}
+		max_distance = Max(max_distance, distance);
+	}
+	return max_distance / extent;
+}
+
+static bool ValidTriangles(const uint* indices, uint num_indices, uint num_vertices)
+{
+	if (num_indices % 3 != 0)
+	{
+		return false;
+	}
+
+	for (uint i = 0; i < num_indices; i += 3)
+	{
+		uint a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (a >= num_vertices || b >= num_vertices || c >= num_vertices || a == b || b == c || a == c)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(LodsHalveTheTrianglesWithinTheMaxError)
+{
+	std::vector<float3> positions;
+	std::vector<uint> indices;
+	MakeSphere(32, 64, positions, indices);
+	uint num_indices = indices.size();
+
+	//The same chain GenerateLods builds at import, every level from the full mesh
+	std::vector<uint> simplified(num_indices);
+	uint previous = num_indices;
+	float previous_error = 0.0f;
+	uint num_lods = 1;
+	while (num_lods < SHL_MAX_LODS)
+	{
+		uint target = (previous / 2) / 3 * 3;
+		float error = 0.0f;
+		uint count = SimplifyMesh(simplified.data(), indices.data(), num_indices, positions[0].ptr(), positions.size(), 3, target, LOD_MAX_ERROR, &error);
+		if (count == 0 || count > previous * 3 / 4)
+		{
+			break;
+		}
+
+		CHECK(count <= target);
+		CHECK(ValidTriangles(simplified.data(), count, positions.size()));
+		CHECK(error <= LOD_MAX_ERROR);
+		CHECK(error >= previous_error);
+		CHECK(SurfaceError(positions, simplified.data(), count) <= LOD_MAX_ERROR);
+
+		previous = count;
+		previous_error = error;
+		num_lods++;
+	}
+
+	//A smooth sphere gets every level
+	CHECK(num_lods == SHL_MAX_LODS);
+}
+
+TEST(LodsStopAtTheTargetError)
+{
+	std::vector<float3> positions;
+	std::vector<uint> indices;
+	MakeSphere(32, 64, positions, indices);
+	uint num_indices = indices.size();
+
+	//Nothing but the error stops it
+	float target_error = 0.01f;
+	float error = 0.0f;
+	std::vector<uint> simplified(num_indices);
+	uint count = SimplifyMesh(simplified.data(), indices.data(), num_indices, positions[0].ptr(), positions.size(), 3, 0, target_error, &error);
+
+	CHECK(count > 0 && count < num_indices);
+	CHECK(error <= target_error);
+	CHECK(ValidTriangles(simplified.data(), count, positions.size()));
+
+	//The error is a mean over the planes around the vertices, the farthest vertex stays within a few times it
+	CHECK(SurfaceError(positions, simplified.data(), count) <= target_error * 3.0f);
+}
+
+TEST(LodsOfAFlatGridHaveNoError)
+{
+	std::vector<float3> positions;
+	std::vector<uint> indices;
+	MakeGrid(16, positions, indices);
+	uint num_indices = indices.size();
+
+	//The borders only collapse along themselves, the grid stays the same square
+	uint target = (num_indices / 8) / 3 * 3;
+	float error = 1.0f;
+	std::vector<uint> simplified(num_indices);
+	uint count = SimplifyMesh(simplified.data(), indices.data(), num_indices, positions[0].ptr(), positions.size(), 3, target, LOD_MAX_ERROR, &error);
+
+	CHECK(count <= target);
+	CHECK(error < 1e-4f);
+	CHECK(ValidTriangles(simplified.data(), count, positions.size()));
+	CHECK(SurfaceError(positions, simplified.data(), count) < 1e-4f);
+
+	float area = 0.0f;
+	for (uint i = 0; i < count; i += 3)
+	{
+		area += Triangle(positions[simplified[i]], positions[simplified[i + 1]], positions[simplified[i + 2]]).Area();
+	}
+	CHECK(Abs(area - 16.0f * 16.0f) < 1e-2f);
+}
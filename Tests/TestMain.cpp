@@ -0,0 +1,80 @@
+#include "Tests.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma comment (lib, "SDL/libx86/SDL2.lib")		// The engine sources call SDL, only Main.cpp linked it
+
+class Application;
+Application* App = nullptr;		// Nothing here runs with the Application
+
+static TestCase* first_test = nullptr;
+static TestCase* last_test = nullptr;
+static uint num_failed_checks = 0;
+
+TestRegistrar::TestRegistrar(TestCase& test, const char* name, TestFunction function)
+{
+	//Kept in the order of their files
+	test.name = name;
+	test.function = function;
+	if (last_test != nullptr)
+	{
+		last_test->next = &test;
+	}
+	else
+	{
+		first_test = &test;
+	}
+	last_test = &test;
+}
+
+bool CheckCondition(bool condition, const char* text, const char* file, int line)
+{
+	if (condition == false)
+	{
+		printf("  %s(%d): CHECK(%s) failed\n", file, line, text);
+		num_failed_checks++;
+	}
+	return condition;
+}
+
+//The engine logs to the console window, here it goes to stdout
+void log(const char file[], int line, const char* format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	vprintf(format, ap);
+	va_end(ap);
+	printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+	//Unbuffered, a crash still shows the test it happened in
+	setvbuf(stdout, nullptr, _IONBF, 0);
+
+	const char* filter = (argc > 1) ? argv[1] : nullptr;
+	uint num_tests = 0;
+	uint num_failed = 0;
+
+	for (TestCase* test = first_test; test != nullptr; test = test->next)
+	{
+		if (filter != nullptr && strstr(test->name, filter) == nullptr)
+		{
+			continue;
+		}
+
+		printf("%s\n", test->name);
+		uint failed_before = num_failed_checks;
+		test->function();
+		num_tests++;
+		if (num_failed_checks != failed_before)
+		{
+			printf("  FAILED\n");
+			num_failed++;
+		}
+	}
+
+	printf("%d tests, %d failed\n", num_tests, num_failed);
+	return num_failed;
+}
@@ -0,0 +1,170 @@
+#include "Tests.h"
+#include "MeshCache.h"
+#include "ModuleMesh.h"
+#include <map>
+#include <string>
+
+// Stands in for RequestMesh and FreeMesh, counting what the cache asks for.
+// ~Mesh unmaps through App->fs, so its meshes are never deleted
+struct CountingLoader
+{
+	std::map<std::string, uint> loads;
+	std::map<const Mesh*, uint> frees;
+	bool fail = false;
+	bool ready = true;
+
+	MeshCache::LoadFunction GetLoad()
+	{
+		return [this](const char* path) { return Load(path); };
+	}
+
+	MeshCache::FreeFunction GetFree()
+	{
+		return [this](Mesh* mesh) { frees[mesh]++; };
+	}
+
+	Mesh* Load(const char* path)
+	{
+		loads[path]++;
+		if (fail)
+		{
+			return nullptr;
+		}
+
+		Mesh* mesh = new Mesh();
+		mesh->num_vertices = 100;
+		mesh->index_size = sizeof(unsigned short);
+		mesh->num_indices = 300;
+		mesh->lods[0].num_indices = 300;
+		mesh->ready = ready;
+		return mesh;
+	}
+
+	uint GetLoads() const
+	{
+		uint total = 0;
+		for (std::map<std::string, uint>::const_iterator it = loads.begin(); it != loads.end(); ++it)
+		{
+			total += it->second;
+		}
+		return total;
+	}
+
+	uint GetFrees() const
+	{
+		uint total = 0;
+		for (std::map<const Mesh*, uint>::const_iterator it = frees.begin(); it != frees.end(); ++it)
+		{
+			total += it->second;
+		}
+		return total;
+	}
+};
+
+TEST(MeshCacheLoadsEachFileOnce)
+{
+	CountingLoader loader;
+	MeshCache cache(loader.GetLoad(), loader.GetFree());
+
+	Mesh* a = cache.Acquire("Library/a.shl");
+	Mesh* b = cache.Acquire("Library/a.shl");
+	Mesh* c = cache.Acquire("Library/c.shl");
+
+	CHECK(a != nullptr && a == b && a != c);
+	CHECK(loader.loads["Library/a.shl"] == 1);
+	CHECK(loader.GetLoads() == 2);
+	CHECK(cache.GetMisses() == 2);
+	CHECK(cache.GetHits() == 1);
+	CHECK(cache.GetReferences("Library/a.shl") == 2);
+	CHECK(cache.GetNumResident() == 2);
+}
+
+TEST(MeshCacheFreesOnLastRelease)
+{
+	CountingLoader loader;
+	MeshCache cache(loader.GetLoad(), loader.GetFree());
+
+	Mesh* a = cache.Acquire("Library/a.shl");
+	cache.Acquire("Library/a.shl");
+	cache.AddReference(a);
+
+	cache.Release(a);
+	cache.Release(a);
+	CHECK(loader.GetFrees() == 0);
+	CHECK(cache.GetReferences("Library/a.shl") == 1);
+
+	cache.Release(a);
+	CHECK(loader.frees[a] == 1);
+	CHECK(cache.GetNumEvicted() == 1);
+	CHECK(cache.GetNumResident() == 0);
+	CHECK(cache.GetResidentBytes() == 0);
+
+	//Gone for the cache, one more Release can't free it again
+	cache.Release(a);
+	CHECK(loader.frees[a] == 1);
+
+	//And the next Acquire loads it again
+	cache.Acquire("Library/a.shl");
+	CHECK(loader.loads["Library/a.shl"] == 2);
+}
+
+TEST(MeshCacheRetriesFailedLoads)
+{
+	CountingLoader loader;
+	MeshCache cache(loader.GetLoad(), loader.GetFree());
+
+	loader.fail = true;
+	CHECK(cache.Acquire("Library/missing.shl") == nullptr);
+	CHECK(cache.GetNumResident() == 0);
+
+	loader.fail = false;
+	CHECK(cache.Acquire("Library/missing.shl") != nullptr);
+	CHECK(loader.loads["Library/missing.shl"] == 2);
+	CHECK(cache.GetMisses() == 2);
+
+	CHECK(cache.Acquire(nullptr) == nullptr);
+	CHECK(loader.GetLoads() == 2);
+}
+
+TEST(MeshCacheCountsBytesOnceReady)
+{
+	CountingLoader loader;
+	MeshCache cache(loader.GetLoad(), loader.GetFree());
+	uint mesh_bytes = 100 * (sizeof(PackedVertex) + sizeof(RenderVertex)) + 300 * sizeof(unsigned short) * 2;
+
+	cache.Acquire("Library/a.shl");
+	CHECK(cache.GetResidentBytes() == mesh_bytes);
+
+	//Streamed meshes are empty until their load is back
+	loader.ready = false;
+	Mesh* streamed = cache.Acquire("Library/b.shl");
+	CHECK(cache.GetResidentBytes() == mesh_bytes);
+
+	streamed->ready = true;
+	cache.UpdateBytes(streamed);
+	CHECK(cache.GetResidentBytes() == mesh_bytes * 2);
+
+	cache.Release(streamed);
+	CHECK(cache.GetResidentBytes() == mesh_bytes);
+}
+
+TEST(MeshCacheClearFreesEverything)
+{
+	CountingLoader loader;
+	MeshCache cache(loader.GetLoad(), loader.GetFree());
+
+	Mesh* a = cache.Acquire("Library/a.shl");
+	Mesh* b = cache.Acquire("Library/b.shl");
+	cache.Acquire("Library/b.shl");
+
+	cache.Clear();
+	CHECK(loader.frees[a] == 1);
+	CHECK(loader.frees[b] == 1);
+	CHECK(cache.GetNumResident() == 0);
+	CHECK(cache.GetResidentBytes() == 0);
+
+	//Components releasing after the scene went free nothing twice
+	cache.Release(b);
+	cache.Release(a);
+	CHECK(loader.GetFrees() == 2);
+}
@@ -0,0 +1,188 @@
+#include "Tests.h"
+#include "RenderQueue.h"
+#include "ModuleMesh.h"
+#include "MathGeoLib\include\Algorithm\Random\LCG.h"
+#include <vector>
+
+#define QUEUE_TEST_MESHES 6
+#define QUEUE_TEST_PACKETS 2000
+
+// Meshes only need their buffer id for the key. ~Mesh unmaps through App->fs,
+// so they are never deleted
+static std::vector<const Mesh*> MakeMeshes()
+{
+	std::vector<const Mesh*> meshes;
+	for (uint i = 0; i < QUEUE_TEST_MESHES; i++)
+	{
+		Mesh* mesh = new Mesh();
+		mesh->id_vertices = i + 1;
+		meshes.push_back(mesh);
+	}
+	return meshes;
+}
+
+// A frame of many objects sharing a few meshes and textures, in no order
+static void SubmitFrame(RenderQueue& queue, const std::vector<const Mesh*>& meshes, LCG& rng)
+{
+	for (uint i = 0; i < QUEUE_TEST_PACKETS; i++)
+	{
+		DrawPacket packet;
+		packet.pass = (rng.Int(0, 3) == 0) ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE;
+		packet.shader = rng.Int(0, 1);
+		packet.texture = rng.Int(0, 4);
+		packet.mesh = meshes[rng.Int(0, meshes.size() - 1)];
+		packet.lod = rng.Int(0, 2);
+		packet.depth = rng.Float();
+		packet.transform = float4x4::Translate((float)i, 0.0f, 0.0f);
+		queue.Submit(packet);
+	}
+}
+
+static bool KeysInOrder(const RenderQueue& queue)
+{
+	for (uint i = 1; i < queue.GetNumPackets(); i++)
+	{
+		if (queue.GetPacket(queue.GetSortedPacket(i - 1)).key > queue.GetPacket(queue.GetSortedPacket(i)).key)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Runs the commands like the renderer would, tracking the bound state. Every
+// bind has to change something, every packet is drawn once with its own state
+// and in the order of the keys. Returns the number of problems found
+static uint CheckCommands(const RenderQueue& queue)
+{
+	uint num_errors = 0;
+	bool bound = false;		// Until the first draw everything is bound once
+	uint shader = 0;
+	uint texture = 0;
+	const Mesh* mesh = nullptr;
+	uint position = 0;
+	uint num_draws = 0;
+	uint num_state_changes = 0;
+
+	const std::vector<RenderCommand>& commands = queue.GetCommands();
+	for (uint i = 0; i < commands.size(); i++)
+	{
+		const RenderCommand& command = commands[i];
+		switch (command.type)
+		{
+		case RENDER_SET_SHADER:
+			num_errors += (bound && command.value == shader) ? 1 : 0;
+			shader = command.value;
+			num_state_changes++;
+			break;
+		case RENDER_BIND_TEXTURE:
+			num_errors += (bound && command.value == texture) ? 1 : 0;
+			texture = command.value;
+			num_state_changes++;
+			break;
+		case RENDER_BIND_MESH:
+			num_errors += (bound && command.mesh == mesh) ? 1 : 0;
+			mesh = command.mesh;
+			num_state_changes++;
+			break;
+		case RENDER_DRAW:
+		case RENDER_DRAW_INSTANCED:
+		{
+			//The first draw needs all three set
+			num_errors += (bound == false && num_state_changes < 3) ? 1 : 0;
+			bound = true;
+
+			uint count = (command.type == RENDER_DRAW_INSTANCED) ? command.num_instances : 1;
+			num_errors += (command.packet == queue.GetSortedPacket(position)) ? 0 : 1;
+			for (uint j = 0; j < count && position < queue.GetNumPackets(); j++, position++)
+			{
+				const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(position));
+				num_errors += (packet.shader == shader && packet.texture == texture && packet.mesh == mesh && command.mesh == mesh) ? 0 : 1;
+				if (command.type == RENDER_DRAW_INSTANCED)
+				{
+					num_errors += (packet.lod == queue.GetPacket(command.packet).lod) ? 0 : 1;
+					num_errors += (queue.GetInstances()[command.first_instance + j].Equals(packet.transform)) ? 0 : 1;
+				}
+			}
+			num_draws++;
+			break;
+		}
+		}
+	}
+
+	num_errors += (position == queue.GetNumPackets()) ? 0 : 1;
+	num_errors += (num_draws == queue.GetNumDraws()) ? 0 : 1;
+	num_errors += (num_state_changes == queue.GetStateChanges()) ? 0 : 1;
+	return num_errors;
+}
+
+TEST(RenderQueueSortsByKey)
+{
+	std::vector<const Mesh*> meshes = MakeMeshes();
+	LCG rng(7);
+	RenderQueue queue;
+	SubmitFrame(queue, meshes, rng);
+	queue.Sort();
+
+	CHECK(queue.GetNumPackets() == QUEUE_TEST_PACKETS);
+	CHECK(KeysInOrder(queue));
+
+	//Opaque first, then the transparent ones
+	bool transparent = false;
+	uint num_errors = 0;
+	for (uint i = 0; i < queue.GetNumPackets(); i++)
+	{
+		const DrawPacket& packet = queue.GetPacket(queue.GetSortedPacket(i));
+		num_errors += (transparent && packet.pass == RENDER_PASS_OPAQUE) ? 1 : 0;
+		transparent = packet.pass == RENDER_PASS_TRANSPARENT;
+	}
+	CHECK(num_errors == 0);
+
+	//Same state, front to back when opaque and back to front when transparent
+	CHECK(RenderQueue::MakeKey(RENDER_PASS_OPAQUE, 0, 1, 1, 0, 0.2f) < RenderQueue::MakeKey(RENDER_PASS_OPAQUE, 0, 1, 1, 0, 0.8f));
+	CHECK(RenderQueue::MakeKey(RENDER_PASS_TRANSPARENT, 0, 1, 1, 0, 0.8f) < RenderQueue::MakeKey(RENDER_PASS_TRANSPARENT, 0, 1, 1, 0, 0.2f));
+	CHECK(RenderQueue::MakeKey(RENDER_PASS_OPAQUE, 1, 0, 0, 0, 1.0f) < RenderQueue::MakeKey(RENDER_PASS_TRANSPARENT, 0, 0, 0, 0, 1.0f));
+}
+
+TEST(RenderQueueBindsOnlyOnChange)
+{
+	std::vector<const Mesh*> meshes = MakeMeshes();
+	LCG rng(11);
+	RenderQueue queue;
+	SubmitFrame(queue, meshes, rng);
+	queue.Build();
+
+	CHECK(KeysInOrder(queue));
+	CHECK(CheckCommands(queue) == 0);
+	CHECK(queue.GetNumDraws() == QUEUE_TEST_PACKETS);
+	CHECK(queue.GetNumInstanced() == 0);
+
+	//Sorted, the binds are a fraction of the draws: 2 passes x 2 shaders x 5 textures x 6 meshes at most
+	CHECK(queue.GetStateChanges() <= 2 * (2 + 2 * 5 + 2 * 5 * QUEUE_TEST_MESHES));
+}
+
+TEST(RenderQueueInstancesCopiesOfAMesh)
+{
+	std::vector<const Mesh*> meshes = MakeMeshes();
+	LCG rng(11);
+	RenderQueue queue;
+	queue.SetInstancing(true);
+	SubmitFrame(queue, meshes, rng);
+	queue.Build();
+
+	CHECK(CheckCommands(queue) == 0);
+	CHECK(queue.GetNumDraws() < QUEUE_TEST_PACKETS);
+	CHECK(queue.GetNumInstanced() > 0);
+	CHECK(queue.GetInstances().size() == queue.GetNumInstanced());
+
+	//The same frame again after a Clear gives the same stream
+	uint num_draws = queue.GetNumDraws();
+	uint state_changes = queue.GetStateChanges();
+	queue.Clear();
+	CHECK(queue.GetNumPackets() == 0);
+	LCG same_rng(11);
+	SubmitFrame(queue, meshes, same_rng);
+	queue.Build();
+	CHECK(queue.GetNumDraws() == num_draws);
+	CHECK(queue.GetStateChanges() == state_changes);
+}
@@ -0,0 +1,184 @@
+#include "Tests.h"
+#include "TextureCache.h"
+#include <vector>
+
+#define TEST_TEXTURE_SIZE 64
+
+// A TEST_TEXTURE_SIZE square filled with one value, with its mips
+static TextureImage MakeImage(unsigned char value)
+{
+	TextureImage image;
+	image.mips.resize(1);
+	image.mips[0].width = TEST_TEXTURE_SIZE;
+	image.mips[0].height = TEST_TEXTURE_SIZE;
+	image.mips[0].pixels.assign(TEST_TEXTURE_SIZE * TEST_TEXTURE_SIZE * 4, value);
+	image.BuildMips();
+	return image;
+}
+
+static uint ImageBytes()
+{
+	return MakeImage(0).GetBytes();
+}
+
+// Ids in the order the cache asked to upload them
+struct UploadLog
+{
+	std::vector<uint> ids;
+
+	TextureCache::UploadFunction GetUpload()
+	{
+		return [this](uint id, const TextureImage& image) { ids.push_back(id); };
+	}
+};
+
+TEST(TextureCacheSharesTexturesByContent)
+{
+	TextureCache cache(1024 * 1024, 1024 * 1024);
+
+	//Two files with the same contents, hashed once each
+	uint64_t hash = 0;
+	CHECK(cache.FindPath("Assets/Textures/a.png", hash) == false);
+	cache.AddPath("Assets/Textures/a.png", 42);
+	cache.AddPath("Assets/Textures/copy_of_a.png", 42);
+	CHECK(cache.FindPath("Assets/Textures/copy_of_a.png", hash) && hash == 42);
+
+	CHECK(cache.Acquire(42) == 0);
+	cache.Add(42, 7);
+	CHECK(cache.Acquire(42) == 7);
+	CHECK(cache.Acquire(42) == 7);
+
+	CHECK(cache.GetNumTextures() == 1);
+	CHECK(cache.GetReferences(42) == 3);
+	CHECK(cache.GetHits() == 2);
+	CHECK(cache.GetMisses() == 1);
+
+	//Only the last release gives the id to free
+	CHECK(cache.Release(7) == 0);
+	CHECK(cache.Release(7) == 0);
+	CHECK(cache.Release(7) == 7);
+	CHECK(cache.GetNumTextures() == 0);
+	CHECK(cache.Release(7) == 0);
+}
+
+TEST(TextureCacheUploadsWithinTheBudget)
+{
+	uint image_bytes = ImageBytes();
+	TextureCache cache(image_bytes * 16, image_bytes * 3 / 2);
+	UploadLog log;
+
+	for (uint i = 1; i <= 5; i++)
+	{
+		TextureImage image = MakeImage(i);
+		cache.StoreImage(i, image);
+		cache.Add(i, i);
+	}
+
+	//Each frame goes over the budget by one texture at most, in the order they came
+	CHECK(cache.Upload(log.GetUpload()) == 2);
+	CHECK(cache.GetUploadedBytes() == image_bytes * 2);
+	CHECK(cache.Upload(log.GetUpload()) == 2);
+	CHECK(cache.Upload(log.GetUpload()) == 1);
+	CHECK(cache.Upload(log.GetUpload()) == 0);
+	CHECK(log.ids.size() == 5 && log.ids[0] == 1 && log.ids[4] == 5);
+
+	//One per frame even if it alone is over the budget
+	cache.SetBudgets(image_bytes * 16, 1);
+	for (uint i = 6; i <= 7; i++)
+	{
+		TextureImage image = MakeImage(i);
+		cache.StoreImage(i, image);
+		cache.Add(i, i);
+	}
+	CHECK(cache.Upload(log.GetUpload()) == 1);
+	CHECK(cache.Upload(log.GetUpload()) == 1);
+	CHECK(cache.GetNumPending() == 0);
+}
+
+TEST(TextureCacheKeepsImagesWithinTheCPUBudget)
+{
+	uint image_bytes = ImageBytes();
+	TextureCache cache(image_bytes * 2, image_bytes * 16);
+
+	for (uint i = 1; i <= 4; i++)
+	{
+		TextureImage image = MakeImage(i);
+		cache.StoreImage(i, image);
+	}
+	CHECK(cache.GetCPUBytes() <= image_bytes * 2);
+	CHECK(cache.GetNumImages() == 2);
+
+	//The least recently used goes, using 3 keeps it
+	CHECK(cache.GetImage(3) != nullptr);
+	TextureImage image = MakeImage(5);
+	cache.StoreImage(5, image);
+	CHECK(cache.GetImage(3) != nullptr);
+	CHECK(cache.GetImage(4) == nullptr);
+	CHECK(cache.GetImage(5) != nullptr);
+	CHECK(cache.GetImage(3)->mips[0].pixels[0] == 3);
+}
+
+TEST(TextureCacheKeepsImagesUntilUploaded)
+{
+	uint image_bytes = ImageBytes();
+	TextureCache cache(image_bytes, image_bytes * 16);
+	UploadLog log;
+
+	//Over the budget while they wait, the upload needs them
+	for (uint i = 1; i <= 3; i++)
+	{
+		TextureImage image = MakeImage(i);
+		cache.StoreImage(i, image);
+		cache.Add(i, i);
+	}
+	CHECK(cache.GetNumImages() == 3);
+
+	CHECK(cache.Upload(log.GetUpload()) == 3);
+	CHECK(cache.GetCPUBytes() <= image_bytes);
+}
+
+TEST(TextureCacheSkipsTexturesReleasedBeforeUpload)
+{
+	TextureCache cache(ImageBytes() * 16, ImageBytes() * 16);
+	UploadLog log;
+
+	for (uint i = 1; i <= 3; i++)
+	{
+		TextureImage image = MakeImage(i);
+		cache.StoreImage(i, image);
+		cache.Add(i, i);
+	}
+
+	CHECK(cache.Release(2) == 2);
+	CHECK(cache.Upload(log.GetUpload()) == 2);
+	CHECK(log.ids.size() == 2 && log.ids[0] == 1 && log.ids[1] == 3);
+
+	//Its image is still there if the same texture comes back
+	CHECK(cache.GetImage(2) != nullptr);
+}
+
+TEST(TextureImageMipsDownToOneTexel)
+{
+	TextureImage image;
+	image.mips.resize(1);
+	image.mips[0].width = 5;
+	image.mips[0].height = 3;
+	for (uint i = 0; i < 5 * 3; i++)
+	{
+		unsigned char value = (unsigned char)(i * 10);
+		image.mips[0].pixels.push_back(value);
+		image.mips[0].pixels.push_back(value);
+		image.mips[0].pixels.push_back(value);
+		image.mips[0].pixels.push_back(255);
+	}
+	image.BuildMips();
+
+	CHECK(image.mips.size() == 3);
+	CHECK(image.mips.size() == 3 && image.mips[1].width == 2 && image.mips[1].height == 1);
+	CHECK(image.mips.size() == 3 && image.mips[2].width == 1 && image.mips[2].height == 1);
+
+	//Texel 0 of level 1 is the average of texels 0, 1, 5 and 6
+	CHECK(image.mips[1].pixels[0] == (0 + 10 + 50 + 60 + 2) / 4);
+	CHECK(image.mips[1].pixels[3] == 255);
+	CHECK(image.GetBytes() == (5 * 3 + 2 + 1) * 4);
+}
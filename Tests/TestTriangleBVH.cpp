@@ -0,0 +1,178 @@
+#include "Tests.h"
+#include "TriangleBVH.h"
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "MathGeoLib\include\Algorithm\Random\LCG.h"
+#include <vector>
+
+#define BVH_TEST_RAYS 5000
+#define BVH_EDGE_MARGIN 1e-4f		// Hits closer than this to an edge may go either way in float
+
+struct BruteHit
+{
+	bool hit = false;
+	bool near_edge = false;
+	float distance = FLOAT_INF;
+};
+
+// Closest hit testing every triangle, the same Moller-Trumbore as the BVH in scalar
+static BruteHit BruteRayCast(const std::vector<float3>& positions, const std::vector<uint>& indices, const float3& origin, const float3& direction)
+{
+	BruteHit ret;
+	float closest_edge = FLOAT_INF;
+	for (uint i = 0; i < indices.size(); i += 3)
+	{
+		const float3& v0 = positions[indices[i]];
+		float3 e1 = positions[indices[i + 1]] - v0;
+		float3 e2 = positions[indices[i + 2]] - v0;
+
+		float3 p = direction.Cross(e2);
+		float det = e1.Dot(p);
+		if (Abs(det) <= 1e-12f)
+		{
+			continue;
+		}
+
+		float3 t = origin - v0;
+		float u = t.Dot(p) / det;
+		float3 q = t.Cross(e1);
+		float v = direction.Dot(q) / det;
+		float distance = e2.Dot(q) / det;
+
+		if (distance < 0.0f)
+		{
+			continue;
+		}
+
+		if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && distance < ret.distance)
+		{
+			ret.hit = true;
+			ret.distance = distance;
+		}
+
+		//Hits on an edge, or that barely miss it, could be taken or not by the BVH
+		if (u > -BVH_EDGE_MARGIN && v > -BVH_EDGE_MARGIN && u + v < 1.0f + BVH_EDGE_MARGIN &&
+			(u < BVH_EDGE_MARGIN || v < BVH_EDGE_MARGIN || u + v > 1.0f - BVH_EDGE_MARGIN))
+		{
+			closest_edge = Min(closest_edge, distance);
+		}
+	}
+
+	ret.near_edge = closest_edge <= ret.distance + BVH_EDGE_MARGIN;
+	return ret;
+}
+
+// Random triangles of different sizes in the unit cube, overlapping and in every orientation
+static void MakeTriangleSoup(LCG& rng, uint num_triangles, std::vector<float3>& positions, std::vector<uint>& indices)
+{
+	for (uint i = 0; i < num_triangles; i++)
+	{
+		float3 center(rng.Float(0.0f, 1.0f), rng.Float(0.0f, 1.0f), rng.Float(0.0f, 1.0f));
+		float size = (i % 10 == 0) ? 0.3f : 0.03f;
+		for (uint v = 0; v < 3; v++)
+		{
+			indices.push_back(positions.size());
+			positions.push_back(center + float3(rng.Float(-size, size), rng.Float(-size, size), rng.Float(-size, size)));
+		}
+	}
+}
+
+static float3 RandomPoint(LCG& rng, float min, float max)
+{
+	return float3(rng.Float(min, max), rng.Float(min, max), rng.Float(min, max));
+}
+
+TEST(BVHMatchesBruteForce)
+{
+	LCG rng(1234);
+	std::vector<float3> positions;
+	std::vector<uint> indices;
+	MakeTriangleSoup(rng, 2000, positions, indices);
+
+	TriangleBVH bvh;
+	bvh.Build(positions.data(), indices.data(), indices.size() / 3);
+
+	uint num_hits = 0;
+	uint num_compared = 0;
+	uint num_mismatches = 0;
+	for (uint i = 0; i < BVH_TEST_RAYS; i++)
+	{
+		//From outside and from inside the soup, directions not normalized
+		float3 origin = (i % 2 == 0) ? RandomPoint(rng, -1.0f, 2.0f) : RandomPoint(rng, 0.0f, 1.0f);
+		float3 direction = RandomPoint(rng, 0.0f, 1.0f) - origin + RandomPoint(rng, -0.2f, 0.2f);
+		if (direction.LengthSq() < 1e-6f)
+		{
+			continue;
+		}
+
+		BruteHit expected = BruteRayCast(positions, indices, origin, direction);
+		float distance = 0.0f;
+		uint triangle = 0;
+		bool hit = bvh.RayCast(origin, direction, FLOAT_INF, distance, &triangle);
+		if (expected.near_edge)
+		{
+			continue;
+		}
+
+		num_compared++;
+		num_hits += expected.hit ? 1 : 0;
+		if (hit != expected.hit || (hit && Abs(distance - expected.distance) > 1e-4f * Max(1.0f, expected.distance)))
+		{
+			num_mismatches++;
+		}
+		else if (hit)
+		{
+			//The triangle given is the one hit at that distance
+			BruteHit alone = BruteRayCast(positions, std::vector<uint>(indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3), origin, direction);
+			num_mismatches += (alone.hit && Abs(alone.distance - distance) <= 1e-4f * Max(1.0f, distance)) ? 0 : 1;
+		}
+	}
+
+	CHECK(num_mismatches == 0);
+	CHECK(num_compared > BVH_TEST_RAYS * 9 / 10);
+	CHECK(num_hits > num_compared / 4);		// Not only misses
+}
+
+TEST(BVHStopsAtMaxDistance)
+{
+	LCG rng(99);
+	std::vector<float3> positions;
+	std::vector<uint> indices;
+	MakeTriangleSoup(rng, 500, positions, indices);
+
+	TriangleBVH bvh;
+	bvh.Build(positions.data(), indices.data(), indices.size() / 3);
+
+	uint num_mismatches = 0;
+	for (uint i = 0; i < 2000; i++)
+	{
+		float3 origin = RandomPoint(rng, -1.0f, 2.0f);
+		float3 direction = RandomPoint(rng, 0.0f, 1.0f) - origin;
+		float max_distance = rng.Float(0.0f, 1.0f);
+
+		//The closest hit decides, whatever is farther doesn't count
+		BruteHit closest = BruteRayCast(positions, indices, origin, direction);
+		float distance = 0.0f;
+		bool hit = bvh.RayCast(origin, direction, max_distance, distance);
+		if (closest.near_edge || Abs(closest.distance - max_distance) < 1e-4f)
+		{
+			continue;
+		}
+
+		bool expected = closest.hit && closest.distance < max_distance;
+		if (hit != expected || (hit && Abs(distance - closest.distance) > 1e-4f))
+		{
+			num_mismatches++;
+		}
+	}
+	CHECK(num_mismatches == 0);
+}
+
+TEST(BVHOfNothingNeverHits)
+{
+	TriangleBVH bvh;
+	float distance = 0.0f;
+	CHECK(bvh.RayCast(float3::zero, float3::unitX, FLOAT_INF, distance) == false);
+
+	bvh.Build(nullptr, nullptr, 0);
+	CHECK(bvh.RayCast(float3::zero, float3::unitX, FLOAT_INF, distance) == false);
+}
@@ -0,0 +1,35 @@
+#ifndef __TESTS_H__
+#define __TESTS_H__
+
+#include "Globals.h"
+
+// Headless checks over the parts of the engine that don't need a window or GL.
+// Every TEST registers itself before main, Tests.exe runs them all or the ones
+// with the name given in the command line, and returns the number of failures
+typedef void(*TestFunction)();
+
+struct TestCase
+{
+	const char* name = nullptr;
+	TestFunction function = nullptr;
+	TestCase* next = nullptr;
+};
+
+class TestRegistrar
+{
+public:
+	TestRegistrar(TestCase& test, const char* name, TestFunction function);
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestCase name##_case; \
+	static TestRegistrar name##_registrar(name##_case, #name, name); \
+	static void name()
+
+//A failed check is reported and the test goes on
+#define CHECK(condition) CheckCondition((condition), #condition, __FILE__, __LINE__)
+
+bool CheckCondition(bool condition, const char* text, const char* file, int line);
+
+#endif // !__TESTS_H__
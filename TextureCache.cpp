@@ -0,0 +1,265 @@
+#include "TextureCache.h"
+
+// TextureImage ----------------------------------------------
+
+uint TextureImage::GetBytes() const
+{
+	uint bytes = 0;
+	for (uint i = 0; i < mips.size(); i++)
+	{
+		bytes += mips[i].pixels.size();
+	}
+	return bytes;
+}
+
+void TextureImage::BuildMips()
+{
+	if (mips.empty())
+	{
+		return;
+	}
+	mips.resize(1);
+
+	while (mips.back().width > 1 || mips.back().height > 1)
+	{
+		const TextureMip& src = mips.back();
+		TextureMip dst;
+		dst.width = (src.width > 1) ? src.width / 2 : 1;
+		dst.height = (src.height > 1) ? src.height / 2 : 1;
+		dst.pixels.resize(dst.width * dst.height * 4);
+
+		//Average of the 2x2 block, edges of odd sizes repeat the last texel
+		for (uint y = 0; y < dst.height; y++)
+		{
+			uint y0 = y * 2;
+			uint y1 = (y0 + 1 < src.height) ? y0 + 1 : y0;
+			for (uint x = 0; x < dst.width; x++)
+			{
+				uint x0 = x * 2;
+				uint x1 = (x0 + 1 < src.width) ? x0 + 1 : x0;
+				for (uint c = 0; c < 4; c++)
+				{
+					uint sum = src.pixels[(y0 * src.width + x0) * 4 + c] + src.pixels[(y0 * src.width + x1) * 4 + c] +
+						src.pixels[(y1 * src.width + x0) * 4 + c] + src.pixels[(y1 * src.width + x1) * 4 + c];
+					dst.pixels[(y * dst.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		mips.push_back(TextureMip());
+		mips.back().width = dst.width;
+		mips.back().height = dst.height;
+		mips.back().pixels.swap(dst.pixels);
+	}
+}
+
+// TextureCache ----------------------------------------------
+
+TextureCache::TextureCache(uint cpu_budget, uint upload_budget) : cpu_budget(cpu_budget), upload_budget(upload_budget)
+{}
+
+void TextureCache::SetBudgets(uint cpu_budget, uint upload_budget)
+{
+	this->cpu_budget = cpu_budget;
+	this->upload_budget = upload_budget;
+	Trim();
+}
+
+bool TextureCache::FindPath(const char* path, uint64_t& hash) const
+{
+	std::unordered_map<std::string, uint64_t>::const_iterator it = paths.find(path);
+	if (it != paths.end())
+	{
+		hash = it->second;
+		return true;
+	}
+	return false;
+}
+
+void TextureCache::AddPath(const char* path, uint64_t hash)
+{
+	paths[path] = hash;
+}
+
+uint TextureCache::Acquire(uint64_t hash)
+{
+	std::unordered_map<uint64_t, uint>::const_iterator it = ids.find(hash);
+	if (it == ids.end())
+	{
+		misses++;
+		return 0;
+	}
+
+	hits++;
+	textures[it->second].references++;
+	return it->second;
+}
+
+void TextureCache::Add(uint64_t hash, uint id)
+{
+	Texture& texture = textures[id];
+	texture.hash = hash;
+	texture.references = 1;
+	texture.pending = true;
+
+	ids[hash] = id;
+	pending.push_back(id);
+}
+
+uint TextureCache::Release(uint id)
+{
+	std::unordered_map<uint, Texture>::iterator it = textures.find(id);
+	if (it == textures.end() || --it->second.references > 0)
+	{
+		return 0;
+	}
+
+	//The decoded image stays in the CPU cache, if it's used again it isn't decoded
+	ids.erase(it->second.hash);
+	textures.erase(it);
+	Trim();
+
+	return id;
+}
+
+const TextureImage* TextureCache::GetImage(uint64_t hash)
+{
+	std::unordered_map<uint64_t, CachedImage>::iterator it = images.find(hash);
+	if (it == images.end())
+	{
+		image_misses++;
+		return nullptr;
+	}
+
+	image_hits++;
+	lru.splice(lru.begin(), lru, it->second.lru);
+	return &it->second.image;
+}
+
+void TextureCache::StoreImage(uint64_t hash, TextureImage& image)
+{
+	std::unordered_map<uint64_t, CachedImage>::iterator it = images.find(hash);
+	if (it != images.end())
+	{
+		cpu_bytes -= it->second.bytes;
+		lru.erase(it->second.lru);
+		images.erase(it);
+	}
+
+	CachedImage& cached = images[hash];
+	cached.image.mips.swap(image.mips);
+	cached.bytes = cached.image.GetBytes();
+	lru.push_front(hash);
+	cached.lru = lru.begin();
+	cpu_bytes += cached.bytes;
+
+	Trim();
+}
+
+void TextureCache::Trim()
+{
+	//From the least recently used, images still waiting for their upload stay
+	//and so does the last one used, its texture may not be added yet
+	std::list<uint64_t>::iterator it = lru.end();
+	while (cpu_bytes > cpu_budget && it != lru.begin())
+	{
+		--it;
+		if (it == lru.begin())
+		{
+			break;
+		}
+
+		std::unordered_map<uint64_t, uint>::const_iterator id = ids.find(*it);
+		if (id != ids.end() && textures[id->second].pending)
+		{
+			continue;
+		}
+
+		std::unordered_map<uint64_t, CachedImage>::iterator image = images.find(*it);
+		cpu_bytes -= image->second.bytes;
+		images.erase(image);
+		it = lru.erase(it);
+	}
+}
+
+uint TextureCache::Upload(const UploadFunction& upload)
+{
+	uint num_uploads = 0;
+	uploaded_bytes = 0;
+
+	while (pending.empty() == false && (num_uploads == 0 || uploaded_bytes < upload_budget))
+	{
+		uint id = pending.front();
+		pending.pop_front();
+
+		//Released before its turn
+		std::unordered_map<uint, Texture>::iterator texture = textures.find(id);
+		if (texture == textures.end() || texture->second.pending == false)
+		{
+			continue;
+		}
+		texture->second.pending = false;
+
+		std::unordered_map<uint64_t, CachedImage>::iterator image = images.find(texture->second.hash);
+		if (image != images.end())
+		{
+			upload(id, image->second.image);
+			uploaded_bytes += image->second.bytes;
+			num_uploads++;
+		}
+	}
+
+	Trim();
+	return num_uploads;
+}
+
+uint TextureCache::GetNumTextures() const
+{
+	return textures.size();
+}
+
+uint TextureCache::GetNumPending() const
+{
+	return pending.size();
+}
+
+uint TextureCache::GetReferences(uint64_t hash) const
+{
+	std::unordered_map<uint64_t, uint>::const_iterator it = ids.find(hash);
+	return (it != ids.end()) ? textures.at(it->second).references : 0;
+}
+
+uint TextureCache::GetHits() const
+{
+	return hits;
+}
+
+uint TextureCache::GetMisses() const
+{
+	return misses;
+}
+
+uint TextureCache::GetImageHits() const
+{
+	return image_hits;
+}
+
+uint TextureCache::GetImageMisses() const
+{
+	return image_misses;
+}
+
+uint TextureCache::GetCPUBytes() const
+{
+	return cpu_bytes;
+}
+
+uint TextureCache::GetNumImages() const
+{
+	return images.size();
+}
+
+uint TextureCache::GetUploadedBytes() const
+{
+	return uploaded_bytes;
+}
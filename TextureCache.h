@@ -0,0 +1,105 @@
+#ifndef __TEXTURECACHE_H__
+#define __TEXTURECACHE_H__
+
+#include "Globals.h"
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+
+// One level of a decoded texture, RGBA 8 bits per channel
+struct TextureMip
+{
+	uint width = 0;
+	uint height = 0;
+	std::vector<unsigned char> pixels;
+};
+
+struct TextureImage
+{
+	std::vector<TextureMip> mips;		// Full chain down to 1x1 once built
+
+	uint GetBytes() const;
+	void BuildMips();		// Box filtered levels from the first one
+};
+
+// Book keeping of the textures, no GL in here. Textures are keyed by the hash
+// of the file contents, so the same image under two names is one texture.
+// Decoded images stay in a CPU cache of limited size (least recently used go
+// first) and new textures wait in a queue, uploaded a few per frame
+class TextureCache
+{
+public:
+	typedef std::function<void(uint id, const TextureImage& image)> UploadFunction;
+
+	TextureCache(uint cpu_budget, uint upload_budget);
+
+	void SetBudgets(uint cpu_budget, uint upload_budget);		// Bytes
+
+	//Files already hashed, so they aren't read again
+	bool FindPath(const char* path, uint64_t& hash) const;
+	void AddPath(const char* path, uint64_t hash);
+
+	//Textures in use, id is whatever the caller names them with
+	uint Acquire(uint64_t hash);		// 0 if there's no texture for it yet
+	void Add(uint64_t hash, uint id);		// First reference, it waits for its upload
+	uint Release(uint id);		// The id to free when the last reference goes, else 0
+
+	const TextureImage* GetImage(uint64_t hash);
+	void StoreImage(uint64_t hash, TextureImage& image);		// The image is moved in
+
+	// Uploads queued textures until the budget of the frame is spent, at least one
+	uint Upload(const UploadFunction& upload);
+
+	uint GetNumTextures() const;
+	uint GetNumPending() const;
+	uint GetReferences(uint64_t hash) const;
+	uint GetHits() const;
+	uint GetMisses() const;
+	uint GetImageHits() const;
+	uint GetImageMisses() const;
+	uint GetCPUBytes() const;
+	uint GetNumImages() const;
+	uint GetUploadedBytes() const;		// In the last Upload call
+
+private:
+	struct Texture
+	{
+		uint64_t hash = 0;
+		uint references = 0;
+		bool pending = false;		// Waiting for its upload, its image can't leave the cache
+	};
+
+	struct CachedImage
+	{
+		TextureImage image;
+		uint bytes = 0;
+		std::list<uint64_t>::iterator lru;
+	};
+
+	void Trim();
+
+private:
+	uint cpu_budget = 0;
+	uint upload_budget = 0;
+
+	std::unordered_map<std::string, uint64_t> paths;
+	std::unordered_map<uint, Texture> textures;		// By id
+	std::unordered_map<uint64_t, uint> ids;		// Hash -> id
+	std::deque<uint> pending;
+
+	std::unordered_map<uint64_t, CachedImage> images;
+	std::list<uint64_t> lru;		// Most recently used first
+	uint cpu_bytes = 0;
+
+	uint hits = 0;
+	uint misses = 0;
+	uint image_hits = 0;
+	uint image_misses = 0;
+	uint uploaded_bytes = 0;
+};
+
+#endif // !__TEXTURECACHE_H__
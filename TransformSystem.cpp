@@ -0,0 +1,216 @@
+#include "TransformSystem.h"
+#include "GameObject.h"
+#include "Component.h"
+#include "ComponentTransform.h"
+
+TransformSystem::TransformSystem()
+{
+}
+
+TransformSystem::~TransformSystem()
+{
+}
+
+uint TransformSystem::Add(ComponentTransform* owner)
+{
+	//Goes at the end until the next rebuild puts it in its level
+	local.push_back(float4x4::identity);
+	world.push_back(float4x4::identity);
+	parents.push_back(TRANSFORM_NO_PARENT);
+	flags.push_back(DIRTY);
+	owners.push_back(owner);
+
+	order_dirty = true;
+
+	return owners.size() - 1;
+}
+
+void TransformSystem::Remove(uint slot)
+{
+	if (slot < owners.size())
+	{
+		owners[slot] = nullptr;
+		order_dirty = true;
+	}
+}
+
+void TransformSystem::Invalidate()
+{
+	order_dirty = true;
+}
+
+void TransformSystem::SetLocal(uint slot, const float4x4& matrix)
+{
+	if (memcmp(&local[slot], &matrix, sizeof(float4x4)) != 0)
+	{
+		local[slot] = matrix;
+		flags[slot] |= DIRTY;
+		any_dirty = true;
+	}
+}
+
+const float4x4& TransformSystem::GetLocal(uint slot) const
+{
+	return local[slot];
+}
+
+const float4x4& TransformSystem::GetWorld(uint slot) const
+{
+	return world[slot];
+}
+
+void TransformSystem::Update(GameObject* root)
+{
+	num_updated = 0;
+
+	if (order_dirty)
+	{
+		Rebuild(root);
+	}
+
+	if (any_dirty == false)
+	{
+		return;
+	}
+	any_dirty = false;
+
+	//Parents go first, a child is recomputed when it or its parent changed
+	changed.clear();
+	for (uint i = 0; i < owners.size(); i++)
+	{
+		flags[i] &= ~CHANGED;
+		if ((flags[i] & IN_SCENE) == 0)
+		{
+			continue;
+		}
+
+		int parent = parents[i];
+		if ((flags[i] & DIRTY) || (parent != TRANSFORM_NO_PARENT && (flags[parent] & CHANGED)))
+		{
+			world[i] = (parent == TRANSFORM_NO_PARENT) ? local[i] : world[parent] * local[i];
+			flags[i] = (flags[i] & ~DIRTY) | CHANGED;
+			changed.push_back(i);
+		}
+	}
+	num_updated = changed.size();
+
+	//Components are told after the pass, they can move their transform again (cameras do)
+	std::vector<uint>::const_iterator it = changed.begin();
+	while (it != changed.end())
+	{
+		owners[*it]->go->UpdateGameObjectTransform();
+		++it;
+	}
+}
+
+void TransformSystem::Rebuild(GameObject* root)
+{
+	uint count = owners.size();
+	std::vector<int> remap(count, TRANSFORM_NO_PARENT);
+	std::vector<uint> order;
+	std::vector<int> new_parents;
+	order.reserve(count);
+	new_parents.reserve(count);
+
+	//Scene level by level, every object with the slot of its closest ancestor with a transform
+	std::vector<std::pair<GameObject*, int>> level;
+	std::vector<std::pair<GameObject*, int>> next_level;
+	if (root != nullptr)
+	{
+		level.push_back(std::pair<GameObject*, int>(root, TRANSFORM_NO_PARENT));
+	}
+
+	while (level.empty() == false)
+	{
+		std::vector<std::pair<GameObject*, int>>::const_iterator it = level.begin();
+		while (it != level.end())
+		{
+			GameObject* go = (*it).first;
+			int ancestor = (*it).second;
+
+			ComponentTransform* transform = (ComponentTransform*)go->GetComponent(Component::TRANSFORM);
+			if (transform != nullptr && transform->slot < count && owners[transform->slot] == transform && remap[transform->slot] == TRANSFORM_NO_PARENT)
+			{
+				remap[transform->slot] = order.size();
+				order.push_back(transform->slot);
+				new_parents.push_back((go->GetParent() == nullptr) ? TRANSFORM_NO_PARENT : ancestor);
+				ancestor = remap[transform->slot];
+			}
+
+			std::vector<GameObject*>::const_iterator child = go->childs.begin();
+			while (child != go->childs.end())
+			{
+				next_level.push_back(std::pair<GameObject*, int>(*child, ancestor));
+				++child;
+			}
+			++it;
+		}
+
+		level.swap(next_level);
+		next_level.clear();
+	}
+
+	uint num_in_scene = order.size();
+
+	//Transforms outside the scene are kept at the end and not updated
+	for (uint i = 0; i < count; i++)
+	{
+		if (owners[i] != nullptr && remap[i] == TRANSFORM_NO_PARENT)
+		{
+			remap[i] = order.size();
+			order.push_back(i);
+			new_parents.push_back(TRANSFORM_NO_PARENT);
+		}
+	}
+
+	std::vector<float4x4> new_local(order.size());
+	std::vector<float4x4> new_world(order.size());
+	std::vector<unsigned char> new_flags(order.size());
+	std::vector<ComponentTransform*> new_owners(order.size());
+
+	for (uint i = 0; i < order.size(); i++)
+	{
+		uint old_slot = order[i];
+		new_local[i] = local[old_slot];
+		new_world[i] = world[old_slot];
+		new_owners[i] = owners[old_slot];
+		new_owners[i]->slot = i;
+
+		unsigned char flag = flags[old_slot] & DIRTY;
+		if (i < num_in_scene)
+		{
+			//Moved to another parent or just entered the scene
+			int old_parent = parents[old_slot];
+			int moved_parent = (old_parent == TRANSFORM_NO_PARENT) ? TRANSFORM_NO_PARENT : remap[old_parent];
+			if ((flags[old_slot] & IN_SCENE) == 0 || moved_parent != new_parents[i])
+			{
+				flag |= DIRTY;
+			}
+			flag |= IN_SCENE;
+		}
+
+		if (flag & DIRTY)
+		{
+			any_dirty = true;
+		}
+		new_flags[i] = flag;
+	}
+
+	local.swap(new_local);
+	world.swap(new_world);
+	parents.swap(new_parents);
+	flags.swap(new_flags);
+	owners.swap(new_owners);
+
+	order_dirty = false;
+}
+
+uint TransformSystem::GetNumTransforms() const
+{
+	return owners.size();
+}
+
+uint TransformSystem::GetNumUpdated() const
+{
+	return num_updated;
+}
@@ -0,0 +1,60 @@
+#ifndef __TRANSFORMSYSTEM_H__
+#define __TRANSFORMSYSTEM_H__
+
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "Globals.h"
+#include <vector>
+
+class GameObject;
+class ComponentTransform;
+
+#define TRANSFORM_NO_PARENT -1
+
+// Local and world matrices of every transform in contiguous arrays. Parents
+// always come before their childs (the scene is stored level by level), so a
+// single pass in order recomputes the world matrices of what moved and of
+// everything below it
+class TransformSystem
+{
+public:
+	TransformSystem();
+	~TransformSystem();
+
+	uint Add(ComponentTransform* owner);
+	void Remove(uint slot);
+	void Invalidate();		// The hierarchy changed, the order is rebuilt on the next update
+
+	void SetLocal(uint slot, const float4x4& matrix);
+	const float4x4& GetLocal(uint slot) const;
+	const float4x4& GetWorld(uint slot) const;
+
+	// Rebuilds the order if needed and updates the dirty subtrees of the scene under root
+	void Update(GameObject* root);
+
+	uint GetNumTransforms() const;
+	uint GetNumUpdated() const;
+
+private:
+	void Rebuild(GameObject* root);
+
+private:
+	enum Flags
+	{
+		DIRTY = 1 << 0,			// Local matrix changed
+		CHANGED = 1 << 1,		// World matrix recomputed this update
+		IN_SCENE = 1 << 2		// Reached from the root, objects outside the scene are not updated
+	};
+
+	std::vector<float4x4> local;
+	std::vector<float4x4> world;
+	std::vector<int> parents;
+	std::vector<unsigned char> flags;
+	std::vector<ComponentTransform*> owners;
+	std::vector<uint> changed;		// Slots recomputed in the last update
+
+	bool order_dirty = false;
+	bool any_dirty = false;
+	uint num_updated = 0;
+};
+
+#endif // !__TRANSFORMSYSTEM_H__
@@ -0,0 +1,371 @@
+#include "TriangleBVH.h"
+#include <algorithm>
+#include <emmintrin.h>
+
+#define BVH_MAX_DEPTH 32		// Deeper nodes are split at the median, keeps the traversal stack bounded
+#define BVH_STACK_SIZE 64
+
+static float SurfaceArea(const AABB& box)
+{
+	if (box.minPoint.x > box.maxPoint.x)
+	{
+		return 0.0f;
+	}
+
+	float3 size = box.Size();
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+TriangleBVH::TriangleBVH()
+{
+}
+
+TriangleBVH::~TriangleBVH()
+{
+}
+
+void TriangleBVH::Build(const float3* positions, const uint* indices, uint num_triangles)
+{
+	Clear();
+
+	if (num_triangles == 0)
+	{
+		return;
+	}
+
+	build_positions = positions;
+	build_indices = indices;
+
+	std::vector<uint> triangles(num_triangles);
+	std::vector<AABB> boxes(num_triangles);
+	std::vector<float3> centroids(num_triangles);
+
+	for (uint i = 0; i < num_triangles; i++)
+	{
+		const float3& a = positions[indices[i * 3]];
+		const float3& b = positions[indices[i * 3 + 1]];
+		const float3& c = positions[indices[i * 3 + 2]];
+
+		triangles[i] = i;
+		boxes[i] = AABB(a.Min(b).Min(c), a.Max(b).Max(c));
+		centroids[i] = boxes[i].CenterPoint();
+	}
+
+	nodes.reserve(2 * num_triangles / BVH_LEAF_TRIANGLES + 1);
+	packets.reserve(num_triangles / BVH_LEAF_TRIANGLES + 1);
+
+	nodes.push_back(BVHNode());
+	Subdivide(0, 0, triangles, boxes, centroids, 0, num_triangles);
+
+	build_positions = nullptr;
+	build_indices = nullptr;
+}
+
+void TriangleBVH::Subdivide(uint node_index, uint depth, std::vector<uint>& triangles, const std::vector<AABB>& boxes, const std::vector<float3>& centroids, uint first, uint count)
+{
+	AABB bounds;
+	AABB centroid_bounds;
+	bounds.SetNegativeInfinity();
+	centroid_bounds.SetNegativeInfinity();
+
+	for (uint i = first; i < first + count; i++)
+	{
+		bounds.Enclose(boxes[triangles[i]]);
+		centroid_bounds.Enclose(centroids[triangles[i]]);
+	}
+
+	nodes[node_index].min_point = bounds.minPoint;
+	nodes[node_index].max_point = bounds.maxPoint;
+
+	if (count <= BVH_LEAF_TRIANGLES)
+	{
+		AddLeaf(nodes[node_index], triangles, first, count);
+		return;
+	}
+
+	//Binned SAH, every axis, the split with the smallest area * triangles wins
+	int best_axis = -1;
+	uint best_bin = 0;
+	float best_cost = FLOAT_INF;
+	float3 extent = centroid_bounds.Size();
+
+	for (int axis = 0; axis < 3 && depth < BVH_MAX_DEPTH; axis++)
+	{
+		if (extent[axis] <= 0.0f)
+		{
+			continue;
+		}
+
+		AABB bin_boxes[BVH_BINS];
+		uint bin_counts[BVH_BINS] = { 0 };
+		for (uint b = 0; b < BVH_BINS; b++)
+		{
+			bin_boxes[b].SetNegativeInfinity();
+		}
+
+		float scale = BVH_BINS / extent[axis];
+		for (uint i = first; i < first + count; i++)
+		{
+			uint bin = Min((uint)((centroids[triangles[i]][axis] - centroid_bounds.minPoint[axis]) * scale), (uint)BVH_BINS - 1);
+			bin_boxes[bin].Enclose(boxes[triangles[i]]);
+			bin_counts[bin]++;
+		}
+
+		//Areas from the right, then sweep from the left
+		float right_areas[BVH_BINS];
+		uint right_counts[BVH_BINS];
+		AABB right_box;
+		right_box.SetNegativeInfinity();
+		uint right_count = 0;
+		for (uint b = BVH_BINS - 1; b > 0; b--)
+		{
+			right_box.Enclose(bin_boxes[b]);
+			right_count += bin_counts[b];
+			right_areas[b] = SurfaceArea(right_box);
+			right_counts[b] = right_count;
+		}
+
+		AABB left_box;
+		left_box.SetNegativeInfinity();
+		uint left_count = 0;
+		for (uint b = 0; b < BVH_BINS - 1; b++)
+		{
+			left_box.Enclose(bin_boxes[b]);
+			left_count += bin_counts[b];
+
+			if (left_count == 0 || right_counts[b + 1] == 0)
+			{
+				continue;
+			}
+
+			float cost = SurfaceArea(left_box) * left_count + right_areas[b + 1] * right_counts[b + 1];
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_axis = axis;
+				best_bin = b;
+			}
+		}
+	}
+
+	uint middle = first;
+	if (best_axis >= 0)
+	{
+		float scale = BVH_BINS / extent[best_axis];
+		float min_value = centroid_bounds.minPoint[best_axis];
+
+		uint* begin = &triangles[first];
+		uint* split = std::partition(begin, begin + count, [&](uint t)
+		{
+			return Min((uint)((centroids[t][best_axis] - min_value) * scale), (uint)BVH_BINS - 1) <= best_bin;
+		});
+		middle = first + (split - begin);
+	}
+
+	//Too deep or all the centroids in the same place, half and half along the longest axis
+	if (middle == first || middle == first + count)
+	{
+		int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+		middle = first + count / 2;
+
+		std::nth_element(triangles.begin() + first, triangles.begin() + middle, triangles.begin() + first + count, [&](uint a, uint b)
+		{
+			return centroids[a][axis] < centroids[b][axis];
+		});
+	}
+
+	uint left = nodes.size();
+	nodes.resize(left + 2);
+	nodes[node_index].first = left;
+	nodes[node_index].count = 0;
+
+	Subdivide(left, depth + 1, triangles, boxes, centroids, first, middle - first);
+	Subdivide(left + 1, depth + 1, triangles, boxes, centroids, middle, first + count - middle);
+}
+
+void TriangleBVH::AddLeaf(BVHNode& node, const std::vector<uint>& triangles, uint first, uint count)
+{
+	node.first = packets.size();
+	node.count = count;
+
+	TrianglePacket packet;
+	memset(&packet, 0, sizeof(TrianglePacket));
+
+	for (uint i = 0; i < count; i++)
+	{
+		uint triangle = triangles[first + i];
+		const float3& v0 = build_positions[build_indices[triangle * 3]];
+		float3 e1 = build_positions[build_indices[triangle * 3 + 1]] - v0;
+		float3 e2 = build_positions[build_indices[triangle * 3 + 2]] - v0;
+
+		packet.v0_x[i] = v0.x;
+		packet.v0_y[i] = v0.y;
+		packet.v0_z[i] = v0.z;
+		packet.e1_x[i] = e1.x;
+		packet.e1_y[i] = e1.y;
+		packet.e1_z[i] = e1.z;
+		packet.e2_x[i] = e2.x;
+		packet.e2_y[i] = e2.y;
+		packet.e2_z[i] = e2.z;
+		packet.triangle[i] = triangle;
+	}
+
+	packets.push_back(packet);
+}
+
+void TriangleBVH::Clear()
+{
+	nodes.clear();
+	packets.clear();
+}
+
+// Slab test, distance where the ray enters the box or FLOAT_INF if it misses
+static float IntersectBox(const BVHNode& node, const float3& origin, const float3& inv_direction, float max_distance)
+{
+	float3 t1 = (node.min_point - origin).Mul(inv_direction);
+	float3 t2 = (node.max_point - origin).Mul(inv_direction);
+
+	float t_near = t1.Min(t2).MaxElement();
+	float t_far = t1.Max(t2).MinElement();
+
+	if (t_near > t_far || t_far < 0.0f || t_near > max_distance)
+	{
+		return FLOAT_INF;
+	}
+	return t_near;
+}
+
+bool TriangleBVH::RayCast(const float3& origin, const float3& direction, float max_distance, float& distance, uint* triangle) const
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	bool ret = false;
+	float3 inv_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	float closest = max_distance;
+
+	__m128 origin_x = _mm_set1_ps(origin.x);
+	__m128 origin_y = _mm_set1_ps(origin.y);
+	__m128 origin_z = _mm_set1_ps(origin.z);
+	__m128 dir_x = _mm_set1_ps(direction.x);
+	__m128 dir_y = _mm_set1_ps(direction.y);
+	__m128 dir_z = _mm_set1_ps(direction.z);
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 epsilon = _mm_set1_ps(1e-12f);
+	__m128 sign_mask = _mm_set1_ps(-0.0f);
+
+	uint stack[BVH_STACK_SIZE];
+	uint stack_size = 0;
+
+	if (IntersectBox(nodes[0], origin, inv_direction, closest) != FLOAT_INF)
+	{
+		stack[stack_size++] = 0;
+	}
+
+	while (stack_size > 0)
+	{
+		const BVHNode& node = nodes[stack[--stack_size]];
+
+		if (node.count > 0)
+		{
+			//Moller-Trumbore on the four triangles of the leaf at once
+			const TrianglePacket& packet = packets[node.first];
+
+			__m128 e1_x = _mm_loadu_ps(packet.e1_x);
+			__m128 e1_y = _mm_loadu_ps(packet.e1_y);
+			__m128 e1_z = _mm_loadu_ps(packet.e1_z);
+			__m128 e2_x = _mm_loadu_ps(packet.e2_x);
+			__m128 e2_y = _mm_loadu_ps(packet.e2_y);
+			__m128 e2_z = _mm_loadu_ps(packet.e2_z);
+
+			//p = direction x e2, det = e1 . p
+			__m128 p_x = _mm_sub_ps(_mm_mul_ps(dir_y, e2_z), _mm_mul_ps(dir_z, e2_y));
+			__m128 p_y = _mm_sub_ps(_mm_mul_ps(dir_z, e2_x), _mm_mul_ps(dir_x, e2_z));
+			__m128 p_z = _mm_sub_ps(_mm_mul_ps(dir_x, e2_y), _mm_mul_ps(dir_y, e2_x));
+			__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1_x, p_x), _mm_mul_ps(e1_y, p_y)), _mm_mul_ps(e1_z, p_z));
+			__m128 valid = _mm_cmpgt_ps(_mm_andnot_ps(sign_mask, det), epsilon);
+			__m128 inv_det = _mm_div_ps(one, det);
+
+			//u = (origin - v0) . p / det
+			__m128 t_x = _mm_sub_ps(origin_x, _mm_loadu_ps(packet.v0_x));
+			__m128 t_y = _mm_sub_ps(origin_y, _mm_loadu_ps(packet.v0_y));
+			__m128 t_z = _mm_sub_ps(origin_z, _mm_loadu_ps(packet.v0_z));
+			__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(t_x, p_x), _mm_mul_ps(t_y, p_y)), _mm_mul_ps(t_z, p_z)), inv_det);
+
+			//q = (origin - v0) x e1, v = direction . q / det, distance = e2 . q / det
+			__m128 q_x = _mm_sub_ps(_mm_mul_ps(t_y, e1_z), _mm_mul_ps(t_z, e1_y));
+			__m128 q_y = _mm_sub_ps(_mm_mul_ps(t_z, e1_x), _mm_mul_ps(t_x, e1_z));
+			__m128 q_z = _mm_sub_ps(_mm_mul_ps(t_x, e1_y), _mm_mul_ps(t_y, e1_x));
+			__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dir_x, q_x), _mm_mul_ps(dir_y, q_y)), _mm_mul_ps(dir_z, q_z)), inv_det);
+			__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2_x, q_x), _mm_mul_ps(e2_y, q_y)), _mm_mul_ps(e2_z, q_z)), inv_det);
+
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+			valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+			valid = _mm_and_ps(valid, _mm_cmpge_ps(t, zero));
+			valid = _mm_and_ps(valid, _mm_cmplt_ps(t, _mm_set1_ps(closest)));
+
+			int hits = _mm_movemask_ps(valid);
+			if (hits != 0)
+			{
+				float distances[4];
+				_mm_storeu_ps(distances, t);
+
+				for (uint i = 0; i < 4; i++)
+				{
+					if ((hits & (1 << i)) && distances[i] < closest)
+					{
+						closest = distances[i];
+						if (triangle != nullptr)
+						{
+							*triangle = packet.triangle[i];
+						}
+						ret = true;
+					}
+				}
+			}
+			continue;
+		}
+
+		//Closest child is pushed last so it's visited first
+		uint left = node.first;
+		float left_distance = IntersectBox(nodes[left], origin, inv_direction, closest);
+		float right_distance = IntersectBox(nodes[left + 1], origin, inv_direction, closest);
+
+		if (left_distance > right_distance)
+		{
+			std::swap(left_distance, right_distance);
+			left++;
+		}
+		uint right = (left == node.first) ? node.first + 1 : node.first;
+
+		if (right_distance != FLOAT_INF)
+		{
+			stack[stack_size++] = right;
+		}
+		if (left_distance != FLOAT_INF)
+		{
+			stack[stack_size++] = left;
+		}
+	}
+
+	if (ret)
+	{
+		distance = closest;
+	}
+
+	return ret;
+}
+
+uint TriangleBVH::GetNumNodes() const
+{
+	return nodes.size();
+}
+
+uint TriangleBVH::GetMemoryUsage() const
+{
+	return sizeof(TriangleBVH) + nodes.capacity() * sizeof(BVHNode) + packets.capacity() * sizeof(TrianglePacket);
+}
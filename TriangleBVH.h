@@ -0,0 +1,57 @@
+#ifndef __TRIANGLEBVH_H__
+#define __TRIANGLEBVH_H__
+
+#include "MathGeoLib\include\MathGeoLib.h"
+#include "Globals.h"
+#include <vector>
+
+#define BVH_LEAF_TRIANGLES 4		// One packet, tested together
+#define BVH_BINS 12					// SAH candidates per axis
+
+struct BVHNode
+{
+	float3 min_point;
+	uint first = 0;			// Leaf: packet index. Inner: index of the left child, the right one follows
+	float3 max_point;
+	uint count = 0;			// Triangles in the leaf, 0 for inner nodes
+};
+
+// Four triangles in Moller-Trumbore form, one array per component. Unused
+// slots have null edges so they never hit
+struct TrianglePacket
+{
+	float v0_x[4], v0_y[4], v0_z[4];
+	float e1_x[4], e1_y[4], e1_z[4];
+	float e2_x[4], e2_y[4], e2_z[4];
+	uint triangle[4];
+};
+
+// Bounding volume hierarchy over the triangles of a mesh, for ray casts
+class TriangleBVH
+{
+public:
+	TriangleBVH();
+	~TriangleBVH();
+
+	void Build(const float3* positions, const uint* indices, uint num_triangles);
+	void Clear();
+
+	// Closest hit in [0, max_distance] along origin + direction * distance.
+	// The direction doesn't need to be normalized, distances are in its units
+	bool RayCast(const float3& origin, const float3& direction, float max_distance, float& distance, uint* triangle = nullptr) const;
+
+	uint GetNumNodes() const;
+	uint GetMemoryUsage() const;
+
+private:
+	void Subdivide(uint node_index, uint depth, std::vector<uint>& triangles, const std::vector<AABB>& boxes, const std::vector<float3>& centroids, uint first, uint count);
+	void AddLeaf(BVHNode& node, const std::vector<uint>& triangles, uint first, uint count);
+
+private:
+	std::vector<BVHNode> nodes;
+	std::vector<TrianglePacket> packets;
+	const float3* build_positions = nullptr;		// Only valid while building
+	const uint* build_indices = nullptr;
+};
+
+#endif // !__TRIANGLEBVH_H__
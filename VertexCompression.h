@@ -0,0 +1,191 @@
+#ifndef __VERTEXCOMPRESSION_H__
+#define __VERTEXCOMPRESSION_H__
+
+#include "MathGeoLib\include\MathGeoLib.h"
+#include <string.h>
+
+#define SNORM16_MAX 32767.0f
+#define SNORM8_MAX 127.0f
+
+// Interleaved vertex as stored in the .shl files (16 bytes)
+struct PackedVertex
+{
+	short position[4];			// snorm16 against the mesh AABB, w unused
+	short normal[2];			// octahedral encoded, snorm16
+	unsigned short uv[2];		// half floats
+};
+
+// Interleaved vertex as uploaded to the GPU (16 bytes). Fixed function
+// can't decode octahedral normals so they are expanded to snorm8
+struct RenderVertex
+{
+	short position[4];
+	signed char normal[4];
+	unsigned short uv[2];
+};
+
+//-- Snorm -----------------------------------------
+
+inline short FloatToSnorm16(float value)
+{
+	value = Clamp(value, -1.0f, 1.0f) * SNORM16_MAX;
+	return (short)(value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+
+inline float Snorm16ToFloat(short value)
+{
+	return Max(value / SNORM16_MAX, -1.0f);
+}
+
+inline signed char FloatToSnorm8(float value)
+{
+	value = Clamp(value, -1.0f, 1.0f) * SNORM8_MAX;
+	return (signed char)(value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+
+//-- Half floats -----------------------------------
+
+inline unsigned short FloatToHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int mantissa = bits & 0x7fffff;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+
+	//NaN and infinity
+	if (((bits >> 23) & 0xff) == 0xff)
+	{
+		return (unsigned short)(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+	}
+
+	//Too big, clamp to infinity
+	if (exponent >= 31)
+	{
+		return (unsigned short)(sign | 0x7c00);
+	}
+
+	//Subnormal or zero
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return (unsigned short)sign;
+		}
+
+		mantissa |= 0x800000;
+		unsigned int shift = 14 - exponent;
+		unsigned int half = mantissa >> shift;
+		half += (mantissa >> (shift - 1)) & 1;
+		return (unsigned short)(sign | half);
+	}
+
+	//Rounding may carry into the exponent, which is still the right result
+	unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+	half += (mantissa >> 12) & 1;
+	return (unsigned short)half;
+}
+
+inline float HalfToFloat(unsigned short half)
+{
+	unsigned int sign = (half & 0x8000) << 16;
+	int exponent = (half >> 10) & 0x1f;
+	unsigned int mantissa = half & 0x3ff;
+	unsigned int bits;
+
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			//Normalize the subnormal
+			exponent = 1;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3ff;
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	float ret;
+	memcpy(&ret, &bits, sizeof(ret));
+	return ret;
+}
+
+//-- Octahedral normals ----------------------------
+
+inline void OctahedralEncode(const float3& normal, short out[2])
+{
+	float length = Abs(normal.x) + Abs(normal.y) + Abs(normal.z);
+	float2 e = float2::zero;
+
+	if (length > 0.0f)
+	{
+		e = float2(normal.x / length, normal.y / length);
+		if (normal.z < 0.0f)
+		{
+			float x = (1.0f - Abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+			float y = (1.0f - Abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+			e = float2(x, y);
+		}
+	}
+
+	out[0] = FloatToSnorm16(e.x);
+	out[1] = FloatToSnorm16(e.y);
+}
+
+inline float3 OctahedralDecode(const short in[2])
+{
+	float3 n(Snorm16ToFloat(in[0]), Snorm16ToFloat(in[1]), 0.0f);
+	n.z = 1.0f - Abs(n.x) - Abs(n.y);
+
+	float t = Max(-n.z, 0.0f);
+	n.x += (n.x >= 0.0f) ? -t : t;
+	n.y += (n.y >= 0.0f) ? -t : t;
+
+	return n.Normalized();
+}
+
+//-- Positions -------------------------------------
+
+// Half size of the box used to quantize, never zero so flat meshes survive
+inline float3 QuantizationExtents(const AABB& bounds)
+{
+	float3 extents = bounds.HalfSize();
+	extents.x = Max(extents.x, 1e-6f);
+	extents.y = Max(extents.y, 1e-6f);
+	extents.z = Max(extents.z, 1e-6f);
+	return extents;
+}
+
+inline void QuantizePosition(const float3& position, const AABB& bounds, short out[4])
+{
+	float3 local = (position - bounds.CenterPoint()).Div(QuantizationExtents(bounds));
+	out[0] = FloatToSnorm16(local.x);
+	out[1] = FloatToSnorm16(local.y);
+	out[2] = FloatToSnorm16(local.z);
+	out[3] = 0;
+}
+
+inline float3 DequantizePosition(const short in[4], const AABB& bounds)
+{
+	float3 local(in[0] / SNORM16_MAX, in[1] / SNORM16_MAX, in[2] / SNORM16_MAX);
+	return bounds.CenterPoint() + local.Mul(QuantizationExtents(bounds));
+}
+
+#endif // !__VERTEXCOMPRESSION_H__
@@ -1,6 +1,7 @@
 #pragma once
 #include "Globals.h"
 #include "Application.h"
+#include <mutex>
 
 
 void log(const char file[], int line, const char* format, ...)
@@ -8,6 +9,10 @@ void log(const char file[], int line, const char* format, ...)
 	static char tmp_string[4096];
 	static char tmp_string2[4096];
 	static va_list  ap;
+	static std::mutex log_mutex;
+
+	//Importers log from worker threads too
+	std::lock_guard<std::mutex> lock(log_mutex);
 
 	// Construct the string from variable arguments
 	va_start(ap, format);